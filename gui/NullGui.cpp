@@ -46,6 +46,8 @@ NullGui::run()
     unsigned long spent = now-prevtime;
 
     long rem = _interval-spent;
+    const int timer = timeToNextTimer();
+    if ( timer >= 0 && timer < rem ) rem = timer;
     if ( rem > 0 )
     {
       gnashSleep( rem * 1000 );
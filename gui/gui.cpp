@@ -73,6 +73,27 @@
 
 namespace gnash {
 
+namespace {
+
+/// The area of the stage to redraw, in square pixels.
+std::uint64_t
+invalidatedArea(const InvalidatedRanges& ranges, const movie_root& m)
+{
+    if (ranges.isWorld()) {
+        return std::uint64_t(m.getStageWidth()) * m.getStageHeight();
+    }
+
+    std::uint64_t area = 0;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        const geometry::Range2d<int>& r = ranges.getRange(i);
+        if (!r.isFinite()) continue;
+        area += std::uint64_t(r.width()) * r.height() / (20 * 20);
+    }
+    return area;
+}
+
+}
+
 struct Gui::Display
 {
     Display(Gui& g, movie_root& r) : _g(g), _r(r) {}
@@ -706,6 +727,9 @@ Gui::display(movie_root* m)
     // reset class member if we do a redraw now
     if (redraw_flag) _redraw_flag=false;
     
+    FrameStats& stats = m->frameStats();
+    const std::uint64_t invalidateStart = stats.now();
+
     // Find out the surrounding frame of all characters which
     // have been updated. This just checks what region of the stage has changed
     // due to ActionScript code, the timeline or user events. The GUI can still
@@ -734,6 +758,9 @@ Gui::display(movie_root* m)
     if (redraw_flag)  {
         changed_ranges.setWorld();
     }
+
+    stats.addPhase(FrameStats::PHASE_INVALIDATE, invalidateStart, stats.now());
+    stats.addInvalidatedArea(invalidatedArea(changed_ranges, *m));
     
     // DEBUG ONLY:
     // This is a good place to inspect the invalidated bounds state. Enable
@@ -820,6 +847,7 @@ Gui::display(movie_root* m)
         );
         
         // show frame on screen
+        FrameStats::Timer t(stats, FrameStats::PHASE_PRESENT);
         renderBuffer();	
     };
     
@@ -1146,6 +1174,35 @@ Gui::getMovieInfo() const
     topIter = tr->insert(topIter, std::make_pair("GC Statistics", ""));
     GC::CollectablesCount cc;
     _stage->gc().countCollectables(cc);
+
+    const GC::Stats& gcStats = _stage->gc().stats();
+    {
+        std::ostringstream ss;
+        ss << gcStats.cycles << " (" << gcStats.oldSweeps << " old sweeps)";
+        tr->append_child(topIter, std::make_pair("GC cycles", ss.str()));
+    }
+    {
+        std::ostringstream ss;
+        ss << gcStats.lastPause << " us (max " << gcStats.maxPause
+           << " us, total " << gcStats.totalPause << " us)";
+        tr->append_child(topIter, std::make_pair("GC last pause", ss.str()));
+    }
+
+    GC::HeapOccupancy heap;
+    GC::heapOccupancy(heap);
+    for (const auto& sizeClass : heap) {
+        std::ostringstream name;
+        std::ostringstream ss;
+        if (sizeClass.blockSize) {
+            name << "GC heap " << sizeClass.blockSize << "-byte blocks";
+            ss << sizeClass.used << " in " << sizeClass.slabs << " slabs";
+        }
+        else {
+            name << "GC heap large blocks";
+            ss << sizeClass.used;
+        }
+        tr->append_child(topIter, std::make_pair(name.str(), ss.str()));
+    }
     
     const std::string lbl = "GC managed ";
     for (auto& countinfo : cc) {
@@ -264,6 +264,17 @@ public:
     ///
     bool advanceMovie(bool doDisplay = true);
 
+    /// Milliseconds before an interval timer of the movie may expire.
+    //
+    /// A GUI can give the movie a heart-beat then, rather than
+    /// waiting for the next interval.
+    ///
+    /// @return 0 if a timer is due, or -1 if there are no timers.
+    ///
+    int timeToNextTimer() const {
+        return _stage ? _stage->timeToNextTimer() : -1;
+    }
+
     /// Convenience static wrapper around advanceMovie for callbacks happiness.
     //
     /// NOTE: this function always return TRUE, for historical reasons.
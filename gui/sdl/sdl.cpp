@@ -117,15 +117,19 @@ SDLGui::run()
             }
         }
 
-        // Wait until real time catches up with movie time.
+        // Wait until real time catches up with movie time, or until
+        // an interval timer expires.
         int delay = movie_time - SDL_GetTicks();
+        const int timer = timeToNextTimer();
+        const bool early = timer >= 0 && timer < delay;
+        if (early) delay = timer;
         if (delay > 0)
         {
             SDL_Delay(delay);
         }
 
         advanceMovie();
-        movie_time += _interval;        // Time next frame should be displayed
+        if (!early) movie_time += _interval; // Time next frame should be displayed
     }
     return false;
 }
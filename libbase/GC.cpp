@@ -17,30 +17,88 @@
 // along with this program; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
 #include "GC.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdlib>
 
 #include "utility.h" // for typeName()
 #include "GnashAlgorithm.h"
 
-#ifdef GNASH_GC_DEBUG
+#if defined(GNASH_GC_DEBUG) || defined(GNASH_STATS_GC)
 # include "log.h"
 #endif
 
 
 namespace gnash {
 
+namespace {
+
+/// Time spent in a collect call.
+class PauseTimer
+{
+public:
+    PauseTimer() : _start(std::chrono::steady_clock::now()) {}
+
+    /// Microseconds elapsed since construction.
+    std::uint64_t elapsed() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - _start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point _start;
+};
+
+/// The least number of old resources each collect call sweeps.
+const size_t minSweepSlice = 4096;
+
+/// A sweep of the old generation is spread over about this many calls.
+const size_t sweepSlices = 8;
+
+/// The heap of all collectables.
+//
+/// It is never destroyed, as resources may outlive static destructors.
+SlabAllocator&
+heap()
+{
+    static SlabAllocator* h = new SlabAllocator;
+    return *h;
+}
+
+}
+
+void*
+GcResource::operator new(std::size_t size)
+{
+    return heap().allocate(size);
+}
+
+void
+GcResource::operator delete(void* p, std::size_t size)
+{
+    heap().deallocate(p, size);
+}
+
+// Resources are created with mark 0, which must not look reachable.
+std::uint64_t GC::_epoch = 1;
+
 GC::GC(GcRoot& root)
     :
     // might raise the default ...
     _maxNewCollectablesCount(64),
-    _resListSize(0),
-    _root(root),
-    _lastResCount(0)
-#ifdef GNASH_GC_DEBUG 
-    , _collectorRuns(0)
-#endif
+    _sweepEpoch(0),
+    _sweepRead(0),
+    _sweepWrite(0),
+    _sweepEnd(0),
+    _oldSwept(0),
+    _youngSwept(0),
+    _root(root)
 {
 #ifdef GNASH_GC_DEBUG 
     log_debug("GC %p created", (void*)this);
@@ -55,25 +113,32 @@ GC::GC(GcRoot& root)
 GC::~GC()
 {
 #ifdef GNASH_GC_DEBUG 
-    log_debug("GC deleted, deleting all managed resources - collector run %d times", _collectorRuns);
+    log_debug("GC deleted, deleting all managed resources - collector run %d times", _stats.cycles);
 #endif
-    for (ResList::const_iterator i = _resList.begin(), e = _resList.end();
-            i != e; ++i) {
-        delete *i;
+    for (const GcResource* res : _young) delete res;
+    for (ResList::size_type i = 0, e = _old.size(); i != e; ++i) {
+        if (i == _sweepWrite) i = _sweepRead;
+        if (i == e) break;
+        delete _old[i];
     }
 }
 
 size_t
-GC::cleanUnreachable()
+GC::sweepYoung()
 {
 
 #if (GNASH_GC_DEBUG > 1)
-    log_debug("GC: sweep scan started");
+    log_debug("GC: young sweep started");
 #endif
 
+    // Destructors may allocate resources, which must not disturb
+    // the loop.
+    ResList young;
+    young.swap(_young);
+
     size_t deleted = 0;
 
-    _resList.remove_if([&deleted](const GcResource* res) {
+    for (const GcResource* res : young) {
         if (!res->isReachable()) {
 
 #if GNASH_GC_DEBUG > 1
@@ -81,24 +146,118 @@ GC::cleanUnreachable()
 #endif
             ++deleted;
             delete res;
-            return true;
         }
-        else {
-            res->clearReachable();
-            return false;
+        else _old.push_back(res);
+    }
+
+#ifdef GNASH_GC_DEBUG 
+    log_debug("GC: recycled %d unreachable young resources - %d promoted",
+            deleted, young.size() - deleted);
+#endif
+
+    return deleted;
+}
+
+void
+GC::startOldSweep()
+{
+    assert(!_sweepEpoch);
+
+    _sweepEpoch = _epoch;
+    _sweepRead = _sweepWrite = 0;
+    _sweepEnd = _old.size();
+    _youngSwept = 0;
+    ++_stats.oldSweeps;
+
+#if (GNASH_GC_DEBUG > 1)
+    log_debug("GC: old sweep started - %d resources, %d after last sweep",
+            _sweepEnd, _oldSwept);
+#endif
+}
+
+size_t
+GC::sweepOld(size_t count)
+{
+    assert(_sweepEpoch);
+
+    const ResList::size_type stop = _sweepEnd - _sweepRead > count ?
+        _sweepRead + count : _sweepEnd;
+
+    size_t deleted = 0;
+
+    for (; _sweepRead != stop; ++_sweepRead) {
+        const GcResource* res = _old[_sweepRead];
+        if (res->_mark < _sweepEpoch) {
+
+#if GNASH_GC_DEBUG > 1
+            log_debug("GC: recycling object %p (%s)", res, typeName(*res));
+#endif
+            ++deleted;
+            delete res;
         }
-    });
+        else _old[_sweepWrite++] = res;
+    }
 
-    _resListSize -= deleted;
+    if (_sweepRead == _sweepEnd) {
+        // Move down the resources promoted during the sweep.
+        _old.erase(_old.begin() + _sweepWrite, _old.begin() + _sweepEnd);
+        _sweepEpoch = 0;
+        _sweepRead = _sweepWrite = _sweepEnd = 0;
+        _oldSwept = _old.size();
 
 #ifdef GNASH_GC_DEBUG 
-    log_debug("GC: recycled %d unreachable resources - %d left",
-            deleted, _resListSize);
+        log_debug("GC: old sweep done - %d resources left", _oldSwept);
 #endif
+    }
 
     return deleted;
 }
 
+void
+GC::collect()
+{
+    PauseTimer timer;
+    size_t deleted = 0;
+    const bool cycle = cycleDue();
+
+    if (cycle) {
+        ++_stats.cycles;
+
+#ifdef GNASH_GC_DEBUG 
+        log_debug("GC: collection cycle started - %d/%d new resources "
+                "allocated since last run, %d old",
+                _young.size(), _maxNewCollectablesCount, _old.size());
+#endif // GNASH_GC_DEBUG
+
+        _youngSwept += _young.size();
+        markReachable();
+        deleted += sweepYoung();
+
+        // Sweeping the old generation costs as much as it is large, so
+        // only do it after allocating half as many resources.
+        if (!_sweepEpoch && _youngSwept > _oldSwept / 2) {
+            startOldSweep();
+        }
+    }
+
+    if (_sweepEpoch) {
+        deleted += sweepOld(std::max(minSweepSlice, _sweepEnd / sweepSlices));
+    }
+
+    const std::uint64_t pause = timer.elapsed();
+    _stats.deleted = deleted;
+    _stats.freed += deleted;
+    _stats.lastPause = pause;
+    _stats.maxPause = std::max(_stats.maxPause, pause);
+    _stats.totalPause += pause;
+
+#ifdef GNASH_STATS_GC
+    log_debug("GC: %s - %d us, %d deleted, %d young, %d old%s",
+            cycle ? "cycle" : "sweep", pause, deleted, _young.size(),
+            _old.size(), _sweepEpoch ? " (sweeping)" : "");
+#endif
+}
+
 void 
 GC::runCycle()
 {
@@ -106,35 +265,56 @@ GC::runCycle()
     // Collection cycle
     //
 
-#ifdef GNASH_GC_DEBUG 
-    ++_collectorRuns;
-#endif
+    PauseTimer timer;
+    ++_stats.cycles;
 
 #ifdef GNASH_GC_DEBUG 
-    log_debug("GC: collection cycle started - %d/%d new resources "
-            "allocated since last run (from %d to %d)",
-            _resListSize - _lastResCount, _maxNewCollectablesCount,
-            _lastResCount, _resListSize);
+    log_debug("GC: full collection cycle started - %d young, %d old "
+            "resources", _young.size(), _old.size());
 #endif // GNASH_GC_DEBUG
 
+    // A sweep in progress only knows about an older cycle; finish it so
+    // the whole old generation can be swept against this one.
+    size_t deleted = _sweepEpoch ? sweepOld(_sweepEnd) : 0;
+
     // Mark all resources as reachable
     markReachable();
 
-    // clean unreachable resources, and mark the others as reachable again
-    cleanUnreachable();
+    // clean unreachable resources of both generations
+    deleted += sweepYoung();
+    startOldSweep();
+    deleted += sweepOld(_sweepEnd);
 
-    _lastResCount = _resListSize;
+    const std::uint64_t pause = timer.elapsed();
+    _stats.deleted = deleted;
+    _stats.freed += deleted;
+    _stats.lastPause = pause;
+    _stats.maxPause = std::max(_stats.maxPause, pause);
+    _stats.totalPause += pause;
 
+#ifdef GNASH_STATS_GC
+    log_debug("GC: full cycle - %d us, %d deleted, %d resources",
+            pause, deleted, _old.size());
+#endif
 }
 
 void
 GC::countCollectables(CollectablesCount& count) const
 {
-    for (const GcResource* resource : _resList) {
+    for (const GcResource* resource : _young) {
         ++count[typeName(*resource)];
     }
+    for (ResList::size_type i = 0, e = _old.size(); i != e; ++i) {
+        if (i == _sweepWrite) i = _sweepRead;
+        if (i == e) break;
+        ++count[typeName(*_old[i])];
+    }
 }
 
-} // end of namespace gnash
-
+void
+GC::heapOccupancy(HeapOccupancy& classes)
+{
+    heap().occupancy(classes);
+}
 
+} // end of namespace gnash
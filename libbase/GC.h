@@ -29,12 +29,15 @@
 //   
 //#define GNASH_GC_DEBUG 1
 
-#include <forward_list>
+#include <vector>
 #include <map>
 #include <string>
+#include <cstdint>
+#include <cstddef>
 #include <cassert>
 
 #include "dsodefs.h"
+#include "SlabAllocator.h"
 #ifdef GNASH_GC_DEBUG
 # include "log.h"
 # include "utility.h"
@@ -71,7 +74,11 @@ public:
 /// Collectable resource
 //
 /// Instances of this class can be managed by a GC object.
-class GcResource
+///
+/// They are allocated from a SlabAllocator shared by all collectors,
+/// so that resources created together lie together and the sweep
+/// returns them to a free list of their size.
+class DSOEXPORT GcResource
 {
 public:
 
@@ -82,6 +89,12 @@ public:
     /// @param gc   The GC to register the resource with.
     GcResource(GC& gc);
 
+    /// Allocate a resource from the collectables heap.
+    static void* operator new(std::size_t size);
+
+    /// Return a resource to the collectables heap.
+    static void operator delete(void* p, std::size_t size);
+
     /// Mark this resource as being reachable
     //
     /// This can trigger further marking of all resources reachable by this
@@ -89,33 +102,13 @@ public:
     //
     /// If the object wasn't reachable before, this call triggers
     /// scan of all contained objects too.
-    void setReachable() const {
+    inline void setReachable() const;
 
-        if (_reachable) {
-
-#if GNASH_GC_DEBUG > 2
-            log_debug(_("Instance %p of class %s already reachable, "
-                    "setReachable doing nothing"), (void*)this,
-                    typeName(*this));
-#endif
-            return;
-        }
-
-#if GNASH_GC_DEBUG  > 2
-        log_debug(_("Instance %p of class %s set to reachable, scanning "
-                "reachable resources from it"), (void*)this,
-                typeName(*this));
-#endif
-
-        _reachable = true;
-        markReachableResources();
-    }
-
-    /// Return true if this object is marked as reachable
-    bool isReachable() const { return _reachable; }
+    /// Return true if the current collection cycle marked this object
+    inline bool isReachable() const;
 
     /// Clear the reachable flag
-    void clearReachable() const { _reachable = false; }
+    void clearReachable() const { _mark = 0; }
 
 protected:
 
@@ -129,12 +122,12 @@ protected:
     /// See setReachable(), which is the function to invoke
     /// against all reachable methods.
     ///
-    /// Feel free to assert(_reachable) in your implementation.
+    /// Feel free to assert(isReachable()) in your implementation.
     ///
     /// The default implementation doesn't mark anything.
     ///
     virtual void markReachableResources() const {
-        assert(_reachable);
+        assert(isReachable());
 #if GNASH_GC_DEBUG > 1
         log_debug(_("Class %s didn't override the markReachableResources() "
                     "method"), typeName(*this));
@@ -150,7 +143,12 @@ protected:
 
 private:
 
-    mutable bool _reachable;
+    /// The collection cycle that last found this resource reachable.
+    //
+    /// A resource that was never marked has 0, which is never a cycle.
+    /// Starting a cycle makes every resource unreachable at once,
+    /// without visiting them.
+    mutable std::uint64_t _mark;
 
 };
 
@@ -161,11 +159,65 @@ private:
 ///
 /// Their reachability is detected starting from a root, which in turn
 /// marks all reachable resources.
+///
+/// Collectables are kept in two generations. New resources go to the
+/// young generation, which is swept by every collection cycle; the
+/// survivors are promoted to the old generation. The old generation is
+/// only swept once half as many resources as it held were allocated
+/// since its last sweep, and that sweep is spread over the following
+/// fuzzyCollect() calls, so that a large heap does not cost one long
+/// pause.
+///
+/// Marking is still done for the whole heap in one go: resources hold
+/// references to each other in too many places (not only in
+/// PropertyLists) for a write barrier to catch every store, and
+/// without one neither a young-only mark nor an incremental mark is
+/// safe.
 class DSOEXPORT GC
 {
 
 public:
 
+    /// Statistics about the work done by the collector.
+    struct Stats
+    {
+        Stats()
+            :
+            cycles(0),
+            oldSweeps(0),
+            deleted(0),
+            allocated(0),
+            freed(0),
+            lastPause(0),
+            maxPause(0),
+            totalPause(0)
+        {}
+
+        /// Number of collection cycles run.
+        size_t cycles;
+
+        /// Number of sweeps of the old generation started.
+        size_t oldSweeps;
+
+        /// Number of resources deleted by the last collect call.
+        size_t deleted;
+
+        /// Number of resources added so far.
+        std::uint64_t allocated;
+
+        /// Number of resources deleted by all collect calls.
+        std::uint64_t freed;
+
+        /// Duration of the last collect call, in microseconds.
+        std::uint64_t lastPause;
+
+        /// Duration of the longest collect call, in microseconds.
+        std::uint64_t maxPause;
+
+        /// Duration of all collect calls, in microseconds.
+        std::uint64_t totalPause;
+    };
+
     /// Create a garbage collector using the given root
     //
     /// @param root     The top level of the GC, which takes care of marking
@@ -198,11 +250,12 @@ public:
         assert(!item->isReachable());
 #endif
 
-        _resList.emplace_front(item); ++_resListSize;
+        _young.push_back(item);
+        ++_stats.allocated;
 
 #if GNASH_GC_DEBUG > 1
         log_debug(_("GC: collectable %p added, num collectables: %d"), item, 
-                _resListSize);
+                _young.size() + _old.size());
 #endif
     }
 
@@ -222,95 +275,182 @@ public:
         //      - Depends on the number of unreachable collectables
         //
         //  - Cheaply computable informations
-        //      - Number of collectables (currently O(n) but can be optimized)
+        //      - Number of collectables in each generation
         //      - Total heap-allocated memory (currently unavailable)
         //
         // Current heuristic:
         //
         //  - We run the cycle again if X new collectables were allocated
-        //    since last cycle run. X defaults to maxNewCollectablesCount
-        //    and can be changed by user (GNASH_GC_TRIGGER_THRESHOLD env
-        //    variable).
-        //
-        // Possible improvements:
+        //    since last cycle run. X is a quarter of the old generation,
+        //    but at least maxNewCollectablesCount, which can be changed
+        //    by user (GNASH_GC_TRIGGER_THRESHOLD env variable). Marking
+        //    costs about as much as the old generation is large, so this
+        //    keeps its cost per new collectable bounded.
         //
-        //  - Adapt X (maxNewCollectablesCount) based on cost/advantage
-        //    runtime analisys
+        //  - Otherwise, if a sweep of the old generation is in progress,
+        //    we continue it.
         //
 
-        if (_resListSize <  _lastResCount + _maxNewCollectablesCount) {
+        if (!cycleDue() && !_sweepEpoch) {
 #if GNASH_GC_DEBUG  > 1
             log_debug(_("GC: collection cycle skipped - %d/%d new resources "
-                        "allocated since last run (from %d to %d)"),
-                    _resListSize-_lastResCount, _maxNewCollectablesCount,
-                    _lastResCount, _resListSize);
+                        "allocated since last run"),
+                    _young.size(), _maxNewCollectablesCount);
 #endif // GNASH_GC_DEBUG
             return;
         }
 
-        runCycle();
+        collect();
     }
 
-    /// Run the collection cycle
+    /// Run a full collection cycle
     //
-    /// Find all reachable collectables, destroy all the others.
+    /// Find all reachable collectables, destroy all the others,
+    /// in both generations.
     ///
     void runCycle();
 
     typedef std::map<std::string, unsigned int> CollectablesCount;
 
     /// Count collectables
+    //
+    /// See heapOccupancy() for the memory they take.
     void countCollectables(CollectablesCount& count) const;
 
+    typedef SlabAllocator::Occupancy HeapOccupancy;
+
+    /// Report the memory taken by the collectables of all collectors
+    //
+    /// @param classes  Receives one entry per size class in use.
+    static void heapOccupancy(HeapOccupancy& classes);
+
+    /// Return statistics about the collection cycles run so far.
+    const Stats& stats() const { return _stats; }
+
 private:
 
+    friend class GcResource;
+
     /// List of collectables
-    typedef std::forward_list<const GcResource*> ResList;
+    typedef std::vector<const GcResource*> ResList;
+
+    /// Whether enough resources were allocated to run a cycle.
+    bool cycleDue() const {
+        return _young.size() >= _maxNewCollectablesCount &&
+            _young.size() >= _old.size() / 4;
+    }
+
+    /// Run a collection cycle if due, or continue sweeping the old
+    /// generation.
+    void collect();
 
     /// Mark all reachable resources
+    //
+    /// This starts a new cycle, making all resources unreachable first.
     void markReachable() {
 #if GNASH_GC_DEBUG > 2
         log_debug(_("GC %p: MARK SCAN"), (void*)this);
 #endif
+        ++_epoch;
         _root.markReachableResources();
     }
 
-    /// Delete all unreachable objects, and mark the others unreachable again
+    /// Delete the unreachable young resources, and promote the others
     //
     /// @return number of objects deleted
-    size_t cleanUnreachable();
+    size_t sweepYoung();
+
+    /// Start sweeping the old generation against the current cycle.
+    void startOldSweep();
+
+    /// Continue sweeping the old generation
+    //
+    /// @param count    The maximum number of old resources to visit.
+    /// @return number of objects deleted
+    size_t sweepOld(size_t count);
 
     /// Number of newly registered collectable since last collection run
     /// triggering next collection.
     size_t _maxNewCollectablesCount;
 
-    /// List of collectable resources
-    ResList _resList;
+    /// Resources allocated since the last collection cycle.
+    ResList _young;
+
+    /// Resources that survived at least one collection cycle.
+    //
+    /// While a sweep is in progress, the entries between _sweepWrite
+    /// and _sweepRead are stale: those resources were deleted or moved
+    /// down.
+    ResList _old;
+
+    /// The cycle the old generation is being swept against, or 0.
+    //
+    /// Resources marked by this cycle or a later one are kept.
+    std::uint64_t _sweepEpoch;
+
+    /// The next old resource to visit.
+    ResList::size_type _sweepRead;
+
+    /// Where to move the next surviving old resource.
+    ResList::size_type _sweepWrite;
+
+    /// Size of the old generation when the sweep started.
+    //
+    /// Resources promoted later are not visited.
+    ResList::size_type _sweepEnd;
+
+    /// Size of the old generation after its last sweep.
+    ResList::size_type _oldSwept;
 
-    /// Size of the ResList to avoid the cost of computing it
-    ResList::size_type _resListSize;
+    /// Number of young resources swept since the last old sweep started.
+    size_t _youngSwept;
 
     /// The GcRoot.
     GcRoot& _root;
 
-    /// Number of resources in collectable list at end of last
-    /// collect() call.
-    ResList::size_type _lastResCount;
+    Stats _stats;
 
-#ifdef GNASH_GC_DEBUG 
-    /// Number of times the collector runs (stats/profiling)
-    size_t _collectorRuns;
-#endif
+    /// The current collection cycle, shared by all collectors.
+    static std::uint64_t _epoch;
 };
 
 
 inline GcResource::GcResource(GC& gc)
     :
-    _reachable(false)
+    _mark(0)
 {
     gc.addCollectable(this);
 }
 
+inline bool
+GcResource::isReachable() const
+{
+    return _mark == GC::_epoch;
+}
+
+inline void
+GcResource::setReachable() const
+{
+    if (_mark == GC::_epoch) {
+
+#if GNASH_GC_DEBUG > 2
+        log_debug(_("Instance %p of class %s already reachable, "
+                "setReachable doing nothing"), (void*)this,
+                typeName(*this));
+#endif
+        return;
+    }
+
+#if GNASH_GC_DEBUG  > 2
+    log_debug(_("Instance %p of class %s set to reachable, scanning "
+            "reachable resources from it"), (void*)this,
+            typeName(*this));
+#endif
+
+    _mark = GC::_epoch;
+    markReachableResources();
+}
+
 } // namespace gnash
 
 #endif // GNASH_GC_H
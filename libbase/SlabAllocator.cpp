@@ -0,0 +1,73 @@
+// SlabAllocator.cpp: size-class allocator for small objects, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "SlabAllocator.h"
+
+namespace gnash {
+
+SlabAllocator::SlabAllocator()
+    :
+    _large(0)
+{
+    for (Class& c : _classes) {
+        c.free = nullptr;
+        c.next = c.end = nullptr;
+        c.slabs = c.used = 0;
+    }
+}
+
+SlabAllocator::~SlabAllocator()
+{
+    for (void* slab : _slabs) ::operator delete(slab);
+}
+
+void
+SlabAllocator::refill(Class& c, std::size_t index)
+{
+    const std::size_t size = blockSize(index);
+
+    _slabs.reserve(_slabs.size() + 1);
+    char* slab = static_cast<char*>(::operator new(slabSize));
+    _slabs.push_back(slab);
+    ++c.slabs;
+
+    c.next = slab;
+    c.end = slab + slabSize / size * size;
+}
+
+void
+SlabAllocator::occupancy(Occupancy& classes) const
+{
+    for (std::size_t i = 0; i < classCount; ++i) {
+        const Class& c = _classes[i];
+        if (!c.slabs) continue;
+        const SizeClass s = { blockSize(i), c.slabs, c.used };
+        classes.push_back(s);
+    }
+    if (_large) {
+        const SizeClass s = { 0, 0, _large };
+        classes.push_back(s);
+    }
+}
+
+} // namespace gnash
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
@@ -0,0 +1,175 @@
+// SlabAllocator.h: size-class allocator for small objects, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_SLABALLOCATOR_H
+#define GNASH_SLABALLOCATOR_H
+
+#include <vector>
+#include <cstddef>
+#include <cassert>
+#include <new>
+#include <boost/noncopyable.hpp>
+
+#include "dsodefs.h"
+
+namespace gnash {
+
+/// Allocates small objects from large slabs, by size class
+//
+/// Sizes are rounded up to a multiple of 16 bytes. Each size class
+/// carves its blocks out of its own slabs, in address order, and keeps
+/// freed blocks on a free list that is used before carving new ones.
+/// Objects allocated together thus lie together, and allocating or
+/// freeing one is a few instructions.
+///
+/// Blocks larger than maxBlockSize come from operator new.
+///
+/// Slabs are only released when the allocator is destroyed.
+///
+/// This class is not thread-safe.
+class DSOEXPORT SlabAllocator : boost::noncopyable
+{
+public:
+
+    /// The largest block size served from slabs.
+    static const std::size_t maxBlockSize = 1024;
+
+    /// Memory used by one size class.
+    struct SizeClass
+    {
+        /// The size of its blocks, or 0 for blocks from operator new.
+        std::size_t blockSize;
+
+        /// The number of slabs it owns.
+        std::size_t slabs;
+
+        /// The number of blocks allocated and not yet freed.
+        std::size_t used;
+    };
+
+    typedef std::vector<SizeClass> Occupancy;
+
+    SlabAllocator();
+
+    /// Release all slabs, whether or not their blocks were freed.
+    ~SlabAllocator();
+
+    /// Allocate a block of at least the given size
+    //
+    /// @param size     The number of bytes needed.
+    /// @return         A block aligned like operator new's.
+    void* allocate(std::size_t size) {
+        if (size > maxBlockSize) {
+            ++_large;
+            return ::operator new(size);
+        }
+        const std::size_t index = classIndex(size);
+        Class& c = _classes[index];
+        if (c.free) {
+            FreeBlock* b = c.free;
+            c.free = b->next;
+            ++c.used;
+            return b;
+        }
+        if (c.next == c.end) refill(c, index);
+        void* p = c.next;
+        c.next += blockSize(index);
+        ++c.used;
+        return p;
+    }
+
+    /// Free a block
+    //
+    /// @param p        A block returned by allocate().
+    /// @param size     The size it was allocated with.
+    void deallocate(void* p, std::size_t size) {
+        if (size > maxBlockSize) {
+            --_large;
+            ::operator delete(p);
+            return;
+        }
+        Class& c = _classes[classIndex(size)];
+        assert(c.used);
+        --c.used;
+        FreeBlock* b = static_cast<FreeBlock*>(p);
+        b->next = c.free;
+        c.free = b;
+    }
+
+    /// Report the memory used by each size class in use.
+    void occupancy(Occupancy& classes) const;
+
+private:
+
+    /// The size of a slab, in bytes.
+    static const std::size_t slabSize = 64 * 1024;
+
+    /// The granularity of block sizes, and their alignment.
+    static const std::size_t granularity = 16;
+
+    static const std::size_t classCount = maxBlockSize / granularity;
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    struct Class
+    {
+        /// Freed blocks, most recently freed first.
+        FreeBlock* free;
+
+        /// The next unused block of the current slab.
+        char* next;
+
+        /// The end of the blocks of the current slab.
+        char* end;
+
+        std::size_t slabs;
+
+        std::size_t used;
+    };
+
+    static std::size_t classIndex(std::size_t size) {
+        return size ? (size - 1) / granularity : 0;
+    }
+
+    static std::size_t blockSize(std::size_t index) {
+        return (index + 1) * granularity;
+    }
+
+    /// Give a size class a new slab.
+    void refill(Class& c, std::size_t index);
+
+    Class _classes[classCount];
+
+    /// Every slab, for releasing them.
+    std::vector<void*> _slabs;
+
+    /// Number of blocks allocated from operator new.
+    std::size_t _large;
+};
+
+} // namespace gnash
+
+#endif
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
@@ -99,6 +99,7 @@ RcInitFile::RcInitFile()
     _extensionsEnabled(false),
     _startStopped(false),
     _insecureSSL(false),
+    _localVariableSlots(true),
     _streamsTimeout(DEFAULT_STREAMS_TIMEOUT),
     _solsandbox(DEFAULT_SOL_SAFEDIR),
     _solreadonly(false),
@@ -121,7 +122,10 @@ RcInitFile::RcInitFile()
     _ignoreShowMenu(true),
     _scriptsTimeout(15),
     _scriptsRecursionLimit(256),
-    _lockScriptLimits(false)
+    _lockScriptLimits(false),
+    _actionProfileInterval(1000),
+    _renderThreads(1),
+    _shapeCacheSize(16384)
 {
     expandPath(_solsandbox);
     loadFiles();
@@ -524,6 +528,18 @@ RcInitFile::parseFile(const std::string& filespec)
                 _rootcert = value;
                 continue;
             }
+
+            if (noCaseCompare(variable, "actionProfile")) {
+                expandPath(value);
+                _actionProfile = value;
+                continue;
+            }
+
+            if (noCaseCompare(variable, "frameTrace")) {
+                expandPath(value);
+                _frameTrace = value;
+                continue;
+            }
             
             if (noCaseCompare(action , "set") ) {
                  extractSetting(_splashScreen, "splashScreen", variable,
@@ -568,6 +584,9 @@ RcInitFile::parseFile(const std::string& filespec)
                            variable, value)
             ||
                  extractSetting(_startStopped, "StartStopped", variable, value)
+            ||
+                 extractSetting(_localVariableSlots, "LocalVariableSlots",
+                           variable, value)
             ||
                  extractSetting(_solreadonly, "SOLReadOnly", variable,
                            value)
@@ -620,6 +639,15 @@ RcInitFile::parseFile(const std::string& filespec)
 			||
                  extractSetting(_lockScriptLimits, "lockScriptLimits", variable,
                            value)
+			||
+                 extractNumber(_actionProfileInterval, "actionProfileInterval",
+                         variable, value)
+            ||
+                 extractNumber(_renderThreads, "renderThreads", variable,
+                         value)
+            ||
+                 extractNumber(_shapeCacheSize, "shapeCacheSize", variable,
+                         value)
             ||
                  cerr << boost::format(_("Warning: unrecognized directive "
                              "\"%s\" in rcfile %s line %d")) 
@@ -767,6 +795,7 @@ RcInitFile::updateFile(const std::string& filespec)
     cmd << "malformedAMFVerbosity " << _verboseMalformedAMF << endl <<
     cmd << "enableExtensions " << _extensionsEnabled << endl <<
     cmd << "startStopped " << _startStopped << endl <<
+    cmd << "localVariableSlots " << _localVariableSlots << endl <<
     cmd << "streamsTimeout " << _streamsTimeout << endl <<
     cmd << "movieLibraryLimit " << _movieLibraryLimit << endl <<
     cmd << "quality " << _quality << endl <<    
@@ -785,6 +814,9 @@ RcInitFile::updateFile(const std::string& filespec)
     cmd << "scriptsTimeout " << _scriptsTimeout << endl <<
     cmd << "scriptsRecursionLimit " << _scriptsRecursionLimit << endl <<
     cmd << "lockScriptLimits " << _lockScriptLimits << endl <<
+    cmd << "actionProfileInterval " << _actionProfileInterval << endl <<
+    cmd << "renderThreads " << _renderThreads << endl <<
+    cmd << "shapeCacheSize " << _shapeCacheSize << endl <<
    
     // Strings.
 
@@ -801,7 +833,9 @@ RcInitFile::updateFile(const std::string& filespec)
     cmd << "flashSystemOS " << _flashSystemOS << endl <<
     cmd << "flashVersionString " << _flashVersionString << endl <<
     cmd << "urlOpenerFormat " << _urlOpenerFormat << endl <<
-    cmd << "GSTAudioSink " << _gstaudiosink << endl;
+    cmd << "GSTAudioSink " << _gstaudiosink << endl <<
+    cmd << "actionProfile " << _actionProfile << endl <<
+    cmd << "frameTrace " << _frameTrace << endl;
 
     // Lists. These can't be handled very well at the moment. The main
     // inconvenience would be that disabling a list makes it an empty
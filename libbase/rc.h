@@ -105,6 +105,13 @@ public:
 
     bool insecureSSL() const { return _insecureSSL; }
     void insecureSSL(bool value) { _insecureSSL = value; }
+
+    /// Return true if ActionScript functions may keep local variables
+    /// in slots of their call frame rather than in an object
+    //
+    /// defaults to true. Turning it off can help debugging.
+    bool localVariableSlots() const { return _localVariableSlots; }
+    void localVariableSlots(bool value) { _localVariableSlots = value; }
     
     int qualityLevel() const { return _quality; }
     void qualityLevel(int value) { _quality = value; }
@@ -358,6 +365,39 @@ public:
 
     bool lockScriptLimits() const { return _lockScriptLimits; }
 
+    /// The file to write an ActionScript profile to
+    //
+    /// ActionScript is only profiled if this is not empty.
+    const std::string& getActionProfile() const { return _actionProfile; }
+
+    void setActionProfile(const std::string& x) { _actionProfile = x; }
+
+    /// The interval between profile samples, in microseconds
+    int getActionProfileInterval() const { return _actionProfileInterval; }
+
+    void setActionProfileInterval(int x) { _actionProfileInterval = x; }
+
+    /// The file to write the timings of the last frames to
+    //
+    /// The timings are only written if this is not empty.
+    const std::string& getFrameTrace() const { return _frameTrace; }
+
+    void setFrameTrace(const std::string& x) { _frameTrace = x; }
+
+    /// The number of threads the AGG renderer draws a frame with
+    //
+    /// 1 draws on the calling thread; 0 uses one thread per processor.
+    unsigned int getRenderThreads() const { return _renderThreads; }
+
+    void setRenderThreads(unsigned int x) { _renderThreads = x; }
+
+    /// The kilobytes the AGG renderer keeps transformed shapes in
+    //
+    /// 0 turns the cache off.
+    unsigned int getShapeCacheSize() const { return _shapeCacheSize; }
+
+    void setShapeCacheSize(unsigned int x) { _shapeCacheSize = x; }
+
     void dump();    
 
 protected:
@@ -537,7 +577,10 @@ protected:
     bool _startStopped;		
 
     /// Allow SSL connections without verifying the certificate
-    bool _insecureSSL;		
+    bool _insecureSSL;
+
+    /// Keep local variables of ActionScript functions in slots
+    bool _localVariableSlots;
 
     /// The number of seconds of inactivity triggering download timeout
     double _streamsTimeout;
@@ -624,6 +667,21 @@ protected:
 
     /// Whether to ignore SWF ScriptLimits tags 
     bool _lockScriptLimits;
+
+    /// The file to write an ActionScript profile to, if any
+    std::string _actionProfile;
+
+    /// The microseconds of CPU time between profile samples
+    int _actionProfileInterval;
+
+    /// The file to write the timings of the last frames to, if any
+    std::string _frameTrace;
+
+    /// The number of threads the AGG renderer draws with
+    unsigned int _renderThreads;
+
+    /// The kilobytes of transformed shapes the AGG renderer keeps
+    unsigned int _shapeCacheSize;
 };
 
 // End of gnash namespace 
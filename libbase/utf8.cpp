@@ -22,7 +22,6 @@
 
 #include "utf8.h"
 
-#include <limits>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -31,10 +30,6 @@
 namespace gnash {
 namespace utf8 {
 
-namespace {
-    const std::uint32_t invalid = std::numeric_limits<std::uint32_t>::max();
-}
-
 std::wstring
 decodeCanonicalString(const std::string& str, int version)
 {
@@ -69,6 +69,9 @@ namespace gnash {
 /// encoding support here is correspondingly non-standard.
 namespace utf8 {
 
+    /// What decodeNextUnicodeCharacter returns for an invalid sequence.
+    const std::uint32_t invalid = 0xffffffff;
+
     /// Converts a std::string with multibyte characters into a std::wstring.
     //
     /// @return a version-dependent wstring.
@@ -94,8 +97,7 @@ namespace utf8 {
 
     /// Return the next Unicode character in the UTF-8 encoded string.
     //
-    /// Invalid UTF-8 sequences produce a U+FFFD character
-    /// as output.  Advances string iterator past the character
+    /// Invalid UTF-8 sequences produce utf8::invalid.  Advances string iterator past the character
     /// returned, unless the returned character is '\0', in which
     /// case the iterator does not advance.
     DSOEXPORT std::uint32_t decodeNextUnicodeCharacter(std::string::const_iterator& it,
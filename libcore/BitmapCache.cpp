@@ -0,0 +1,236 @@
+// BitmapCache.cpp: DisplayObjects drawn from a bitmap, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "BitmapCache.h"
+
+#include <cmath>
+#include <algorithm>
+#include <memory>
+
+#include "Renderer.h"
+#include "Transform.h"
+#include "GnashImage.h"
+#include "GnashNumeric.h"
+#include "FillStyle.h"
+#include "Geometry.h"
+#include "ShapeRecord.h"
+#include "log.h"
+#include "utility.h"
+
+namespace gnash {
+
+namespace {
+
+bool
+sameRect(const SWFRect& a, const SWFRect& b)
+{
+    if (a.is_null() || b.is_null()) return a.is_null() == b.is_null();
+    return a.get_x_min() == b.get_x_min() && a.get_y_min() == b.get_y_min() &&
+        a.get_x_max() == b.get_x_max() && a.get_y_max() == b.get_y_max();
+}
+
+}
+
+const int BitmapCache::maxSize;
+
+BitmapCache::BitmapCache()
+    :
+    _renderer(nullptr),
+    _x(0),
+    _y(0),
+    _dirty(true),
+    _unsupported(false)
+{
+}
+
+BitmapCache::~BitmapCache()
+{
+}
+
+bool
+BitmapCache::update(Renderer& renderer, const Transform& xform,
+        const SWFRect& bounds, const Draw& draw)
+{
+    if (_unsupported || bounds.is_null()) return false;
+
+    const SWFMatrix& mat = xform.matrix;
+    if (current(renderer, mat, bounds)) return true;
+
+    SWFRect world;
+    world.expand_to_transformed_rect(mat, bounds);
+
+    // Whole pixels, with one to spare on each side for antialiasing, and
+    // room for the filters.
+    const FilterMargins m = margins();
+    const int x0 = std::floor(twipsToPixels(world.get_x_min())) - 1 - m.left;
+    const int y0 = std::floor(twipsToPixels(world.get_y_min())) - 1 - m.top;
+    const int x1 = std::ceil(twipsToPixels(world.get_x_max())) + 1 + m.right;
+    const int y1 = std::ceil(twipsToPixels(world.get_y_max())) + 1 + m.bottom;
+
+    const int width = x1 - x0;
+    const int height = y1 - y0;
+
+    if (width > maxSize || height > maxSize) {
+        clear();
+        return false;
+    }
+
+    // Draw into the old bitmap if it has the right size, as
+    // BitmapData.draw() does.
+    if (!_bitmap || &renderer != _renderer ||
+            static_cast<int>(_bitmap->image().width()) != width ||
+            static_cast<int>(_bitmap->image().height()) != height) {
+
+        std::unique_ptr<image::GnashImage> im(
+                new image::ImageRGBA(width, height));
+        _bitmap = renderer.createCachedBitmap(std::move(im));
+        _renderer = &renderer;
+
+        const int w = pixelsToTwips(width);
+        const int h = pixelsToTwips(height);
+
+        SWFMatrix fillMatrix;
+        fillMatrix.set_scale(1.0 / 20, 1.0 / 20);
+
+        SWF::Subshape s;
+        s.addFillStyle(BitmapFill(BitmapFill::CLIPPED, _bitmap.get(),
+                    fillMatrix, BitmapFill::SMOOTHING_UNSPECIFIED));
+
+        Path p(w, h, 1, 0, 0);
+        p.drawLineTo(w, 0);
+        p.drawLineTo(0, 0);
+        p.drawLineTo(0, h);
+        p.drawLineTo(w, h);
+        s.addPath(p);
+
+        _shape.clear();
+        _shape.addSubshape(s);
+        _shape.setBounds(SWFRect(0, 0, w, h));
+    }
+
+    image::GnashImage& im = _bitmap->image();
+    std::fill(im.begin(), im.end(), 0);
+
+    {
+        Renderer::Internal in(renderer, im);
+        Renderer* internal = in.renderer();
+        if (!internal) {
+            log_debug("Current renderer does not support internal rendering, "
+                    "so cacheAsBitmap has no effect");
+            _unsupported = true;
+            clear();
+            return false;
+        }
+
+        // Draw in world coordinates, so that masks inside the
+        // DisplayObject, which are drawn with their own world
+        // transform, match the rest. Color transforms are applied to the
+        // bitmap.
+        internal->set_translation(-x0, -y0);
+        draw(*internal, Transform(mat, SWFCxForm()));
+    }
+
+    for (const auto& f : _filters) {
+        if (!f->apply(im)) {
+            LOG_ONCE(log_unimpl(_("Bitmap filter %s"), typeName(*f)));
+        }
+    }
+
+    _matrix = mat;
+    _bounds = bounds;
+    _x = x0;
+    _y = y0;
+    _dirty = false;
+    return true;
+}
+
+void
+BitmapCache::display(Renderer& renderer, const Transform& xform) const
+{
+    assert(_bitmap);
+
+    // Move the bitmap by whole pixels, so that it is not resampled.
+    const int dx =
+        std::lround(twipsToPixels(xform.matrix.tx() - _matrix.tx()));
+    const int dy =
+        std::lround(twipsToPixels(xform.matrix.ty() - _matrix.ty()));
+
+    SWFMatrix mat;
+    mat.set_translation(pixelsToTwips(_x + dx), pixelsToTwips(_y + dy));
+
+    renderer.drawShape(_shape, Transform(mat, xform.colorTransform));
+}
+
+void
+BitmapCache::setFilters(Filters filters)
+{
+    _filters = std::move(filters);
+    _dirty = true;
+}
+
+SWFRect
+BitmapCache::filteredBounds(const SWFRect& world) const
+{
+    if (world.is_null() || _filters.empty()) return world;
+
+    const FilterMargins m = margins();
+    return SWFRect(world.get_x_min() - pixelsToTwips(m.left),
+            world.get_y_min() - pixelsToTwips(m.top),
+            world.get_x_max() + pixelsToTwips(m.right),
+            world.get_y_max() + pixelsToTwips(m.bottom));
+}
+
+void
+BitmapCache::clear()
+{
+    _shape.clear();
+    _bitmap.reset();
+    _renderer = nullptr;
+    _dirty = true;
+}
+
+bool
+BitmapCache::current(const Renderer& renderer, const SWFMatrix& mat,
+        const SWFRect& bounds) const
+{
+    return _bitmap && !_dirty && &renderer == _renderer &&
+        mat.a() == _matrix.a() && mat.b() == _matrix.b() &&
+        mat.c() == _matrix.c() && mat.d() == _matrix.d() &&
+        sameRect(bounds, _bounds);
+}
+
+FilterMargins
+BitmapCache::margins() const
+{
+    FilterMargins m;
+    for (const auto& f : _filters) {
+        f->addMargins(m);
+    }
+    return m;
+}
+
+} // namespace gnash
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
@@ -0,0 +1,144 @@
+// BitmapCache.h: DisplayObjects drawn from a bitmap, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_BITMAPCACHE_H
+#define GNASH_BITMAPCACHE_H
+
+#include <functional>
+#include <boost/noncopyable.hpp>
+#include <boost/intrusive_ptr.hpp>
+
+#include "CachedBitmap.h"
+#include "Filters.h"
+#include "ShapeRecord.h"
+#include "SWFMatrix.h"
+#include "SWFRect.h"
+
+namespace gnash {
+    class Renderer;
+    class Transform;
+}
+
+namespace gnash {
+
+/// The bitmap a DisplayObject with cacheAsBitmap or filters is drawn from
+//
+/// The DisplayObject is drawn into the bitmap with an internal renderer,
+/// at the movie's scale, and the bitmap is then drawn in its place. The
+/// bitmap is drawn again only when the DisplayObject's content changes
+/// or it is scaled, rotated or skewed. When it is only moved, the bitmap
+/// is moved with it by whole pixels.
+//
+/// Color transforms and masks of the DisplayObject itself are applied
+/// when the bitmap is drawn, so changing them is also free.
+//
+/// Filters are applied to the bitmap after the DisplayObject is drawn
+/// into it, so they too only run again when the bitmap is redrawn. The
+/// bitmap has room for what the filters draw around the DisplayObject.
+class BitmapCache : boost::noncopyable
+{
+public:
+
+    /// Draws a DisplayObject's content, without its mask.
+    typedef std::function<void(Renderer&, const Transform&)> Draw;
+
+    /// The largest bitmap, in pixels, as for BitmapData.
+    static const int maxSize = 2880;
+
+    BitmapCache();
+
+    ~BitmapCache();
+
+    /// The DisplayObject's content has changed.
+    void invalidate() {
+        _dirty = true;
+    }
+
+    /// The filters applied to the bitmap, in order.
+    const Filters& filters() const {
+        return _filters;
+    }
+
+    /// Replace the filters.
+    void setFilters(Filters filters);
+
+    /// Grow world bounds of the DisplayObject by what its filters draw.
+    SWFRect filteredBounds(const SWFRect& world) const;
+
+    /// Make the bitmap match the DisplayObject as it is to be drawn.
+    //
+    /// @param renderer The renderer the bitmap will be drawn with.
+    /// @param xform    The DisplayObject's world transform.
+    /// @param bounds   The DisplayObject's bounds in its own coordinates.
+    /// @param draw     Draws the DisplayObject if the bitmap is out of date.
+    /// @return         false if the DisplayObject cannot be drawn from a
+    ///                 bitmap now and must be drawn normally.
+    bool update(Renderer& renderer, const Transform& xform,
+            const SWFRect& bounds, const Draw& draw);
+
+    /// Draw the bitmap in the DisplayObject's place.
+    //
+    /// This must follow a successful update() with the same transform.
+    void display(Renderer& renderer, const Transform& xform) const;
+
+    /// Free the bitmap.
+    void clear();
+
+private:
+
+    /// Whether the bitmap was drawn for this renderer, matrix and bounds.
+    bool current(const Renderer& renderer, const SWFMatrix& mat,
+            const SWFRect& bounds) const;
+
+    /// The margins of all filters.
+    FilterMargins margins() const;
+
+    Filters _filters;
+
+    boost::intrusive_ptr<CachedBitmap> _bitmap;
+
+    /// A rectangle filled with the bitmap.
+    SWF::ShapeRecord _shape;
+
+    /// The renderer the bitmap was created with.
+    const Renderer* _renderer;
+
+    /// The world matrix the bitmap was drawn with.
+    SWFMatrix _matrix;
+
+    /// The DisplayObject's bounds when the bitmap was drawn.
+    SWFRect _bounds;
+
+    /// The position of the bitmap on the stage when it was drawn, in pixels.
+    int _x;
+    int _y;
+
+    bool _dirty;
+
+    /// Set when the renderer cannot draw into bitmaps.
+    bool _unsupported;
+};
+
+} // namespace gnash
+
+#endif
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
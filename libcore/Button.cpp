@@ -47,6 +47,7 @@
 #include "sound_definition.h"
 #include "Transform.h"
 #include "sound_handler.h"
+#include "flash/filters/BitmapFilter_as.h"
 
 /** \page buttons Buttons and mouse behaviour
 
@@ -359,10 +360,22 @@ Button::handleFocus()
 void
 Button::display(Renderer& renderer, const Transform& base)
 {
-    const DisplayObject::MaskRenderer mr(renderer, *this);
-
     const Transform xform = base * transform();
 
+    const bool cached = displayCached(renderer, xform,
+            [this](Renderer& r, const Transform& x) { drawContent(r, x); });
+
+    if (!cached) {
+        const DisplayObject::MaskRenderer mr(renderer, *this);
+        drawContent(renderer, xform);
+    }
+
+    clear_invalidated();
+}
+
+void
+Button::drawContent(Renderer& renderer, const Transform& xform)
+{
     DisplayObjects actChars;
     getActiveCharacters(actChars);
 
@@ -372,8 +385,6 @@ Button::display(Renderer& renderer, const Transform& base)
     for (auto& actChar : actChars) {
         actChar->display(renderer, xform);
     }
-
-    clear_invalidated();
 }
 
 
@@ -741,6 +752,8 @@ Button::add_invalidated_bounds(InvalidatedRanges& ranges, bool force)
             std::bind(&DisplayObject::add_invalidated_bounds, std::placeholders::_1,
                 std::ref(ranges), force || invalidated())
     );
+
+    if (force || invalidated() || childInvalidated()) addFilterBounds(ranges);
 }
 
 SWFRect
@@ -993,8 +1006,10 @@ as_value
 button_cacheAsBitmap(const fn_call& fn)
 {
     Button* obj = ensure<IsDisplayObject<Button> >(fn);
-    LOG_ONCE(log_unimpl(_("Button.cacheAsBitmap")));
-    UNUSED(obj);
+
+    if (!fn.nargs) return as_value(obj->cacheAsBitmap());
+
+    obj->setCacheAsBitmap(toBool(fn.arg(0), getVM(fn)));
     return as_value();
 }
 
@@ -1002,8 +1017,13 @@ as_value
 button_filters(const fn_call& fn)
 {
     Button* obj = ensure<IsDisplayObject<Button> >(fn);
-    LOG_ONCE(log_unimpl(_("Button.filters")));
-    UNUSED(obj);
+
+    if (!fn.nargs) {
+        return as_value(fromFilters(fn, obj->filters()));
+    }
+
+    as_object* array = toObject(fn.arg(0), getVM(fn));
+    obj->setFilters(array ? toFilters(*array) : Filters());
     return as_value();
 }
 
@@ -145,6 +145,9 @@ protected:
 
 private:
 
+    /// Draw the active DisplayObjects, without the mask.
+    void drawContent(Renderer& renderer, const Transform& xform);
+
     /// Returns all DisplayObjects that are active based on the current state.
     //
     /// The "_visible" property does not matter here. 
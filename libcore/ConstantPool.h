@@ -22,12 +22,17 @@
 #include <vector>
 #include <iosfwd>
 
+#include "as_string.h"
+
 namespace gnash {
 
 class VM;
 
-/// An indexed list of strings (must match the definition in action_buffer.h)
-typedef std::vector<const char*> ConstantPool;
+/// An indexed list of strings
+//
+/// The strings are shared, so that pushing a constant copies no
+/// characters and its string_table key is only looked up once.
+typedef std::vector<as_string> ConstantPool;
 
 std::ostream& operator<<(std::ostream& os, const ConstantPool& p);
 
@@ -43,6 +43,7 @@
 #include "Global_as.h"
 #include "Renderer.h"
 #include "GnashAlgorithm.h"
+#include "BitmapCache.h"
 #ifdef USE_SWFTREE
 # include "tree.hh"
 #endif
@@ -103,6 +104,7 @@ DisplayObject::DisplayObject(movie_root& mr, as_object* object,
     _mask(nullptr),
     _maskee(nullptr),
     _blendMode(BLENDMODE_NORMAL),
+    _cacheAsBitmap(false),
     _visible(true),
     _scriptTransformed(false),
     _dynamicallyCreated(false),
@@ -116,6 +118,10 @@ DisplayObject::DisplayObject(movie_root& mr, as_object* object,
     // This informs the core that the object is a DisplayObject.
     if (_object) _object->setDisplayObject(this);
 }
+
+DisplayObject::~DisplayObject()
+{
+}
     
 void
 DisplayObject::getLoadedMovie(Movie* extern_movie)
@@ -187,6 +193,14 @@ DisplayObject::set_invalidated()
 
 void
 DisplayObject::set_invalidated(const char* debug_file, int debug_line)
+{
+    if (_bitmapCache) _bitmapCache->invalidate();
+    set_placement_invalidated(debug_file, debug_line);
+}
+
+void
+DisplayObject::set_placement_invalidated(const char* debug_file,
+        int debug_line)
 {
     // Set the invalidated-flag of the parent. Note this does not mean that
     // the parent must re-draw itself, it just means that one of it's childs
@@ -205,7 +219,7 @@ DisplayObject::set_invalidated(const char* debug_file, int debug_line)
         _invalidated = true;
         
 #ifdef DEBUG_SET_INVALIDATED
-        log_debug("%p set_invalidated() of %s in %s:%d",
+        log_debug("%p set_placement_invalidated() of %s in %s:%d",
             (void*)this, getTarget(), debug_file, debug_line);
 #else
         UNUSED(debug_file);
@@ -231,12 +245,15 @@ DisplayObject::add_invalidated_bounds(InvalidatedRanges& ranges, bool force)
         SWFRect bounds;        
         bounds.expand_to_transformed_rect(getWorldMatrix(*this), getBounds());
         ranges.add(bounds.getRange());                        
+        addFilterBounds(ranges);
     }        
 }
 
 void
 DisplayObject::set_child_invalidated()
 {
+    if (_bitmapCache) _bitmapCache->invalidate();
+
     if (!_child_invalidated) {
         _child_invalidated=true;
         if (_parent) _parent->set_child_invalidated();
@@ -322,7 +339,7 @@ DisplayObject::blendMode(const fn_call& fn)
 void
 DisplayObject::set_visible(bool visible)
 {
-    if (_visible != visible) set_invalidated(__FILE__, __LINE__);
+    if (_visible != visible) set_placement_invalidated(__FILE__, __LINE__);
 
     // Remove focus from this DisplayObject if it changes from visible to
     // invisible (see Selection.as).
@@ -397,7 +414,7 @@ DisplayObject::setMatrix(const SWFMatrix& m, bool updateCache)
 
     if (m == _transform.matrix) return;
 
-    set_invalidated(__FILE__, __LINE__);
+    set_placement_invalidated(__FILE__, __LINE__);
     _transform.matrix = m;
 
     // don't update caches if SWFMatrix wasn't updated too
@@ -686,6 +703,7 @@ DisplayObject::destroy()
     /// We don't destroy ourself twice, right ?
 
     if (_object) _object->clearProperties();
+    if (_bitmapCache) _bitmapCache->clear();
 
     assert(!_destroyed);
     _destroyed = true;
@@ -727,7 +745,7 @@ DisplayObject::setMask(DisplayObject* mask)
 {
     if ( _mask == mask ) return;
 
-    set_invalidated();
+    set_placement_invalidated(__FILE__, __LINE__);
 
     // Backup this before setMaskee has a chance to change it..
     DisplayObject* prevMaskee = _maskee;
@@ -780,11 +798,83 @@ DisplayObject::setMaskee(DisplayObject* maskee)
 }
 
 
+void
+DisplayObject::setCacheAsBitmap(bool cache)
+{
+    if (cache == _cacheAsBitmap) return;
+
+    set_invalidated(__FILE__, __LINE__);
+    _cacheAsBitmap = cache;
+
+    if (cache) {
+        if (!_bitmapCache) _bitmapCache.reset(new BitmapCache);
+    }
+    else if (_bitmapCache && _bitmapCache->filters().empty()) {
+        _bitmapCache.reset();
+    }
+}
+
+void
+DisplayObject::setFilters(Filters filters)
+{
+    if (filters.empty() && (!_bitmapCache || _bitmapCache->filters().empty())) {
+        return;
+    }
+
+    // Invalidate the area of the old filters.
+    set_invalidated(__FILE__, __LINE__);
+
+    if (!_bitmapCache) _bitmapCache.reset(new BitmapCache);
+    _bitmapCache->setFilters(std::move(filters));
+
+    if (!_cacheAsBitmap && _bitmapCache->filters().empty()) {
+        _bitmapCache.reset();
+    }
+}
+
+const Filters&
+DisplayObject::filters() const
+{
+    static const Filters none;
+    return _bitmapCache ? _bitmapCache->filters() : none;
+}
+
+bool
+DisplayObject::displayCached(Renderer& renderer, const Transform& xform,
+        const std::function<void(Renderer&, const Transform&)>& draw)
+{
+    if (!_bitmapCache) return false;
+
+    // Masks are drawn into the mask buffer, which needs their shapes.
+    for (const DisplayObject* p = this; p; p = p->parent()) {
+        if (p->isMaskLayer() || p->isDynamicMask()) return false;
+    }
+
+    if (!_bitmapCache->update(renderer, xform, getBounds(), draw)) {
+        return false;
+    }
+
+    const MaskRenderer mr(renderer, *this);
+    _bitmapCache->display(renderer, xform);
+    return true;
+}
+
+void
+DisplayObject::addFilterBounds(InvalidatedRanges& ranges) const
+{
+    if (!_bitmapCache || _bitmapCache->filters().empty()) return;
+
+    SWFRect bounds;
+    bounds.expand_to_transformed_rect(getWorldMatrix(*this), getBounds());
+    ranges.add(_bitmapCache->filteredBounds(bounds).getRange());
+}
+
 bool 
 DisplayObject::boundsInClippingArea(Renderer& renderer) const 
 {
     SWFRect mybounds = getBounds();
     getWorldMatrix(*this).transform(mybounds);
+    if (_bitmapCache) mybounds = _bitmapCache->filteredBounds(mybounds);
   
     return renderer.bounds_in_clipping_area(mybounds.getRange());  
 }
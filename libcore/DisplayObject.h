@@ -29,6 +29,8 @@
 #include <string>
 #include <cassert>
 #include <cstdint> // For C99 int types
+#include <memory>
+#include <functional>
 #include <boost/noncopyable.hpp>
 #include <boost/logic/tribool.hpp>
 
@@ -41,6 +43,7 @@
 #include "SWFCxForm.h"
 #include "dsodefs.h" 
 #include "snappingrange.h"
+#include "Filters.h"
 #ifdef USE_SWFTREE
 # include "tree.hh"
 #endif
@@ -65,6 +68,7 @@ namespace gnash {
     class as_environment;
     class DisplayObject;
     class KeyVisitor;
+    class BitmapCache;
     namespace SWF {
         class TextRecord;
     }
@@ -181,7 +185,7 @@ public:
     /// @param parent   The parent of the new DisplayObject. This may be null.
     DisplayObject(movie_root& mr, as_object* object, DisplayObject* parent);
 
-    virtual ~DisplayObject() {}
+    virtual ~DisplayObject();
 
     /// The lowest placeable and accessible depth for a DisplayObject.
     /// Macromedia Flash help says: depth starts at -16383 (0x3FFF)
@@ -352,7 +356,7 @@ public:
     void setCxForm(const SWFCxForm& cx) 
     {       
         if (_transform.colorTransform != cx) {
-            set_invalidated();
+            set_placement_invalidated(__FILE__, __LINE__);
             _transform.colorTransform = cx;
         }
     }
@@ -691,6 +695,12 @@ public:
     ///
     void set_invalidated();
     void set_invalidated(const char* debug_file, int debug_line);
+
+    /// Like set_invalidated(), for changes that only move, color or mask
+    /// this DisplayObject as a whole.
+    //
+    /// A bitmap this DisplayObject is cached in stays valid.
+    void set_placement_invalidated(const char* debug_file, int debug_line);
     
     
     /// Calls set_invalidated() and extends old_invalidated_ranges to the
@@ -895,6 +905,25 @@ public:
         _blendMode = bm;
     }
 
+    /// Whether this DisplayObject is drawn from a cached bitmap.
+    bool cacheAsBitmap() const {
+        return _cacheAsBitmap;
+    }
+
+    /// Draw this DisplayObject from a cached bitmap, or normally.
+    //
+    /// See BitmapCache for when the bitmap is drawn again.
+    void setCacheAsBitmap(bool cache);
+
+    /// Set the filters this DisplayObject is drawn with.
+    //
+    /// A DisplayObject with filters is drawn from a cached bitmap, as with
+    /// cacheAsBitmap, and the filters are applied to the bitmap.
+    void setFilters(Filters filters);
+
+    /// The filters this DisplayObject is drawn with.
+    const Filters& filters() const;
+
     // action_buffer is externally owned
     typedef std::vector<const action_buffer*> BufferList;
     typedef std::map<event_id, BufferList> Events;
@@ -975,6 +1004,21 @@ protected:
         DisplayObject* _mask;
     };
 
+    /// Draw this DisplayObject from its cached bitmap, if it has one.
+    //
+    /// The mask of the DisplayObject is drawn first, as a MaskRenderer
+    /// does.
+    //
+    /// @param xform    The world transform of the DisplayObject.
+    /// @param draw     Draws the content of the DisplayObject without
+    ///                 its mask, when the bitmap needs updating.
+    /// @return         false if the DisplayObject has to be drawn normally.
+    bool displayCached(Renderer& renderer, const Transform& xform,
+            const std::function<void(Renderer&, const Transform&)>& draw);
+
+    /// Add the area drawn by this DisplayObject's filters, if any.
+    void addFilterBounds(InvalidatedRanges& ranges) const;
+
     virtual bool unloadChildren() { return false; }
 
     /// Get the movie_root to which this DisplayObject belongs.
@@ -1077,6 +1121,11 @@ private:
 
     BlendMode _blendMode;
 
+    /// Set when cacheAsBitmap is true or there are filters.
+    std::unique_ptr<BitmapCache> _bitmapCache;
+
+    bool _cacheAsBitmap;
+
     bool _visible;
 
     /// Whether this DisplayObject has been transformed by ActionScript code
@@ -0,0 +1,600 @@
+// FilterKernels.cpp: pixel operations of the bitmap filters, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "FilterKernels.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "GnashImage.h"
+
+// The SSE2 and plain versions of each kernel do the same float operations
+// in the same order, so that they give the same results. Keep it that way:
+// the tests compare them.
+
+namespace gnash {
+namespace filter {
+
+namespace {
+
+#ifdef __SSE2__
+bool useSimd = true;
+#else
+bool useSimd = false;
+#endif
+
+/// Round a value in the range 0..255 to a byte.
+inline std::uint8_t
+roundToByte(float v)
+{
+    return static_cast<std::uint8_t>(v + 0.5f);
+}
+
+/// Clamp a value to 0..255 and round it to a byte.
+//
+/// The comparisons are those of SSE's min and max, including for NaN.
+inline std::uint8_t
+clampToByte(float v)
+{
+    v = v < 255.0f ? v : 255.0f;
+    v = v > 0.0f ? v : 0.0f;
+    return roundToByte(v);
+}
+
+/// Get the unpremultiplied color of a pixel.
+inline void
+unpremultiply(const std::uint8_t* p, float* c)
+{
+    const int a = p[3];
+    if (!a) {
+        std::fill(c, c + 4, 0.0f);
+        return;
+    }
+    for (size_t i = 0; i < 3; ++i) {
+        c[i] = std::min(255, (p[i] * 255 + a / 2) / a);
+    }
+    c[3] = a;
+}
+
+/// Store an unpremultiplied color in a pixel.
+inline void
+premultiply(const std::uint8_t* c, std::uint8_t* p)
+{
+    const int a = c[3];
+    for (size_t i = 0; i < 3; ++i) {
+        p[i] = (c[i] * a + 127) / 255;
+    }
+    p[3] = a;
+}
+
+#ifdef __SSE2__
+
+/// The four bytes of a pixel as 32-bit integers.
+inline __m128i
+loadPixel(const std::uint8_t* p)
+{
+    std::int32_t v;
+    std::memcpy(&v, p, 4);
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zero),
+            zero);
+}
+
+/// Store four 32-bit integers in the range 0..255 as a pixel.
+inline void
+storePixel(std::uint8_t* p, __m128i v)
+{
+    v = _mm_packs_epi32(v, v);
+    v = _mm_packus_epi16(v, v);
+    const std::int32_t out = _mm_cvtsi128_si32(v);
+    std::memcpy(p, &out, 4);
+}
+
+/// Sixteen bytes as four vectors of 32-bit integers.
+inline void
+widen(const std::uint8_t* p, __m128i* out)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i lo = _mm_unpacklo_epi8(b, zero);
+    const __m128i hi = _mm_unpackhi_epi8(b, zero);
+    out[0] = _mm_unpacklo_epi16(lo, zero);
+    out[1] = _mm_unpackhi_epi16(lo, zero);
+    out[2] = _mm_unpacklo_epi16(hi, zero);
+    out[3] = _mm_unpackhi_epi16(hi, zero);
+}
+
+/// Round and clamp four floats to bytes, as clampToByte() does.
+inline __m128i
+clampToBytes(__m128 v)
+{
+    v = _mm_min_ps(v, _mm_set1_ps(255.0f));
+    v = _mm_max_ps(v, _mm_setzero_ps());
+    return _mm_cvttps_epi32(_mm_add_ps(v, _mm_set1_ps(0.5f)));
+}
+
+#endif
+
+/// Blur a row of four-byte pixels horizontally from src into dst.
+void
+blurRow(const std::uint8_t* src, std::uint8_t* dst, size_t width, size_t r)
+{
+    const float scale = 1.0f / (2 * r + 1);
+
+#ifdef __SSE2__
+    if (useSimd) {
+        const __m128 vscale = _mm_set1_ps(scale);
+        const __m128 half = _mm_set1_ps(0.5f);
+
+        __m128i sum = _mm_setzero_si128();
+        for (size_t x = 0; x <= r && x < width; ++x) {
+            sum = _mm_add_epi32(sum, loadPixel(src + x * 4));
+        }
+
+        for (size_t x = 0; x < width; ++x) {
+            const __m128 f = _mm_add_ps(
+                    _mm_mul_ps(_mm_cvtepi32_ps(sum), vscale), half);
+            storePixel(dst + x * 4, _mm_cvttps_epi32(f));
+
+            if (x + r + 1 < width) {
+                sum = _mm_add_epi32(sum, loadPixel(src + (x + r + 1) * 4));
+            }
+            if (x >= r) {
+                sum = _mm_sub_epi32(sum, loadPixel(src + (x - r) * 4));
+            }
+        }
+        return;
+    }
+#endif
+
+    std::int32_t sum[4] = { 0, 0, 0, 0 };
+    for (size_t x = 0; x <= r && x < width; ++x) {
+        for (size_t c = 0; c < 4; ++c) sum[c] += src[x * 4 + c];
+    }
+
+    for (size_t x = 0; x < width; ++x) {
+        for (size_t c = 0; c < 4; ++c) {
+            dst[x * 4 + c] = roundToByte(sum[c] * scale);
+            if (x + r + 1 < width) sum[c] += src[(x + r + 1) * 4 + c];
+            if (x >= r) sum[c] -= src[(x - r) * 4 + c];
+        }
+    }
+}
+
+/// Write a row of the vertical blur from the column sums, then move the
+/// sums down a row.
+//
+/// @param next     The row entering the sums, if any.
+/// @param prev     The row leaving the sums, if any.
+void
+blurColumnsStep(std::int32_t* sums, std::uint8_t* row,
+        const std::uint8_t* next, const std::uint8_t* prev, size_t n,
+        float scale)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    if (useSimd) {
+        const __m128 vscale = _mm_set1_ps(scale);
+        const __m128 half = _mm_set1_ps(0.5f);
+
+        for (; i + 16 <= n; i += 16) {
+            __m128i* s = reinterpret_cast<__m128i*>(sums + i);
+            __m128i v[4];
+            for (size_t k = 0; k < 4; ++k) {
+                v[k] = _mm_loadu_si128(s + k);
+            }
+
+            __m128i out[4];
+            for (size_t k = 0; k < 4; ++k) {
+                out[k] = _mm_cvttps_epi32(_mm_add_ps(
+                            _mm_mul_ps(_mm_cvtepi32_ps(v[k]), vscale), half));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i),
+                    _mm_packus_epi16(_mm_packs_epi32(out[0], out[1]),
+                        _mm_packs_epi32(out[2], out[3])));
+
+            __m128i d[4];
+            if (next) {
+                widen(next + i, d);
+                for (size_t k = 0; k < 4; ++k) v[k] = _mm_add_epi32(v[k], d[k]);
+            }
+            if (prev) {
+                widen(prev + i, d);
+                for (size_t k = 0; k < 4; ++k) v[k] = _mm_sub_epi32(v[k], d[k]);
+            }
+            for (size_t k = 0; k < 4; ++k) {
+                _mm_storeu_si128(s + k, v[k]);
+            }
+        }
+    }
+#endif
+
+    for (; i < n; ++i) {
+        row[i] = roundToByte(sums[i] * scale);
+        if (next) sums[i] += next[i];
+        if (prev) sums[i] -= prev[i];
+    }
+}
+
+/// Blur rows of n bytes vertically, in place.
+void
+blurColumns(std::uint8_t* data, size_t n, size_t stride, size_t height,
+        size_t r)
+{
+    const float scale = 1.0f / (2 * r + 1);
+
+    std::vector<std::int32_t> sums(n);
+    for (size_t y = 0; y <= r && y < height; ++y) {
+        const std::uint8_t* row = data + y * stride;
+        for (size_t i = 0; i < n; ++i) sums[i] += row[i];
+    }
+
+    // The rows leaving the sums have already been blurred, so the last
+    // r + 1 rows are kept as they were.
+    std::vector<std::uint8_t> saved((r + 1) * n);
+
+    for (size_t y = 0; y < height; ++y) {
+        std::uint8_t* row = data + y * stride;
+        std::copy(row, row + n, saved.begin() + (y % (r + 1)) * n);
+
+        const std::uint8_t* next = y + r + 1 < height ?
+            data + (y + r + 1) * stride : nullptr;
+        const std::uint8_t* prev = y >= r ?
+            &saved[((y - r) % (r + 1)) * n] : nullptr;
+
+        blurColumnsStep(sums.data(), row, next, prev, n, scale);
+    }
+}
+
+/// Blur the rows of an RGBA image horizontally.
+void
+blurRows(image::GnashImage& im, size_t r)
+{
+    const size_t width = im.width();
+    std::vector<std::uint8_t> row(width * 4);
+
+    for (size_t y = 0; y < im.height(); ++y) {
+        std::uint8_t* p = scanline(im, y);
+        std::copy(p, p + width * 4, row.begin());
+        blurRow(row.data(), p, width, r);
+    }
+}
+
+/// Blur the rows of a plane horizontally.
+//
+/// Four rows are blurred at once, as the four channels of a row of pixels.
+void
+blurPlaneRows(std::uint8_t* plane, size_t width, size_t height, size_t r)
+{
+    std::vector<std::uint8_t> in(width * 4);
+    std::vector<std::uint8_t> out(width * 4);
+
+    for (size_t y = 0; y < height; y += 4) {
+        const size_t rows = std::min<size_t>(4, height - y);
+
+        std::fill(in.begin(), in.end(), 0);
+        for (size_t k = 0; k < rows; ++k) {
+            const std::uint8_t* p = plane + (y + k) * width;
+            for (size_t x = 0; x < width; ++x) in[x * 4 + k] = p[x];
+        }
+
+        blurRow(in.data(), out.data(), width, r);
+
+        for (size_t k = 0; k < rows; ++k) {
+            std::uint8_t* p = plane + (y + k) * width;
+            for (size_t x = 0; x < width; ++x) p[x] = out[x * 4 + k];
+        }
+    }
+}
+
+} // anonymous namespace
+
+bool
+simd()
+{
+    return useSimd;
+}
+
+void
+setSimd(bool use)
+{
+#ifdef __SSE2__
+    useSimd = use;
+#else
+    static_cast<void>(use);
+#endif
+}
+
+int
+blurRadius(float blur)
+{
+    // Flash blurs by at most 255 pixels.
+    if (!(blur >= 2)) return 0;
+    return static_cast<int>(std::min(blur, 255.0f)) / 2;
+}
+
+void
+boxBlur(image::GnashImage& im, float blurX, float blurY, int passes)
+{
+    assert(im.type() == image::TYPE_RGBA);
+
+    const int rx = blurRadius(blurX);
+    const int ry = blurRadius(blurY);
+
+    for (int i = 0; i < passes; ++i) {
+        if (rx) blurRows(im, rx);
+        if (ry) {
+            blurColumns(im.begin(), im.width() * 4, im.stride(), im.height(),
+                    ry);
+        }
+    }
+}
+
+void
+boxBlur(std::uint8_t* plane, size_t width, size_t height, float blurX,
+        float blurY, int passes)
+{
+    const int rx = blurRadius(blurX);
+    const int ry = blurRadius(blurY);
+
+    for (int i = 0; i < passes; ++i) {
+        if (rx) blurPlaneRows(plane, width, height, rx);
+        if (ry) blurColumns(plane, width, width, height, ry);
+    }
+}
+
+void
+colorMatrix(image::GnashImage& im, const float* m)
+{
+    assert(im.type() == image::TYPE_RGBA);
+
+    std::uint8_t* p = im.begin();
+    std::uint8_t* const end = im.end();
+
+#ifdef __SSE2__
+    if (useSimd) {
+        // The columns of the matrix.
+        __m128 cols[5];
+        for (size_t i = 0; i < 5; ++i) {
+            cols[i] = _mm_setr_ps(m[i], m[5 + i], m[10 + i], m[15 + i]);
+        }
+
+        for (; p != end; p += 4) {
+            float c[4];
+            unpremultiply(p, c);
+
+            __m128 v = _mm_mul_ps(cols[0], _mm_set1_ps(c[0]));
+            v = _mm_add_ps(v, _mm_mul_ps(cols[1], _mm_set1_ps(c[1])));
+            v = _mm_add_ps(v, _mm_mul_ps(cols[2], _mm_set1_ps(c[2])));
+            v = _mm_add_ps(v, _mm_mul_ps(cols[3], _mm_set1_ps(c[3])));
+            v = _mm_add_ps(v, cols[4]);
+
+            std::uint8_t out[4];
+            storePixel(out, clampToBytes(v));
+            premultiply(out, p);
+        }
+        return;
+    }
+#endif
+
+    for (; p != end; p += 4) {
+        float c[4];
+        unpremultiply(p, c);
+
+        std::uint8_t out[4];
+        for (size_t i = 0; i < 4; ++i) {
+            const float* row = m + i * 5;
+            float v = row[0] * c[0];
+            v += row[1] * c[1];
+            v += row[2] * c[2];
+            v += row[3] * c[3];
+            v += row[4];
+            out[i] = clampToByte(v);
+        }
+        premultiply(out, p);
+    }
+}
+
+void
+convolve(image::GnashImage& im, size_t cols, size_t rows, const float* m,
+        float divisor, float bias, bool preserveAlpha, bool clamp,
+        std::uint32_t color, std::uint8_t alpha)
+{
+    assert(im.type() == image::TYPE_RGBA);
+
+    const size_t width = im.width();
+    const size_t height = im.height();
+    if (!width || !height || !cols || !rows) return;
+
+    // The matrix is centered on each pixel.
+    const int ox = cols / 2;
+    const int oy = rows / 2;
+
+    // The unpremultiplied colors of the image, with a border wide
+    // enough for the matrix.
+    const size_t pw = width + cols - 1;
+    const size_t ph = height + rows - 1;
+    std::vector<float> src(pw * ph * 4);
+
+    const float border[4] = {
+        static_cast<float>((color >> 16) & 0xff),
+        static_cast<float>((color >> 8) & 0xff),
+        static_cast<float>(color & 0xff),
+        static_cast<float>(alpha)
+    };
+
+    for (size_t y = 0; y < ph; ++y) {
+        const int iy = static_cast<int>(y) - oy;
+        for (size_t x = 0; x < pw; ++x) {
+            const int ix = static_cast<int>(x) - ox;
+            float* s = &src[(y * pw + x) * 4];
+
+            const bool inside = ix >= 0 && iy >= 0 &&
+                ix < static_cast<int>(width) && iy < static_cast<int>(height);
+
+            if (!inside && !clamp) {
+                std::copy(border, border + 4, s);
+                continue;
+            }
+
+            const int cx = std::max(0, std::min<int>(ix, width - 1));
+            const int cy = std::max(0, std::min<int>(iy, height - 1));
+            unpremultiply(scanline(im, cy) + cx * 4, s);
+        }
+    }
+
+    const float d = divisor ? divisor : 1.0f;
+
+    for (size_t y = 0; y < height; ++y) {
+        std::uint8_t* p = scanline(im, y);
+
+        for (size_t x = 0; x < width; ++x, p += 4) {
+            const float* base = &src[(y * pw + x) * 4];
+            std::uint8_t out[4];
+
+#ifdef __SSE2__
+            if (useSimd) {
+                __m128 acc = _mm_setzero_ps();
+                for (size_t j = 0; j < rows; ++j) {
+                    const float* s = base + j * pw * 4;
+                    const float* k = m + j * cols;
+                    for (size_t i = 0; i < cols; ++i) {
+                        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(k[i]),
+                                    _mm_loadu_ps(s + i * 4)));
+                    }
+                }
+                acc = _mm_add_ps(_mm_div_ps(acc, _mm_set1_ps(d)),
+                        _mm_set1_ps(bias));
+                storePixel(out, clampToBytes(acc));
+            }
+            else
+#endif
+            {
+                float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                for (size_t j = 0; j < rows; ++j) {
+                    const float* s = base + j * pw * 4;
+                    const float* k = m + j * cols;
+                    for (size_t i = 0; i < cols; ++i) {
+                        for (size_t c = 0; c < 4; ++c) {
+                            acc[c] += k[i] * s[i * 4 + c];
+                        }
+                    }
+                }
+                for (size_t c = 0; c < 4; ++c) {
+                    out[c] = clampToByte(acc[c] / d + bias);
+                }
+            }
+
+            if (preserveAlpha) out[3] = p[3];
+            premultiply(out, p);
+        }
+    }
+}
+
+void
+shadow(image::GnashImage& im, int dx, int dy, std::uint32_t color,
+        std::uint8_t alpha, float blurX, float blurY, float strength,
+        int passes, bool inner, bool knockout, bool hideObject)
+{
+    assert(im.type() == image::TYPE_RGBA);
+
+    const int width = im.width();
+    const int height = im.height();
+
+    // The alpha of the image, offset, and inverted for an inner shadow
+    // so that it falls inside the shape.
+    std::vector<std::uint8_t> plane(width * height);
+    for (int y = 0; y < height; ++y) {
+        const int sy = y - dy;
+        for (int x = 0; x < width; ++x) {
+            const int sx = x - dx;
+            std::uint8_t a = 0;
+            if (sx >= 0 && sy >= 0 && sx < width && sy < height) {
+                a = scanline(im, sy)[sx * 4 + 3];
+            }
+            plane[y * width + x] = inner ? 255 - a : a;
+        }
+    }
+
+    boxBlur(plane.data(), width, height, blurX, blurY, passes);
+
+    const int sc[3] = {
+        static_cast<int>((color >> 16) & 0xff),
+        static_cast<int>((color >> 8) & 0xff),
+        static_cast<int>(color & 0xff)
+    };
+
+    for (int y = 0; y < height; ++y) {
+        std::uint8_t* p = scanline(im, y);
+        const std::uint8_t* s = &plane[y * width];
+
+        for (int x = 0; x < width; ++x, p += 4) {
+            const float st = s[x] * strength;
+            int sa = st >= 255.0f ? 255 : st > 0.0f ? static_cast<int>(st) : 0;
+            sa = (sa * alpha + 127) / 255;
+            if (inner) sa = (sa * p[3] + 127) / 255;
+
+            int sh[4];
+            for (size_t c = 0; c < 3; ++c) sh[c] = (sc[c] * sa + 127) / 255;
+            sh[3] = sa;
+
+            if (inner && !knockout && !hideObject) {
+                // Over the image.
+                for (size_t c = 0; c < 4; ++c) {
+                    p[c] = sh[c] + (p[c] * (255 - sa) + 127) / 255;
+                }
+            }
+            else if (!inner && knockout) {
+                // Where the image is not.
+                const int k = 255 - p[3];
+                for (size_t c = 0; c < 4; ++c) {
+                    p[c] = (sh[c] * k + 127) / 255;
+                }
+            }
+            else if (!inner && !hideObject) {
+                // Behind the image.
+                const int k = 255 - p[3];
+                for (size_t c = 0; c < 4; ++c) {
+                    p[c] += (sh[c] * k + 127) / 255;
+                }
+            }
+            else {
+                std::copy(sh, sh + 4, p);
+            }
+        }
+    }
+}
+
+} // namespace filter
+} // namespace gnash
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
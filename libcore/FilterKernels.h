@@ -0,0 +1,100 @@
+// FilterKernels.h: pixel operations of the bitmap filters, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_FILTERKERNELS_H
+#define GNASH_FILTERKERNELS_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace gnash {
+    namespace image {
+        class GnashImage;
+    }
+}
+
+namespace gnash {
+
+/// The pixel operations the filters in Filters.h are made of.
+//
+/// All of them work in place on images of premultiplied RGBA pixels.
+/// Where Gnash is built with SSE2 (always on x86_64), the inner loops use
+/// it; the results are exactly those of the plain C++ versions.
+namespace filter {
+
+/// Whether the kernels use SSE2.
+bool simd();
+
+/// Use SSE2 in the kernels, if Gnash is built with it, or not.
+//
+/// This is only for comparing the two in tests and benchmarks.
+void setSimd(bool use);
+
+/// The pixels a box blur of the given size reaches on each side.
+int blurRadius(float blur);
+
+/// Blur with a box of blurX by blurY pixels, passes times.
+//
+/// Each pass is a horizontal and a vertical running sum, so the cost
+/// does not depend on the size of the box. Pixels outside the image
+/// are transparent.
+void boxBlur(image::GnashImage& im, float blurX, float blurY, int passes);
+
+/// Blur a plane of width * height 8-bit values, as boxBlur() does.
+void boxBlur(std::uint8_t* plane, size_t width, size_t height,
+        float blurX, float blurY, int passes);
+
+/// Transform the unpremultiplied colors by a 4x5 matrix.
+//
+/// The rows of the matrix give red, green, blue and alpha; the fifth
+/// column is an offset in the range 0..255.
+void colorMatrix(image::GnashImage& im, const float* matrix);
+
+/// Convolve the unpremultiplied colors with a cols by rows matrix.
+//
+/// @param clamp    Whether pixels outside the image repeat its edge or
+///                 have the given color and alpha.
+void convolve(image::GnashImage& im, size_t cols, size_t rows,
+        const float* matrix, float divisor, float bias, bool preserveAlpha,
+        bool clamp, std::uint32_t color, std::uint8_t alpha);
+
+/// Draw a blurred shadow of the image's alpha offset by (dx, dy).
+//
+/// A glow is a shadow with no offset.
+//
+/// @param color        The RGB color of the shadow.
+/// @param alpha        The opacity of the shadow.
+/// @param strength     Multiplies the shadow's alpha before it is drawn.
+/// @param inner        Draw the shadow inside the image's shape instead
+///                     of behind it.
+/// @param knockout     Leave the image out, and with it the part of an
+///                     outer shadow that the image covers.
+/// @param hideObject   Draw the shadow only.
+void shadow(image::GnashImage& im, int dx, int dy, std::uint32_t color,
+        std::uint8_t alpha, float blurX, float blurY, float strength,
+        int passes, bool inner, bool knockout, bool hideObject);
+
+} // namespace filter
+} // namespace gnash
+
+#endif
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
@@ -0,0 +1,212 @@
+// Filters.cpp: drawing the bitmap filters, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "Filters.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "FilterKernels.h"
+#include "GnashImage.h"
+
+namespace gnash {
+
+namespace {
+
+/// The offset of a shadow, in whole pixels.
+void
+shadowOffset(float distance, float angle, int& dx, int& dy)
+{
+    dx = std::lround(distance * std::cos(angle));
+    dy = std::lround(distance * std::sin(angle));
+}
+
+/// Add the margins of an outer shadow or glow.
+void
+addShadowMargins(FilterMargins& m, int dx, int dy, float blurX, float blurY,
+        int passes)
+{
+    const int rx = filter::blurRadius(blurX) * passes;
+    const int ry = filter::blurRadius(blurY) * passes;
+    m.left += rx + std::max(0, -dx);
+    m.right += rx + std::max(0, dx);
+    m.top += ry + std::max(0, -dy);
+    m.bottom += ry + std::max(0, dy);
+}
+
+} // anonymous namespace
+
+std::unique_ptr<BitmapFilter>
+BitmapFilter::clone() const
+{
+    return std::unique_ptr<BitmapFilter>(new BitmapFilter(*this));
+}
+
+Filters
+cloneFilters(const Filters& filters)
+{
+    Filters ret;
+    ret.reserve(filters.size());
+    for (const auto& f : filters) {
+        ret.push_back(f->clone());
+    }
+    return ret;
+}
+
+std::unique_ptr<BitmapFilter>
+BevelFilter::clone() const
+{
+    return std::unique_ptr<BitmapFilter>(new BevelFilter(*this));
+}
+
+bool
+BlurFilter::apply(image::GnashImage& im) const
+{
+    if (im.type() != image::TYPE_RGBA) return false;
+    filter::boxBlur(im, m_blurX, m_blurY, m_quality);
+    return true;
+}
+
+void
+BlurFilter::addMargins(FilterMargins& m) const
+{
+    const int rx = filter::blurRadius(m_blurX) * m_quality;
+    const int ry = filter::blurRadius(m_blurY) * m_quality;
+    m.left += rx;
+    m.right += rx;
+    m.top += ry;
+    m.bottom += ry;
+}
+
+std::unique_ptr<BitmapFilter>
+BlurFilter::clone() const
+{
+    return std::unique_ptr<BitmapFilter>(new BlurFilter(*this));
+}
+
+bool
+ColorMatrixFilter::apply(image::GnashImage& im) const
+{
+    if (im.type() != image::TYPE_RGBA) return false;
+
+    // Without a matrix the filter changes nothing.
+    if (m_matrix.size() < 20) return true;
+
+    filter::colorMatrix(im, &m_matrix[0]);
+    return true;
+}
+
+std::unique_ptr<BitmapFilter>
+ColorMatrixFilter::clone() const
+{
+    return std::unique_ptr<BitmapFilter>(new ColorMatrixFilter(*this));
+}
+
+bool
+ConvolutionFilter::apply(image::GnashImage& im) const
+{
+    if (im.type() != image::TYPE_RGBA) return false;
+
+    const size_t size = _matrixX * _matrixY;
+    if (!size || _matrix.size() < size) return true;
+
+    filter::convolve(im, _matrixX, _matrixY, &_matrix[0], _divisor, _bias,
+            _preserveAlpha, _clamp, _color, _alpha);
+    return true;
+}
+
+std::unique_ptr<BitmapFilter>
+ConvolutionFilter::clone() const
+{
+    return std::unique_ptr<BitmapFilter>(new ConvolutionFilter(*this));
+}
+
+bool
+DropShadowFilter::apply(image::GnashImage& im) const
+{
+    if (im.type() != image::TYPE_RGBA) return false;
+
+    int dx, dy;
+    shadowOffset(m_distance, m_angle, dx, dy);
+    filter::shadow(im, dx, dy, m_color, m_alpha, m_blurX, m_blurY,
+            m_strength, m_quality, m_inner, m_knockout, m_hideObject);
+    return true;
+}
+
+void
+DropShadowFilter::addMargins(FilterMargins& m) const
+{
+    // An inner shadow stays inside the object.
+    if (m_inner) return;
+
+    int dx, dy;
+    shadowOffset(m_distance, m_angle, dx, dy);
+    addShadowMargins(m, dx, dy, m_blurX, m_blurY, m_quality);
+}
+
+std::unique_ptr<BitmapFilter>
+DropShadowFilter::clone() const
+{
+    return std::unique_ptr<BitmapFilter>(new DropShadowFilter(*this));
+}
+
+bool
+GlowFilter::apply(image::GnashImage& im) const
+{
+    if (im.type() != image::TYPE_RGBA) return false;
+
+    filter::shadow(im, 0, 0, m_color, m_alpha, m_blurX, m_blurY,
+            m_strength, m_quality, m_inner, m_knockout, false);
+    return true;
+}
+
+void
+GlowFilter::addMargins(FilterMargins& m) const
+{
+    if (m_inner) return;
+    addShadowMargins(m, 0, 0, m_blurX, m_blurY, m_quality);
+}
+
+std::unique_ptr<BitmapFilter>
+GlowFilter::clone() const
+{
+    return std::unique_ptr<BitmapFilter>(new GlowFilter(*this));
+}
+
+std::unique_ptr<BitmapFilter>
+GradientBevelFilter::clone() const
+{
+    return std::unique_ptr<BitmapFilter>(new GradientBevelFilter(*this));
+}
+
+std::unique_ptr<BitmapFilter>
+GradientGlowFilter::clone() const
+{
+    return std::unique_ptr<BitmapFilter>(new GradientGlowFilter(*this));
+}
+
+} // namespace gnash
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
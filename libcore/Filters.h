@@ -21,15 +21,30 @@
 #define GNASH_FILTERS_H
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 #include <utility>
 
 namespace gnash {
     class SWFStream;
+    namespace image {
+        class GnashImage;
+    }
 }
 
 namespace gnash {
 
+// The pixels a filter draws around its input, on each side.
+struct FilterMargins
+{
+    FilterMargins() : left(0), top(0), right(0), bottom(0) {}
+
+    int left;
+    int top;
+    int right;
+    int bottom;
+};
+
 // The common base class for AS display filters.
 class BitmapFilter
 {
@@ -37,10 +52,29 @@ public:
     virtual bool read(SWFStream& /*in*/) {
         return true;
     }
+
+    // Apply the filter to an image of premultiplied RGBA pixels, which
+    // must have room for the margins of the filter. See Filters.cpp for
+    // the implementations. Returns false if the filter is not implemented.
+    virtual bool apply(image::GnashImage& /*im*/) const {
+        return false;
+    }
+
+    // Add the pixels the filter draws outside its input.
+    virtual void addMargins(FilterMargins& /*m*/) const {}
+
+    // A new filter with the same parameters.
+    virtual std::unique_ptr<BitmapFilter> clone() const;
+
     BitmapFilter() {}
     virtual ~BitmapFilter() {}
 };
 
+typedef std::vector<std::unique_ptr<BitmapFilter> > Filters;
+
+// Copy a list of filters, as for each DisplayObject placed with them.
+Filters cloneFilters(const Filters& filters);
+
 // A bevel effect filter.
 class BevelFilter : public BitmapFilter
 {
@@ -55,6 +89,8 @@ public:
     // Fill from a SWFStream. See parser/filter_factory.cpp for the implementations.
     virtual bool read(SWFStream& in);
 
+    virtual std::unique_ptr<BitmapFilter> clone() const;
+
     virtual ~BevelFilter() {}
 
     BevelFilter()
@@ -104,6 +140,12 @@ public:
     // Fill from a SWFStream. See parser/filter_factory.cpp for the implementations.
     virtual bool read(SWFStream& in);
 
+    virtual bool apply(image::GnashImage& im) const;
+
+    virtual void addMargins(FilterMargins& m) const;
+
+    virtual std::unique_ptr<BitmapFilter> clone() const;
+
     virtual ~BlurFilter() {}
 
     BlurFilter() : 
@@ -126,6 +168,10 @@ public:
     // Fill from a SWFStream. See parser/filter_factory.cpp for the implementations.
     virtual bool read(SWFStream& in);
 
+    virtual bool apply(image::GnashImage& im) const;
+
+    virtual std::unique_ptr<BitmapFilter> clone() const;
+
     virtual ~ColorMatrixFilter() {}
 
     ColorMatrixFilter() : 
@@ -148,6 +194,10 @@ public:
     // the implementations.
     virtual bool read(SWFStream& in);
 
+    virtual bool apply(image::GnashImage& im) const;
+
+    virtual std::unique_ptr<BitmapFilter> clone() const;
+
     virtual ~ConvolutionFilter() {}
 
     ConvolutionFilter()
@@ -198,6 +248,12 @@ public:
     // Fill from a SWFStream. See parser/filter_factory.cpp for the implementations.
     virtual bool read(SWFStream& in);
 
+    virtual bool apply(image::GnashImage& im) const;
+
+    virtual void addMargins(FilterMargins& m) const;
+
+    virtual std::unique_ptr<BitmapFilter> clone() const;
+
     virtual ~DropShadowFilter() {}
 
     DropShadowFilter() : 
@@ -216,7 +272,7 @@ public:
     {}
 
     float m_distance; // Distance of the filter in pixels.
-    float m_angle; // Angle of the filter.
+    float m_angle; // Angle of the filter in radians.
     std::uint32_t m_color; // RGB color.
     std::uint8_t m_alpha; // Alpha strength, as a percentage(?)
     float m_blurX; // horizontal blur
@@ -236,6 +292,12 @@ public:
     // Fill from a SWFStream. See parser/filter_factory.cpp for the implementations.
     virtual bool read(SWFStream& in);
 
+    virtual bool apply(image::GnashImage& im) const;
+
+    virtual void addMargins(FilterMargins& m) const;
+
+    virtual std::unique_ptr<BitmapFilter> clone() const;
+
     virtual ~GlowFilter() {}
 
     GlowFilter() : 
@@ -277,6 +339,8 @@ public:
     // Fill from a SWFStream. See parser/filter_factory.cpp for the implementations.
     virtual bool read(SWFStream& in);
 
+    virtual std::unique_ptr<BitmapFilter> clone() const;
+
     virtual ~GradientBevelFilter() {}
 
     GradientBevelFilter() : 
@@ -324,6 +388,8 @@ public:
     // Fill from a SWFStream. See parser/filter_factory.cpp for the implementations.
     virtual bool read(SWFStream& in);
 
+    virtual std::unique_ptr<BitmapFilter> clone() const;
+
     virtual ~GradientGlowFilter() {}
 
     GradientGlowFilter() : 
@@ -0,0 +1,220 @@
+// FrameStats.cpp: timings of the work done for each frame, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "FrameStats.h"
+
+#include <ostream>
+#include <iomanip>
+#include <algorithm>
+#include <csignal>
+#include <cassert>
+
+namespace gnash {
+
+namespace {
+
+volatile std::sig_atomic_t dumpSignalled = 0;
+
+extern "C" void
+onDumpSignal(int)
+{
+    dumpSignalled = 1;
+}
+
+/// Write the start of a complete event of the trace.
+void
+writeEvent(std::ostream& o, const char* name, const char* cat,
+        std::uint64_t start, std::uint64_t duration)
+{
+    o << "{\"name\":\"" << name << "\",\"cat\":\"" << cat
+      << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << start
+      << ",\"dur\":" << duration;
+}
+
+}
+
+FrameStats::Frame::Frame()
+    :
+    start(0),
+    end(0),
+    advanced(false),
+    invalidatedArea(0)
+{
+    std::fill_n(phaseStart, PHASE_COUNT, 0);
+    std::fill_n(phaseTime, PHASE_COUNT, 0);
+}
+
+FrameStats::FrameStats(size_t capacity)
+    :
+    _epoch(std::chrono::steady_clock::now()),
+    _frames(std::max<size_t>(capacity, 1)),
+    _next(0),
+    _size(0),
+    _started(false)
+{
+}
+
+const char*
+FrameStats::phaseName(Phase phase)
+{
+    switch (phase) {
+        case PHASE_ADVANCE: return "advance";
+        case PHASE_LOADS: return "loads";
+        case PHASE_ACTIONS: return "actions";
+        case PHASE_CLEANUP: return "cleanup";
+        case PHASE_TIMERS: return "timers";
+        case PHASE_INVALIDATE: return "invalidate";
+        case PHASE_RENDER: return "render";
+        case PHASE_PRESENT: return "present";
+        default: return "unknown";
+    }
+}
+
+void
+FrameStats::beginFrame(const Counters& totals)
+{
+    endFrame(totals);
+
+    _started = true;
+    _totals = totals;
+    _current = Frame();
+    _current.start = _current.end = now();
+}
+
+void
+FrameStats::endFrame(const Counters& totals)
+{
+    if (!_started) return;
+
+    _current.counters.actions = totals.actions - _totals.actions;
+    _current.counters.allocated = totals.allocated - _totals.allocated;
+    _current.counters.freed = totals.freed - _totals.freed;
+
+    _frames[_next] = _current;
+    _next = (_next + 1) % _frames.size();
+    _size = std::min(_size + 1, _frames.size());
+    _started = false;
+    _totals = totals;
+}
+
+void
+FrameStats::addPhase(Phase phase, std::uint64_t start, std::uint64_t end)
+{
+    // Work outside a frame, such as the actions of the first frame run
+    // when the movie is loaded, starts one.
+    if (!_started) {
+        _started = true;
+        _current = Frame();
+        _current.start = _current.end = start;
+    }
+
+    assert(phase < PHASE_COUNT);
+
+    // A phase run more than once in a frame, as when the movie catches
+    // up with a streaming sound, starts when it first ran.
+    if (!_current.phaseTime[phase]) _current.phaseStart[phase] = start;
+    _current.phaseTime[phase] += end - start;
+    _current.end = std::max(_current.end, end);
+}
+
+void
+FrameStats::summarize(std::ostream& o) const
+{
+    std::uint64_t total[PHASE_COUNT] = {};
+    std::uint64_t worst[PHASE_COUNT] = {};
+    size_t advanced = 0;
+    std::uint64_t longest = 0;
+
+    for (size_t i = 0; i < _size; ++i) {
+        const Frame& f = (*this)[i];
+        if (f.advanced) ++advanced;
+        longest = std::max(longest, f.end - f.start);
+        for (size_t p = 0; p < PHASE_COUNT; ++p) {
+            total[p] += f.phaseTime[p];
+            worst[p] = std::max(worst[p], f.phaseTime[p]);
+        }
+    }
+
+    o << _size << " frames (" << advanced << " advanced), longest "
+      << longest << " us\n";
+    o << std::left << std::setw(12) << "phase" << std::right
+      << std::setw(12) << "mean us" << std::setw(12) << "max us" << "\n";
+    for (size_t p = 0; p < PHASE_COUNT; ++p) {
+        o << std::left << std::setw(12) << phaseName(static_cast<Phase>(p))
+          << std::right << std::setw(12) << (_size ? total[p] / _size : 0)
+          << std::setw(12) << worst[p] << "\n";
+    }
+}
+
+void
+FrameStats::writeTrace(std::ostream& o) const
+{
+    o << "{\"traceEvents\":[";
+
+    for (size_t i = 0; i < _size; ++i) {
+        const Frame& f = (*this)[i];
+        if (i) o << ",";
+
+        o << "\n";
+        writeEvent(o, "frame", "frame", f.start, f.end - f.start);
+        o << ",\"args\":{\"advanced\":" << (f.advanced ? "true" : "false")
+          << ",\"invalidatedArea\":" << f.invalidatedArea << "}}";
+
+        for (size_t p = 0; p < PHASE_COUNT; ++p) {
+            if (!f.phaseTime[p]) continue;
+            o << ",\n";
+            writeEvent(o, phaseName(static_cast<Phase>(p)), "phase",
+                    f.phaseStart[p], f.phaseTime[p]);
+            o << "}";
+        }
+
+        o << ",\n{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,\"ts\":"
+          << f.start << ",\"args\":{\"actions\":" << f.counters.actions
+          << ",\"allocated\":" << f.counters.allocated
+          << ",\"freed\":" << f.counters.freed << "}}";
+    }
+
+    o << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+bool
+FrameStats::dumpRequested()
+{
+    if (!dumpSignalled) return false;
+    dumpSignalled = 0;
+    return true;
+}
+
+void
+FrameStats::dumpOnSignal()
+{
+#ifdef SIGUSR2
+    std::signal(SIGUSR2, onDumpSignal);
+#endif
+}
+
+} // namespace gnash
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
@@ -0,0 +1,224 @@
+// FrameStats.h: timings of the work done for each frame, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_FRAMESTATS_H
+#define GNASH_FRAMESTATS_H
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <boost/noncopyable.hpp>
+
+#include "dsodefs.h"
+
+namespace gnash {
+
+/// Records where the time of the most recent frames went
+//
+/// A frame record is started by each movie_root::advance call and
+/// collects the time spent in each phase of the advance and of the
+/// display that follows it, with the number of actions executed and of
+/// collectables allocated and freed, and the area the GUI redrew.
+//
+/// The records of the last frames are kept in a ring buffer. They can
+/// be read one by one, summarized as text or written as a trace in the
+/// Chrome trace event format, which chrome://tracing and Perfetto load.
+class DSOEXPORT FrameStats : boost::noncopyable
+{
+public:
+
+    /// The parts of the work done for a frame.
+    enum Phase
+    {
+        /// Advancing the live DisplayObjects.
+        PHASE_ADVANCE,
+
+        /// Loading movies whose requests completed.
+        PHASE_LOADS,
+
+        /// Executing the action queue.
+        PHASE_ACTIONS,
+
+        /// Cleaning up the display lists and collecting garbage.
+        PHASE_CLEANUP,
+
+        /// Executing timers and advance callbacks.
+        PHASE_TIMERS,
+
+        /// Finding the invalidated bounds.
+        PHASE_INVALIDATE,
+
+        /// Rendering the stage.
+        PHASE_RENDER,
+
+        /// Showing the rendered frame.
+        PHASE_PRESENT,
+
+        PHASE_COUNT
+    };
+
+    /// Running totals of the counters kept for each frame.
+    struct Counters
+    {
+        Counters() : actions(0), allocated(0), freed(0) {}
+
+        /// Actions executed.
+        std::uint64_t actions;
+
+        /// Collectables allocated.
+        std::uint64_t allocated;
+
+        /// Collectables freed.
+        std::uint64_t freed;
+    };
+
+    /// The record of one frame.
+    struct Frame
+    {
+        Frame();
+
+        /// When the frame started, in microseconds since the FrameStats
+        /// was created.
+        std::uint64_t start;
+
+        /// When the last phase of the frame ended.
+        std::uint64_t end;
+
+        /// When each phase first started, or 0.
+        std::uint64_t phaseStart[PHASE_COUNT];
+
+        /// The microseconds spent in each phase.
+        std::uint64_t phaseTime[PHASE_COUNT];
+
+        /// Whether the movie advanced to a new frame.
+        bool advanced;
+
+        /// The counters for this frame alone.
+        Counters counters;
+
+        /// The area redrawn, in square pixels.
+        std::uint64_t invalidatedArea;
+    };
+
+    /// Measures a phase of the current frame
+    class Timer : boost::noncopyable
+    {
+    public:
+        Timer(FrameStats& stats, Phase phase)
+            :
+            _stats(stats),
+            _phase(phase),
+            _start(stats.now())
+        {}
+
+        ~Timer() {
+            _stats.addPhase(_phase, _start, _stats.now());
+        }
+
+    private:
+        FrameStats& _stats;
+        const Phase _phase;
+        const std::uint64_t _start;
+    };
+
+    /// @param capacity     The number of frames to keep.
+    explicit FrameStats(size_t capacity = 256);
+
+    /// The name of a phase, as used in traces.
+    static const char* phaseName(Phase phase);
+
+    /// Microseconds since the FrameStats was created.
+    std::uint64_t now() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - _epoch).count();
+    }
+
+    /// End the current frame, if any, and start a new one.
+    //
+    /// @param totals   The running totals of the counters.
+    void beginFrame(const Counters& totals);
+
+    /// End the current frame, if any.
+    //
+    /// @param totals   The running totals of the counters.
+    void endFrame(const Counters& totals);
+
+    /// Mark the current frame as advancing the movie.
+    void setAdvanced() {
+        _current.advanced = true;
+    }
+
+    /// Add to the area redrawn in the current frame.
+    void addInvalidatedArea(std::uint64_t area) {
+        _current.invalidatedArea += area;
+    }
+
+    /// Add the time of a phase to the current frame.
+    void addPhase(Phase phase, std::uint64_t start, std::uint64_t end);
+
+    /// The number of ended frames kept.
+    size_t size() const {
+        return _size;
+    }
+
+    /// An ended frame, from 0 for the oldest to size() - 1.
+    const Frame& operator[](size_t i) const {
+        return _frames[(_next + _frames.size() - _size + i) % _frames.size()];
+    }
+
+    /// Write the average and worst time of each phase of the frames kept.
+    void summarize(std::ostream& o) const;
+
+    /// Write the frames kept as a Chrome trace event file.
+    void writeTrace(std::ostream& o) const;
+
+    /// Whether a dump was asked for by a signal since the last call.
+    static bool dumpRequested();
+
+    /// Ask for a dump when the process gets SIGUSR2.
+    static void dumpOnSignal();
+
+private:
+
+    const std::chrono::steady_clock::time_point _epoch;
+
+    std::vector<Frame> _frames;
+
+    /// Where the next ended frame goes.
+    size_t _next;
+
+    size_t _size;
+
+    /// Whether a frame was begun and not ended.
+    bool _started;
+
+    Frame _current;
+
+    /// The totals when the current frame started, or the last ended.
+    Counters _totals;
+};
+
+} // namespace gnash
+
+#endif
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
@@ -30,6 +30,9 @@
 #include "namedStrings.h"
 #include "CallStack.h"
 #include "DisplayObject.h"
+#include "DecodedActions.h"
+#include "LocalVariables.h"
+#include "rc.h"
 
 namespace gnash {
 
@@ -42,7 +45,10 @@ Function::Function(const action_buffer& ab, as_environment& env,
     _action_buffer(ab),
     _scopeStack(std::move(scopeStack)),
     _startPC(start),
-    _length(0)
+    _length(0),
+    _name(0),
+    _localVariables(nullptr),
+    _localsScanned(false)
 {
     assert( _startPC < _action_buffer.size() );
 }
@@ -153,6 +159,36 @@ Function::setLength(size_t len)
     _length = len;
 }
 
+const LocalVariables*
+Function::localVariables() const
+{
+    if (_localsScanned) return _localVariables;
+    _localsScanned = true;
+
+    if (!RcInitFile::getDefaultInstance().localVariableSlots()) return nullptr;
+
+    // SWF5 functions look in the scope stack they were defined with before
+    // their local variables.
+    const int version = _action_buffer.getDefinitionVersion();
+    if (version < 6 && !_scopeStack.empty()) return nullptr;
+
+    // The variables Function::call and Function2::call declare.
+    std::vector<ObjectURI> names;
+    for (const Argument& arg : _args) {
+        if (!arg.reg) names.push_back(arg.name);
+    }
+    names.push_back(NSV::PROP_THIS);
+    names.push_back(NSV::PROP_ARGUMENTS);
+    names.push_back(NSV::PROP_SUPER);
+
+    const LocalVariables& vars = _action_buffer.decodedActions().localVariables(
+            _startPC, _startPC + _length, _pool, names,
+            getStringTable(*this), version < 7);
+
+    if (vars.enabled()) _localVariables = &vars;
+    return _localVariables;
+}
+
 void
 Function::markReachableResources() const
 {
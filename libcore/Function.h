@@ -26,6 +26,7 @@
 #include "ConstantPool.h"
 #include "UserFunction.h"
 #include "ObjectURI.h"
+#include "string_table.h"
 
 // Forward declarations
 namespace gnash {
@@ -116,9 +117,25 @@ public:
     /// Set the length in bytes of the function code.
 	void setLength(size_t len);
 
+    /// Set the name given to the function by its definition.
+    void setName(string_table::key name) {
+        _name = name;
+    }
+
+    /// The name given to the function by its definition, or 0 if the
+    /// function is anonymous.
+    string_table::key name() const {
+        return _name;
+    }
+
 	/// Dispatch.
 	virtual as_value call(const fn_call& fn);
 
+    /// Return the local variables kept in slots of the CallFrame.
+    //
+    /// The function body is scanned for them on the first call.
+    virtual const LocalVariables* localVariables() const;
+
 	/// Mark reachable resources. Override from as_object
 	//
 	/// Reachable resources from this object are its scope stack
@@ -163,6 +180,13 @@ private:
 	/// to a DoAction block
 	size_t _length;
 
+    string_table::key _name;
+
+    /// The local variables kept in slots, valid once _localsScanned.
+    mutable const LocalVariables* _localVariables;
+
+    mutable bool _localsScanned;
+
 };
 
 /// Add properties to an 'arguments' object.
@@ -32,7 +32,8 @@ MorphShape::MorphShape(movie_root& mr, as_object* object,
     :
     DisplayObject(mr, object, parent),
     _def(def),
-    _shape(_def->shape1())
+    _shape(_def->shape1()),
+    _morphedRatio(-1)
 {
 }
 
@@ -87,6 +88,11 @@ MorphShape::getBounds() const
 void
 MorphShape::morph()
 {
+    // Morphing again would give the same shape a new revision, so that
+    // renderers could not reuse their work on it.
+    if (get_ratio() == _morphedRatio) return;
+    _morphedRatio = get_ratio();
+
     _shape.setLerp(_def->shape1(), _def->shape2(), currentRatio());
 }
 
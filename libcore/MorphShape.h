@@ -73,6 +73,9 @@ private:
 	
     SWF::ShapeRecord _shape;
 
+    /// The ratio _shape was last morphed to, or -1 before the first time.
+    int _morphedRatio;
+
 };
 
 
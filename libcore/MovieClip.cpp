@@ -513,6 +513,7 @@ MovieClip::MovieClip(as_object* object, const movie_definition* def,
     _hasLooped(false),
     _flushedOrphanedTags(false),
     _callingFrameActions(false),
+    _enterFrameHandler(false),
     _lockroot(false),
     _onLoadCalled(false)
 {
@@ -720,13 +721,23 @@ MovieClip::notifyEvent(const event_id& id)
     log_debug("Event %s invoked for movieclip %s", id, getTarget());
 #endif
 
-    // We do not execute ENTER_FRAME if unloaded
-    if (id.id() == event_id::ENTER_FRAME && unloaded()) {
+    if (id.id() == event_id::ENTER_FRAME) {
+
+        // We do not execute ENTER_FRAME if unloaded
+        if (unloaded()) {
 #ifdef GNASH_DEBUG
-        log_debug("Sprite %s ignored ENTER_FRAME event (is unloaded)",
-                getTarget());
+            log_debug("Sprite %s ignored ENTER_FRAME event (is unloaded)",
+                    getTarget());
 #endif
-        return;
+            return;
+        }
+
+        // Most clips of a movie with many have no handler, so don't
+        // look for one unless it may exist.
+        if (!_enterFrameHandler && !stage().enterFrameInherited() &&
+                !get_event_handlers().count(id)) {
+            return;
+        }
     }
 
     if (isButtonEvent(id) && !isEnabled()) {
@@ -1195,7 +1206,12 @@ void
 MovieClip::draw(Renderer& renderer, const Transform& xform)
 {
     const DisplayObject::MaskRenderer mr(renderer, *this);
+    drawContent(renderer, xform);
+}
 
+void
+MovieClip::drawContent(Renderer& renderer, const Transform& xform)
+{
     _drawable.finalize();
     _drawable.display(renderer, xform);
     _displayList.display(renderer, xform);
@@ -1212,7 +1228,11 @@ MovieClip::display(Renderer& renderer, const Transform& base)
     
     // Draw everything with our own transform.
     const Transform xform = base * transform();
-    draw(renderer, xform);
+
+    const bool cached = displayCached(renderer, xform,
+            [this](Renderer& r, const Transform& x) { drawContent(r, x); });
+    if (!cached) draw(renderer, xform);
+
     clear_invalidated();
 }
 
@@ -1269,6 +1289,12 @@ MovieClip::add_display_object(const SWF::PlaceObject2Tag* tag,
         ch->setBlendMode(static_cast<DisplayObject::BlendMode>(bm));
     }
 
+    if (tag->hasBitmapCaching()) {
+        ch->setCacheAsBitmap(tag->getBitmapCaching());
+    }
+
+    if (tag->hasFilters()) ch->setFilters(cloneFilters(tag->getFilters()));
+
     // Attach event handlers (if any).
     const SWF::PlaceObject2Tag::EventHandlers& event_handlers =
         tag->getEventHandlers();
@@ -1299,6 +1325,14 @@ MovieClip::move_display_object(const SWF::PlaceObject2Tag* tag, DisplayList& dli
         tag->hasCxform() ? &tag->getCxform() : nullptr,
         tag->hasMatrix() ? &tag->getMatrix() : nullptr,
         tag->hasRatio() ? &ratio : nullptr);
+
+    // Filters are moved like the rest, unless ActionScript took over.
+    if (tag->hasFilters()) {
+        DisplayObject* ch = dlist.getDisplayObjectAtDepth(tag->getDepth());
+        if (ch && ch->get_accept_anim_moves()) {
+            ch->setFilters(cloneFilters(tag->getFilters()));
+        }
+    }
 }
 
 void
@@ -1357,6 +1391,9 @@ MovieClip::replace_display_object(const SWF::PlaceObject2Tag* tag,
     if (tag->hasMatrix()) {
         ch->setMatrix(tag->getMatrix(), true); 
     }
+    if (tag->hasFilters()) {
+        ch->setFilters(cloneFilters(tag->getFilters()));
+    }
 
     // use SWFMatrix from the old DisplayObject if tag doesn't provide one.
     dlist.replaceDisplayObject(ch, tag->getDepth(), 
@@ -1662,6 +1699,8 @@ MovieClip::add_invalidated_bounds(InvalidatedRanges& ranges, bool force)
             _drawable.getBounds());
 
     ranges.add(bounds.getRange());
+
+    addFilterBounds(ranges);
 }
 
 
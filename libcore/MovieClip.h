@@ -134,6 +134,13 @@ public:
     /// action
     void queueEvent(const event_id& id, int lvl);
 
+    /// Record whether this clip has an onEnterFrame property of its own.
+    //
+    /// This is called by movie_root::setEnterFrameHandler().
+    void setEnterFrameHandler(bool handler) {
+        _enterFrameHandler = handler;
+    }
+
     void queueLoad();
 
     /// Return the _root ActionScript property of this sprite.
@@ -637,6 +644,9 @@ protected:
 
 private:
 
+    /// Draw the drawing API shape and the DisplayList, without the mask.
+    void drawContent(Renderer& renderer, const Transform& xform);
+
     /// Process any completed loadVariables request
     void processCompletedLoadVariableRequests();
 
@@ -769,6 +779,9 @@ private:
     // true is we're calling frame actions
     bool _callingFrameActions;
 
+    /// Whether this clip has an onEnterFrame property of its own.
+    bool _enterFrameHandler;
+
     bool _lockroot;
 
     bool _onLoadCalled;
@@ -378,6 +378,13 @@ public:
         return _bound.type() == typeid(GetterSetter);
     }
 
+	/// Return the value of a simple property without copying it
+	//
+	/// @return     0 for getter/setter properties.
+	const as_value* getSimpleValue() const {
+        return boost::get<as_value>(&_bound);
+    }
+
 	/// Clear visibility flags
 	void clearVisible(int swfVersion) { _flags.clear_visible(swfVersion); }
 
@@ -0,0 +1,241 @@
+// PropertyCache.cpp: inline caches for property lookups, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h" // GNASH_STATS_PROPERTY_CACHE
+#endif
+
+#include "PropertyCache.h"
+
+#include "as_object.h"
+#include "as_value.h"
+#include "Property.h"
+#include "ObjectURI.h"
+#include "namedStrings.h"
+
+#ifdef GNASH_STATS_PROPERTY_CACHE
+# include <iostream>
+#endif
+
+namespace gnash {
+
+PropertyCache::Stats PropertyCache::_stats = { 0, 0, 0 };
+
+#ifdef GNASH_STATS_PROPERTY_CACHE
+namespace {
+
+struct StatsDumper
+{
+    ~StatsDumper() {
+        const PropertyCache::Stats& s = PropertyCache::stats();
+        const unsigned long total = s.hits + s.misses;
+        std::cerr << "PropertyCache: " << s.hits << " hits, "
+                  << s.misses << " misses (" << s.uncacheable
+                  << " uncacheable), hit rate "
+                  << (total ? 100.0 * s.hits / total : 0) << "%"
+                  << std::endl;
+    }
+} statsDumper;
+
+}
+#endif
+
+PropertyCache::PropertyCache()
+    :
+    _next(0)
+{
+    for (Entry& e : _entries) {
+        e.versions[0] = 0;
+        e.depth = 0;
+    }
+}
+
+Property*
+PropertyCache::findMember(as_object& obj, const ObjectURI& uri, int version)
+{
+    if (const Entry* e = find(obj, uri.name, version)) {
+        ++_stats.hits;
+        return e->prop;
+    }
+
+    ++_stats.misses;
+    Property* prop;
+    if (!fill(obj, uri, version, false, prop)) {
+        ++_stats.uncacheable;
+        return nullptr;
+    }
+    return prop;
+}
+
+bool
+PropertyCache::lookup(as_object& obj, const ObjectURI& uri, int version,
+        Property*& prop)
+{
+    if (const Entry* e = find(obj, uri.name, version)) {
+        ++_stats.hits;
+        prop = e->prop;
+        return true;
+    }
+
+    ++_stats.misses;
+    if (!fill(obj, uri, version, true, prop)) {
+        ++_stats.uncacheable;
+        return false;
+    }
+    return true;
+}
+
+Property*
+PropertyCache::findOwnMember(as_object& obj, const ObjectURI& uri,
+        int version)
+{
+    // TextField variables and array lengths are updated by set_member.
+    if (obj.displayObject() || obj.array()) return nullptr;
+
+    const PropertyList::Version current = obj._members.version();
+
+    for (const Entry& e : _entries) {
+        if (e.versions[0] == current && e.name == uri.name &&
+                e.swfVersion == version) {
+            ++_stats.hits;
+            return e.prop;
+        }
+    }
+
+    ++_stats.misses;
+
+    // Inherited getter/setters and new members are left to set_member.
+    Property* prop = obj._members.getProperty(uri);
+    if (!prop) {
+        ++_stats.uncacheable;
+        return nullptr;
+    }
+
+    Entry& e = victim();
+    e.versions[0] = current;
+    e.chain[0] = &obj;
+    e.prop = prop;
+    e.name = uri.name;
+    e.swfVersion = version;
+    e.depth = 1;
+    return prop;
+}
+
+const PropertyCache::Entry*
+PropertyCache::find(const as_object& obj, string_table::key name,
+        int version) const
+{
+    const PropertyList::Version current = obj._members.version();
+
+    for (const Entry& e : _entries) {
+
+        if (e.versions[0] != current) continue;
+        if (e.name != name || e.swfVersion != version) continue;
+
+        // The receiver is unchanged, so its __proto__ member still
+        // exists; check that it still points to the same, unchanged,
+        // object, and so on up to the holder.
+        size_t i = 1;
+        for (; i < e.depth; ++i) {
+            const as_value* proto = e.protos[i - 1]->getSimpleValue();
+            if (!proto || proto->get_object() != e.chain[i]) break;
+            if (e.chain[i]->_members.version() != e.versions[i]) break;
+        }
+        if (i == e.depth) return &e;
+    }
+    return nullptr;
+}
+
+bool
+PropertyCache::fill(as_object& obj, const ObjectURI& uri, int version,
+        bool absent, Property*& prop)
+{
+    if (obj.isSuper()) return false;
+
+    Entry e;
+    e.depth = 0;
+
+    as_object* o = &obj;
+
+    for (;;) {
+
+        if (e.depth == maxDepth) return false;
+
+        // Adding a densely stored element does not change the version.
+        if (o->_members.isElement(uri)) return false;
+
+        e.chain[e.depth] = o;
+        e.versions[e.depth] = o->_members.version();
+        ++e.depth;
+
+        prop = o->_members.getProperty(uri);
+        if (prop) {
+            // A hidden member makes get_member look further, but may
+            // become visible without a layout change.
+            if (!visible(*prop, version)) return false;
+            break;
+        }
+
+        // DisplayObjects have members outside their PropertyList.
+        if (o->displayObject()) return false;
+
+        const Property* proto = o->_members.getProperty(NSV::PROP_uuPROTOuu);
+        if (!proto || !visible(*proto, version)) {
+
+            // The end of the chain. Adding a __proto__ or __resolve
+            // member to any object on it changes its version.
+            if (!absent) return false;
+            for (size_t i = 0; i < e.depth; ++i) {
+                if (e.chain[i]->_members.getProperty(NSV::PROP_uuRESOLVE)) {
+                    return false;
+                }
+            }
+            break;
+        }
+
+        // A __proto__ that is not an object may become one without a
+        // layout change.
+        const as_value* protoVal = proto->getSimpleValue();
+        as_object* next = protoVal ? protoVal->get_object() : nullptr;
+        if (!next || next->displayObject()) return false;
+
+        // Leave circular chains to get_member.
+        for (size_t i = 0; i < e.depth; ++i) {
+            if (e.chain[i] == next) return false;
+        }
+
+        e.protos[e.depth - 1] = proto;
+        o = next;
+    }
+
+    e.prop = prop;
+    e.name = uri.name;
+    e.swfVersion = version;
+    victim() = e;
+    return true;
+}
+
+PropertyCache::Entry&
+PropertyCache::victim()
+{
+    Entry& e = _entries[_next];
+    _next = (_next + 1) % entries;
+    return e;
+}
+
+} // namespace gnash
@@ -0,0 +1,178 @@
+// PropertyCache.h: inline caches for property lookups, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_PROPERTYCACHE_H
+#define GNASH_PROPERTYCACHE_H
+
+#include <cstddef>
+
+#include "PropertyList.h"
+#include "string_table.h"
+#include "dsodefs.h"
+
+// Forward declarations
+namespace gnash {
+    class as_object;
+    class Property;
+    struct ObjectURI;
+}
+
+namespace gnash {
+
+/// An inline cache of the property lookups made by one action.
+//
+/// Each GetMember, SetMember and CallMethod action gets its own cache
+/// (see DecodedActions). It remembers, for the last few objects the
+/// action was used with, where in the inheritance chain the property was
+/// found, so that looking it up again is a few version comparisons
+/// instead of a prototype walk and a PropertyList search per object.
+//
+/// An entry records the PropertyList::version() of every object from the
+/// receiver to the object holding the property, and the __proto__
+/// property linking each of them to the next. It stays valid as long as
+/// none of these objects gains, loses or changes the flags of a property
+/// and no __proto__ along the chain points to another object. As
+/// versions are never reused, a dead object can not be mistaken for a
+/// live one.
+//
+/// Lookups whose result depends on anything else are never cached and
+/// always use the normal as_object::get_member() and set_member() path:
+/// DisplayObject properties, __resolve, 'super', getter/setter
+/// __proto__ members, hidden properties shadowing inherited ones,
+/// densely stored array elements (see PropertyList::setDense()) and
+/// prototype chains longer than maxDepth.
+class DSOEXPORT PropertyCache
+{
+public:
+
+    /// The number of different receivers remembered.
+    static const size_t entries = 4;
+
+    /// The maximum number of objects from receiver to holder.
+    static const size_t maxDepth = 4;
+
+    /// Counters of cache use, for all caches.
+    struct Stats
+    {
+        /// Lookups answered by a cache.
+        unsigned long hits;
+
+        /// Lookups that had to walk the inheritance chain.
+        unsigned long misses;
+
+        /// Misses whose result could not be cached.
+        unsigned long uncacheable;
+    };
+
+    PropertyCache();
+
+    /// Find a property for reading.
+    //
+    /// This follows the rules of as_object::get_member().
+    //
+    /// @return     The property, or 0 if the caller must use
+    ///             get_member() (including when there is no such member).
+    Property* findMember(as_object& obj, const ObjectURI& uri, int version);
+
+    /// Find a property for reading, or find that there is none.
+    //
+    /// This is findMember() for lookups that often fail, such as those
+    /// made along a scope chain: that an object and its prototypes, none
+    /// of which has a __resolve member, lack the property is remembered
+    /// as well.
+    //
+    /// @param prop     Set to the property, or to 0 if get_member() would
+    ///                 not find one.
+    /// @return         false if the caller must use get_member().
+    bool lookup(as_object& obj, const ObjectURI& uri, int version,
+            Property*& prop);
+
+    /// Find a property for writing.
+    //
+    /// Only existing properties of the object itself are cached; this
+    /// follows the rules of as_object::set_member(). A cache must be used
+    /// either for reading or for writing, never both.
+    //
+    /// @return     The property, or 0 if the caller must use
+    ///             set_member().
+    Property* findOwnMember(as_object& obj, const ObjectURI& uri,
+            int version);
+
+    /// Return the counters of all caches.
+    static const Stats& stats() {
+        return _stats;
+    }
+
+private:
+
+    struct Entry
+    {
+        /// The versions of the objects from receiver to holder.
+        //
+        /// A 0 receiver version marks an unused entry.
+        PropertyList::Version versions[maxDepth];
+
+        /// The objects from receiver to holder (the receiver is not used).
+        as_object* chain[maxDepth];
+
+        /// The __proto__ property of each object but the holder.
+        const Property* protos[maxDepth];
+
+        /// The property found, or 0 if the chain has none.
+        Property* prop;
+
+        /// The property name.
+        string_table::key name;
+
+        /// The SWF version the lookup was made for.
+        int swfVersion;
+
+        /// The number of objects from receiver to holder.
+        size_t depth;
+    };
+
+    /// Return a valid entry for this lookup, or 0.
+    const Entry* find(const as_object& obj, string_table::key name,
+            int version) const;
+
+    /// Walk the inheritance chain like get_member() and remember the result.
+    //
+    /// @param absent   Whether to remember that there is no property.
+    /// @return         false if the result can not be remembered.
+    bool fill(as_object& obj, const ObjectURI& uri, int version, bool absent,
+            Property*& prop);
+
+    /// Return the entry to replace.
+    Entry& victim();
+
+    Entry _entries[entries];
+
+    /// The next entry to replace.
+    size_t _next;
+
+    static Stats _stats;
+};
+
+} // namespace gnash
+
+#endif
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
@@ -25,8 +25,7 @@
 #include "PropertyList.h"
 
 #include <utility> 
-#include <functional> 
-#include <boost/tuple/tuple.hpp>
+#include <new>
 
 #include "Property.h" 
 #include "as_environment.h"
@@ -53,54 +52,383 @@
 
 namespace gnash {
 
+/// An open-addressing hash table from string_table keys to Slots.
+//
+/// This uses linear probing, and deletion moves entries back instead of
+/// leaving tombstones. The table is kept at most half full.
+class PropertyList::Index
+{
+public:
+
+    Index()
+        :
+        _entries(16),
+        _used(0)
+    {}
+
+    /// Return the Slot stored for a key, or 0.
+    Slot* find(string_table::key k) const {
+        for (size_t i = home(k); _entries[i].slot; i = (i + 1) & mask()) {
+            if (_entries[i].key == k) return _entries[i].slot;
+        }
+        return nullptr;
+    }
+
+    /// Store a Slot for a key that is not in the table.
+    void insert(string_table::key k, Slot* slot) {
+        if ((_used + 1) * 2 > _entries.size()) rehash(_entries.size() * 2);
+        size_t i = home(k);
+        while (_entries[i].slot) i = (i + 1) & mask();
+        _entries[i].key = k;
+        _entries[i].slot = slot;
+        ++_used;
+    }
+
+    /// Change the Slot stored for a key that is in the table.
+    void update(string_table::key k, Slot* slot) {
+        _entries[position(k)].slot = slot;
+    }
+
+    /// Remove a key that is in the table.
+    void erase(string_table::key k) {
+        size_t i = position(k);
+
+        // Move back any following entry that would not be found from its
+        // home position once this one is empty.
+        for (size_t j = (i + 1) & mask(); _entries[j].slot;
+                j = (j + 1) & mask()) {
+            const size_t h = home(_entries[j].key);
+            const bool between = i <= j ? (i < h && h <= j) : (i < h || h <= j);
+            if (between) continue;
+            _entries[i] = _entries[j];
+            i = j;
+        }
+        _entries[i] = Entry();
+        --_used;
+    }
+
+private:
+
+    struct Entry
+    {
+        Entry() : key(0), slot(nullptr) {}
+        string_table::key key;
+        Slot* slot;
+    };
+
+    size_t mask() const {
+        return _entries.size() - 1;
+    }
+
+    /// Keys are small consecutive integers, so spread them out.
+    size_t home(string_table::key k) const {
+        return (k * 0x9e3779b97f4a7c15ULL >> 32) & mask();
+    }
+
+    /// Return the position of a key that is in the table.
+    size_t position(string_table::key k) const {
+        size_t i = home(k);
+        while (!_entries[i].slot || _entries[i].key != k) {
+            i = (i + 1) & mask();
+        }
+        return i;
+    }
+
+    void rehash(size_t size) {
+        std::vector<Entry> old(size);
+        old.swap(_entries);
+        _used = 0;
+        for (const Entry& e : old) {
+            if (e.slot) insert(e.key, e.slot);
+        }
+    }
+
+    std::vector<Entry> _entries;
+
+    size_t _used;
+};
+
 namespace {
 
-inline
-PropertyList::const_iterator
-iterator_find(const PropertyList::container& p, const ObjectURI& uri, VM& vm)
+/// The last PropertyList version handed out.
+PropertyList::Version lastVersion = 0;
+
+/// Return the array index named by a string, or -1.
+//
+/// Only the canonical form of an index counts: "1", but not "01" or "+1",
+/// which name other properties. Indices from PropertyList::maxElements on
+/// are not counted.
+int
+canonicalIndex(const std::string& s)
 {
-    const bool caseless = vm.getSWFVersion() < 7;
+    if (s.empty() || s.size() > 9) return -1;
+    if (s[0] == '0') return s.size() == 1 ? 0 : -1;
 
-    if (!caseless) {
-        return p.project<PropertyList::CreationOrder>(
-                p.get<PropertyList::Case>().find(uri));
+    int i = 0;
+    for (const char c : s) {
+        if (c < '0' || c > '9') return -1;
+        i = i * 10 + (c - '0');
     }
-        
-    return p.project<PropertyList::CreationOrder>(
-            p.get<PropertyList::NoCase>().find(uri));
+    return i;
 }
 
 }
     
 PropertyList::PropertyList(as_object& obj)
     :
-    _props(boost::make_tuple(
-                boost::tuple<>(),
-                boost::make_tuple(
-                    KeyExtractor(),
-                    ObjectURI::LessThan()
-                ),
-                boost::make_tuple(
-                    KeyExtractor(),
-                    ObjectURI::CaseLessThan(getStringTable(obj), true)
-                )
-            )
-        ),
-    _owner(obj)
+    _owner(obj),
+    _version(++lastVersion),
+    _first(nullptr),
+    _last(nullptr),
+    _free(nullptr),
+    _size(0),
+    _capacity(0),
+    _elementsAfter(nullptr)
+{
+}
+
+PropertyList::~PropertyList()
+{
+    destroyAll();
+}
+
+void
+PropertyList::changed()
+{
+    _version = ++lastVersion;
+}
+
+PropertyList::Slot*
+PropertyList::find(const ObjectURI& uri) const
+{
+    if (getVM(_owner).getSWFVersion() < 7) return findNoCase(uri);
+    return findExact(uri);
+}
+
+PropertyList::Slot*
+PropertyList::findExact(const ObjectURI& uri) const
+{
+    if (_byName) return _byName->find(uri.name);
+
+    for (Slot* s = _first; s; s = s->next) {
+        if (s->prop().uri().name == uri.name) return s;
+    }
+    return nullptr;
+}
+
+PropertyList::Slot*
+PropertyList::findNoCase(const ObjectURI& uri) const
+{
+    string_table& st = getStringTable(_owner);
+    const string_table::key k = uri.noCase(st);
+
+    if (!_byName) {
+        for (Slot* s = _first; s; s = s->next) {
+            if (s->prop().uri().noCase(st) == k) return s;
+        }
+        return nullptr;
+    }
+
+    if (!_byNoCase) {
+        _byNoCase.reset(new Index);
+        for (Slot* s = _first; s; s = s->next) {
+            const string_table::key nc = s->prop().uri().noCase(st);
+            if (!_byNoCase->find(nc)) _byNoCase->insert(nc, s);
+        }
+    }
+    return _byNoCase->find(k);
+}
+
+void
+PropertyList::grow()
+{
+    const size_t n = _capacity ? _capacity : flatSize;
+    Slot* slots = new Slot[n];
+
+    if (_flat) _overflow.push_back(std::unique_ptr<Slot[]>(slots));
+    else _flat.reset(slots);
+
+    for (size_t i = n; i > 0; --i) {
+        slots[i - 1].prev = _free;
+        _free = &slots[i - 1];
+    }
+    _capacity += n;
+}
+
+PropertyList::Slot*
+PropertyList::insert(const Property& prop, Slot* after)
+{
+    if (!_free) grow();
+    Slot* s = _free;
+    _free = s->prev;
+
+    new (&s->storage) Property(prop);
+    s->prev = after;
+    s->next = after ? after->next : _first;
+    if (s->next) s->next->prev = s;
+    else _last = s;
+    if (after) after->next = s;
+    else _first = s;
+    ++_size;
+
+    if (_byName) {
+        _byName->insert(prop.uri().name, s);
+    }
+    else if (_size > flatLimit) {
+        _byName.reset(new Index);
+        for (Slot* i = _first; i; i = i->next) {
+            _byName->insert(i->prop().uri().name, i);
+        }
+    }
+
+    if (_byNoCase) {
+        const string_table::key nc = prop.uri().noCase(getStringTable(_owner));
+        if (!_byNoCase->find(nc)) _byNoCase->insert(nc, s);
+    }
+    return s;
+}
+
+bool
+PropertyList::replace(Slot& slot, const Property& prop)
+{
+    const string_table::key oldName = slot.prop().uri().name;
+    const string_table::key newName = prop.uri().name;
+
+    if (newName != oldName) {
+        if (findExact(prop.uri())) return false;
+        if (_byName) {
+            _byName->erase(oldName);
+            _byName->insert(newName, &slot);
+        }
+    }
+
+    // Both names match case-insensitively, so _byNoCase is still right.
+    slot.prop() = prop;
+    return true;
+}
+
+void
+PropertyList::erase(Slot& slot)
+{
+    const ObjectURI& uri = slot.prop().uri();
+
+    if (_byName) _byName->erase(uri.name);
+
+    // Another property may now be the first with this name.
+    if (_byNoCase) {
+        string_table& st = getStringTable(_owner);
+        const string_table::key nc = uri.noCase(st);
+        if (_byNoCase->find(nc) == &slot) {
+            Slot* next = slot.next;
+            while (next && next->prop().uri().noCase(st) != nc) {
+                next = next->next;
+            }
+            if (next) _byNoCase->update(nc, next);
+            else _byNoCase->erase(nc);
+        }
+    }
+
+    if (&slot == _elementsAfter) _elementsAfter = slot.prev;
+
+    if (slot.prev) slot.prev->next = slot.next;
+    else _first = slot.next;
+    if (slot.next) slot.next->prev = slot.prev;
+    else _last = slot.prev;
+    --_size;
+
+    slot.prop().~Property();
+    slot.prev = _free;
+    _free = &slot;
+}
+
+int
+PropertyList::elementIndex(const ObjectURI& uri) const
+{
+    if (!_elements) return -1;
+    return canonicalIndex(getStringTable(_owner).value(uri.name));
+}
+
+ObjectURI
+PropertyList::elementKey(size_t i) const
+{
+    return getURI(getVM(_owner), std::to_string(i), true);
+}
+
+void
+PropertyList::setDense()
+{
+    if (_elements) return;
+
+    string_table& st = getStringTable(_owner);
+    for (const Slot* s = _first; s; s = s->next) {
+        if (canonicalIndex(st.value(s->prop().uri().name)) >= 0) return;
+    }
+    _elements.reset(new std::vector<as_value>);
+    _elementsAfter = nullptr;
+
+    // Elements may now be added without a layout change.
+    changed();
+}
+
+void
+PropertyList::makeSparse()
 {
+    if (!_elements) return;
+
+    // Stop storing densely before inserting the elements as Properties.
+    const std::unique_ptr<std::vector<as_value> > elements(
+            std::move(_elements));
+
+    Slot* after = _elementsAfter;
+    _elementsAfter = nullptr;
+
+    for (size_t i = 0; i < elements->size(); ++i) {
+        after = insert(Property(elementKey(i), (*elements)[i], PropFlags()),
+                after);
+    }
+    changed();
+}
+
+void
+PropertyList::destroyAll()
+{
+    for (Slot* s = _first; s; s = s->next) {
+        s->prop().~Property();
+    }
 }
 
 bool
 PropertyList::setValue(const ObjectURI& uri, const as_value& val,
         const PropFlags& flagsIfMissing)
 {
-	const_iterator found = iterator_find(_props, uri, getVM(_owner));
+    const int i = elementIndex(uri);
+    if (i >= 0) {
+        std::vector<as_value>& elements = *_elements;
+        const size_t n = elements.size();
+        if (static_cast<size_t>(i) < n) {
+            elements[i] = val;
+            return true;
+        }
+
+        // A new element can only be stored densely if it comes after all
+        // the others, in index and in creation order.
+        if (static_cast<size_t>(i) == n && flagsIfMissing == PropFlags() &&
+                (!n || _elementsAfter == _last)) {
+            if (!n) _elementsAfter = _last;
+            elements.push_back(val);
+            return true;
+        }
+        makeSparse();
+    }
+
+	Slot* found = find(uri);
 	
-	if (found == _props.end()) {
+	if (!found) {
 		// create a new member
 		Property a(uri, val, flagsIfMissing);
 		// Non slot properties are negative ordering in insertion order
-		_props.push_back(a);
+		insert(a);
+        changed();
 #ifdef GNASH_DEBUG_PROPERTY
         ObjectURI::Logger l(getStringTable(_owner));
         log_debug("Simple AS property %s inserted with flags %s",
@@ -109,7 +437,7 @@ PropertyList::setValue(const ObjectURI& uri, const as_value& val,
 		return true;
 	}
 
-	const Property& prop = *found;
+	const Property& prop = found->prop();
 	return prop.setValue(_owner, val);
 
 }
@@ -117,22 +445,29 @@ PropertyList::setValue(const ObjectURI& uri, const as_value& val,
 void
 PropertyList::setFlags(const ObjectURI& uri, int setFlags, int clearFlags)
 {
-	iterator found = iterator_find(_props, uri, getVM(_owner));
-	if (found == _props.end()) return;
-    PropFlags f = found->getFlags();
+    if (element(uri)) makeSparse();
+
+	Slot* found = find(uri);
+	if (!found) return;
+    PropFlags f = found->prop().getFlags();
     f.set_flags(setFlags, clearFlags);
-	found->setFlags(f);
+	found->prop().setFlags(f);
+    changed();
 
 }
 
 void
 PropertyList::setFlagsAll(int setFlags, int clearFlags)
 {
-    for (const auto& prop: _props) {
+    if (_elements && !_elements->empty()) makeSparse();
+
+    for (Slot* s = _first; s; s = s->next) {
+        const Property& prop = s->prop();
         PropFlags f = prop.getFlags();
         f.set_flags(setFlags, clearFlags);
         prop.setFlags(f);
     }
+    changed();
 }
 
 Property*
@@ -145,26 +480,39 @@ PropertyList::getProperty(const ObjectURI& uri) const
         getStringTable(_owner), 10000000, NSV::PROP_uuPROTOuu, 10);
     kcl.check(uri.name);
 #endif // GNASH_STATS_PROPERTY_LOOKUPS
-	iterator found = iterator_find(_props, uri, getVM(_owner));
-	if (found == _props.end()) return nullptr;
-	return const_cast<Property*>(&(*found));
+
+    // Only real Properties can be returned.
+    if (element(uri)) const_cast<PropertyList*>(this)->makeSparse();
+
+	Slot* found = find(uri);
+	if (!found) return nullptr;
+	return &found->prop();
 }
 
 std::pair<bool,bool>
 PropertyList::delProperty(const ObjectURI& uri)
 {
 	//GNASH_REPORT_FUNCTION;
-	iterator found = iterator_find(_props, uri, getVM(_owner));
-	if (found == _props.end()) {
+    if (const as_value* e = element(uri)) {
+        if (e == &_elements->back()) {
+            _elements->pop_back();
+            return std::make_pair(true, true);
+        }
+        makeSparse();
+    }
+
+	Slot* found = find(uri);
+	if (!found) {
 		return std::make_pair(false, false);
 	}
 
 	// check if member is protected from deletion
-	if (found->getFlags().test<PropFlags::dontDelete>()) {
+	if (found->prop().getFlags().test<PropFlags::dontDelete>()) {
 		return std::make_pair(true, false);
 	}
 
-	_props.erase(found);
+	erase(*found);
+    changed();
 	return std::make_pair(true, true);
 }
 
@@ -173,25 +521,45 @@ PropertyList::visitKeys(KeyVisitor& visitor, PropertyTracker& donelist)
     const
 {
     // We should enumerate in order of creation, not lexicographically.
-	for (const auto& prop : _props) {
+    if (_elements && !_elementsAfter) visitElementKeys(visitor, donelist);
 
-		if (prop.getFlags().test<PropFlags::dontEnum>()) continue;
+	for (const Slot* s = _first; s; s = s->next) {
 
-        const ObjectURI& uri = prop.uri();
+        const Property& prop = s->prop();
 
-		if (donelist.insert(uri).second) {
-			visitor(uri);
-		}
+		if (!prop.getFlags().test<PropFlags::dontEnum>()) {
+            const ObjectURI& uri = prop.uri();
+            if (donelist.insert(uri).second) {
+                visitor(uri);
+            }
+        }
+
+        if (s == _elementsAfter) visitElementKeys(visitor, donelist);
 	}
 }
 
+void
+PropertyList::visitElementKeys(KeyVisitor& visitor, PropertyTracker& donelist)
+    const
+{
+    for (size_t i = 0; i < _elements->size(); ++i) {
+        const ObjectURI uri = elementKey(i);
+        if (donelist.insert(uri).second) {
+            visitor(uri);
+        }
+    }
+}
+
 void
 PropertyList::dump()
 {
     ObjectURI::Logger l(getStringTable(_owner));
-	for (const auto& prop : _props) {
-            log_debug("  %s: %s", l(prop.uri()), prop.getValue(_owner));
+	for (const Slot* s = _first; s; s = s->next) {
+            log_debug("  %s: %s", l(s->prop().uri()), s->prop().getValue(_owner));
 	}
+    for (size_t i = 0; _elements && i < _elements->size(); ++i) {
+        log_debug("  %s: %s", l(elementKey(i)), (*_elements)[i]);
+    }
 }
 
 bool
@@ -199,14 +567,16 @@ PropertyList::addGetterSetter(const ObjectURI& uri, as_function& getter,
 	as_function* setter, const as_value& cacheVal,
 	const PropFlags& flagsIfMissing)
 {
+    if (isElement(uri)) makeSparse();
+
 	Property a(uri, &getter, setter, flagsIfMissing);
-	iterator found = iterator_find(_props, uri, getVM(_owner));
+	Slot* found = find(uri);
     
-	if (found != _props.end()) {
+	if (found) {
 		// copy flags from previous member (even if it's a normal member ?)
-		a.setFlags(found->getFlags());
-		a.setCache(found->getCache());
-		_props.replace(found, a);
+		a.setFlags(found->prop().getFlags());
+		a.setCache(found->prop().getCache());
+		replace(*found, a);
 
 #ifdef GNASH_DEBUG_PROPERTY
         ObjectURI::Logger l(getStringTable(_owner));
@@ -217,13 +587,14 @@ PropertyList::addGetterSetter(const ObjectURI& uri, as_function& getter,
 	}
 	else {
 		a.setCache(cacheVal);
-		_props.push_back(a);
+		insert(a);
 #ifdef GNASH_DEBUG_PROPERTY
         ObjectURI::Logger l(getStringTable(_owner));
         log_debug("AS GetterSetter %s inserted with flags %s", l(uri),
                 a.getFlags());
 #endif
 	}
+    changed();
 
 	return true;
 }
@@ -232,14 +603,16 @@ bool
 PropertyList::addGetterSetter(const ObjectURI& uri, as_c_function_ptr getter,
 	as_c_function_ptr setter, const PropFlags& flagsIfMissing)
 {
+    if (isElement(uri)) makeSparse();
+
 	Property a(uri, getter, setter, flagsIfMissing);
 
-	const_iterator found = iterator_find(_props, uri, getVM(_owner));
-	if (found != _props.end())
+	Slot* found = find(uri);
+	if (found)
 	{
 		// copy flags from previous member (even if it's a normal member ?)
-		a.setFlags(found->getFlags());
-		_props.replace(found, a);
+		a.setFlags(found->prop().getFlags());
+		replace(*found, a);
 
 #ifdef GNASH_DEBUG_PROPERTY
         ObjectURI::Logger l(getStringTable(_owner));
@@ -250,13 +623,14 @@ PropertyList::addGetterSetter(const ObjectURI& uri, as_c_function_ptr getter,
 	}
 	else
 	{
-		_props.push_back(a);
+		insert(a);
 #ifdef GNASH_DEBUG_PROPERTY
 		string_table& st = getStringTable(_owner);
 		log_debug("Native GetterSetter %s in namespace %s inserted with "
                           "flags %s", st.value(key), st.value(nsId), a.getFlags());
 #endif
 	}
+    changed();
 
 	return true;
 }
@@ -265,8 +639,10 @@ bool
 PropertyList::addDestructiveGetter(const ObjectURI& uri, as_function& getter, 
 	const PropFlags& flagsIfMissing)
 {
-	const_iterator found = iterator_find(_props, uri, getVM(_owner));
-	if (found != _props.end())
+    if (isElement(uri)) makeSparse();
+
+	Slot* found = find(uri);
+	if (found)
 	{
         ObjectURI::Logger l(getStringTable(_owner));
         log_error(_("Property %s already exists, can't addDestructiveGetter"),
@@ -277,7 +653,8 @@ PropertyList::addDestructiveGetter(const ObjectURI& uri, as_function& getter,
 	// destructive getter doesn't need a setter
 	Property a(uri, &getter, nullptr, flagsIfMissing, true);
 
-	_props.push_back(a);
+	insert(a);
+    changed();
 
 #ifdef GNASH_DEBUG_PROPERTY
     ObjectURI::Logger l(getStringTable(_owner));
@@ -292,12 +669,15 @@ bool
 PropertyList::addDestructiveGetter(const ObjectURI& uri,
 	as_c_function_ptr getter, const PropFlags& flagsIfMissing)
 {
-	iterator found = iterator_find(_props, uri, getVM(_owner));
-	if (found != _props.end()) return false; 
+    if (isElement(uri)) makeSparse();
+
+	Slot* found = find(uri);
+	if (found) return false; 
 
 	// destructive getter doesn't need a setter
 	Property a(uri, getter, nullptr, flagsIfMissing, true);
-	_props.push_back(a);
+	insert(a);
+    changed();
 
 #ifdef GNASH_DEBUG_PROPERTY
     ObjectURI::Logger l(getStringTable(_owner));
@@ -310,8 +690,16 @@ PropertyList::addDestructiveGetter(const ObjectURI& uri,
 void
 PropertyList::clear()
 {
-	_props.clear();
+    destroyAll();
+    _first = _last = _free = nullptr;
+    _size = _capacity = 0;
+    _flat.reset();
+    _overflow.clear();
+    _byName.reset();
+    _byNoCase.reset();
+    if (_elements) _elements->clear();
+    _elementsAfter = nullptr;
+    changed();
 }
 
 } // namespace gnash
-
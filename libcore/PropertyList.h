@@ -24,13 +24,10 @@
 #include <cassert> // for inlines
 #include <utility> // for std::pair
 #include <cstdint>
-#include <boost/multi_index_container.hpp>
-#include <boost/multi_index/ordered_index.hpp>
-#include <boost/multi_index/sequenced_index.hpp>
-#include <boost/multi_index/key_extractors.hpp>
+#include <memory>
+#include <vector>
+#include <type_traits>
 #include <boost/noncopyable.hpp>
-#include <functional>
-#include <algorithm>
 
 #include "Property.h" // for templated functions
 #include "dsodefs.h" // for DSOTEXPORT
@@ -78,6 +75,22 @@ public:
 /// as_object, not just original as_object it was use with. Currently (as
 /// there is no use for this scenario) it is not possible to change the
 /// owner.
+//
+/// Most objects have only a few properties, so Properties are stored in
+/// flat arrays of slots, linked in creation order, and looked up by
+/// comparing keys one after the other. Once a list grows beyond
+/// flatLimit properties, lookups go through an open-addressing hash
+/// table keyed by string_table key. The case-insensitive table used
+/// for SWF6 and below is only built by the first such lookup.
+//
+/// Properties never move once created, so a Property* stays valid
+/// until that property is deleted or the list is cleared, even if other
+/// properties are added in the meantime (for instance by a getter).
+//
+/// The elements of an Array can instead be stored densely: see
+/// setDense(). They are then plain values in a vector, not Properties,
+/// which is invisible to users of the Property interface but lets Array
+/// functions work on them without looking up a name for each index.
 class PropertyList : boost::noncopyable
 {
 public:
@@ -85,53 +98,27 @@ public:
     typedef std::set<ObjectURI, ObjectURI::LessThan> PropertyTracker;
     typedef Property value_type;
 
-    /// Identifier for the sequenced index
-    struct CreationOrder {};
+    /// The number of Properties allocated together by an empty list.
+    static const size_t flatSize = 4;
 
-    /// The sequenced index in creation order.
-    typedef boost::multi_index::sequenced<
-        boost::multi_index::tag<CreationOrder> > SequencedIndex;
-    
-    struct KeyExtractor
-    {
-        typedef const ObjectURI& result_type;
-        result_type operator()(const Property& p) const {
-            return p.uri();
-        }
-    };
+    /// The number of Properties above which lookups use hash tables.
+    static const size_t flatLimit = 8;
+
+    /// A number identifying the layout of a PropertyList.
+    typedef std::uint64_t Version;
 
-    /// Identifier for the case-sensitive index
-    struct Case {};
-    
-    /// The case-sensitive index
-    typedef boost::multi_index::ordered_unique<
-        boost::multi_index::tag<Case>,
-        KeyExtractor,
-        ObjectURI::LessThan> CaseIndex;
-
-    /// Identifier for the case-insensitive index
-    struct NoCase {};
-    
-    /// The case-insensitive index
-    typedef boost::multi_index::ordered_non_unique<
-        boost::multi_index::tag<NoCase>,
-        KeyExtractor,
-        ObjectURI::CaseLessThan> NoCaseIndex;
-
-    /// The container of the Properties.
-    typedef boost::multi_index_container<
-        value_type,
-        boost::multi_index::indexed_by<SequencedIndex, CaseIndex, NoCaseIndex>
-        > container;
-
-    typedef container::iterator iterator;
-    typedef container::const_iterator const_iterator;
+    /// The first index whose name is too long to be stored densely.
+    //
+    /// Elements from this index on are always Properties.
+    static const size_t maxElements = 1000000000;
 
     /// Construct the PropertyList 
     //
     /// @param obj      The as_object to which this PropertyList belongs.
     DSOTEXPORT PropertyList(as_object& obj);
 
+    DSOTEXPORT ~PropertyList();
+
     /// Visit properties 
     //
     /// The method will invoke the given visitor method
@@ -150,11 +137,17 @@ public:
     template <class U, class V>
     void visitValues(V& visitor, U cmp = U()) const {
 
-        for (const auto& prop : _props) {
+        if (_elements && !_elementsAfter &&
+                !visitElements(visitor, cmp)) return;
 
-            if (!cmp(prop)) continue;
-            as_value val = prop.getValue(_owner);
-            if (!visitor.accept(prop.uri(), val)) return;
+        for (const Slot* s = _first; s; s = s->next) {
+
+            const Property& prop = s->prop();
+            if (cmp(prop)) {
+                as_value val = prop.getValue(_owner);
+                if (!visitor.accept(prop.uri(), val)) return;
+            }
+            if (s == _elementsAfter && !visitElements(visitor, cmp)) return;
         }
     }
 
@@ -277,9 +270,66 @@ public:
     /// Remove all entries in the container
     void clear();
 
+    /// Store array elements densely from now on, if possible.
+    //
+    /// Properties named by the indices 0, 1, 2... are then kept as plain
+    /// values in a vector, as long as they are created in that order,
+    /// without flags and without other properties created in between.
+    /// Anything else, including any request for the Property of an
+    /// element, turns them into normal Properties for good (see
+    /// makeSparse()). Enumeration order is the same in both cases.
+    //
+    /// This does nothing if a property is already named by an index.
+    void setDense();
+
+    /// Turn densely stored elements into Properties and stop storing them.
+    void makeSparse();
+
+    /// Return the densely stored elements, or 0 if not storing densely.
+    //
+    /// The vector may be changed freely, as elements are only values.
+    /// Anything else that changes the list may invalidate it.
+    std::vector<as_value>* elements() {
+        return _elements.get();
+    }
+
+    /// Return a densely stored element, or 0 if there is none.
+    //
+    /// @param uri  Name of the element.
+    as_value* element(const ObjectURI& uri) const {
+        if (!_elements) return nullptr;
+        const int i = elementIndex(uri);
+        if (i < 0 || static_cast<size_t>(i) >= _elements->size()) {
+            return nullptr;
+        }
+        return &(*_elements)[i];
+    }
+
+    /// Whether a name belongs to the densely stored elements.
+    //
+    /// This is true for all index names while storing densely, whether
+    /// the element exists or not, as creating it does not change the
+    /// version().
+    bool isElement(const ObjectURI& uri) const {
+        return _elements && elementIndex(uri) >= 0;
+    }
+
     /// Return number of properties in this list
     size_t size() const {
-        return _props.size();
+        return _size + (_elements ? _elements->size() : 0);
+    }
+
+    /// Return the version of this PropertyList's layout
+    //
+    /// The version changes whenever a property is added, deleted,
+    /// replaced or has its flags changed, but not when a property value
+    /// changes. Versions are unique in the process: two PropertyLists
+    /// never share one, so an unchanged version means both the same
+    /// list and the same Property objects.
+    //
+    /// This is what PropertyCache uses to validate cached lookups.
+    Version version() const {
+        return _version;
     }
 
     /// Dump all members (using log_debug)
@@ -293,16 +343,139 @@ public:
     /// This can be called very frequently, so is inlined to allow the
     /// compiler to optimize it.
     void setReachable() const {
-        std::for_each(_props.begin(), _props.end(),
-                std::mem_fn(&Property::setReachable));
+        for (const Slot* s = _first; s; s = s->next) {
+            s->prop().setReachable();
+        }
+        if (_elements) {
+            for (const as_value& val : *_elements) val.setReachable();
+        }
     }
 
 private:
 
-    container _props;
+    /// Storage for one Property, linked to its neighbours in creation order.
+    struct Slot
+    {
+        Property& prop() {
+            return *reinterpret_cast<Property*>(&storage);
+        }
+
+        const Property& prop() const {
+            return *reinterpret_cast<const Property*>(&storage);
+        }
+
+        std::aligned_storage<sizeof(Property), alignof(Property)>::type storage;
+
+        /// The previous Property, or the next free slot.
+        Slot* prev;
+
+        /// The next Property.
+        Slot* next;
+    };
+
+    /// A hash table of Slots (defined in PropertyList.cpp).
+    class Index;
+
+    /// Visit the densely stored elements like visitValues().
+    //
+    /// @return false if the visitor asked to stop.
+    template <class U, class V>
+    bool visitElements(V& visitor, U& cmp) const {
+        // The visitor may change the elements.
+        for (size_t i = 0; _elements && i < _elements->size(); ++i) {
+            const Property prop(elementKey(i), (*_elements)[i], PropFlags());
+            if (!cmp(prop)) continue;
+            as_value val = (*_elements)[i];
+            if (!visitor.accept(prop.uri(), val)) return false;
+        }
+        return true;
+    }
+
+    /// Return the index named by a property name while storing densely.
+    //
+    /// @return     The index, or -1 if the name is not a canonical array
+    ///             index or elements are not stored densely.
+    int elementIndex(const ObjectURI& uri) const;
+
+    /// Return the name of an element.
+    ObjectURI elementKey(size_t i) const;
+
+    /// Visit the keys of the densely stored elements like visitKeys().
+    void visitElementKeys(KeyVisitor& v, PropertyTracker& donelist) const;
+
+    /// Find a property according to the current SWF version's rules.
+    Slot* find(const ObjectURI& uri) const;
+
+    /// Find a property by exact (case-sensitive) name.
+    Slot* findExact(const ObjectURI& uri) const;
+
+    /// Find the first property whose name matches case-insensitively.
+    Slot* findNoCase(const ObjectURI& uri) const;
+
+    /// Add a Property after another one.
+    //
+    /// @param after    The Property to insert after, or 0 to insert
+    ///                 before all others.
+    /// @return         The new Property's slot.
+    Slot* insert(const Property& prop, Slot* after);
+
+    /// Add a Property after all the others.
+    void insert(const Property& prop) {
+        insert(prop, _last);
+    }
+
+    /// Replace a Property, keeping its position.
+    //
+    /// @return false if the new property has the exact name of another
+    ///         property, in which case nothing is done.
+    bool replace(Slot& slot, const Property& prop);
+
+    /// Destroy a Property and free its slot.
+    void erase(Slot& slot);
+
+    /// Destroy all Properties.
+    void destroyAll();
+
+    /// Add a new array of free slots.
+    void grow();
+
+    /// Give this PropertyList a new, unique version.
+    void changed();
 
     as_object& _owner;
 
+    Version _version;
+
+    /// The first and last Properties in creation order.
+    Slot* _first;
+    Slot* _last;
+
+    /// Unused slots, linked through Slot::prev.
+    Slot* _free;
+
+    size_t _size;
+
+    /// The number of slots in all arrays.
+    size_t _capacity;
+
+    /// The first array of slots, holding flatSize Properties.
+    std::unique_ptr<Slot[]> _flat;
+
+    /// Further arrays, each as large as all previous ones together.
+    std::vector<std::unique_ptr<Slot[]> > _overflow;
+
+    /// Properties by name, once there are more than flatLimit.
+    std::unique_ptr<Index> _byName;
+
+    /// The first Property for each case-insensitive name, built on demand.
+    mutable std::unique_ptr<Index> _byNoCase;
+
+    /// The densely stored elements, if storing densely.
+    std::unique_ptr<std::vector<as_value> > _elements;
+
+    /// The Property created just before the first element, or 0.
+    Slot* _elementsAfter;
+
 };
 
 
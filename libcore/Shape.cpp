@@ -50,7 +50,10 @@ Shape::display(Renderer& renderer, const Transform& base)
 {
     const Transform xform = base * transform();
 
-    _def->display(renderer, xform);
+    const bool cached = displayCached(renderer, xform,
+            [this](Renderer& r, const Transform& x) { _def->display(r, x); });
+    if (!cached) _def->display(renderer, xform);
+
     clear_invalidated();
 }
 
@@ -118,6 +118,13 @@ public:
     ///
     bool expired(unsigned long now, unsigned long& elapsed); 
 
+    /// Return the time the timer next expires, in milliseconds.
+    //
+    /// This is meaningless if the timer is cleared.
+    unsigned long expiryTime() const {
+        return _start + _interval;
+    }
+
     /// Return true if interval has been cleared.
     //
     /// Note that the timer is constructed as cleared and you
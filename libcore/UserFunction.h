@@ -22,6 +22,7 @@
 
 namespace gnash {
     class Global_as;
+    class LocalVariables;
 }
 
 namespace gnash {
@@ -44,6 +45,14 @@ public:
     /// the value should be 0.
     virtual std::uint8_t registers() const = 0;
 
+    /// Return the local variables kept in slots of the CallFrame
+    //
+    /// @return     null if all local variables are properties of the
+    ///             activation object, as for all but SWF functions.
+    virtual const LocalVariables* localVariables() const {
+        return nullptr;
+    }
+
 protected:
 
     UserFunction(Global_as& gl) : as_function(gl) {}
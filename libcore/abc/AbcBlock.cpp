@@ -310,7 +310,8 @@ operator<<(std::ostream& o, const Trait::Kind k)
 
 AbcBlock::AbcBlock()
     :
-    _stringTable(&VM::get().getStringTable())
+    _stringTable(&VM::get().getStringTable()),
+    _prepared(false)
 {
 	mCH = &VM::get().getMachine()->global()->classHierarchy();
 	// TODO: Make this the real 'Object' prototype.
@@ -321,6 +322,8 @@ AbcBlock::AbcBlock()
 void
 AbcBlock::prepare(Machine* mach)
 {
+    if (_prepared) return;
+    _prepared = true;
 
     std::for_each(_classes.begin(), _classes.end(),
             std::mem_fun(&abc::Class::initPrototype));
@@ -1186,7 +1189,7 @@ AbcBlock::read_method_bodies()
 
         Method& method = *_methods[offset];
 
-		if (method.getBody()) {
+		if (method.hasBody()) {
 			log_error(_("ABC: Only one body per method."));
 			return false;
 		}
@@ -1208,11 +1211,10 @@ AbcBlock::read_method_bodies()
 		method.setBodyLength(clength);
 
 		// The code.
-		//TODO: Clean this up.
-		std::string body;
-		_stream->read_string_with_length(clength, body);
-
-		method.setBody(new CodeStream(body));
+		std::vector<std::uint8_t> code(clength);
+		_stream->ensureBytes(clength);
+		_stream->read(reinterpret_cast<char*>(code.data()), clength);
+		method.setBody(std::move(code));
 		
         // Exception count and exceptions
         
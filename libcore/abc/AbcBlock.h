@@ -312,6 +312,10 @@ public:
         return _namespacePool[i];
     }
 
+    /// Create the runtime objects for the classes, scripts and methods.
+    //
+    /// Only the first call does anything, so a DoABC tag that is
+    /// executed again when its frame is revisited costs nothing.
     void prepare(Machine* mach);
 
 private:
@@ -364,6 +368,7 @@ private:
 
 	std::uint32_t mVersion;
 
+    bool _prepared;
 
 };
 
@@ -59,12 +59,8 @@ Class::addValue(string_table::key name, Namespace *ns,
 
     const ObjectURI uri(name, nsname);
 
-	if (slotId == 0) {
-		_prototype->init_member(uri, val, flags);
-	}
-	else {
-		_prototype->init_member(uri, val, flags, slotId);
-	}
+	_prototype->init_member(uri, val, flags);
+	if (slotId) setSlot(slotId, uri, isstatic);
 	return true;
 }
 
@@ -105,17 +101,14 @@ Class::addSlotFunction(string_table::key name, Namespace *ns,
 
 bool
 Class::addSlot(string_table::key name, Namespace* ns,
-        std::uint32_t slotId, Class* /*type*/, bool /*isstatic*/)
+        std::uint32_t slotId, Class* /*type*/, bool isstatic)
 {
 	string_table::key nsname = ns ? ns->getURI() : 0;
+    const ObjectURI uri(name, nsname);
 
 	//TODO: Set flags.
-	if (slotId == 0) {
-		_prototype->init_member(ObjectURI(name, nsname), as_value(), 0);
-	}
-	else {
-		_prototype->reserveSlot(ObjectURI(name, nsname), slotId);
-	}
+	_prototype->init_member(uri, as_value(), 0);
+	if (slotId) setSlot(slotId, uri, isstatic);
 	return true;
 }
 
@@ -235,6 +235,21 @@ public:
 		return &i->second;
 	}
 
+    /// The name of the instance trait in a slot, or 0 if there is none.
+    //
+    /// Slot ids are given to traits by the ABC block; instances of a
+    /// sealed Class always have the same slots.
+    const ObjectURI* slotName(std::uint32_t slotID) const {
+        return slotID < _slots.size() && _slots[slotID].name ?
+            &_slots[slotID] : 0;
+    }
+
+    /// The name of the static trait in a slot, or 0 if there is none.
+    const ObjectURI* staticSlotName(std::uint32_t slotID) const {
+        return slotID < _staticSlots.size() && _staticSlots[slotID].name ?
+            &_staticSlots[slotID] : 0;
+    }
+
 	Property* getGetBinding(as_value& v, abc::MultiName& n);
 	Property* getSetBinding(as_value& v, abc::MultiName& n);
 
@@ -262,6 +277,13 @@ private:
         return true;
     }
 
+    /// Give a trait a slot.
+    void setSlot(std::uint32_t slotID, const ObjectURI& uri, bool isstatic) {
+        std::vector<ObjectURI>& slots = isstatic ? _staticSlots : _slots;
+        if (slots.size() <= slotID) slots.resize(slotID + 1);
+        slots[slotID] = uri;
+    }
+
 	bool addStaticBinding(string_table::key name, const Property& b) {
         _staticBindings.insert(std::make_pair(name, b));
         return true;
@@ -282,6 +304,12 @@ private:
     /// The static Traits for this class;
     std::vector<Trait> _staticTraits;
 
+    /// The names of the instance traits, by slot id.
+    std::vector<ObjectURI> _slots;
+
+    /// The names of the static traits, by slot id.
+    std::vector<ObjectURI> _staticSlots;
+
 	
 	typedef std::map<string_table::key, Property> BindingContainer;
 
@@ -2,130 +2,378 @@
 //
 //   Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012
 //   Free Software Foundation, Inc.
-// 
+//
 // This program is free software; you can redistribute it and/or modify
 // it under the terms of the GNU General Public License as published by
 // the Free Software Foundation; either version 3 of the License, or
 // (at your option) any later version.
-// 
+//
 // This program is distributed in the hope that it will be useful,
 // but WITHOUT ANY WARRANTY; without even the implied warranty of
 // MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
 // GNU General Public License for more details.
-// 
+//
 // You should have received a copy of the GNU General Public License
 // along with this program; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "CodeStream.h"
-#include <iostream>
+
+#include <vector>
+
+#include "SWF.h"
+#include "log.h"
 
 namespace gnash {
 
-/// Read a variable length encoded 32 bit unsigned integer
-std::uint32_t
-CodeStream::read_V32()
+namespace {
+
+/// The operands an opcode takes.
+enum Operands
 {
-	char data;
+    /// Not an opcode we can execute.
+    OPERANDS_INVALID,
+    OPERANDS_NONE,
+    OPERANDS_U8,
+    OPERANDS_U30,
+    OPERANDS_U30_U30,
 
-	read(&data,1);
-	std::uint32_t result = data;
-	if (!(result & 0x00000080))	return result;
+    /// A branch offset, relative to the next instruction.
+    OPERANDS_BRANCH,
 
-	read(&data,1);
-	result = (result & 0x0000007F) | data << 7;
-	if (!(result & 0x00004000)) return result;
-	
-	read(&data,1);
-	result = (result & 0x00003FFF) | data << 14;
-	if (!(result & 0x00200000)) return result;
+    /// A default offset, a case count and count + 1 offsets, all
+    /// relative to the lookupswitch instruction.
+    OPERANDS_LOOKUPSWITCH,
 
-	read(&data,1);
-	result = (result & 0x001FFFFF) | data << 21;
-	if (!(result & 0x10000000)) return result;
+    /// u8, u30, u8, u30.
+    OPERANDS_DEBUG
+};
 
-	read(&data,1);
-	return (result & 0x0FFFFFFF) | data << 28;
+Operands
+operands(std::uint8_t opcode)
+{
+    switch (static_cast<SWF::abc_action_type>(opcode)) {
 
-}
+        case SWF::ABC_ACTION_IFNLT:
+        case SWF::ABC_ACTION_IFNLE:
+        case SWF::ABC_ACTION_IFNGT:
+        case SWF::ABC_ACTION_IFNGE:
+        case SWF::ABC_ACTION_JUMP:
+        case SWF::ABC_ACTION_IFTRUE:
+        case SWF::ABC_ACTION_IFFALSE:
+        case SWF::ABC_ACTION_IFEQ:
+        case SWF::ABC_ACTION_IFNE:
+        case SWF::ABC_ACTION_IFLT:
+        case SWF::ABC_ACTION_IFLE:
+        case SWF::ABC_ACTION_IFGT:
+        case SWF::ABC_ACTION_IFGE:
+        case SWF::ABC_ACTION_IFSTRICTEQ:
+        case SWF::ABC_ACTION_IFSTRICTNE:
+            return OPERANDS_BRANCH;
 
-/// Read an opcode for ActionScript 3
-std::uint8_t
-CodeStream::read_as3op()
-{
-	char data;
-	read(&data,1);
-	if(eof()){
-		return 0;
-	}
-	else{
-		return static_cast<std::uint8_t> (data);
-	}
-}
+        case SWF::ABC_ACTION_LOOKUPSWITCH:
+            return OPERANDS_LOOKUPSWITCH;
 
-/// Change the current position by a relative value.
-void
-CodeStream::seekBy(int change)
-{
-	seekg(change,ios_base::cur);
-}
+        case SWF::ABC_ACTION_DEBUG:
+            return OPERANDS_DEBUG;
 
-/// Set the current position to an absolute value (relative to the start)
-void
-CodeStream::seekTo(unsigned int set)
-{
-	seekg(set);
-}
+        case SWF::ABC_ACTION_PUSHBYTE:
+        case SWF::ABC_ACTION_GETSCOPEOBJECT:
+            return OPERANDS_U8;
 
-//TODO: Is there a better way to read a 24 bit signed int?
-std::int32_t
-CodeStream::read_S24()
-{
-	char buffer[3];
-	read(buffer,3);
-	uint32_t result = buffer[0] & 0xFF;
-	result |= buffer[1] & 0xFF << 8;
-	result |= buffer[2] & 0xFF << 16;
-	if (result & (1 << 23)) {
-	       	result |= -1 << 24;
-   	}
-
-	return static_cast<std::int32_t>(result);
+        case SWF::ABC_ACTION_GETSUPER:
+        case SWF::ABC_ACTION_SETSUPER:
+        case SWF::ABC_ACTION_DXNS:
+        case SWF::ABC_ACTION_KILL:
+        case SWF::ABC_ACTION_PUSHSHORT:
+        case SWF::ABC_ACTION_PUSHSTRING:
+        case SWF::ABC_ACTION_PUSHINT:
+        case SWF::ABC_ACTION_PUSHUINT:
+        case SWF::ABC_ACTION_PUSHDOUBLE:
+        case SWF::ABC_ACTION_PUSHNAMESPACE:
+        case SWF::ABC_ACTION_NEWFUNCTION:
+        case SWF::ABC_ACTION_CALL:
+        case SWF::ABC_ACTION_CONSTRUCT:
+        case SWF::ABC_ACTION_CONSTRUCTSUPER:
+        case SWF::ABC_ACTION_0x53: // applytype
+        case SWF::ABC_ACTION_NEWOBJECT:
+        case SWF::ABC_ACTION_NEWARRAY:
+        case SWF::ABC_ACTION_NEWCLASS:
+        case SWF::ABC_ACTION_GETDESCENDANTS:
+        case SWF::ABC_ACTION_NEWCATCH:
+        case SWF::ABC_ACTION_FINDPROPSTRICT:
+        case SWF::ABC_ACTION_FINDPROPERTY:
+        case SWF::ABC_ACTION_FINDDEF:
+        case SWF::ABC_ACTION_GETLEX:
+        case SWF::ABC_ACTION_SETPROPERTY:
+        case SWF::ABC_ACTION_GETLOCAL:
+        case SWF::ABC_ACTION_SETLOCAL:
+        case SWF::ABC_ACTION_GETPROPERTY:
+        case SWF::ABC_ACTION_INITPROPERTY:
+        case SWF::ABC_ACTION_DELETEPROPERTY:
+        case SWF::ABC_ACTION_GETSLOT:
+        case SWF::ABC_ACTION_SETSLOT:
+        case SWF::ABC_ACTION_GETGLOBALSLOT:
+        case SWF::ABC_ACTION_SETGLOBALSLOT:
+        case SWF::ABC_ACTION_COERCE:
+        case SWF::ABC_ACTION_ASTYPE:
+        case SWF::ABC_ACTION_INCLOCAL:
+        case SWF::ABC_ACTION_DECLOCAL:
+        case SWF::ABC_ACTION_ISTYPE:
+        case SWF::ABC_ACTION_INCLOCAL_I:
+        case SWF::ABC_ACTION_DECLOCAL_I:
+        case SWF::ABC_ACTION_DEBUGLINE:
+        case SWF::ABC_ACTION_DEBUGFILE:
+        case SWF::ABC_ACTION_BKPTLINE:
+            return OPERANDS_U30;
+
+        case SWF::ABC_ACTION_HASNEXT2:
+        case SWF::ABC_ACTION_CALLMETHOD:
+        case SWF::ABC_ACTION_CALLSTATIC:
+        case SWF::ABC_ACTION_CALLSUPER:
+        case SWF::ABC_ACTION_CALLPROPERTY:
+        case SWF::ABC_ACTION_CONSTRUCTPROP:
+        case SWF::ABC_ACTION_CALLPROPLEX:
+        case SWF::ABC_ACTION_CALLSUPERVOID:
+        case SWF::ABC_ACTION_CALLPROPVOID:
+            return OPERANDS_U30_U30;
+
+        // Not an opcode, but executing it returns, as the end of the code
+        // does; it is found padding code.
+        case SWF::ABC_ACTION_END:
+        case SWF::ABC_ACTION_BKPT:
+        case SWF::ABC_ACTION_NOP:
+        case SWF::ABC_ACTION_THROW:
+        case SWF::ABC_ACTION_DXNSLATE:
+        case SWF::ABC_ACTION_LABEL:
+        case SWF::ABC_ACTION_PUSHWITH:
+        case SWF::ABC_ACTION_POPSCOPE:
+        case SWF::ABC_ACTION_NEXTNAME:
+        case SWF::ABC_ACTION_HASNEXT:
+        case SWF::ABC_ACTION_PUSHNULL:
+        case SWF::ABC_ACTION_PUSHUNDEFINED:
+        case SWF::ABC_ACTION_NEXTVALUE:
+        case SWF::ABC_ACTION_PUSHTRUE:
+        case SWF::ABC_ACTION_PUSHFALSE:
+        case SWF::ABC_ACTION_PUSHNAN:
+        case SWF::ABC_ACTION_POP:
+        case SWF::ABC_ACTION_DUP:
+        case SWF::ABC_ACTION_SWAP:
+        case SWF::ABC_ACTION_PUSHSCOPE:
+        // Memory access and sign extension, used by Alchemy.
+        case SWF::ABC_ACTION_0x35:
+        case SWF::ABC_ACTION_0x36:
+        case SWF::ABC_ACTION_0x37:
+        case SWF::ABC_ACTION_0x38:
+        case SWF::ABC_ACTION_0x39:
+        case SWF::ABC_ACTION_0x3A:
+        case SWF::ABC_ACTION_0x3B:
+        case SWF::ABC_ACTION_0x3C:
+        case SWF::ABC_ACTION_0x3D:
+        case SWF::ABC_ACTION_0x3E:
+        case SWF::ABC_ACTION_0x50:
+        case SWF::ABC_ACTION_0x51:
+        case SWF::ABC_ACTION_0x52:
+        case SWF::ABC_ACTION_RETURNVOID:
+        case SWF::ABC_ACTION_RETURNVALUE:
+        case SWF::ABC_ACTION_NEWACTIVATION:
+        case SWF::ABC_ACTION_GETGLOBALSCOPE:
+        case SWF::ABC_ACTION_CONVERT_S:
+        case SWF::ABC_ACTION_ESC_XELEM:
+        case SWF::ABC_ACTION_ESC_XATTR:
+        case SWF::ABC_ACTION_CONVERT_I:
+        case SWF::ABC_ACTION_CONVERT_U:
+        case SWF::ABC_ACTION_CONVERT_D:
+        case SWF::ABC_ACTION_CONVERT_B:
+        case SWF::ABC_ACTION_CONVERT_O:
+        case SWF::ABC_ACTION_CHECKFILTER:
+        case SWF::ABC_ACTION_COERCE_B:
+        case SWF::ABC_ACTION_COERCE_A:
+        case SWF::ABC_ACTION_COERCE_I:
+        case SWF::ABC_ACTION_COERCE_D:
+        case SWF::ABC_ACTION_COERCE_S:
+        case SWF::ABC_ACTION_ASTYPELATE:
+        case SWF::ABC_ACTION_COERCE_U:
+        case SWF::ABC_ACTION_COERCE_O:
+        case SWF::ABC_ACTION_NEGATE:
+        case SWF::ABC_ACTION_INCREMENT:
+        case SWF::ABC_ACTION_DECREMENT:
+        case SWF::ABC_ACTION_ABC_TYPEOF:
+        case SWF::ABC_ACTION_NOT:
+        case SWF::ABC_ACTION_BITNOT:
+        case SWF::ABC_ACTION_CONCAT:
+        case SWF::ABC_ACTION_ADD_D:
+        case SWF::ABC_ACTION_ADD:
+        case SWF::ABC_ACTION_SUBTRACT:
+        case SWF::ABC_ACTION_MULTIPLY:
+        case SWF::ABC_ACTION_DIVIDE:
+        case SWF::ABC_ACTION_MODULO:
+        case SWF::ABC_ACTION_LSHIFT:
+        case SWF::ABC_ACTION_RSHIFT:
+        case SWF::ABC_ACTION_URSHIFT:
+        case SWF::ABC_ACTION_BITAND:
+        case SWF::ABC_ACTION_BITOR:
+        case SWF::ABC_ACTION_BITXOR:
+        case SWF::ABC_ACTION_EQUALS:
+        case SWF::ABC_ACTION_STRICTEQUALS:
+        case SWF::ABC_ACTION_LESSTHAN:
+        case SWF::ABC_ACTION_LESSEQUALS:
+        case SWF::ABC_ACTION_GREATERTHAN:
+        case SWF::ABC_ACTION_GREATEREQUALS:
+        case SWF::ABC_ACTION_INSTANCEOF:
+        case SWF::ABC_ACTION_ISTYPELATE:
+        case SWF::ABC_ACTION_IN:
+        case SWF::ABC_ACTION_INCREMENT_I:
+        case SWF::ABC_ACTION_DECREMENT_I:
+        case SWF::ABC_ACTION_NEGATE_I:
+        case SWF::ABC_ACTION_ADD_I:
+        case SWF::ABC_ACTION_SUBTRACT_I:
+        case SWF::ABC_ACTION_MULTIPLY_I:
+        case SWF::ABC_ACTION_GETLOCAL0:
+        case SWF::ABC_ACTION_GETLOCAL1:
+        case SWF::ABC_ACTION_GETLOCAL2:
+        case SWF::ABC_ACTION_GETLOCAL3:
+        case SWF::ABC_ACTION_SETLOCAL0:
+        case SWF::ABC_ACTION_SETLOCAL1:
+        case SWF::ABC_ACTION_SETLOCAL2:
+        case SWF::ABC_ACTION_SETLOCAL3:
+        case SWF::ABC_ACTION_TIMESTAMP:
+            return OPERANDS_NONE;
+
+        default:
+            return OPERANDS_INVALID;
+    }
 }
-	
-/// Read a signed 8-bit character.
-int8_t
-CodeStream::read_s8()
-{
-	char data;
-	read(&data,1);
-	return static_cast<int8_t> (data);
+
 }
 
-/// Read an unsigned 8-bit character.
-std::uint8_t
-CodeStream::read_u8()
+std::uint32_t
+CodeStream::readLongV32(std::uint32_t result)
 {
-	char data;
-	read(&data,1);
-	return static_cast<std::uint8_t> (data);
+    result = (result & 0x7f) | (read_u8() << 7);
+    if (!(result & 0x4000)) return result;
+
+    result = (result & 0x3fff) | (read_u8() << 14);
+    if (!(result & 0x200000)) return result;
+
+    result = (result & 0x1fffff) | (read_u8() << 21);
+    if (!(result & 0x10000000)) return result;
+
+    return (result & 0xfffffff) | (read_u8() << 28);
 }
 
-/// Same as read_V32(), but doesn't bother with the arithmetic for
-/// calculating the value.
-void 
-CodeStream::skip_V32()
+bool
+CodeStream::verify()
 {
-	// shortcut evalution is mandated as standard.
-	//TODO: Make this more efficient.
-// 	if ((*mCurrent++ & 0x80) && (*mCurrent++ & 0x80) && (*mCurrent++ &0x80)
-// 		&& (*mCurrent++ & 0x80) && (*mCurrent++ & 0x80)){
-// 		return;
-// 	}
-	read_V32();
-	return;
+    const std::size_t length = size();
+
+    // Where instructions start, and where branches go.
+    std::vector<bool> starts(length + 1);
+    std::vector<std::size_t> targets;
+
+    // Whether n more bytes can be read.
+    const auto fits = [this](std::size_t n) {
+        return static_cast<std::size_t>(_end - _pos) >= n;
+    };
+
+    // Whether a V32 can be read.
+    const auto fitsV32 = [this]() {
+        for (const std::uint8_t* p = _pos; p != _end && p - _pos < 5; ++p) {
+            if (!(*p & 0x80)) return true;
+        }
+        return _end - _pos >= 5;
+    };
+
+    // Skip the operands of an opcode, noting where it may branch to.
+    const auto skipOperands = [&](std::uint8_t opcode, std::size_t start) {
+        switch (operands(opcode)) {
+
+            case OPERANDS_INVALID:
+                return false;
+
+            case OPERANDS_NONE:
+                return true;
 
+            case OPERANDS_U8:
+                if (!fits(1)) return false;
+                read_u8();
+                return true;
+
+            case OPERANDS_U30:
+                if (!fitsV32()) return false;
+                skip_V32();
+                return true;
+
+            case OPERANDS_U30_U30:
+                if (!fitsV32()) return false;
+                skip_V32();
+                if (!fitsV32()) return false;
+                skip_V32();
+                return true;
+
+            case OPERANDS_BRANCH:
+            {
+                if (!fits(3)) return false;
+                const std::int32_t offset = read_S24();
+                targets.push_back(tell() + offset);
+                return true;
+            }
+
+            case OPERANDS_LOOKUPSWITCH:
+            {
+                if (!fits(3)) return false;
+                targets.push_back(start + read_S24());
+                if (!fitsV32()) return false;
+                const std::uint32_t cases = read_V32();
+                if (cases >= length || !fits((cases + 1) * 3)) return false;
+                for (std::uint32_t i = 0; i <= cases; ++i) {
+                    targets.push_back(start + read_S24());
+                }
+                return true;
+            }
+
+            case OPERANDS_DEBUG:
+                if (!fits(1)) return false;
+                read_u8();
+                if (!fitsV32()) return false;
+                skip_V32();
+                if (!fits(1)) return false;
+                read_u8();
+                if (!fitsV32()) return false;
+                skip_V32();
+                return true;
+        }
+        return false;
+    };
+
+    _pos = _begin;
+    while (_pos != _end) {
+        const std::size_t start = tell();
+        starts[start] = true;
+
+        const std::uint8_t opcode = read_u8();
+        if (!skipOperands(opcode, start)) {
+            log_error(_("ABC: invalid opcode 0x%x or truncated operands "
+                        "at offset %d"), +opcode, start);
+            seekTo(0);
+            return false;
+        }
+    }
+
+    // Falling off the end of the code is a return, so a branch may
+    // go there too. Negative offsets wrap round to large targets.
+    starts[length] = true;
+    for (std::size_t target : targets) {
+        if (target > length || !starts[target]) {
+            log_error(_("ABC: branch to offset %d, which does not start "
+                        "an instruction"), target);
+            seekTo(0);
+            return false;
+        }
+    }
+
+    seekTo(0);
+    return true;
 }
 
 } // namespace gnash
-
@@ -2,17 +2,17 @@
 //
 //   Copyright (C) 2007, 2008, 2009, 2010, 2011, 2012
 //   Free Software Foundation, Inc.
-// 
+//
 // This program is free software; you can redistribute it and/or modify
 // it under the terms of the GNU General Public License as published by
 // the Free Software Foundation; either version 3 of the License, or
 // (at your option) any later version.
-// 
+//
 // This program is distributed in the hope that it will be useful,
 // but WITHOUT ANY WARRANTY; without even the implied warranty of
 // MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
 // GNU General Public License for more details.
-// 
+//
 // You should have received a copy of the GNU General Public License
 // along with this program; if not, write to the Free Software
 // Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
@@ -20,56 +20,125 @@
 #ifndef GNASH_CODESTREAM_H
 #define GNASH_CODESTREAM_H
 
-#include <string>
-#include <boost/utility.hpp>
+#include <boost/noncopyable.hpp>
 #include <cstdint>
-#include <istream>
-#include <sstream>
+#include <cstddef>
+#include <cassert>
 
 namespace gnash {
 
-/// The exception which will be thrown by the CodeStream for access
-/// violations.
 class CodeStreamException { };
 
-/// A checked read DisplayObject array
-///
-/// CodeStream provides a safe interface to read various things from a
-/// DisplayObject array of known size.  Any attempt to access memory outside
-/// of the given array will throw an exception of type CodeStreamException
-class CodeStream : public std::istream, private boost::noncopyable
+/// Reads the bytecode of an AVM2 method body
+//
+/// A CodeStream reads from memory it does not own, normally the code
+/// of a Method, which must outlive it. Reading is a pointer increment.
+//
+/// Only opcodes are checked against the end of the code; operands are
+/// not, so code must pass verify() before it is executed.
+class CodeStream : private boost::noncopyable
 {
 public:
-	CodeStream(std::string data): std::istream(new std::stringbuf(data)){
-		
-	}
 
-/// Read a variable length encoded 32 bit unsigned integer
-std::uint32_t read_V32();
+    /// Read the bytes from begin to end.
+    CodeStream(const std::uint8_t* begin, const std::uint8_t* end)
+        :
+        _begin(begin),
+        _end(end),
+        _pos(begin)
+    {
+        assert(begin <= end);
+    }
+
+    /// Read an opcode.
+    //
+    /// @return     The opcode, or 0 (SWF::ABC_ACTION_END) at the end of
+    ///             the code.
+    std::uint8_t read_as3op() {
+        if (_pos >= _end) return 0;
+        return *_pos++;
+    }
+
+    /// Read a variable-length encoded unsigned 32-bit integer.
+    std::uint32_t read_V32() {
+        std::uint32_t result = read_u8();
+        if (!(result & 0x80)) return result;
+        return readLongV32(result);
+    }
+
+    /// Skip a variable-length encoded integer.
+    void skip_V32() {
+        for (int i = 0; i < 5 && (read_u8() & 0x80); ++i);
+    }
+
+    /// Read a signed 24-bit integer, as used for branch offsets.
+    std::int32_t read_S24() {
+        assert(_end - _pos >= 3);
+        std::uint32_t result = _pos[0] | (_pos[1] << 8) | (_pos[2] << 16);
+        _pos += 3;
+        if (result & 0x800000) result |= 0xff000000;
+        return static_cast<std::int32_t>(result);
+    }
+
+    std::int8_t read_s8() {
+        return static_cast<std::int8_t>(read_u8());
+    }
+
+    std::uint8_t read_u8() {
+        assert(_pos < _end);
+        return *_pos++;
+    }
+
+    /// Move the read position by a number of bytes.
+    void seekBy(int change) {
+        _pos += change;
+        assert(_pos >= _begin && _pos <= _end);
+    }
+
+    /// Move the read position to an offset from the start of the code.
+    void seekTo(std::size_t offset) {
+        assert(offset <= size());
+        _pos = _begin + offset;
+    }
 
-/// Read an opcode for ActionScript 3
-std::uint8_t read_as3op();
+    /// The read position, as an offset from the start of the code.
+    std::size_t tell() const {
+        return _pos - _begin;
+    }
 
-/// Change the current position by a relative value.
-void seekBy(int change);
+    /// The address of the read position.
+    //
+    /// This identifies an instruction for as long as its code exists.
+    const std::uint8_t* position() const {
+        return _pos;
+    }
 
-/// Set the current position to an absolute value (relative to the start)
-void seekTo(unsigned int set);
+    /// The size of the code, in bytes.
+    std::size_t size() const {
+        return _end - _begin;
+    }
 
-///Read a signed 24 bit interger.
-std::int32_t read_S24();
+    /// Check that the code can be executed without reading past its end
+    //
+    /// The code is decoded once: every opcode must be known, every operand
+    /// must lie within the code and every branch, including those of
+    /// lookupswitch, must land on an instruction or at the end of the
+    /// code.
+    //
+    /// @return     false if the code is invalid. The read position is
+    ///             left at the start of the code.
+    bool verify();
 
-/// Read a signed 8-bit character.
-int8_t read_s8();
+private:
 
-/// Read an unsigned 8-bit character.
-std::uint8_t read_u8();
+    /// Read the remaining bytes of a V32 whose first byte is given.
+    std::uint32_t readLongV32(std::uint32_t result);
 
-/// Same as read_V32(), but doesn't bother with the arithmetic for
-/// calculating the value.
-void skip_V32();
+    const std::uint8_t* _begin;
+    const std::uint8_t* _end;
+    const std::uint8_t* _pos;
 
 };
 
 } // namespace gnash
-#endif 
+#endif
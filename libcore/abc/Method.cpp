@@ -27,6 +27,7 @@
 #include "Global_as.h"
 #include "VM.h"
 #include "namedStrings.h"
+#include "log.h"
 
 #include <functional>
 
@@ -43,7 +44,7 @@ Method::Method()
     _isNative(false),
     _implementation(0),
     _flags(0),
-    _body(0),
+    _hasBody(false),
     _maxRegisters(0),
     _scopeDepth(0),
     _maxScope(0),
@@ -55,19 +56,34 @@ Method::Method()
 void
 Method::print_body()
 {
-		if (!_body) {
+		if (!_hasBody) {
 			log_parse("Method has no body.");
 			return;
 		}
 		std::stringstream ss("Method Body:");
-		for(std::uint32_t i = 0; i < _bodyLength ; ++i) {
-			const std::uint8_t opcode = _body->read_as3op();
+		for (std::uint8_t opcode : _code) {
 			ss << "0x" << std::uppercase << std::hex << (opcode | 0x0) << " ";
 		}
-		_body->seekTo(0);
 		log_parse("%s", ss.str());
 }
 
+CodeStream*
+Method::getBody()
+{
+    if (_body || !_hasBody) return _body.get();
+
+    _body.reset(new CodeStream(_code.data(), _code.data() + _code.size()));
+
+    // Check it once, so that executing it needs no checks.
+    if (!_body->verify()) {
+        log_error(_("ABC: Invalid code in method %u; not executing it."),
+                _methodID);
+        _code.clear();
+        _body.reset(new CodeStream(_code.data(), _code.data()));
+    }
+    return _body.get();
+}
+
 void
 Method::setOwner(Class *pOwner)
 {
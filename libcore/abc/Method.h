@@ -29,6 +29,10 @@
 #include <map>
 #include <vector>
 #include <list>
+#include <memory>
+#include <cstdint>
+
+#include "CodeStream.h"
 
 // Forward declarations
 namespace gnash {
@@ -38,7 +42,6 @@ namespace gnash {
         class Namespace;
         class Class;
     }
-    class CodeStream;
     class as_object;
 }
 
@@ -118,7 +121,7 @@ public:
 	asBinding* getBinding(string_table::key name);
 
 	bool isNative() { return _isNative; }
-	bool hasBody() const { return _body != NULL; }
+	bool hasBody() const { return _hasBody; }
 
 	as_object* construct(as_object* /*base_scope*/) {
         // TODO:
@@ -133,8 +136,19 @@ public:
         _needsActivation = true;
     }
 
-	CodeStream *getBody() { return _body; }
-	void setBody(CodeStream *b) { _body = b; }
+    /// Get the code of the method body, ready for execution.
+    //
+    /// Most methods in a large ABC block are never called, so the code
+    /// is only verified the first time it is needed. Code that fails
+    /// verification is replaced by an empty body.
+	CodeStream *getBody();
+
+    /// Take the bytecode of the method body.
+	void setBody(std::vector<std::uint8_t> code) {
+        _code = std::move(code);
+        _body.reset();
+        _hasBody = true;
+    }
 
 	bool addValue(string_table::key name, Namespace *ns,
             std::uint32_t slotID, Class *type, as_value& val, bool isconst);
@@ -286,7 +300,9 @@ private:
 	std::list<as_value> _optionalArguments;
 	as_function* _implementation;
 	unsigned char _flags;
-	CodeStream* _body;
+	std::vector<std::uint8_t> _code;
+	std::unique_ptr<CodeStream> _body;
+	bool _hasBody;
 	std::uint32_t _maxRegisters;
 
     std::uint32_t _scopeDepth;
@@ -53,6 +53,9 @@ public:
 
     virtual const std::string& stringValue() const;
 
+    /// The static definition of this Class.
+    Class* getClass() const { return _class; }
+
 private:
 
     Class* _class;
@@ -45,53 +45,75 @@
 namespace gnash {
 
 namespace {
-    /// Find a variable in the given as_object
+    /// Find a local variable of the given CallFrame
     //
-    /// @param varname
+    /// @param name
     /// Name of the local variable
     ///
     /// @param ret
     /// If a variable is found it's assigned to this parameter.
     /// Untouched if the variable is not found.
     ///
+    /// @param retTarget
+    /// If not NULL, set to the activation object if the variable is found.
+    ///
     /// @return true if the variable was found, false otherwise
-    bool getLocal(as_object& locals, const std::string& name, as_value& ret);
-
-    bool findLocal(as_object& locals, const std::string& varname, as_value& ret,
+    bool findLocal(CallFrame& frame, const ObjectURI& name, as_value& ret,
             as_object** retTarget);
 
     /// Delete a local variable
     //
-    /// @param varname
+    /// @param name
     /// Name of the local variable
     ///
     /// @return true if the variable was found and deleted, false otherwise
-    bool deleteLocal(as_object& locals, const std::string& varname);
+    bool deleteLocal(CallFrame& frame, const ObjectURI& name);
 
-    /// Set a variable of the given object, if it exists.
+    /// Set a local variable of the given CallFrame, if it exists.
     //
-    /// @param varname
+    /// @param name
     /// Name of the local variable
     ///
     /// @param val
     /// Value to assign to the variable
     ///
     /// @return true if the variable was found, false otherwise
-    bool setLocal(as_object& locals, const std::string& varname,
+    bool setExistingLocal(CallFrame& frame, const ObjectURI& name,
         const as_value& val);
 
+    /// Return the current CallFrame if it keeps local variables in slots.
+    //
+    /// Its activation object, when found in a scope stack, must then be
+    /// searched with the local functions above rather than as an object.
+    CallFrame* slotsFrame(VM& vm);
+
     as_object* getElement(as_object* obj, const ObjectURI& uri);
 
+    /// @param shared
+    /// The shared string of varname, if any, to look up its key from.
     /// @param retTarget
     /// If not NULL, the pointer will be set to the actual object containing the
     /// found variable (if found).
     as_value getVariableRaw(const as_environment& env,
-        const std::string& varname,
+        const std::string& varname, const as_string* shared,
         const as_environment::ScopeStack& scope,
         as_object** retTarget = nullptr);
 
     void setVariableRaw(const as_environment& env, const std::string& varname,
-        const as_value& val, const as_environment::ScopeStack& scope);
+        const as_string* shared, const as_value& val,
+        const as_environment::ScopeStack& scope);
+
+    as_value getVariable(const as_environment& env,
+        const std::string& varname, const as_string* shared,
+        const as_environment::ScopeStack& scope, as_object** retTarget);
+
+    void setVariable(const as_environment& env, const std::string& varname,
+        const as_string* shared, const as_value& val,
+        const as_environment::ScopeStack& scope);
+
+    /// Get the key of a raw variable name, from its shared string if any.
+    ObjectURI getVariableURI(VM& vm, const std::string& varname,
+            const as_string* shared);
 
     // Search for next '.' or '/' character in this word.  Return
     // a pointer to it, or null if it wasn't found.
@@ -219,9 +241,18 @@ findObject(const as_environment& ctx, const std::string& path,
             do {
                 // Try scope stack
                 if (scope) {
+                    CallFrame* frame = slotsFrame(vm);
                     for (size_t i = scope->size(); i > 0; --i) {
                         as_object* obj = (*scope)[i-1];
-                        
+
+                        as_value val;
+                        if (frame && obj == &frame->locals() &&
+                                findLocal(*frame, subpartURI, val, nullptr)) {
+                            if (!val.is_object()) continue;
+                            element = toObject(val, vm);
+                            break;
+                        }
+
                         element = getElement(obj, subpartURI);
                         if (element) break;
                     }
@@ -289,68 +320,28 @@ as_value
 getVariable(const as_environment& env, const std::string& varname,
         const as_environment::ScopeStack& scope, as_object** retTarget)
 {
-    // Path lookup rigamarole.
-    std::string path;
-    std::string var;
-
-    if (parsePath(varname, path, var)) {
-        // TODO: let find_target return generic as_objects, or use 'with' stack,
-        //       see player2.swf or bug #18758 (strip.swf)
-        as_object* target = findObject(env, path, &scope); 
-
-        if (target) {
-            as_value val;
-            target->get_member(getURI(env.getVM(), var), &val);
-            if (retTarget) *retTarget = target;
-            return val;
-        }
-        else {
-            return as_value();
-        }
-    }
-
-    if (varname.find('/') != std::string::npos &&
-            varname.find(':') == std::string::npos) {
+    return getVariable(env, varname, nullptr, scope, retTarget);
+}
 
-        // Consider it all a path ...
-        as_object* target = findObject(env, varname, &scope); 
-        if (target) {
-            // ... but only if it resolves to a sprite
-            DisplayObject* d = target->displayObject();
-            MovieClip* m = d ? d->to_movie() : nullptr;
-            if (m) return as_value(getObject(m));
-        }
-    }
-    return getVariableRaw(env, varname, scope, retTarget);
+as_value
+getVariable(const as_environment& env, const as_string& varname,
+        const as_environment::ScopeStack& scope, as_object** retTarget)
+{
+    return getVariable(env, varname.str(), &varname, scope, retTarget);
 }
 
 void
 setVariable(const as_environment& env, const std::string& varname,
     const as_value& val, const as_environment::ScopeStack& scope)
 {
-    IF_VERBOSE_ACTION(
-        log_action(_("-------------- %s = %s"), varname, val);
-    );
-
-    // Path lookup rigamarole.
-    std::string path;
-    std::string var;
-
-    if (parsePath(varname, path, var)) {
-        as_object* target = findObject(env, path, &scope); 
-        if (target) {
-            target->set_member(getURI(env.getVM(), var), val);
-        }
-        else {
-            IF_VERBOSE_ASCODING_ERRORS(
-            log_aserror(_("Path target '%s' not found while setting %s=%s"),
-                path, varname, val);
-            );
-        }
-        return;
-    }
+    setVariable(env, varname, nullptr, val, scope);
+}
 
-    setVariableRaw(env, varname, val, scope);
+void
+setVariable(const as_environment& env, const as_string& varname,
+    const as_value& val, const as_environment::ScopeStack& scope)
+{
+    setVariable(env, varname.str(), &varname, val, scope);
 }
 
 bool
@@ -365,9 +356,14 @@ delVariable(const as_environment& ctx, const std::string& varname,
     const ObjectURI& varkey = getURI(vm, varname);
 
     // Check the with-stack.
+    CallFrame* frame = slotsFrame(vm);
     for (size_t i = scope.size(); i > 0; --i) {
         as_object* obj = scope[i - 1];
 
+        if (frame && obj == &frame->locals() && deleteLocal(*frame, varkey)) {
+            return true;
+        }
+
         if (obj) {
             std::pair<bool, bool> ret = obj->delProperty(varkey);
             if (ret.first) {
@@ -377,7 +373,7 @@ delVariable(const as_environment& ctx, const std::string& varname,
     }
 
     // Check locals for deletion.
-    if (vm.calling() && deleteLocal(vm.currentCall().locals(), varname)) {
+    if (vm.calling() && deleteLocal(vm.currentCall(), varkey)) {
         return true;
     }
 
@@ -434,10 +430,87 @@ validRawVariableName(const std::string& varname)
     return (varname.find(":::") == std::string::npos);
 }
 
+ObjectURI
+getVariableURI(VM& vm, const std::string& varname, const as_string* shared)
+{
+    return shared ? getURI(vm, *shared) : getURI(vm, varname);
+}
+
+as_value
+getVariable(const as_environment& env, const std::string& varname,
+        const as_string* shared, const as_environment::ScopeStack& scope,
+        as_object** retTarget)
+{
+    // Path lookup rigamarole.
+    std::string path;
+    std::string var;
+
+    if (parsePath(varname, path, var)) {
+        // TODO: let find_target return generic as_objects, or use 'with' stack,
+        //       see player2.swf or bug #18758 (strip.swf)
+        as_object* target = findObject(env, path, &scope); 
+
+        if (target) {
+            as_value val;
+            target->get_member(getURI(env.getVM(), var), &val);
+            if (retTarget) *retTarget = target;
+            return val;
+        }
+        else {
+            return as_value();
+        }
+    }
+
+    if (varname.find('/') != std::string::npos &&
+            varname.find(':') == std::string::npos) {
+
+        // Consider it all a path ...
+        as_object* target = findObject(env, varname, &scope); 
+        if (target) {
+            // ... but only if it resolves to a sprite
+            DisplayObject* d = target->displayObject();
+            MovieClip* m = d ? d->to_movie() : nullptr;
+            if (m) return as_value(getObject(m));
+        }
+    }
+    return getVariableRaw(env, varname, shared, scope, retTarget);
+}
+
+void
+setVariable(const as_environment& env, const std::string& varname,
+    const as_string* shared, const as_value& val,
+    const as_environment::ScopeStack& scope)
+{
+    IF_VERBOSE_ACTION(
+        log_action(_("-------------- %s = %s"), varname, val);
+    );
+
+    // Path lookup rigamarole.
+    std::string path;
+    std::string var;
+
+    if (parsePath(varname, path, var)) {
+        as_object* target = findObject(env, path, &scope); 
+        if (target) {
+            target->set_member(getURI(env.getVM(), var), val);
+        }
+        else {
+            IF_VERBOSE_ASCODING_ERRORS(
+            log_aserror(_("Path target '%s' not found while setting %s=%s"),
+                path, varname, val);
+            );
+        }
+        return;
+    }
+
+    setVariableRaw(env, varname, shared, val, scope);
+}
+
 // No path rigamarole.
 void
 setVariableRaw(const as_environment& env, const std::string& varname,
-    const as_value& val, const as_environment::ScopeStack& scope)
+    const as_string* shared, const as_value& val,
+    const as_environment::ScopeStack& scope)
 {
 
     if (!validRawVariableName(varname)) {
@@ -448,13 +521,21 @@ setVariableRaw(const as_environment& env, const std::string& varname,
     }
 
     VM& vm = env.getVM();
-    const ObjectURI& varkey = getURI(vm, varname);
+    const ObjectURI varkey = getVariableURI(vm, varname, shared);
 
     // in SWF5 and lower, scope stack should just contain 'with' elements 
 
     // Check the scope stack.
+    CallFrame* frame = slotsFrame(vm);
     for (size_t i = scope.size(); i > 0; --i) {
         as_object* obj = scope[i - 1];
+        if (frame && obj == &frame->locals()) {
+            const int slot = findSlot(*frame, varkey);
+            if (slot >= 0 && frame->getSlot(slot)) {
+                frame->setSlot(slot, val);
+                return;
+            }
+        }
         if (obj && obj->set_member(varkey, val, true)) {
             return;
         }
@@ -462,7 +543,7 @@ setVariableRaw(const as_environment& env, const std::string& varname,
     
     const int swfVersion = vm.getSWFVersion();
     if (swfVersion < 6 && vm.calling()) {
-       if (setLocal(vm.currentCall().locals(), varname, val)) return;
+       if (setExistingLocal(vm.currentCall(), varkey, val)) return;
     }
     
     // TODO: shouldn't _target be in the scope chain ?
@@ -478,7 +559,8 @@ setVariableRaw(const as_environment& env, const std::string& varname,
 
 as_value
 getVariableRaw(const as_environment& env, const std::string& varname,
-    const as_environment::ScopeStack& scope, as_object** retTarget)
+    const as_string* shared, const as_environment::ScopeStack& scope,
+    as_object** retTarget)
 {
 
     if (!validRawVariableName(varname)) {
@@ -492,12 +574,17 @@ getVariableRaw(const as_environment& env, const std::string& varname,
 
     VM& vm = env.getVM();
     const int swfVersion = vm.getSWFVersion();
-    const ObjectURI& key = getURI(vm, varname);
+    const ObjectURI key = getVariableURI(vm, varname, shared);
 
     // Check the scope stack.
+    CallFrame* frame = slotsFrame(vm);
     for (size_t i = scope.size(); i > 0; --i) {
 
         as_object* obj = scope[i - 1];
+        if (frame && obj == &frame->locals()) {
+            if (findLocal(*frame, key, val, retTarget)) return val;
+            continue;
+        }
         if (obj && obj->get_member(key, &val)) {
             if (retTarget) *retTarget = obj;
             return val;
@@ -507,7 +594,7 @@ getVariableRaw(const as_environment& env, const std::string& varname,
     // Check locals for getting them
     // for SWF6 and up locals should be in the scope stack
     if (swfVersion < 6 && vm.calling()) {
-       if (findLocal(vm.currentCall().locals(), varname, val, retTarget)) {
+       if (findLocal(vm.currentCall(), key, val, retTarget)) {
            return val;
        }
     }
@@ -571,39 +658,57 @@ getVariableRaw(const as_environment& env, const std::string& varname,
 }
 
 bool
-getLocal(as_object& locals, const std::string& name, as_value& ret)
-{
-    return locals.get_member(getURI(getVM(locals), name), &ret);
-}
-
-bool
-findLocal(as_object& locals, const std::string& varname, as_value& ret,
+findLocal(CallFrame& frame, const ObjectURI& name, as_value& ret,
         as_object** retTarget) 
 {
+    as_object& locals = frame.locals();
 
-    if (getLocal(locals, varname, ret)) {
-        if (retTarget) *retTarget = &locals;
-        return true;
-    }
+    const int slot = findSlot(frame, name);
+    const as_value* val = slot >= 0 ? frame.getSlot(slot) : nullptr;
 
-    return false;
+    if (val) ret = *val;
+    else if (!locals.get_member(name, &ret)) return false;
+
+    if (retTarget) {
+        // The activation object is about to be seen as an object.
+        frame.spillSlots();
+        *retTarget = &locals;
+    }
+    return true;
 }
 
 bool
-deleteLocal(as_object& locals, const std::string& varname)
+deleteLocal(CallFrame& frame, const ObjectURI& name)
 {
-    return locals.delProperty(getURI(getVM(locals), varname)).second;
+    const int slot = findSlot(frame, name);
+    if (slot >= 0 && frame.deleteSlot(slot)) return true;
+    return frame.locals().delProperty(name).second;
 }
 
 bool
-setLocal(as_object& locals, const std::string& varname, const as_value& val)
+setExistingLocal(CallFrame& frame, const ObjectURI& name, const as_value& val)
 {
-    Property* prop = locals.getOwnProperty(getURI(getVM(locals), varname));
+    const int slot = findSlot(frame, name);
+    if (slot >= 0 && frame.getSlot(slot)) {
+        frame.setSlot(slot, val);
+        return true;
+    }
+
+    as_object& locals = frame.locals();
+    Property* prop = locals.getOwnProperty(name);
     if (!prop) return false;
     prop->setValue(locals, val);
     return true;
 }
 
+CallFrame*
+slotsFrame(VM& vm)
+{
+    if (!vm.calling()) return nullptr;
+    CallFrame& frame = vm.currentCall();
+    return frame.localVariables() ? &frame : nullptr;
+}
+
 as_object*
 getElement(as_object* obj, const ObjectURI& uri)
 {
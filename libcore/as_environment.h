@@ -153,6 +153,13 @@ private:
 as_value getVariable(const as_environment& ctx, const std::string& varname,
     const as_environment::ScopeStack& scope, as_object** retTarget = nullptr);
 
+/// Return the (possibly undefined) value of the named var.
+//
+/// This is the same as above, except that a path-less name is looked up
+/// by the string_table key cached in the shared string.
+as_value getVariable(const as_environment& ctx, const as_string& varname,
+    const as_environment::ScopeStack& scope, as_object** retTarget = nullptr);
+
 /// Given a path to variable, set its value.
 //
 /// If no variable with that name is found, a new one is created.
@@ -167,6 +174,13 @@ as_value getVariable(const as_environment& ctx, const std::string& varname,
 void setVariable(const as_environment& ctx, const std::string& path,
     const as_value& val, const as_environment::ScopeStack& scope);
 
+/// Given a path to variable, set its value.
+//
+/// This is the same as above, except that a path-less name is looked up
+/// by the string_table key cached in the shared string.
+void setVariable(const as_environment& ctx, const as_string& path,
+    const as_value& val, const as_environment::ScopeStack& scope);
+
 /// Delete a variable, without support for the path, using a ScopeStack.
 //
 /// @param ctx      Timeline context to use for variable finding.
@@ -40,6 +40,7 @@
 #include "GnashAlgorithm.h"
 #include "DisplayObject.h"
 #include "namedStrings.h"
+#include "PropertyCache.h"
 
 namespace gnash {
 template<typename T>
@@ -272,6 +273,16 @@ private:
     SortedPropertyList& _to;
 };
 
+/// Whether a property of an object is its onEnterFrame handler.
+//
+/// Up to SWF6 the name is matched regardless of case, like any lookup.
+bool
+isEnterFrame(const as_object& o, const ObjectURI& uri)
+{
+    const ObjectURI::CaseEquals eq(getStringTable(o), getSWFVersion(o) < 7);
+    return eq(uri, NSV::PROP_ON_ENTER_FRAME);
+}
+
 } // anonymous namespace
 
 
@@ -312,7 +323,11 @@ as_object::stringValue() const
 std::pair<bool,bool>
 as_object::delProperty(const ObjectURI& uri)
 {
-    return _members.delProperty(uri);
+    const std::pair<bool, bool> ret = _members.delProperty(uri);
+    if (ret.second && isEnterFrame(*this, uri)) {
+        getRoot(*this).setEnterFrameHandler(*this, false);
+    }
+    return ret;
 }
 
 
@@ -322,6 +337,10 @@ as_object::add_property(const std::string& name, as_function& getter,
 {
     const ObjectURI& uri = getURI(vm(), name);
 
+    if (isEnterFrame(*this, uri)) {
+        getRoot(*this).setEnterFrameHandler(*this, true);
+    }
+
     Property* prop = _members.getProperty(uri);
 
     if (prop) {
@@ -379,6 +398,12 @@ as_object::get_member(const ObjectURI& uri, as_value* val)
 {
     assert(val);
 
+    // Densely stored array elements are visible simple values.
+    if (const as_value* e = _members.element(uri)) {
+        *val = *e;
+        return true;
+    }
+
     const int version = getSWFVersion(*this);
 
     PrototypeRecursor<IsVisible> pr(this, uri, IsVisible(version));
@@ -440,6 +465,26 @@ as_object::get_member(const ObjectURI& uri, as_value* val)
     }
 }
 
+bool
+as_object::getCachedMember(const ObjectURI& uri, as_value* val,
+        PropertyCache& cache)
+{
+    assert(val);
+
+    Property* prop = cache.findMember(*this, uri, getSWFVersion(*this));
+    if (!prop) return get_member(uri, val);
+
+    try {
+        *val = prop->getValue(*this);
+        return true;
+    }
+    catch (const ActionTypeError& exc) {
+        IF_VERBOSE_ASCODING_ERRORS(
+            log_aserror(_("Caught exception: %s"), exc.what());
+            );
+        return false;
+    }
+}
 
 as_object*
 as_object::get_super(const ObjectURI& fname)
@@ -594,6 +639,17 @@ as_object::set_member(const ObjectURI& uri, const as_value& val, bool ifFound)
     // call this function again if the key is a valid index.
     if (array()) checkArrayLength(*this, uri, val);
 
+    // Clips only look for an onEnterFrame handler if they may have one.
+    if (isEnterFrame(*this, uri)) {
+        getRoot(*this).setEnterFrameHandler(*this, true);
+    }
+
+    // Densely stored elements have no flags and no triggers.
+    if (as_value* e = _members.element(uri)) {
+        *e = val;
+        return true;
+    }
+
     PrototypeRecursor<Exists> pr(this, uri);
 
     Property* prop = pr.getProperty();
@@ -620,25 +676,7 @@ as_object::set_member(const ObjectURI& uri, const as_value& val, bool ifFound)
     }
         
     if (prop) {
-        if (readOnly(*prop)) {
-            IF_VERBOSE_ASCODING_ERRORS(
-                ObjectURI::Logger l(getStringTable(*this));
-                log_aserror(_("Attempt to set read-only property '%s'"),
-                            l(uri));
-                );
-            return true;
-        }
-            
-        try {
-            executeTriggers(prop, uri, val);
-        }
-        catch (const ActionTypeError& exc) {
-            IF_VERBOSE_ASCODING_ERRORS(
-                log_aserror(
-                _("%s: %s"), getStringTable(*this).value(getName(uri)), exc.what());
-            );
-        }
-            
+        updateMember(*prop, uri, val);
         return true;
     }
         
@@ -664,6 +702,40 @@ as_object::set_member(const ObjectURI& uri, const as_value& val, bool ifFound)
     return false;
 }
 
+bool
+as_object::setCachedMember(const ObjectURI& uri, const as_value& val,
+        PropertyCache& cache)
+{
+    Property* prop = cache.findOwnMember(*this, uri, getSWFVersion(*this));
+    if (!prop) return set_member(uri, val);
+
+    updateMember(*prop, uri, val);
+    return true;
+}
+
+void
+as_object::updateMember(Property& prop, const ObjectURI& uri,
+        const as_value& val)
+{
+    if (readOnly(prop)) {
+        IF_VERBOSE_ASCODING_ERRORS(
+            ObjectURI::Logger l(getStringTable(*this));
+            log_aserror(_("Attempt to set read-only property '%s'"),
+                        l(uri));
+            );
+        return;
+    }
+
+    try {
+        executeTriggers(&prop, uri, val);
+    }
+    catch (const ActionTypeError& exc) {
+        IF_VERBOSE_ASCODING_ERRORS(
+            log_aserror(
+            _("%s: %s"), getStringTable(*this).value(getName(uri)), exc.what());
+        );
+    }
+}
 
 void
 as_object::init_member(const std::string& key1, const as_value& val, int flags)
@@ -975,6 +1047,9 @@ as_object::watch(const ObjectURI& uri, as_function& trig,
 	
     std::string propname = getStringTable(*this).value(getName(uri));
 
+    // Setting densely stored elements does not look for triggers.
+    _members.makeSparse();
+
     if (!_trigs.get()) _trigs.reset(new TriggerContainer);
 
     TriggerContainer::iterator it = _trigs->find(uri);
@@ -50,6 +50,7 @@ namespace gnash {
     class Global_as;
     class as_value;
     class string_table;
+    class PropertyCache;
 }
 
 namespace gnash {
@@ -228,6 +229,18 @@ public:
     virtual bool set_member(const ObjectURI& uri, const as_value& val,
         bool ifFound = false);
 
+    /// Set a member, remembering the lookup in an inline cache.
+    //
+    /// This behaves like set_member(), but finding an existing member of
+    /// this object with the same cache is not repeated. See PropertyCache.
+    //
+    /// @param uri      Property identifier.
+    /// @param val      Value to assign to the named property.
+    /// @param cache    The cache of the calling action.
+    /// @return         See set_member().
+    bool setCachedMember(const ObjectURI& uri, const as_value& val,
+            PropertyCache& cache);
+
     /// Initialize a member value by string
     //
     /// This is just a wrapper around the other init_member method
@@ -426,6 +439,18 @@ public:
     /// @return         true if the named property was found, false otherwise.
     virtual bool get_member(const ObjectURI& uri, as_value* val);
 
+    /// Get a member, remembering the lookup in an inline cache.
+    //
+    /// This behaves like get_member(), but a lookup already made with the
+    /// same cache is not repeated. See PropertyCache.
+    //
+    /// @param uri      Property identifier.
+    /// @param val      Variable to assign an existing value to.
+    /// @param cache    The cache of the calling action.
+    /// @return         true if the named property was found, false otherwise.
+    bool getCachedMember(const ObjectURI& uri, as_value* val,
+            PropertyCache& cache);
+
     /// Get the super object of this object.
     ///
     /// The super should be __proto__ if this is a prototype object
@@ -627,8 +652,29 @@ public:
     }
 
     /// Set whether this object should be treated as an array.
+    //
+    /// This also makes the object store its elements densely where it
+    /// can (see PropertyList::setDense()).
     void setArray(bool array = true) {
         _array = array;
+        if (array) _members.setDense();
+    }
+
+    /// Return the densely stored elements of an array, or 0.
+    //
+    /// While an array's elements are created in order and are simple
+    /// values, they are kept in a vector, which Array functions can work
+    /// on directly. The vector's contents may be changed; anything else
+    /// that changes this object may invalidate it.
+    std::vector<as_value>* denseElements() {
+        return _members.elements();
+    }
+
+    /// Return a densely stored element, or 0.
+    //
+    /// @param uri      The element's name.
+    const as_value* denseElement(const ObjectURI& uri) const {
+        return _members.element(uri);
     }
 
     /// Return the DisplayObject associated with this object.
@@ -685,6 +731,13 @@ private:
     void executeTriggers(Property* prop, const ObjectURI& uri,
             const as_value& val);
 
+    /// Set the value of a member found by set_member().
+    void updateMember(Property& prop, const ObjectURI& uri,
+            const as_value& val);
+
+    /// PropertyCache validates its entries against our PropertyList.
+    friend class PropertyCache;
+
     /// A utility class for processing this as_object's inheritance chain
     template<typename T> class PrototypeRecursor;
 
@@ -776,6 +829,7 @@ getMember(as_object& o, const ObjectURI& uri)
 inline as_value
 getOwnProperty(as_object& o, const ObjectURI& uri)
 {
+    if (const as_value* e = o.denseElement(uri)) return *e;
     Property* p = o.getOwnProperty(uri);
     return p ? p->getValue(o) : as_value();
 }
@@ -853,7 +907,7 @@ get(as_object* o)
 inline bool
 hasOwnProperty(as_object& o, const ObjectURI& uri)
 {
-    return (o.getOwnProperty(uri));
+    return o.denseElement(uri) || o.getOwnProperty(uri);
 }
 
 DSOTEXPORT as_object* getObjectWithPrototype(Global_as& gl, const ObjectURI& c);
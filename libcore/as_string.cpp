@@ -0,0 +1,161 @@
+// as_string.cpp: shared immutable ActionScript strings, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "as_string.h"
+
+#include <ostream>
+#include <vector>
+
+#include "utf8.h"
+
+namespace gnash {
+
+const std::string as_string::_empty;
+
+const std::wstring as_string::_emptyWide;
+
+const std::wstring&
+as_string::decoded(int version) const
+{
+    if (!_rep) return _emptyWide;
+
+    std::unique_ptr<const std::wstring>& wide = _rep->wide[version > 5];
+    if (wide) return *wide;
+
+    if (version > 5) {
+        // As utf8::decodeCanonicalString, noting invalid sequences.
+        std::unique_ptr<std::wstring> wstr(new std::wstring);
+        const std::string& s = str();
+        std::string::const_iterator it = s.begin(), e = s.end();
+        while (std::uint32_t code = utf8::decodeNextUnicodeCharacter(it, e)) {
+            if (code == utf8::invalid) {
+                _rep->invalid = true;
+                continue;
+            }
+            wstr->push_back(static_cast<wchar_t>(code));
+        }
+        wide = std::move(wstr);
+    }
+    else {
+        wide.reset(new std::wstring(
+                    utf8::decodeCanonicalString(str(), version)));
+    }
+    return *wide;
+}
+
+std::size_t
+as_string::length(int version) const
+{
+    if (!_rep) return 0;
+    if (version <= 5) return _rep->size;
+    const std::size_t chars = _rep->countChars();
+    if (chars != std::string::npos) return chars;
+    return decoded(version).size();
+}
+
+as_string
+operator+(const as_string& a, const as_string& b)
+{
+    // Short results are cheaper to copy than to keep in pieces.
+    const std::size_t flatMax = 128;
+
+    if (b.empty()) return a;
+    if (a.empty()) return b;
+
+    as_string ret;
+    if (a.size() + b.size() <= flatMax) {
+        std::string s;
+        s.reserve(a.size() + b.size());
+        s.append(a.str()).append(b.str());
+        ret._rep.reset(new as_string::Rep(std::move(s)));
+    }
+    else ret._rep.reset(new as_string::Rep(a, b));
+    return ret;
+}
+
+void
+as_string::Rep::flatten() const
+{
+    std::string s;
+    s.reserve(size);
+
+    // Appending to a string makes concatenations that nest to the left,
+    // as deep as the number of appends, so walk them with our own stack.
+    std::vector<const Rep*> pending(1, this);
+    while (!pending.empty()) {
+        const Rep* r = pending.back();
+        pending.pop_back();
+        if (!r->left) {
+            s += r->str;
+            continue;
+        }
+        pending.push_back(r->right.get());
+        pending.push_back(r->left.get());
+    }
+
+    str = std::move(s);
+    releaseOperands();
+}
+
+std::size_t
+as_string::Rep::countChars() const
+{
+    if (counted) return chars;
+
+    // Only unflattened concatenations are counted when made.
+    std::size_t n = 0;
+    std::string::const_iterator it = str.begin(), e = str.end();
+    while (it != e) {
+        const std::uint32_t code = utf8::decodeNextUnicodeCharacter(it, e);
+        if (!code || code == utf8::invalid) {
+            n = std::string::npos;
+            break;
+        }
+        ++n;
+    }
+    chars = n;
+    counted = true;
+    return chars;
+}
+
+void
+as_string::Rep::releaseOperands() const
+{
+    std::vector<boost::intrusive_ptr<const Rep> > pending;
+    pending.push_back(std::move(left));
+    pending.push_back(std::move(right));
+
+    while (!pending.empty()) {
+        boost::intrusive_ptr<const Rep> r = std::move(pending.back());
+        pending.pop_back();
+        // Take the operands of a concatenation about to be deleted, so
+        // that deleting it does not recurse.
+        if (r->get_ref_count() == 1 && r->left) {
+            pending.push_back(std::move(r->left));
+            pending.push_back(std::move(r->right));
+        }
+    }
+}
+
+std::ostream&
+operator<<(std::ostream& o, const as_string& s)
+{
+    return o << s.str();
+}
+
+} // namespace gnash
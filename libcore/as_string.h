@@ -0,0 +1,226 @@
+// as_string.h: shared immutable ActionScript strings, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_AS_STRING_H
+#define GNASH_AS_STRING_H
+
+#include <string>
+#include <memory>
+#include <iosfwd>
+#include <boost/intrusive_ptr.hpp>
+
+#include "dsodefs.h"
+#include "ref_counted.h"
+#include "string_table.h"
+
+namespace gnash {
+
+/// A shared, immutable string.
+//
+/// Copying an as_string only copies a pointer, so strings parsed once
+/// from action code (constant pools, ActionPush literals) can be pushed,
+/// stored and passed around without being copied.
+//
+/// An as_string also remembers its string_table key once it has been
+/// looked up, so that using the same string as a property name again
+/// needs no hashing, and its decoded characters once String methods
+/// asked for them, so that indexing into it is constant time.
+//
+/// Concatenating long strings only records the two operands; the
+/// characters are copied together the first time they are needed. Building
+/// a string by appending to it repeatedly thus takes linear time.
+class DSOEXPORT as_string
+{
+public:
+
+    /// Construct an empty string.
+    as_string() {}
+
+    /// Construct a string holding a copy of the given characters.
+    explicit as_string(const char* str)
+        :
+        _rep(*str ? new Rep(str) : nullptr)
+    {}
+
+    /// Construct a string taking over the given std::string.
+    explicit as_string(std::string str)
+        :
+        _rep(str.empty() ? nullptr : new Rep(std::move(str)))
+    {}
+
+    /// The characters of this string.
+    const std::string& str() const {
+        if (!_rep) return _empty;
+        if (_rep->left) _rep->flatten();
+        return _rep->str;
+    }
+
+    /// The number of bytes in this string.
+    std::size_t size() const {
+        return _rep ? _rep->size : 0;
+    }
+
+    bool empty() const {
+        return !_rep;
+    }
+
+    friend as_string operator+(const as_string& a, const as_string& b);
+
+    /// Return the characters of this string as decoded for a SWF version
+    //
+    /// This is what utf8::decodeCanonicalString returns. It is decoded
+    /// on first call and then kept with the string.
+    const std::wstring& decoded(int version) const;
+
+    /// Return the number of characters decoded for a SWF version
+    //
+    /// This is decoded(version).size(), but concatenations add up the
+    /// lengths of their operands where they can instead of decoding.
+    std::size_t length(int version) const;
+
+    /// Whether decoding this string as UTF-8 skips invalid sequences
+    //
+    /// If not, decoded() for SWF6 and above has one character for each
+    /// utf8::decodeNextUnicodeCharacter finds.
+    bool hasInvalidUTF8() const {
+        decoded(6);
+        return _rep && _rep->invalid;
+    }
+
+    /// Return the string_table key of this string.
+    //
+    /// The string is interned on first call; the key is then cached for
+    /// the given table.
+    //
+    /// @return     0 for the empty string, as string_table::find does.
+    string_table::key key(string_table& st) const {
+        if (!_rep) return 0;
+        if (_rep->table != &st) {
+            _rep->key = st.find(str());
+            _rep->table = &st;
+        }
+        return _rep->key;
+    }
+
+    /// Two strings are equal if they have the same characters.
+    bool operator==(const as_string& o) const {
+        return _rep == o._rep || str() == o.str();
+    }
+
+    bool operator!=(const as_string& o) const {
+        return !(*this == o);
+    }
+
+private:
+
+    struct Rep : ref_counted
+    {
+        template<typename T>
+        explicit Rep(T&& s)
+            :
+            str(std::forward<T>(s)),
+            size(str.size()),
+            table(nullptr),
+            key(0),
+            invalid(false),
+            counted(false),
+            chars(0)
+        {}
+
+        /// A concatenation of two non-empty strings, not yet flattened.
+        Rep(const as_string& a, const as_string& b)
+            :
+            left(a._rep),
+            right(b._rep),
+            size(a.size() + b.size()),
+            table(nullptr),
+            key(0),
+            invalid(false),
+            counted(true)
+        {
+            const std::size_t ca = a._rep->countChars();
+            const std::size_t cb = b._rep->countChars();
+            chars = (ca == std::string::npos || cb == std::string::npos) ?
+                std::string::npos : ca + cb;
+        }
+
+        ~Rep() {
+            if (left) releaseOperands();
+        }
+
+        /// Copy the characters of the operands into str and drop them.
+        void flatten() const;
+
+        /// Drop the operands, without recursing down long chains of
+        /// concatenations.
+        void releaseOperands() const;
+
+        /// Count the UTF-8 characters of this string, if that is what
+        /// decoding it finds.
+        //
+        /// @return     The count, or std::string::npos if the string has
+        ///             invalid sequences or a null character.
+        std::size_t countChars() const;
+
+        /// The characters, once flattened.
+        mutable std::string str;
+
+        /// The operands of an unflattened concatenation, or null.
+        mutable boost::intrusive_ptr<const Rep> left;
+        mutable boost::intrusive_ptr<const Rep> right;
+
+        const std::size_t size;
+
+        /// The table the cached key belongs to.
+        mutable string_table* table;
+
+        mutable string_table::key key;
+
+        /// The characters decoded for SWF5 and for later versions.
+        mutable std::unique_ptr<const std::wstring> wide[2];
+
+        /// Whether UTF-8 decoding skipped invalid sequences.
+        mutable bool invalid;
+
+        /// Whether chars is known.
+        mutable bool counted;
+
+        /// The result of countChars().
+        mutable std::size_t chars;
+    };
+
+    boost::intrusive_ptr<const Rep> _rep;
+
+    static const std::string _empty;
+
+    static const std::wstring _emptyWide;
+};
+
+/// Concatenate two strings.
+DSOEXPORT as_string operator+(const as_string& a, const as_string& b);
+
+DSOEXPORT std::ostream& operator<<(std::ostream& o, const as_string& s);
+
+} // namespace gnash
+
+#endif
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
@@ -248,6 +248,17 @@ as_value::to_string(int version) const
     
 }
 
+as_string
+as_value::to_shared_string(int version) const
+{
+    if (_type == STRING) return _string;
+    if (_type == OBJECT) {
+        String_as* s;
+        if (isNativeType(getObj(), s)) return s->sharedValue();
+    }
+    return as_string(to_string(version));
+}
+
 as_value::AsType
 as_value::defaultPrimitive(int version) const
 {
@@ -462,7 +473,7 @@ as_value::to_object(VM& vm) const
             return getObject(toDisplayObject());
 
         case STRING:
-            return constructObject(vm, getStr(), NSV::CLASS_STRING);
+            return constructObject(vm, _string, NSV::CLASS_STRING);
 
         case NUMBER:
             return constructObject(vm, getNum(), NSV::CLASS_NUMBER);
@@ -518,15 +529,19 @@ as_value::get_object() const
 void
 as_value::set_undefined()
 {
+    releasePayload();
     _type = UNDEFINED;
-    _value = boost::blank();
+    _dangling = false;
+    _object = nullptr;
 }
 
 void
 as_value::set_null()
 {
+    releasePayload();
     _type = NULLTYPE;
-    _value = boost::blank();
+    _dangling = false;
+    _object = nullptr;
 }
 
 void
@@ -538,16 +553,21 @@ as_value::set_as_object(as_object* obj)
         return;
     }
     if (obj->displayObject()) {
-        // The static cast is fine as long as the as_object is genuinely
-        // a DisplayObject.
+        // Whether it was destroyed is checked whenever it is used, as
+        // a CharacterProxy would.
+        DisplayObject* ch = obj->displayObject();
+        releasePayload();
         _type = DISPLAYOBJECT;
-        _value = CharacterProxy(obj->displayObject(), getRoot(*obj));
+        _dangling = false;
+        _character = ch;
         return;
     }
 
     if (_type != OBJECT || getObj() != obj) {
+        releasePayload();
         _type = OBJECT;
-        _value = obj;
+        _dangling = false;
+        _object = obj;
     }
 }
 
@@ -658,9 +678,13 @@ as_value::equalsSameType(const as_value& v) const
             return true;
 
         case OBJECT:
+            return _object == v._object;
+
         case BOOLEAN:
+            return _boolean == v._boolean;
+
         case STRING:
-            return _value == v._value;
+            return _string == v._string;
 
         case DISPLAYOBJECT:
             return toDisplayObject() == v.toDisplayObject(); 
@@ -699,11 +723,10 @@ as_value::setReachable() const
             break;
         }
         case DISPLAYOBJECT:
-        {
-            CharacterProxy sp = getCharacterProxy();
-            sp.setReachable();
+            // A destroyed DisplayObject is not kept alive.
+            checkDangling();
+            if (!_dangling) _character->setReachable();
             break;
-        }
         default: break;
     }
 }
@@ -712,41 +735,74 @@ as_object*
 as_value::getObj() const
 {
     assert(_type == OBJECT);
-    return boost::get<as_object*>(_value);
+    return _object;
+}
+
+void
+as_value::checkDangling() const
+{
+    assert(_type == DISPLAYOBJECT);
+    if (_dangling || !_character->isDestroyed()) return;
+
+    // The proxy keeps the original target of the DisplayObject.
+    const DanglingCharacter* proxy = new DanglingCharacter(
+            CharacterProxy(_character, getRoot(*getObject(_character))));
+    proxy->add_ref();
+    _proxy = proxy;
+    _dangling = true;
 }
 
 CharacterProxy
 as_value::getCharacterProxy() const
 {
-    assert(_type == DISPLAYOBJECT);
-    return boost::get<CharacterProxy>(_value);
+    checkDangling();
+    if (_dangling) return _proxy->proxy;
+    return CharacterProxy(_character, getRoot(*getObject(_character)));
 }
 
 DisplayObject*
 as_value::getCharacter(bool allowUnloaded) const
 {
-    return getCharacterProxy().get(allowUnloaded);
+    assert(_type == DISPLAYOBJECT);
+    if (!_dangling) {
+        if (allowUnloaded) return _character;
+        checkDangling();
+        if (!_dangling) return _character;
+    }
+    return _proxy->proxy.get(allowUnloaded);
 }
 
 void
 as_value::set_string(const std::string& str)
 {
+    set_string(as_string(str));
+}
+
+void
+as_value::set_string(as_string str)
+{
+    releasePayload();
     _type = STRING;
-    _value = str;
+    _dangling = false;
+    new (&_string) as_string(std::move(str));
 }
 
 void
 as_value::set_double(double val)
 {
+    releasePayload();
     _type = NUMBER;
-    _value = val;
+    _dangling = false;
+    _number = val;
 }
 
 void
 as_value::set_bool(bool val)
 {
+    releasePayload();
     _type = BOOLEAN;
-    _value = val;
+    _dangling = false;
+    _boolean = val;
 }
 
 bool
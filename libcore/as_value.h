@@ -21,13 +21,14 @@
 
 #include <limits>
 #include <string>
-#include <boost/variant.hpp>
 #include <iosfwd> // for inlined output operator
 #include <type_traits>
 #include <cstdint>
+#include <new>
 
 #include "dsodefs.h" // for DSOTEXPORT
 #include "CharacterProxy.h"
+#include "as_string.h"
 #include "GnashNumeric.h" // for isNaN
 
 
@@ -91,6 +92,13 @@ enum primitive_types
 //
 /// It is possible to check the current type of an as_value using is_string(),
 /// is_number() etc. These functions have no ActionScript side effects.
+//
+/// Storage
+/// A value is 16 bytes: its type and a payload of at most one pointer.
+/// Strings are shared as_strings. A DisplayObject is held by pointer
+/// until it is found destroyed; from then on the value keeps its
+/// original target in a CharacterProxy out of line, so that it can be
+/// rebound like the proxy would.
 class as_value
 {
 
@@ -119,7 +127,8 @@ public:
     DSOEXPORT as_value()
         :
         _type(UNDEFINED),
-        _value(boost::blank())
+        _dangling(false),
+        _object(nullptr)
     {
     }
     
@@ -127,32 +136,46 @@ public:
     DSOEXPORT as_value(const as_value& v)
         :
         _type(v._type),
-        _value(v._value)
+        _dangling(v._dangling)
     {
+        copyPayload(v);
     }
 
     /// Move constructor.
     DSOEXPORT as_value(as_value&& other)
-        : _type(other._type),
-          _value(std::move(other._value))
+        :
+        _type(other._type),
+        _dangling(other._dangling)
     {
-        other._type = UNDEFINED;
+        movePayload(other);
     }
 
-    ~as_value() {}
+    ~as_value() {
+        releasePayload();
+    }
     
     /// Construct a primitive String value 
     DSOEXPORT as_value(const char* str)
         :
         _type(STRING),
-        _value(std::string(str))
+        _dangling(false),
+        _string(str)
     {}
 
     /// Construct a primitive String value 
     DSOEXPORT as_value(std::string str)
         :
         _type(STRING),
-        _value(std::move(str))
+        _dangling(false),
+        _string(std::move(str))
+    {}
+
+    /// Construct a primitive String value sharing the given string
+    DSOEXPORT as_value(as_string str)
+        :
+        _type(STRING),
+        _dangling(false),
+        _string(std::move(str))
     {}
     
     /// Construct a primitive Boolean value
@@ -161,20 +184,24 @@ public:
     as_value(T val)
         :
         _type(BOOLEAN),
-        _value(val)
+        _dangling(false),
+        _boolean(val)
     {}
 
     /// Construct a primitive Number value
     as_value(double num)
         :
         _type(NUMBER),
-        _value(num)
+        _dangling(false),
+        _number(num)
     {}
     
     /// Construct a null, Object, or DisplayObject value
     as_value(as_object* obj)
         :
-        _type(UNDEFINED)
+        _type(UNDEFINED),
+        _dangling(false),
+        _object(nullptr)
     {
         set_as_object(obj);
     }
@@ -182,16 +209,23 @@ public:
     /// Assign to an as_value.
     DSOEXPORT as_value& operator=(const as_value& v)
     {
-        _type = v._type;
-        _value = v._value;
+        if (this != &v) {
+            releasePayload();
+            _type = v._type;
+            _dangling = v._dangling;
+            copyPayload(v);
+        }
         return *this;
     }
 
     DSOEXPORT as_value& operator=(as_value&& other)
     {
-        _type = other._type;
-        _value = std::move(other._value);
-        other._type = UNDEFINED;
+        if (this != &other) {
+            releasePayload();
+            _type = other._type;
+            _dangling = other._dangling;
+            movePayload(other);
+        }
         return *this;
     }
 
@@ -234,6 +268,21 @@ public:
     //
     /// TODO: drop the default argument.
     DSOTEXPORT std::string to_string(int version = 7) const;
+
+    /// Get the shared string of a String value.
+    //
+    /// This performs no conversion and no copy, so the caller must check
+    /// that this value is a String.
+    const as_string& getSharedString() const {
+        assert(_type == STRING);
+        return _string;
+    }
+
+    /// Get a string representation of this value as a shared string.
+    //
+    /// A String value is shared rather than copied; anything else is
+    /// converted as by to_string().
+    DSOEXPORT as_string to_shared_string(int version = 7) const;
     
     /// Get a number representation for this value
     //
@@ -317,6 +366,9 @@ public:
     
     /// Set to a primitive string.
     void set_string(const std::string& str);
+
+    /// Set to a primitive string, sharing it.
+    void set_string(as_string str);
     
     /// Set to a primitive number.
     void set_double(double val);
@@ -410,22 +462,91 @@ public:
 
 private:
 
-    /// AsValueType handles the following AS types:
-    //
-    /// 1. undefined / null
-    /// 2. Number
-    /// 3. Boolean
-    /// 4. Object
-    /// 5. MovieClip
-    /// 6. String
-    typedef boost::variant<boost::blank,
-                           double,
-                           bool,
-                           as_object*,
-                           CharacterProxy,
-                           std::string>
-    AsValueType;
-    
+    /// A CharacterProxy to a destroyed DisplayObject, shared by copies.
+    struct DanglingCharacter : ref_counted
+    {
+        explicit DanglingCharacter(const CharacterProxy& p) : proxy(p) {}
+        const CharacterProxy proxy;
+    };
+
+    /// The type whose payload a value of the given type has
+    //
+    /// Exceptions keep the payload of the value thrown.
+    static AsType payloadType(AsType t) {
+        return static_cast<AsType>(t & ~1);
+    }
+
+    /// Set the payload to a copy of the given value's.
+    //
+    /// The type must already be the given value's.
+    void copyPayload(const as_value& v) {
+        switch (payloadType(_type)) {
+            case STRING:
+                new (&_string) as_string(v._string);
+                break;
+            case DISPLAYOBJECT:
+                if (_dangling) {
+                    _proxy = v._proxy;
+                    _proxy->add_ref();
+                }
+                else _character = v._character;
+                break;
+            default:
+                copyScalar(v);
+        }
+    }
+
+    /// Copy a payload that needs no reference counting.
+    void copyScalar(const as_value& v) {
+        switch (payloadType(_type)) {
+            case NUMBER:
+                _number = v._number;
+                break;
+            case BOOLEAN:
+                _boolean = v._boolean;
+                break;
+            case DISPLAYOBJECT:
+                _character = v._character;
+                break;
+            default:
+                _object = v._object;
+        }
+    }
+
+    /// Take over the payload of the given value, leaving it undefined.
+    //
+    /// The type must already be the given value's.
+    void movePayload(as_value& v) {
+        if (payloadType(_type) == STRING) {
+            new (&_string) as_string(std::move(v._string));
+            v._string.~as_string();
+        }
+        else if (_dangling) _proxy = v._proxy;
+        else copyScalar(v);
+        v._type = UNDEFINED;
+        v._dangling = false;
+    }
+
+    /// Release the payload, before it is overwritten.
+    void releasePayload() {
+        switch (payloadType(_type)) {
+            case STRING:
+                _string.~as_string();
+                break;
+            case DISPLAYOBJECT:
+                if (_dangling) _proxy->drop_ref();
+                break;
+            default:
+                break;
+        }
+    }
+
+    /// Switch to the target of a destroyed DisplayObject
+    //
+    /// CharacterProxy does the same when accessed. The caller must check
+    /// that this is a DisplayObject.
+    void checkDangling() const;
+
     /// Use the relevant equality function, not operator==
     bool operator==(const as_value& v) const;
     
@@ -439,46 +560,62 @@ private:
     bool equalsSameType(const as_value& v) const;
     
     AsType _type;
+
+    /// Whether a DisplayObject value was found destroyed.
+    mutable bool _dangling;
+
+    union
+    {
+        double _number;
+        bool _boolean;
+        as_object* _object;
+
+        /// The DisplayObject, until found destroyed.
+        mutable DisplayObject* _character;
+
+        /// The proxy of a destroyed DisplayObject; one reference is ours.
+        mutable const DanglingCharacter* _proxy;
+
+        as_string _string;
+    };
     
-    AsValueType _value;
-    
-    /// Get the object pointer variant member.
+    /// Get the object pointer payload.
     //
     /// Callers must check that this is an Object (including DisplayObjects).
     as_object* getObj() const;
     
-    /// Get the DisplayObject variant member.
+    /// Get the DisplayObject payload.
     //
     /// The caller must check that this is a DisplayObject.
     DisplayObject* getCharacter(bool skipRebinding = false) const;
 
-    /// Get the DisplayObject proxy variant member.
+    /// Get a proxy to the DisplayObject payload.
     //
     /// The caller must check that this value is a DisplayObject
     CharacterProxy getCharacterProxy() const;
 
-    /// Get the number variant member.
+    /// Get the number payload.
     //
     /// The caller must check that this value is a Number.
     double getNum() const {
         assert(_type == NUMBER);
-        return boost::get<double>(_value);
+        return _number;
     }
     
-    /// Get the boolean variant member.
+    /// Get the boolean payload.
     //
     /// The caller must check that this value is a Boolean.
     bool getBool() const {
         assert(_type == BOOLEAN);
-        return boost::get<bool>(_value);
+        return _boolean;
     }
 
-    /// Get the boolean variant member.
+    /// Get the string payload.
     //
     /// The caller must check that this value is a String.
     const std::string& getStr() const {
         assert(_type == STRING);
-        return boost::get<std::string>(_value);
+        return _string.str();
     }
     
 };
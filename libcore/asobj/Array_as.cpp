@@ -108,6 +108,12 @@ namespace {
     /// Set the length property of an object only if it is a genuine array.
     void setArrayLength(as_object& o, const int size);
 
+    /// Return the elements of an array if they are all stored densely.
+    //
+    /// If this returns 0, some elements are Properties or missing, and
+    /// the generic code must be used.
+    std::vector<as_value>* denseArray(as_object& array);
+
     void resizeArray(as_object& o, const int size);
 
 }
@@ -227,6 +233,36 @@ inplaceMerge(IterType begin, IterType middle, const IterType& end, ComparatorTyp
     }
 }
 
+/// Merge-sort a vector using comparator @compare and a buffer.
+//
+/// This is a bottom-up version of mergeSort(), which is as safe but needs
+/// only O(n log n) comparisons and copies, at the cost of a second vector.
+/// Like std::list::sort it is stable.
+template<typename T, typename ComparatorType>
+void
+bufferedMergeSort(std::vector<T>& v, ComparatorType compare)
+{
+    const size_t size = v.size();
+    std::vector<T> buffer(size);
+
+    for (size_t width = 1; width < size; width *= 2) {
+        for (size_t begin = 0; begin < size; begin += 2 * width) {
+            const size_t middle = std::min(begin + width, size);
+            const size_t end = std::min(begin + 2 * width, size);
+
+            // Take from the second range only if it is strictly less.
+            size_t i = begin, j = middle, k = begin;
+            while (i < middle && j < end) {
+                if (compare(v[j], v[i])) buffer[k++] = std::move(v[j++]);
+                else buffer[k++] = std::move(v[i++]);
+            }
+            while (i < middle) buffer[k++] = std::move(v[i++]);
+            while (j < end) buffer[k++] = std::move(v[j++]);
+        }
+        v.swap(buffer);
+    }
+}
+
 /// Merge-sort the range delineated by (@begin, end] using comparator @compare.
 template<typename IterType, typename ComparatorType>
 void mergeSort(IterType begin, IterType end, ComparatorType compare)
@@ -262,6 +298,25 @@ template <typename IterType>
 void
 SafeSort(IterType begin, IterType end, const as_value_custom& compare);
 
+/// Replace the elements of an array with sorted ones.
+//
+/// A custom comparator may have changed the array while sorting, in which
+/// case the elements are set one by one like any others.
+void
+storeSorted(as_object& o, std::vector<as_value>& sorted)
+{
+    std::vector<as_value>* e = denseArray(o);
+    if (e && e->size() == sorted.size()) {
+        e->swap(sorted);
+        return;
+    }
+
+    VM& vm = getVM(o);
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        o.set_member(arrayKey(vm, i), sorted[i]);
+    }
+}
+
 /// \brief
 /// Attempt to sort the array using given values comparator, avc.
 /// If two or more elements in the array are equal, as determined
@@ -290,34 +345,21 @@ bool sort(as_object& o, AVCMP avc, AVEQ ave)
     // Invalid comparator can lead to undefined behaviour,
     // including invalid memory access and infinite loops.
     //
-    // Pragmatically, it seems that std::list::sort is
-    // more robust in this reguard, so we'll sort a list
-    // instead of the queue. We want to sort a copy anyway
-    // to avoid the comparator changing the original container.
+    // So we use our own merge sort, which is safe with any comparator.
+    // We want to sort a copy anyway to avoid the comparator changing the
+    // original container.
 
-    typedef std::list<as_value> SortContainer;
+    typedef std::vector<as_value> SortContainer;
 
     SortContainer v;
     PushToContainer<SortContainer> pv(v);
     foreachArray(o, pv);
 
-    const size_t size = v.size(); 
-
-    v.sort(avc);
+    mergesort::bufferedMergeSort(v, avc);
 
     if (std::adjacent_find(v.begin(), v.end(), ave) != v.end()) return false;
 
-    VM& vm = getVM(o);
-
-    SortContainer::const_iterator it = v.begin();
-
-    for (size_t i = 0; i < size; ++i) {
-        if (i >= v.size()) {
-            break;
-        }
-        o.set_member(arrayKey(vm, i), *it);
-        ++it;
-    }
+    storeSorted(o, v);
     return true;
 }
 
@@ -327,27 +369,15 @@ void
 sort(as_object& o, AVCMP avc) 
 {
 
-    typedef std::list<as_value> SortContainer;
+    typedef std::vector<as_value> SortContainer;
 
     SortContainer v;
     PushToContainer<SortContainer> pv(v);
     foreachArray(o, pv);
 
-    const size_t size = v.size(); 
-
-    v.sort(avc);
+    mergesort::bufferedMergeSort(v, avc);
 
-    VM& vm = getVM(o);
-
-    SortContainer::const_iterator it = v.begin();
-
-    for (size_t i = 0; i < size; ++i) {
-        if (it == v.end()) {
-            break;
-        }
-        o.set_member(arrayKey(vm, i), *it);
-        ++it;
-    }
+    storeSorted(o, v);
 }
 
 /// \brief
@@ -998,6 +1028,14 @@ arrayKey(VM& vm, size_t i)
     return getURI(vm, std::to_string(i), true);
 }
 
+as_value
+arrayElement(as_object& array, size_t i)
+{
+    const std::vector<as_value>* e = array.denseElements();
+    if (e && i < e->size()) return (*e)[i];
+    return getOwnProperty(array, arrayKey(getVM(array), i));
+}
+
 namespace {
 
 void
@@ -1088,18 +1126,28 @@ array_splice(const fn_call& fn)
         callMethod(ret, propPush, getOwnProperty(*array, key));
     }
 
-    // Shift elements in 'this' array by simple assignment, not delete
-    // and readd.
-    for (size_t i = 0; i < static_cast<size_t>(size - remove); ++i) {
-        const bool started = (i >= static_cast<size_t>(start));
-        const size_t index = started ? i + remove : i;
-        const size_t target = started ? i + newelements : i;
-        array->set_member(getKey(fn, target), v[index]);
+    std::vector<as_value>* e = denseArray(*array);
+    if (e && e->size() == static_cast<size_t>(size)) {
+        e->erase(e->begin() + start, e->begin() + start + remove);
+        e->insert(e->begin() + start, newelements, as_value());
+        for (size_t i = 0; i < newelements; ++i) {
+            (*e)[start + i] = fn.arg(i + 2);
+        }
     }
+    else {
+        // Shift elements in 'this' array by simple assignment, not delete
+        // and readd.
+        for (size_t i = 0; i < static_cast<size_t>(size - remove); ++i) {
+            const bool started = (i >= static_cast<size_t>(start));
+            const size_t index = started ? i + remove : i;
+            const size_t target = started ? i + newelements : i;
+            array->set_member(getKey(fn, target), v[index]);
+        }
 
-    // Insert the replacement elements in the gap we left.
-    for (size_t i = 0; i < newelements; ++i) {
-        array->set_member(getKey(fn, start + i), fn.arg(i + 2));
+        // Insert the replacement elements in the gap we left.
+        for (size_t i = 0; i < newelements; ++i) {
+            array->set_member(getKey(fn, start + i), fn.arg(i + 2));
+        }
     }
     
     // This one is correct!
@@ -1320,6 +1368,14 @@ array_push(const fn_call& fn)
 
     const size_t size = arrayLength(*array);
 
+    if (std::vector<as_value>* e = denseArray(*array)) {
+        for (size_t i = 0; i < shift; ++i) {
+            e->push_back(fn.arg(i));
+        }
+        setArrayLength(*array, size + shift);
+        return as_value(size + shift);
+    }
+
     for (size_t i = 0; i < shift; ++i) {
         array->set_member(getKey(fn, size + i), fn.arg(i));
     }
@@ -1340,6 +1396,15 @@ array_unshift(const fn_call& fn)
 
     const size_t size = arrayLength(*array);
 
+    if (std::vector<as_value>* e = denseArray(*array)) {
+        e->insert(e->begin(), shift, as_value());
+        for (size_t i = 0; i < shift; ++i) {
+            (*e)[i] = fn.arg(i);
+        }
+        setArrayLength(*array, size + shift);
+        return as_value(size + shift);
+    }
+
     for (size_t i = size + shift - 1; i >= shift ; --i) {
         const ObjectURI nextkey = getKey(fn, i - shift);
         const ObjectURI currentkey = getKey(fn, i);
@@ -1367,6 +1432,13 @@ array_pop(const fn_call& fn)
     const size_t size = arrayLength(*array);
     if (size < 1) return as_value();
 
+    if (std::vector<as_value>* e = denseArray(*array)) {
+        as_value ret = e->back();
+        e->pop_back();
+        setArrayLength(*array, size - 1);
+        return ret;
+    }
+
     const ObjectURI ind = getKey(fn, size - 1);
     as_value ret = getOwnProperty(*array, ind);
     array->delProperty(ind);
@@ -1386,6 +1458,13 @@ array_shift(const fn_call& fn)
     // An array with no elements has nothing to return.
     if (size < 1) return as_value();
 
+    if (std::vector<as_value>* e = denseArray(*array)) {
+        as_value ret = e->front();
+        e->erase(e->begin());
+        setArrayLength(*array, size - 1);
+        return ret;
+    }
+
     as_value ret = getOwnProperty(*array, getKey(fn, 0));
 
     for (size_t i = 0; i < static_cast<size_t>(size - 1); ++i) {
@@ -1410,6 +1489,11 @@ array_reverse(const fn_call& fn)
     // An array with 0 or 1 elements has nothing to reverse.
     if (size < 2) return as_value();
 
+    if (std::vector<as_value>* e = denseArray(*array)) {
+        std::reverse(e->begin(), e->end());
+        return array;
+    }
+
     for (size_t i = 0; i < static_cast<size_t>(size) / 2; ++i) {
         const ObjectURI bottomkey = getKey(fn, i);
         const ObjectURI topkey = getKey(fn, size - i - 1);
@@ -1554,14 +1638,11 @@ join(as_object* array, const std::string& separator)
 
     std::string s;
 
-    VM& vm = getVM(*array);
     const int version = getSWFVersion(*array);
 
     for (size_t i = 0; i < size; ++i) {
         if (i) s += separator;
-        const std::string& index = std::to_string(i);
-        const as_value& el = getOwnProperty(*array, getURI(vm, index));
-        s += el.to_string(version);
+        s += arrayElement(*array, i).to_string(version);
     }
     return as_value(s);
 }
@@ -1591,10 +1672,8 @@ void foreachArray(as_object& array, int start, int end, T& pred)
     assert(end >= start);
     assert(size >= end);
 
-    VM& vm = getVM(array);
-
     for (size_t i = start; i < static_cast<size_t>(end); ++i) {
-        pred(getOwnProperty(array, arrayKey(vm, i)));
+        pred(arrayElement(array, i));
     }
 }
 
@@ -1621,13 +1700,38 @@ resizeArray(as_object& o, const int size)
 
     const size_t currentSize = arrayLength(o);
     if (realSize < currentSize) {
+
+        size_t first = realSize;
+
+        if (std::vector<as_value>* e = o.denseElements()) {
+
+            // Unless the elements reach the length, there are others
+            // stored as properties. Only indices too long to be stored
+            // densely can be.
+            const bool allDense = e->size() == currentSize;
+            if (e->size() > realSize) e->resize(realSize);
+            if (allDense) return;
+            if (first < PropertyList::maxElements) {
+                first = PropertyList::maxElements;
+            }
+        }
+
         VM& vm = getVM(o);
-        for (size_t i = realSize; i < currentSize; ++i) {
+        for (size_t i = first; i < currentSize; ++i) {
             o.delProperty(arrayKey(vm, i));
         }
     }
 }
 
+std::vector<as_value>*
+denseArray(as_object& array)
+{
+    if (!array.array()) return nullptr;
+    std::vector<as_value>* e = array.denseElements();
+    if (!e || e->size() != arrayLength(array)) return nullptr;
+    return e;
+}
+
 void
 setArrayLength(as_object& array, const int size)
 {
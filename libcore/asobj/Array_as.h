@@ -47,6 +47,16 @@ size_t arrayLength(as_object& array);
 /// @return         The ObjectURI to look up.
 ObjectURI arrayKey(VM& vm, size_t i);
 
+/// Get an element of an object as though it were an array
+//
+/// This is the same as getOwnProperty(array, arrayKey(vm, i)), but
+/// doesn't look up the key for densely stored Array elements.
+//
+/// @param array    The object whose element is needed.
+/// @param i        The index of the element.
+/// @return         The element, or undefined if it does not exist.
+as_value arrayElement(as_object& array, size_t i);
+
 /// A visitor to check whether an array is strict or not.
 //
 /// Strict arrays have no non-hidden non-numeric properties. Only real arrays
@@ -80,10 +90,8 @@ void foreachArray(as_object& array, T& pred)
     size_t size = arrayLength(array);
     if (!size) return;
 
-    VM& vm = getVM(array);
-
     for (size_t i = 0; i < static_cast<size_t>(size); ++i) {
-        pred(getOwnProperty(array, arrayKey(vm, i)));
+        pred(arrayElement(array, i));
     }
 }
 
@@ -885,7 +885,7 @@ executeAMFFunction(as_object& o, amf::Reader& rd)
     const std::string& meth = a.to_string();
 
     // These are in reverse order!
-    std::vector<as_value> d;
+    fn_call::Args::container_type d;
     while(rd(a)) d.push_back(a);
     std::reverse(d.begin(), d.end());
     fn_call::Args args;
@@ -39,6 +39,7 @@
 #include "NativeFunction.h" 
 #include "Bitmap.h"
 #include "Array_as.h"
+#include "flash/filters/BitmapFilter_as.h"
 #include "FillStyle.h"
 #include "namedStrings.h"
 #include "Renderer.h"
@@ -360,8 +361,10 @@ as_value
 movieclip_cacheAsBitmap(const fn_call& fn)
 {
     MovieClip* movieclip = ensure<IsDisplayObject<MovieClip> >(fn);
-    UNUSED(movieclip);
-    LOG_ONCE( log_unimpl(_("MovieClip.cacheAsBitmap()")) );
+
+    if (!fn.nargs) return as_value(movieclip->cacheAsBitmap());
+
+    movieclip->setCacheAsBitmap(toBool(fn.arg(0), getVM(fn)));
     return as_value();
 }
 
@@ -370,19 +373,15 @@ as_value
 movieclip_filters(const fn_call& fn)
 {
     MovieClip* movieclip = ensure<IsDisplayObject<MovieClip> >(fn);
-    
-    UNUSED(movieclip);
-
-    LOG_ONCE(log_unimpl(_("MovieClip.filters()")));
 
     if (!fn.nargs) {
-        // Getter
-        Global_as& gl = getGlobal(fn);
-        as_object* array = gl.createArray();
-        return as_value(array);
+        // Getter: changing the copies has no effect.
+        return as_value(fromFilters(fn, movieclip->filters()));
     }
 
     // Setter
+    as_object* array = toObject(fn.arg(0), getVM(fn));
+    movieclip->setFilters(array ? toFilters(*array) : Filters());
     return as_value();
 }
 
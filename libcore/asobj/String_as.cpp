@@ -69,11 +69,11 @@ namespace {
             const std::string& function);
 
     inline int getStringVersioned(const fn_call& fn, const as_value& arg,
-            std::string& str);
+            as_string& str);
 
 }
 
-String_as::String_as(std::string s)
+String_as::String_as(as_string s)
     :
     _string(std::move(s))
 {
@@ -154,11 +154,11 @@ string_concat(const fn_call& fn)
 {
     as_value val(fn.this_ptr);
 
-    std::string str;
+    as_string str;
     const int version = getStringVersioned(fn, val, str);
 
     for (size_t i = 0; i < fn.nargs; i++) {
-        str += fn.arg(i).to_string(version);
+        str = str + fn.arg(i).to_shared_string(version);
     }
 
     return as_value(str);
@@ -171,10 +171,10 @@ string_slice(const fn_call& fn)
 {
     as_value val(fn.this_ptr);
     
-    std::string str;
+    as_string str;
     const int version = getStringVersioned(fn, val, str);
 
-    std::wstring wstr = utf8::decodeCanonicalString(str, version);
+    const std::wstring& wstr = str.decoded(version);
 
     if (!checkArgs(fn, 1, 2, "String.slice()")) return as_value();
 
@@ -226,10 +226,10 @@ string_split(const fn_call& fn)
 {
     as_value val(fn.this_ptr);
     
-    std::string str;
+    as_string str;
     const int version = getStringVersioned(fn, val, str);
     
-    std::wstring wstr = utf8::decodeCanonicalString(str, version);
+    const std::wstring& wstr = str.decoded(version);
 
     Global_as& gl = getGlobal(fn);
     as_object* array = gl.createArray();
@@ -341,16 +341,16 @@ string_lastIndexOf(const fn_call& fn)
 {
     as_value val(fn.this_ptr);
     
-    std::string str;
+    as_string str;
     const int version = getStringVersioned(fn, val, str);
-    const std::wstring& wstr = utf8::decodeCanonicalString(str, version);
+    const std::wstring& wstr = str.decoded(version);
 
     if (!checkArgs(fn, 1, 2, "String.lastIndexOf()")) return as_value(-1);
 
     const std::wstring& toFind = utf8::decodeCanonicalString(
         fn.arg(0).to_string(version), version);
 
-    int start = str.size();
+    int start = str.str().size();
 
     if (fn.nargs >= 2) {
         start = toInt(fn.arg(1), getVM(fn));
@@ -379,10 +379,10 @@ string_substr(const fn_call& fn)
 {
     as_value val(fn.this_ptr);
     
-    std::string str;
+    as_string str;
     const int version = getStringVersioned(fn, val, str);
 
-    std::wstring wstr = utf8::decodeCanonicalString(str, version);
+    const std::wstring& wstr = str.decoded(version);
 
     if (!checkArgs(fn, 1, 2, "String.substr()")) return as_value(str);
     
@@ -417,10 +417,10 @@ string_substring(const fn_call& fn)
 {
     as_value val(fn.this_ptr);
     
-    std::string str;
+    as_string str;
     const int version = getStringVersioned(fn, val, str);
 
-    const std::wstring& wstr = utf8::decodeCanonicalString(str, version);
+    const std::wstring& wstr = str.decoded(version);
 
     if (!checkArgs(fn, 1, 2, "String.substring()")) return as_value(str);
 
@@ -471,12 +471,12 @@ string_indexOf(const fn_call& fn)
  
     /// Do not return before this, because the toString method should always
     /// be called. (TODO: test).   
-    std::string str;
+    as_string str;
     const int version = getStringVersioned(fn, val, str);
 
     if (!checkArgs(fn, 1, 2, "String.indexOf")) return as_value(-1);
 
-    const std::wstring& wstr = utf8::decodeCanonicalString(str, version);
+    const std::wstring& wstr = str.decoded(version);
 
     const as_value& tfarg = fn.arg(0); // to find arg
     const std::wstring& toFind =
@@ -559,10 +559,10 @@ string_charCodeAt(const fn_call& fn)
 {
     as_value val(fn.this_ptr);
     
-    std::string str;
+    as_string str;
     const int version = getStringVersioned(fn, val, str);
 
-    const std::wstring& wstr = utf8::decodeCanonicalString(str, version);
+    const std::wstring& wstr = str.decoded(version);
 
     if (fn.nargs == 0) {
         IF_VERBOSE_ASCODING_ERRORS(
@@ -595,16 +595,29 @@ string_charAt(const fn_call& fn)
 {
     as_value val(fn.this_ptr);
     
-    std::string str;
-    const int version = getStringVersioned(fn, val, str);
+    as_string s;
+    const int version = getStringVersioned(fn, val, s);
 
     if (!checkArgs(fn, 1, 1, "String.charAt()")) return as_value("");
 
     // to_int() makes this safe from overflows.
     const size_t index = static_cast<size_t>(toInt(fn.arg(0), getVM(fn)));
 
+    // Every version decodes UTF-8 here. Unless that meets invalid
+    // sequences, which count as characters, the decoded string can be
+    // indexed directly.
+    if (!s.hasInvalidUTF8()) {
+        const std::wstring& wstr = s.decoded(6);
+        if (index >= wstr.size()) return as_value("");
+        if (version == 5) {
+            return as_value(utf8::encodeLatin1Character(wstr[index]));
+        }
+        return as_value(utf8::encodeUnicodeCharacter(wstr[index]));
+    }
+
     size_t currentIndex = 0;
 
+    const std::string& str = s.str();
     std::string::const_iterator it = str.begin(), e = str.end();
 
     while (std::uint32_t code = utf8::decodeNextUnicodeCharacter(it, e))
@@ -629,10 +642,10 @@ string_toUpperCase(const fn_call& fn)
 {
     as_value val(fn.this_ptr);
 
-    std::string str;
+    as_string str;
     const int version = getStringVersioned(fn, val, str);
 
-    std::wstring wstr = utf8::decodeCanonicalString(str, version);
+    std::wstring wstr = str.decoded(version);
 
 #if !defined(__HAIKU__) && !defined(__amigaos4__) && !defined(__ANDROID__)
     static const std::locale swfLocale((std::locale()), new SWFCtype());
@@ -655,10 +668,10 @@ string_toLowerCase(const fn_call& fn)
 {
     as_value val(fn.this_ptr);
     
-    std::string str;
+    as_string str;
     const int version = getStringVersioned(fn, val, str);
 
-    std::wstring wstr = utf8::decodeCanonicalString(str, version);
+    std::wstring wstr = str.decoded(version);
 
 #if !defined(__HAIKU__) && !defined(__amigaos4__) && !defined(__ANDROID__)
     static const std::locale swfLocale((std::locale()), new SWFCtype());
@@ -721,10 +734,11 @@ string_ctor(const fn_call& fn)
 {
     const int version = getSWFVersion(fn);
 
-    std::string str;
+    as_string str;
 
     if (fn.nargs) {
-        str = fn.arg(0).to_string(version);
+        // Share the string, and its decoded form.
+        str = fn.arg(0).to_shared_string(version);
     }
 
     if (!fn.isInstantiation())
@@ -735,14 +749,14 @@ string_ctor(const fn_call& fn)
     as_object* obj = fn.this_ptr;
 
     obj->setRelay(new String_as(str));
-    std::wstring wstr = utf8::decodeCanonicalString(str, getSWFVersion(fn));
-    obj->init_member(NSV::PROP_LENGTH, wstr.size(), as_object::DefaultFlags);
+    obj->init_member(NSV::PROP_LENGTH, str.length(version),
+            as_object::DefaultFlags);
 
     return as_value();
 }
     
 inline int
-getStringVersioned(const fn_call& fn, const as_value& val, std::string& str)
+getStringVersioned(const fn_call& fn, const as_value& val, as_string& str)
 {
 
     /// version to use is the one of the SWF containing caller code.
@@ -759,7 +773,9 @@ getStringVersioned(const fn_call& fn, const as_value& val, std::string& str)
     const int version = fn.callerDef ? fn.callerDef->get_version() :
         getSWFVersion(fn);
     
-    str = val.to_string(version);
+    // Share the string rather than copying it, so that its decoded form
+    // is kept.
+    str = val.to_shared_string(version);
 
     return version;
 
@@ -23,6 +23,7 @@
 
 #include <string>
 #include "Relay.h"
+#include "as_string.h"
 
 namespace gnash {
 
@@ -35,14 +36,19 @@ class String_as : public Relay
 
 public:
 
-    explicit String_as(std::string s);
+    explicit String_as(as_string s);
 
     const std::string& value() {
+        return _string.str();
+    }
+
+    /// The string, shared with the primitive values it came from.
+    const as_string& sharedValue() const {
         return _string;
     }
 
 private:
-    std::string _string;
+    as_string _string;
 };
 
 /// Initialize the global String class
@@ -50,6 +50,8 @@
 #include "NativeFunction.h"
 #include "GnashNumeric.h"
 #include "Array_as.h"
+#include "Filters.h"
+#include "utility.h"
 
 namespace gnash {
 
@@ -709,12 +711,119 @@ registerBitmapDataNative(as_object& global)
 
 namespace {
 
+// sourceBitmap: BitmapData,
+// sourceRect: Rectangle,
+// destPoint: Point,
+// filter: BitmapFilter
 as_value
 bitmapdata_applyFilter(const fn_call& fn)
 {
     BitmapData_as* ptr = ensure<ThisIsNative<BitmapData_as> >(fn);
-    UNUSED(ptr);
-    LOG_ONCE(log_unimpl(__FUNCTION__) );
+
+    if (ptr->disposed()) return as_value();
+
+    if (fn.nargs < 4) {
+        IF_VERBOSE_ASCODING_ERRORS(
+            log_aserror(_("BitmapData.applyFilter() needs four arguments"));
+        );
+        return as_value();
+    }
+
+    as_object* o = toObject(fn.arg(0), getVM(fn));
+    BitmapData_as* source;
+    if (!isNativeType(o, source) || source->disposed()) {
+        return as_value();
+    }
+
+    as_object* rect = toObject(fn.arg(1), getVM(fn));
+    if (!rect) return as_value();
+
+    as_value x, y, w, h;
+    rect->get_member(NSV::PROP_X, &x);
+    rect->get_member(NSV::PROP_Y, &y);
+    rect->get_member(NSV::PROP_WIDTH, &w);
+    rect->get_member(NSV::PROP_HEIGHT, &h);
+
+    int destX = 0;
+    int destY = 0;
+    as_object* destpoint = toObject(fn.arg(2), getVM(fn));
+    if (destpoint) {
+        as_value px, py;
+        destpoint->get_member(NSV::PROP_X, &px);
+        destpoint->get_member(NSV::PROP_Y, &py);
+        destX = toInt(px, getVM(fn));
+        destY = toInt(py, getVM(fn));
+    }
+
+    as_object* f = toObject(fn.arg(3), getVM(fn));
+    const BitmapFilter* filter =
+        f ? dynamic_cast<const BitmapFilter*>(f->relay()) : nullptr;
+    if (!filter) {
+        IF_VERBOSE_ASCODING_ERRORS(
+            log_aserror(_("BitmapData.applyFilter(): last argument is not "
+                          "a filter"));
+        );
+        return as_value();
+    }
+
+    int sourceX = toInt(x, getVM(fn));
+    int sourceY = toInt(y, getVM(fn));
+    int sourceW = toInt(w, getVM(fn));
+    int sourceH = toInt(h, getVM(fn));
+
+    // As for copyPixels().
+    if (sourceX < 0) destX -= sourceX;
+    if (sourceY < 0) destY -= sourceY;
+
+    adjustRect(sourceX, sourceY, sourceW, sourceH, *source);
+    if (sourceW == 0 || sourceH == 0) return as_value();
+
+    int destW = sourceW;
+    int destH = sourceH;
+    adjustRect(destX, destY, destW, destH, *ptr);
+    if (destW == 0 || destH == 0) return as_value();
+
+    // The filters work on premultiplied RGBA pixels. What they draw
+    // outside the rectangle is lost.
+    image::ImageRGBA im(destW, destH);
+
+    for (int i = 0; i < destH; ++i) {
+        BitmapData_as::iterator src = pixelAt(*source, sourceX, sourceY + i);
+        std::uint8_t* p = scanline(im, i);
+        for (int j = 0; j < destW; ++j, ++src, p += 4) {
+            const std::uint32_t px = *src;
+            const std::uint32_t a = px >> 24;
+            p[0] = (((px >> 16) & 0xff) * a + 127) / 255;
+            p[1] = (((px >> 8) & 0xff) * a + 127) / 255;
+            p[2] = ((px & 0xff) * a + 127) / 255;
+            p[3] = a;
+        }
+    }
+
+    if (!filter->apply(im)) {
+        LOG_ONCE(log_unimpl(_("BitmapData.applyFilter() with %s"),
+                    typeName(*filter)));
+        return as_value();
+    }
+
+    for (int i = 0; i < destH; ++i) {
+        BitmapData_as::iterator targ = pixelAt(*ptr, destX, destY + i);
+        const std::uint8_t* p = scanline(im, i);
+        for (int j = 0; j < destW; ++j, ++targ, p += 4) {
+            const std::uint32_t a = p[3];
+            std::uint32_t px = a << 24;
+            if (a) {
+                for (size_t c = 0; c < 3; ++c) {
+                    const std::uint32_t v =
+                        std::min<std::uint32_t>(255, (p[c] * 255 + a / 2) / a);
+                    px |= v << (16 - c * 8);
+                }
+            }
+            *targ = px;
+        }
+    }
+
+    ptr->updateObjects();
     return as_value();
 }
 
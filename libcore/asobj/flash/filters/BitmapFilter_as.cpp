@@ -24,6 +24,9 @@
 #include "NativeFunction.h"
 #include "Global_as.h"
 #include "Filters.h"
+#include "Array_as.h"
+#include "as_function.h"
+#include "as_environment.h"
 
 namespace gnash {
 
@@ -33,6 +36,92 @@ namespace {
     as_value bitmapfilter_clone(const fn_call& fn);
     as_value getBitmapFilterConstructor(const fn_call& fn);
     void attachBitmapFilterInterface(as_object& o);
+
+    /// Append a copy of the filter of each flash.filters object.
+    struct CloneFilter
+    {
+        CloneFilter(Filters& filters, VM& vm) : _filters(filters), _vm(vm) {}
+
+        void operator()(const as_value& val) {
+            as_object* o = toObject(val, _vm);
+            if (!o) return;
+            const BitmapFilter* f =
+                dynamic_cast<const BitmapFilter*>(o->relay());
+            if (f) _filters.push_back(f->clone());
+        }
+
+    private:
+        Filters& _filters;
+        VM& _vm;
+    };
+
+    /// Append each element of an array as a number.
+    struct PushNumber
+    {
+        PushNumber(std::vector<float>& v, VM& vm) : _v(v), _vm(vm) {}
+
+        void operator()(const as_value& val) {
+            _v.push_back(toNumber(val, _vm));
+        }
+
+    private:
+        std::vector<float>& _v;
+        VM& _vm;
+    };
+
+    /// Make a flash.filters object of the named class with a copy of a
+    /// filter.
+    template<typename T>
+    as_object*
+    wrapFilter(const fn_call& fn, const T& filter, const std::string& name)
+    {
+        as_value ctorVal(findObject(fn.env(), "flash.filters." + name));
+        as_function* ctor = ctorVal.to_function();
+        if (!ctor) return nullptr;
+
+        fn_call::Args args;
+        as_object* o = constructInstance(*ctor, fn.env(), args);
+        T* copy = o ? dynamic_cast<T*>(o->relay()) : nullptr;
+        if (!copy) return nullptr;
+
+        *copy = filter;
+        return o;
+    }
+
+    as_object*
+    wrapFilter(const fn_call& fn, const BitmapFilter& f)
+    {
+        if (const BevelFilter* p = dynamic_cast<const BevelFilter*>(&f)) {
+            return wrapFilter(fn, *p, "BevelFilter");
+        }
+        if (const BlurFilter* p = dynamic_cast<const BlurFilter*>(&f)) {
+            return wrapFilter(fn, *p, "BlurFilter");
+        }
+        if (const ColorMatrixFilter* p =
+                dynamic_cast<const ColorMatrixFilter*>(&f)) {
+            return wrapFilter(fn, *p, "ColorMatrixFilter");
+        }
+        if (const ConvolutionFilter* p =
+                dynamic_cast<const ConvolutionFilter*>(&f)) {
+            return wrapFilter(fn, *p, "ConvolutionFilter");
+        }
+        if (const DropShadowFilter* p =
+                dynamic_cast<const DropShadowFilter*>(&f)) {
+            return wrapFilter(fn, *p, "DropShadowFilter");
+        }
+        if (const GlowFilter* p = dynamic_cast<const GlowFilter*>(&f)) {
+            return wrapFilter(fn, *p, "GlowFilter");
+        }
+        if (const GradientBevelFilter* p =
+                dynamic_cast<const GradientBevelFilter*>(&f)) {
+            return wrapFilter(fn, *p, "GradientBevelFilter");
+        }
+        if (const GradientGlowFilter* p =
+                dynamic_cast<const GradientGlowFilter*>(&f)) {
+            return wrapFilter(fn, *p, "GradientGlowFilter");
+        }
+        return nullptr;
+    }
 }
  
 /// This may need a reference to its owner as_object
@@ -102,6 +191,45 @@ registerBitmapClass(as_object& where, Global_as::ASFunction ctor,
 
 }
 
+Filters
+toFilters(as_object& array)
+{
+    Filters filters;
+    CloneFilter c(filters, getVM(array));
+    foreachArray(array, c);
+    return filters;
+}
+
+as_object*
+fromFilters(const fn_call& fn, const Filters& filters)
+{
+    as_object* array = getGlobal(fn).createArray();
+    for (const std::unique_ptr<BitmapFilter>& f : filters) {
+        as_object* o = wrapFilter(fn, *f);
+        if (o) callMethod(array, NSV::PROP_PUSH, o);
+    }
+    return array;
+}
+
+std::vector<float>
+toMatrix(as_object& array)
+{
+    std::vector<float> matrix;
+    PushNumber p(matrix, getVM(array));
+    foreachArray(array, p);
+    return matrix;
+}
+
+as_object*
+fromMatrix(const fn_call& fn, const std::vector<float>& matrix)
+{
+    as_object* array = getGlobal(fn).createArray();
+    for (const float f : matrix) {
+        callMethod(array, NSV::PROP_PUSH, f);
+    }
+    return array;
+}
+
 namespace {
 
 void
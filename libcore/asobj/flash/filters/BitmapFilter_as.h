@@ -20,7 +20,10 @@
 #ifndef GNASH_ASOBJ_BITMAPFILTER_H
 #define GNASH_ASOBJ_BITMAPFILTER_H
 
+#include <vector>
+
 #include "Global_as.h"
+#include "Filters.h"
 
 namespace gnash {
     class as_object;
@@ -41,6 +44,25 @@ void registerBitmapFilterNative(as_object& global);
 void registerBitmapClass(as_object& where, Global_as::ASFunction ctor,
         Global_as::Properties p, const ObjectURI& uri);
 
+/// Copy the filters in an array of flash.filters objects.
+//
+/// This is what setting the filters property of a MovieClip or Button
+/// stores: later changes to the objects have no effect. Elements that are
+/// not filters are ignored.
+Filters toFilters(as_object& array);
+
+/// Make an array of flash.filters objects with copies of filters.
+//
+/// This is what getting the filters property of a MovieClip or Button
+/// returns.
+as_object* fromFilters(const fn_call& fn, const Filters& filters);
+
+/// Read the numbers in an array, as for the matrix of a filter.
+std::vector<float> toMatrix(as_object& array);
+
+/// Make an array of numbers, as for the matrix of a filter.
+as_object* fromMatrix(const fn_call& fn, const std::vector<float>& matrix);
+
 } // end of gnash namespace
 
 #endif
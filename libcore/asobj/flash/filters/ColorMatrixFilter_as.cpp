@@ -40,7 +40,25 @@ namespace {
 class ColorMatrixFilter_as : public Relay, public ColorMatrixFilter
 {
 public:
-    ColorMatrixFilter_as() {}
+    /// The identity matrix, which changes nothing.
+    ColorMatrixFilter_as()
+        :
+        ColorMatrixFilter(std::vector<float>(20))
+    {
+        for (size_t i = 0; i < 20; i += 6) m_matrix[i] = 1;
+    }
+
+    /// Set the matrix from an array.
+    //
+    /// Missing elements are 0, and elements after the 20th are ignored.
+    void setMatrix(as_object& array) {
+        m_matrix = toMatrix(array);
+        m_matrix.resize(20);
+    }
+
+    const std::vector<float>& matrix() const {
+        return m_matrix;
+    }
 };
 
 /// The prototype of flash.filters.ColorMatrixFilter is a new BitmapFilter.
@@ -65,7 +83,11 @@ as_value
 colormatrixfilter_matrix(const fn_call& fn)
 {
     ColorMatrixFilter_as* ptr = ensure<ThisIsNative<ColorMatrixFilter_as> >(fn);
-    UNUSED(ptr);
+    if (fn.nargs == 0) {
+        return as_value(fromMatrix(fn, ptr->matrix()));
+    }
+    as_object* array = toObject(fn.arg(0), getVM(fn));
+    if (array) ptr->setMatrix(*array);
     return as_value();
 }
 
@@ -73,7 +95,13 @@ as_value
 colormatrixfilter_new(const fn_call& fn)
 {
     as_object* obj = ensure<ValidThis>(fn);
-    obj->setRelay(new ColorMatrixFilter_as);
+    ColorMatrixFilter_as* ptr = new ColorMatrixFilter_as;
+    obj->setRelay(ptr);
+
+    if (fn.nargs) {
+        as_object* array = toObject(fn.arg(0), getVM(fn));
+        if (array) ptr->setMatrix(*array);
+    }
     return as_value();
 }
 
@@ -25,6 +25,7 @@
 #include "Global_as.h"
 #include "BitmapFilter_as.h"
 #include "Filters.h"
+#include "GnashNumeric.h"
 
 namespace gnash {
 
@@ -48,7 +49,54 @@ namespace {
 class ConvolutionFilter_as : public Relay, public ConvolutionFilter
 {
 public:
-    ConvolutionFilter_as() {}
+    ConvolutionFilter_as()
+    {
+        _divisor = 1;
+        _preserveAlpha = true;
+        _clamp = true;
+    }
+
+    std::uint8_t matrixX() const { return _matrixX; }
+    std::uint8_t matrixY() const { return _matrixY; }
+    const std::vector<float>& matrix() const { return _matrix; }
+    float divisor() const { return _divisor; }
+    float bias() const { return _bias; }
+    bool preserveAlpha() const { return _preserveAlpha; }
+    bool clamp() const { return _clamp; }
+    std::uint32_t color() const { return _color; }
+    std::uint8_t alpha() const { return _alpha; }
+
+    /// Set the number of columns, from 0 to 15.
+    void setMatrixX(int x) {
+        _matrixX = gnash::clamp(x, 0, 15);
+        _matrix.resize(_matrixX * _matrixY);
+    }
+
+    /// Set the number of rows, from 0 to 15.
+    void setMatrixY(int y) {
+        _matrixY = gnash::clamp(y, 0, 15);
+        _matrix.resize(_matrixX * _matrixY);
+    }
+
+    /// Set the matrix from an array.
+    //
+    /// It always has matrixX * matrixY elements: missing ones are 0, and
+    /// others are ignored.
+    void setMatrix(as_object& array) {
+        _matrix = toMatrix(array);
+        _matrix.resize(_matrixX * _matrixY);
+    }
+
+    void setDivisor(float d) { _divisor = d; }
+    void setBias(float b) { _bias = b; }
+    void setPreserveAlpha(bool p) { _preserveAlpha = p; }
+    void setClamp(bool c) { _clamp = c; }
+    void setColor(std::uint32_t c) { _color = c & 0xffffff; }
+
+    /// Set the alpha of off-image pixels, from 0 to 1.
+    void setAlpha(double a) {
+        _alpha = isNaN(a) ? 0 : gnash::clamp<double>(a, 0, 1) * 255;
+    }
 };
 
 /// The prototype of flash.filters.ConvolutionFilter is a new BitmapFilter.
@@ -89,8 +137,10 @@ as_value
 convolutionfilter_matrixX(const fn_call& fn)
 {
     ConvolutionFilter_as* ptr = ensure<ThisIsNative<ConvolutionFilter_as> >(fn);
-    UNUSED(ptr);
-    log_unimpl(__PRETTY_FUNCTION__);
+    if (fn.nargs == 0) {
+        return as_value(ptr->matrixX());
+    }
+    ptr->setMatrixX(toInt(fn.arg(0), getVM(fn)));
     return as_value();
 }
 
@@ -98,8 +148,10 @@ as_value
 convolutionfilter_matrixY(const fn_call& fn)
 {
     ConvolutionFilter_as* ptr = ensure<ThisIsNative<ConvolutionFilter_as> >(fn);
-    UNUSED(ptr);
-    log_unimpl(__PRETTY_FUNCTION__);
+    if (fn.nargs == 0) {
+        return as_value(ptr->matrixY());
+    }
+    ptr->setMatrixY(toInt(fn.arg(0), getVM(fn)));
     return as_value();
 }
 
@@ -107,8 +159,10 @@ as_value
 convolutionfilter_divisor(const fn_call& fn)
 {
     ConvolutionFilter_as* ptr = ensure<ThisIsNative<ConvolutionFilter_as> >(fn);
-    UNUSED(ptr);
-    log_unimpl(__PRETTY_FUNCTION__);
+    if (fn.nargs == 0) {
+        return as_value(ptr->divisor());
+    }
+    ptr->setDivisor(toNumber(fn.arg(0), getVM(fn)));
     return as_value();
 }
 
@@ -116,8 +170,10 @@ as_value
 convolutionfilter_bias(const fn_call& fn)
 {
     ConvolutionFilter_as* ptr = ensure<ThisIsNative<ConvolutionFilter_as> >(fn);
-    UNUSED(ptr);
-    log_unimpl(__PRETTY_FUNCTION__);
+    if (fn.nargs == 0) {
+        return as_value(ptr->bias());
+    }
+    ptr->setBias(toNumber(fn.arg(0), getVM(fn)));
     return as_value();
 }
 
@@ -125,8 +181,10 @@ as_value
 convolutionfilter_preserveAlpha(const fn_call& fn)
 {
     ConvolutionFilter_as* ptr = ensure<ThisIsNative<ConvolutionFilter_as> >(fn);
-    UNUSED(ptr);
-    log_unimpl(__PRETTY_FUNCTION__);
+    if (fn.nargs == 0) {
+        return as_value(ptr->preserveAlpha());
+    }
+    ptr->setPreserveAlpha(toBool(fn.arg(0), getVM(fn)));
     return as_value();
 }
 
@@ -134,8 +192,10 @@ as_value
 convolutionfilter_clamp(const fn_call& fn)
 {
     ConvolutionFilter_as* ptr = ensure<ThisIsNative<ConvolutionFilter_as> >(fn);
-    UNUSED(ptr);
-    log_unimpl(__PRETTY_FUNCTION__);
+    if (fn.nargs == 0) {
+        return as_value(ptr->clamp());
+    }
+    ptr->setClamp(toBool(fn.arg(0), getVM(fn)));
     return as_value();
 }
 
@@ -143,8 +203,10 @@ as_value
 convolutionfilter_color(const fn_call& fn)
 {
     ConvolutionFilter_as* ptr = ensure<ThisIsNative<ConvolutionFilter_as> >(fn);
-    UNUSED(ptr);
-    log_unimpl(__PRETTY_FUNCTION__);
+    if (fn.nargs == 0) {
+        return as_value(ptr->color());
+    }
+    ptr->setColor(toInt(fn.arg(0), getVM(fn)));
     return as_value();
 }
 
@@ -152,8 +214,10 @@ as_value
 convolutionfilter_alpha(const fn_call& fn)
 {
     ConvolutionFilter_as* ptr = ensure<ThisIsNative<ConvolutionFilter_as> >(fn);
-    UNUSED(ptr);
-    log_unimpl(__PRETTY_FUNCTION__);
+    if (fn.nargs == 0) {
+        return as_value(ptr->alpha() / 255.0);
+    }
+    ptr->setAlpha(toNumber(fn.arg(0), getVM(fn)));
     return as_value();
 }
 
@@ -161,8 +225,11 @@ as_value
 convolutionfilter_matrix(const fn_call& fn)
 {
     ConvolutionFilter_as* ptr = ensure<ThisIsNative<ConvolutionFilter_as> >(fn);
-    UNUSED(ptr);
-    log_unimpl(__PRETTY_FUNCTION__);
+    if (fn.nargs == 0) {
+        return as_value(fromMatrix(fn, ptr->matrix()));
+    }
+    as_object* array = toObject(fn.arg(0), getVM(fn));
+    if (array) ptr->setMatrix(*array);
     return as_value();
 }
 
@@ -170,7 +237,24 @@ as_value
 convolutionfilter_new(const fn_call& fn)
 {
     as_object* obj = ensure<ValidThis>(fn);
-    obj->setRelay(new ConvolutionFilter_as);
+    ConvolutionFilter_as* ptr = new ConvolutionFilter_as;
+    obj->setRelay(ptr);
+
+    // new ConvolutionFilter(matrixX, matrixY, matrix, divisor, bias,
+    //     preserveAlpha, clamp, color, alpha)
+    VM& vm = getVM(fn);
+    if (fn.nargs > 0) ptr->setMatrixX(toInt(fn.arg(0), vm));
+    if (fn.nargs > 1) ptr->setMatrixY(toInt(fn.arg(1), vm));
+    if (fn.nargs > 2) {
+        as_object* array = toObject(fn.arg(2), vm);
+        if (array) ptr->setMatrix(*array);
+    }
+    if (fn.nargs > 3) ptr->setDivisor(toNumber(fn.arg(3), vm));
+    if (fn.nargs > 4) ptr->setBias(toNumber(fn.arg(4), vm));
+    if (fn.nargs > 5) ptr->setPreserveAlpha(toBool(fn.arg(5), vm));
+    if (fn.nargs > 6) ptr->setClamp(toBool(fn.arg(6), vm));
+    if (fn.nargs > 7) ptr->setColor(toInt(fn.arg(7), vm));
+    if (fn.nargs > 8) ptr->setAlpha(toNumber(fn.arg(8), vm));
     return as_value();
 }
 
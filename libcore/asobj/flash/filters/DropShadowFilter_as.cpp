@@ -25,6 +25,7 @@
 #include "Global_as.h"
 #include "BitmapFilter_as.h"
 #include "Filters.h"
+#include "GnashNumeric.h"
 
 namespace gnash {
 
@@ -133,11 +134,12 @@ as_value
 dropshadowfilter_angle(const fn_call& fn)
 {
     DropShadowFilter_as* ptr = ensure<ThisIsNative<DropShadowFilter_as> >(fn);
+    // The angle is in degrees in ActionScript, and in radians in SWF.
     if (fn.nargs == 0) {
-        return as_value(ptr->m_angle);
+        return as_value(ptr->m_angle * 180.0 / PI);
     }
     double sp_angle = toNumber(fn.arg(0), getVM(fn));
-    ptr->m_angle = sp_angle;
+    ptr->m_angle = sp_angle * PI / 180.0;
     return as_value();
 }
 
@@ -23,8 +23,11 @@
 #include <utility>
 #include <string>
 #include <sstream>
+#include <fstream>
 #include <map>
 #include <bitset>
+#include <algorithm>
+#include <limits>
 #include <cassert>
 #include <functional>
 #include <boost/algorithm/string/replace.hpp>
@@ -58,6 +61,7 @@
 #include "StreamProvider.h"
 #include "SystemClock.h"
 #include "as_function.h"
+#include "Profiler.h"
 
 #ifdef USE_SWFTREE
 # include "tree.hh"
@@ -145,6 +149,7 @@ movie_root::movie_root(VirtualClock& clock, const RunResources& runResources)
     m_background_color_set(false),
     _mouseX(0),
     _mouseY(0),
+    _executingTimer(0),
     _lastTimerId(0),
     _lastKeyEvent(key::INVALID),
     _currentFocus(nullptr),
@@ -153,6 +158,7 @@ movie_root::movie_root(VirtualClock& clock, const RunResources& runResources)
     _invalidated(true),
     _disableScripts(false),
     _processingActionLevel(PRIORITY_SIZE),
+    _enterFrameInherited(false),
     _hostfd(-1),
     _controlfd(-1),
     _quality(QUALITY_HIGH),
@@ -174,6 +180,9 @@ movie_root::movie_root(VirtualClock& clock, const RunResources& runResources)
     gnash::RcInitFile& rcfile = gnash::RcInitFile::getDefaultInstance();
     _recursionLimit = rcfile.getScriptsRecursionLimit();
     _timeoutLimit = rcfile.getScriptsTimeout();
+
+    _frameTrace = rcfile.getFrameTrace();
+    if (!_frameTrace.empty()) FrameStats::dumpOnSignal();
 }
 
 void
@@ -191,8 +200,14 @@ movie_root::~movie_root()
 {
     clear(_actionQueue);
     _intervalTimers.clear();
+    _timerHeap.clear();
     _movieLoader.clear();
 
+    if (!_frameTrace.empty()) {
+        _frameStats.endFrame(frameCounters());
+        writeFrameTrace();
+    }
+
     assert(testInvariant());
 }
 
@@ -346,6 +361,7 @@ movie_root::setLevel(unsigned int num, Movie* movie)
             //       test sets an interval and then loads something
             //       in _level0. The result is the interval is disabled.
             _intervalTimers.clear();
+            _timerHeap.clear();
 
             // TODO: check what else we should do in these cases 
             //       (like, unregistering all childs etc...)
@@ -537,6 +553,7 @@ movie_root::reset()
 
     // remove all intervals
     _intervalTimers.clear();
+    _timerHeap.clear();
 
     // remove all loadMovie requests
     _movieLoader.clear();
@@ -819,6 +836,9 @@ movie_root::addIntervalTimer(std::unique_ptr<Timer> timer)
 
     assert(_intervalTimers.find(id) == _intervalTimers.end());
 
+    _timerHeap.push_back(TimerExpiry(timer->expiryTime(), id));
+    std::push_heap(_timerHeap.begin(), _timerHeap.end());
+
     _intervalTimers.insert(std::make_pair(id, std::move(timer)));
 
     return id;
@@ -832,14 +852,14 @@ movie_root::clearIntervalTimer(std::uint32_t x)
         return false;
     }
 
-    // We do not remove the element here because
-    // we might have been called during execution
-    // of another timer, thus during a scan of the _intervalTimers
-    // container. If we use erase() here, the iterators in executeTimers
-    // would be invalidated. Rather, executeTimers() would check container
-    // elements for being still active and remove the cleared one in a safe way
-    // at each iteration.
+    // A timer clearing itself is still executing, so it is removed
+    // by executeTimers() when it returns. The heap entry of any other
+    // is left to be dropped when it reaches the top.
     it->second->clearInterval();
+    if (x != _executingTimer) {
+        _intervalTimers.erase(it);
+        dropStaleTimers();
+    }
 
     return true;
 }
@@ -852,6 +872,22 @@ movie_root::advance()
     // contructed from a negative value.
     const size_t now = std::max<size_t>(_vm.getTime(), _lastMovieAdvancement);
 
+    if (FrameStats::dumpRequested()) {
+        std::ostringstream ss;
+        _frameStats.summarize(ss);
+        log_debug("Frame timings:\n%s", ss.str());
+
+        Renderer* renderer = _runResources.renderer();
+        if (renderer) {
+            std::ostringstream rs;
+            renderer->summarize(rs);
+            if (!rs.str().empty()) log_debug("Renderer:\n%s", rs.str());
+        }
+        writeFrameTrace();
+    }
+
+    _frameStats.beginFrame(frameCounters());
+
     bool advanced = false;
 
     try {
@@ -938,6 +974,7 @@ movie_root::advance()
 #endif  // USE_SOUND
         
         // Always do this.
+        FrameStats::Timer t(_frameStats, FrameStats::PHASE_TIMERS);
         executeAdvanceCallbacks();
         executeTimers();
     
@@ -959,13 +996,18 @@ movie_root::advance()
 void
 movie_root::advanceMovie()
 {
+    _frameStats.setAdvanced();
+
     // Do mouse drag, if needed
     doMouseDrag();
 
     // Advance all non-unloaded DisplayObjects in the LiveChars list
     // in reverse order (last added, first advanced)
     // NOTE: can throw ActionLimitException
-    advanceLiveChars(); 
+    {
+        FrameStats::Timer t(_frameStats, FrameStats::PHASE_ADVANCE);
+        advanceLiveChars(); 
+    }
 
     // Process loadMovie requests
     // 
@@ -975,13 +1017,22 @@ movie_root::advanceMovie()
     //       is known to fix more tests in misc-mtasc.all/levels.swf
     //       to be checked if it keeps the swfdec testsuite safe
     //
-    _movieLoader.processCompletedRequests();
+    {
+        FrameStats::Timer t(_frameStats, FrameStats::PHASE_LOADS);
+        _movieLoader.processCompletedRequests();
+    }
 
     // Process queued actions
     // NOTE: can throw ActionLimitException
-    processActionQueue();
+    {
+        FrameStats::Timer t(_frameStats, FrameStats::PHASE_ACTIONS);
+        processActionQueue();
+    }
 
-    cleanupAndCollect();
+    {
+        FrameStats::Timer t(_frameStats, FrameStats::PHASE_CLEANUP);
+        cleanupAndCollect();
+    }
 
     assert(testInvariant());
 }
@@ -994,6 +1045,18 @@ movie_root::timeToNextFrame() const
     return _movieAdvancementDelay - elapsed;
 }
 
+int
+movie_root::timeToNextTimer() const
+{
+    if (_timerHeap.empty()) return -1;
+
+    const unsigned long now = _vm.getTime();
+    const unsigned long next = _timerHeap.front().time;
+    if (next <= now) return 0;
+    return std::min<unsigned long>(next - now,
+            std::numeric_limits<int>::max());
+}
+
 void
 movie_root::display()
 {
@@ -1016,6 +1079,8 @@ movie_root::display()
     Renderer* renderer = _runResources.renderer();
     if (!renderer) return;
 
+    FrameStats::Timer t(_frameStats, FrameStats::PHASE_RENDER);
+
     Renderer::External ex(*renderer, m_background_color,
             _stageWidth, _stageHeight,
             frame_size.get_x_min(), frame_size.get_x_max(),
@@ -1485,6 +1550,21 @@ movie_root::processActionQueue()
     _vm.getStack().clear();
 }
 
+void
+movie_root::setEnterFrameHandler(as_object& o, bool handler)
+{
+    DisplayObject* d = o.displayObject();
+    MovieClip* mc = d ? d->to_movie() : nullptr;
+    if (mc) {
+        mc->setEnterFrameHandler(handler);
+        return;
+    }
+
+    // Any other object may be the prototype of clips. A clip's handler
+    // is never inherited, as DisplayObjects end the prototype chain.
+    if (handler) _enterFrameInherited = true;
+}
+
 void
 movie_root::removeQueuedConstructor(MovieClip* target)
 {
@@ -1700,6 +1780,21 @@ movie_root::processInvoke(ExternalInterface::invoke_t *invoke)
     return true;
 }
 
+void
+movie_root::dropStaleTimers()
+{
+    while (!_timerHeap.empty()) {
+        const TimerExpiry& e = _timerHeap.front();
+        TimerMap::const_iterator it = _intervalTimers.find(e.id);
+        if (it != _intervalTimers.end() &&
+                it->second->expiryTime() == e.time) {
+            return;
+        }
+        std::pop_heap(_timerHeap.begin(), _timerHeap.end());
+        _timerHeap.pop_back();
+    }
+}
+
 void
 movie_root::executeTimers()
 {
@@ -1710,43 +1805,86 @@ movie_root::executeTimers()
     // Don't do anything if we have no timers, just return so we don't
     // waste cpu cycles.
     if (_intervalTimers.empty()) {
+        _timerHeap.clear();
         return;
     }
 
-    unsigned long now = _vm.getTime();
+    const unsigned long now = _vm.getTime();
+
+    // Take the expired timers off the heap, the first to expire first
+    // and of those the first set first.
+    std::vector<TimerExpiry> expired;
+    while (!_timerHeap.empty() && _timerHeap.front().time <= now) {
+        std::pop_heap(_timerHeap.begin(), _timerHeap.end());
+        const TimerExpiry e = _timerHeap.back();
+        _timerHeap.pop_back();
+
+        TimerMap::const_iterator it = _intervalTimers.find(e.id);
+        if (it == _intervalTimers.end()) continue;
+
+        const Timer& timer = *it->second;
+        if (timer.cleared()) {
+            _intervalTimers.erase(e.id);
+            continue;
+        }
+        if (timer.expiryTime() == e.time) expired.push_back(e);
+    }
 
-    typedef std::multimap<unsigned long, Timer*>
-        ExpiredTimers;
+    if (expired.empty()) return;
 
-    ExpiredTimers expiredTimers;
+    // Timers expiring just now run before the late ones.
+    std::stable_partition(expired.begin(), expired.end(),
+            [now](const TimerExpiry& e) { return e.time == now; });
 
-    for (TimerMap::iterator it = _intervalTimers.begin(),
-            itEnd = _intervalTimers.end(); it != itEnd; ) {
+    for (size_t i = 0, e = expired.size(); i != e; ++i) {
 
-        TimerMap::iterator nextIterator = it;
-        ++nextIterator;
+        const TimerExpiry& expiry = expired[i];
 
-        Timer* timer = it->second.get();
+        // A timer may remove others, or all of them.
+        TimerMap::iterator it = _intervalTimers.find(expiry.id);
+        if (it == _intervalTimers.end()) continue;
 
-        if (timer->cleared()) {
-            // this timer was cleared, erase it
-            _intervalTimers.erase(it);
+        _executingTimer = expiry.id;
+        try {
+            it->second->executeAndReset();
         }
-        else {
-            unsigned long elapsed;
-            if (timer->expired(now, elapsed)) {
-                expiredTimers.insert(std::make_pair(elapsed, timer));
+        catch (...) {
+            // The timers not run yet still expire next time.
+            _executingTimer = 0;
+            for (; i != e; ++i) {
+                _timerHeap.push_back(expired[i]);
+                std::push_heap(_timerHeap.begin(), _timerHeap.end());
             }
+            throw;
         }
+        _executingTimer = 0;
+
+        it = _intervalTimers.find(expiry.id);
+        if (it == _intervalTimers.end()) continue;
 
-        it = nextIterator;
+        const Timer& timer = *it->second;
+        if (timer.cleared()) {
+            _intervalTimers.erase(it);
+        }
+        else {
+            _timerHeap.push_back(TimerExpiry(timer.expiryTime(), expiry.id));
+            std::push_heap(_timerHeap.begin(), _timerHeap.end());
+        }
     }
 
-    foreachSecond(expiredTimers.begin(), expiredTimers.end(),
-                  &Timer::executeAndReset);
+    // Drop the entries of timers cleared long before they expire.
+    if (_timerHeap.size() > 2 * _intervalTimers.size() + 64) {
+        _timerHeap.erase(std::remove_if(_timerHeap.begin(), _timerHeap.end(),
+                [this](const TimerExpiry& e) {
+                    TimerMap::const_iterator it = _intervalTimers.find(e.id);
+                    return it == _intervalTimers.end() ||
+                        it->second->expiryTime() != e.time;
+                }), _timerHeap.end());
+        std::make_heap(_timerHeap.begin(), _timerHeap.end());
+    }
+    else dropStaleTimers();
 
-    if (!expiredTimers.empty())
-        processActionQueue();
+    processActionQueue();
 }
 
 void
@@ -2380,9 +2518,39 @@ void
 movie_root::handleFsCommand(const std::string& cmd, const std::string& arg)
     const
 {
+    // Lets a movie choose when its ActionScript profile is written.
+    if (cmd == "writeProfile" && _vm.profiler()) {
+        _vm.profiler()->write();
+    }
+
     if (_fsCommandHandler) _fsCommandHandler->notify(cmd, arg);
 }
 
+FrameStats::Counters
+movie_root::frameCounters() const
+{
+    FrameStats::Counters c;
+    c.actions = _vm.actionsExecuted();
+    c.allocated = _gc.stats().allocated;
+    c.freed = _gc.stats().freed;
+    return c;
+}
+
+void
+movie_root::writeFrameTrace() const
+{
+    if (_frameTrace.empty()) return;
+
+    std::ofstream out(_frameTrace.c_str());
+    _frameStats.writeTrace(out);
+    if (!out) {
+        log_error(_("Could not write the frame timings to %s"), _frameTrace);
+        return;
+    }
+    log_debug("Wrote the timings of %d frames to %s", _frameStats.size(),
+            _frameTrace);
+}
+
 bool
 isLevelTarget(int version, const std::string& name, unsigned int& levelno)
 {
@@ -88,6 +88,7 @@
 #include "MovieClip.h"
 #include "SimpleBuffer.h" // for LoadCallback
 #include "MovieLoader.h"
+#include "FrameStats.h"
 #include "ExternalInterface.h"
 #include "GC.h"
 #include "VM.h"
@@ -371,6 +372,14 @@ public:
     ///
     int timeToNextFrame() const;
 
+    /// Return the number of milliseconds before an interval timer
+    /// may next expire.
+    //
+    /// @return     0 if a timer is due, or -1 if there are no timers.
+    ///             The time can be too short if the next timer was
+    ///             cleared.
+    int timeToNextTimer() const;
+
     /// Entry point for movie advancement
     //
     /// This function does:
@@ -681,6 +690,21 @@ public:
     /// @return         The class to be used, or 0 if no class is associated.
     as_function* getRegisteredClass(const SWF::DefinitionTag* sprite) const;
 
+    /// Record that an object gained or lost an onEnterFrame property
+    //
+    /// Clips only look for an onEnterFrame handler on ENTER_FRAME if
+    /// they have such a property, or if another object ever had one,
+    /// as they may inherit it.
+    ///
+    /// @param o        The object whose property changed.
+    /// @param handler  Whether it now has the property.
+    void setEnterFrameHandler(as_object& o, bool handler);
+
+    /// Whether an object other than a clip was ever given onEnterFrame.
+    bool enterFrameInherited() const {
+        return _enterFrameInherited;
+    }
+
     /// Set a filedescriptor to use for host application requests
     /// (for browser communication mostly)
     void setHostFD(int fd) {
@@ -720,6 +744,9 @@ public:
     }
 
     /// Call this to notify FS commands
+    //
+    /// The "writeProfile" command also writes the ActionScript profile,
+    /// if one is being taken.
     DSOEXPORT void handleFsCommand(const std::string& cmd,
             const std::string& arg) const;
     
@@ -823,6 +850,21 @@ public:
         return _gc;
     }
 
+    /// The timings of the last frames advanced and displayed.
+    FrameStats& frameStats() {
+        return _frameStats;
+    }
+
+    const FrameStats& frameStats() const {
+        return _frameStats;
+    }
+
+    /// Write the timings of the last frames to the rcfile's frameTrace.
+    //
+    /// The timings are also written when the movie_root is destroyed,
+    /// and when the process gets SIGUSR2.
+    void writeFrameTrace() const;
+
     /// Ask the host interface a question.
     //
     /// @param what The question to pose.
@@ -894,6 +936,11 @@ private:
     /// Execute expired timers
     void executeTimers();
 
+    /// Drop the stale entries from the top of _timerHeap
+    //
+    /// The top then is the next timer to expire.
+    void dropStaleTimers();
+
     /// Cleanup references to unloaded DisplayObjects and run the GC.
     void cleanupAndCollect();
 
@@ -963,6 +1010,9 @@ private:
 
     void handleActionLimitHit(const std::string& ref);
 
+    /// The running totals of the counters kept in the frame timings.
+    FrameStats::Counters frameCounters() const;
+
     typedef std::forward_list<Button*> ButtonListeners;
     ButtonListeners _buttonListeners;
 
@@ -1018,6 +1068,33 @@ private:
 
     TimerMap _intervalTimers;
 
+    /// When a timer of _intervalTimers expires.
+    struct TimerExpiry
+    {
+        TimerExpiry(unsigned long t, std::uint32_t i) : time(t), id(i) {}
+
+        /// The next timer to expire, and of those the first set, is the
+        /// greatest, so that it is at the top of a heap.
+        bool operator<(const TimerExpiry& other) const {
+            if (time != other.time) return time > other.time;
+            return id > other.id;
+        }
+
+        unsigned long time;
+        std::uint32_t id;
+    };
+
+    /// The expiry of each timer, in a heap with the next to expire on top
+    //
+    /// An entry is stale if its timer was removed or cleared, or expires
+    /// at another time. Stale entries are dropped as they reach the top,
+    /// so executeTimers() only visits the timers that expired and
+    /// timeToNextTimer() sees the next one to.
+    std::vector<TimerExpiry> _timerHeap;
+
+    /// The id of the timer being executed, or 0.
+    std::uint32_t _executingTimer;
+
     size_t _lastTimerId;
 
     /// bit-array for recording the unreleased keys
@@ -1055,6 +1132,9 @@ private:
     /// aborted due to action limit set or whatever else
     bool _disableScripts;
     int _processingActionLevel;
+
+    /// Whether an object other than a clip was ever given onEnterFrame.
+    bool _enterFrameInherited;
     
     /// filedescriptor to write to for host application requests
     //
@@ -1099,6 +1179,11 @@ private:
 
     MovieLoader _movieLoader;
 
+    FrameStats _frameStats;
+
+    /// Where to write the frame timings, if anywhere.
+    std::string _frameTrace;
+
     struct SoundStream {
         SoundStream(int i, int b) : id(i), block(b) {}
         int id;
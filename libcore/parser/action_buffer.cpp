@@ -27,6 +27,7 @@
 #include "SWFStream.h"
 #include "SWF.h"
 #include "ASHandlers.h"
+#include "DecodedActions.h"
 #include "movie_definition.h"
 
 namespace gnash {
@@ -44,6 +45,10 @@ action_buffer::action_buffer(const movie_definition& md)
 {
 }
 
+action_buffer::~action_buffer()
+{
+}
+
 void
 action_buffer::read(SWFStream& in, unsigned long endPos)
 {
@@ -97,6 +102,13 @@ action_buffer::read(SWFStream& in, unsigned long endPos)
     
 }
 
+const DecodedActions&
+action_buffer::decodedActions() const
+{
+    if (!_decoded) _decoded.reset(new DecodedActions(*this));
+    return *_decoded;
+}
+
 const ConstantPool&
 action_buffer::readConstantPool(size_t start_pc, size_t stop_pc) const
 {
@@ -121,8 +133,7 @@ action_buffer::readConstantPool(size_t start_pc, size_t stop_pc) const
     
     // Index the strings.
     for (int ct = 0; ct < count; ct++) {
-        // Point into the current action buffer.
-        pool[ct] = reinterpret_cast<const char*>(&m_buffer[3 + i]);
+        const char* str = reinterpret_cast<const char*>(&m_buffer[3 + i]);
 
         // TODO: rework this "safety" thing here (doesn't look all that safe)
         while (m_buffer[3 + i]) {
@@ -131,13 +142,14 @@ action_buffer::readConstantPool(size_t start_pc, size_t stop_pc) const
                 log_error(_("action buffer dict length exceeded"));
                 // Jam something into the remaining (invalid) entries.
                 while (ct < count) {
-                    pool[ct] = "<invalid>";
+                    pool[ct] = as_string("<invalid>");
                     ct++;
                 }
                 return pool;
             }
             i++;
         }
+        pool[ct] = as_string(str);
         i++;
     }
 
@@ -22,6 +22,7 @@
 #include <string>
 #include <vector> 
 #include <map> 
+#include <memory>
 #include <boost/noncopyable.hpp>
 #include <cstdint>
 
@@ -34,6 +35,7 @@ namespace gnash {
 	class as_value;
 	class movie_definition;
 	class SWFStream; // for read signature
+	class DecodedActions;
 }
 
 namespace gnash {
@@ -52,6 +54,8 @@ public:
 
 	action_buffer(const movie_definition& md);
 
+	~action_buffer();
+
 	/// Read action bytes from input stream up to but not including endPos
 	//
 	/// @param endPos
@@ -156,7 +160,7 @@ public:
         // We'll query the last inserted one for now (highest PC)
         const ConstantPool& pool = _pools.rbegin()->second;
 
-        if ( n < pool.size() ) return pool[n];
+        if ( n < pool.size() ) return pool[n].str().c_str();
 
         else return nullptr;
 	}
@@ -186,6 +190,12 @@ public:
         return _src;
     }
 
+	/// Return the pre-decoded form of this buffer
+	//
+	/// The buffer is decoded on first call and the result kept for
+	/// as long as the buffer lives.
+	const DecodedActions& decodedActions() const;
+
 private:
 
 	/// the code itself, as read from the SWF
@@ -201,6 +211,9 @@ private:
 	/// permissions to grant to the action code.
 	/// 
 	const movie_definition& _src;
+
+	/// The pre-decoded actions, built on demand by decodedActions()
+	mutable std::unique_ptr<DecodedActions> _decoded;
 };
 
 
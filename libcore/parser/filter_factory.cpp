@@ -37,6 +37,20 @@ enum filter_types
     GRADIENT_BEVEL = 7
 };
 
+namespace {
+
+/// Read an RGB color stored as three bytes.
+std::uint32_t
+readRGB(SWFStream& in)
+{
+    const std::uint32_t r = in.read_u8();
+    const std::uint32_t g = in.read_u8();
+    const std::uint32_t b = in.read_u8();
+    return (r << 16) | (g << 8) | b;
+}
+
+}
+
 int
 filter_factory::read(SWFStream& in, bool read_multiple, Filters* store)
 {
@@ -113,7 +127,7 @@ bool DropShadowFilter::read(SWFStream& in)
 {
     in.ensureBytes(4 + 8 + 8 + 2 + 1);
 
-    m_color = in.read_u8() << (16 + in.read_u8()) << (8 + in.read_u8());
+    m_color = readRGB(in);
     m_alpha = in.read_u8();
 
     m_blurX = in.read_fixed();
@@ -126,9 +140,11 @@ bool DropShadowFilter::read(SWFStream& in)
 
     m_inner = in.read_bit(); 
     m_knockout = in.read_bit(); 
-    m_hideObject = in.read_bit(); 
 
-    static_cast<void> (in.read_uint(5)); // Throw these away on purpose.
+    // The object is drawn over its shadow unless this is clear.
+    m_hideObject = !in.read_bit(); 
+
+    m_quality = static_cast<std::uint8_t> (in.read_uint(5));
 
     IF_VERBOSE_PARSE(
         log_parse(_("   DropShadowFilter: blurX=%f blurY=%f"),
@@ -163,7 +179,7 @@ bool GlowFilter::read(SWFStream& in)
 
     in.ensureBytes(4 + 8 + 2 + 1);
 
-    m_color = in.read_u8() << (16 + in.read_u8()) << (8 + in.read_u8());
+    m_color = readRGB(in);
     m_alpha = in.read_u8();
 
     m_blurX = in.read_fixed();
@@ -174,7 +190,9 @@ bool GlowFilter::read(SWFStream& in)
     m_inner = in.read_bit(); 
     m_knockout = in.read_bit(); 
 
-    static_cast<void> (in.read_uint(6)); // Throw these away.
+    static_cast<void> (in.read_bit()); // Always set.
+
+    m_quality = static_cast<std::uint8_t> (in.read_uint(5));
 
     IF_VERBOSE_PARSE(
         log_parse(_("   GlowFilter "));
@@ -190,10 +208,10 @@ bool BevelFilter::read(SWFStream& in)
     // TODO: It is possible that the order of these two should be reversed.
     // highlight might come first. Find out for sure and then fix and remove
     // this comment.
-    m_shadowColor = in.read_u8() << (16 + in.read_u8()) << (8 + in.read_u8());
+    m_shadowColor = readRGB(in);
     m_shadowAlpha = in.read_u8();
 
-    m_highlightColor = in.read_u8() << (16 + in.read_u8()) << (8 + in.read_u8());
+    m_highlightColor = readRGB(in);
     m_highlightAlpha = in.read_u8();
 
     m_blurX = in.read_fixed();
@@ -235,7 +253,7 @@ bool GradientGlowFilter::read(SWFStream& in)
 
     for (int i = 0; i < count; ++i)
     {
-        m_colors.push_back(in.read_u8() << (16 + in.read_u8()) << (8 + in.read_u8()));
+        m_colors.push_back(readRGB(in));
         m_alphas.push_back(in.read_u8());
     }
 
@@ -289,7 +307,7 @@ ConvolutionFilter::read(SWFStream& in)
         _matrix.push_back(in.read_long_float());
     }
 
-    _color = in.read_u8() << (16 + in.read_u8()) << (8 + in.read_u8());
+    _color = readRGB(in);
     _alpha = in.read_u8();
 
     static_cast<void> (in.read_uint(6)); // Throw away.
@@ -345,7 +363,7 @@ bool GradientBevelFilter::read(SWFStream& in)
     m_ratios.reserve(count);
     for (int i = 0; i < count; ++i)
     {
-        m_colors.push_back(in.read_u8() << (16 + in.read_u8()) << (8 + in.read_u8()));
+        m_colors.push_back(readRGB(in));
         m_alphas.push_back(in.read_u8());
     }
 
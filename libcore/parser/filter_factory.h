@@ -19,18 +19,14 @@
 #ifndef GNASH_FILTER_FACTORY_H
 #define GNASH_FILTER_FACTORY_H
 
-#include <vector>
-#include <memory>
+#include "Filters.h"
 
 namespace gnash {
     class SWFStream;
-    class BitmapFilter;
 }
 
 namespace gnash {
 
-typedef std::vector<std::unique_ptr<BitmapFilter> > Filters;
-
 class filter_factory
 {
 public:
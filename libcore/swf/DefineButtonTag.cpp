@@ -328,6 +328,7 @@ ButtonRecord::instantiate(Button* button, bool name) const
     o->setMatrix(_matrix, true);
     o->setCxForm(_cxform);
     o->set_depth(_buttonLayer + DisplayObject::staticDepthOffset + 1);
+    if (!_filters.empty()) o->setFilters(cloneFilters(_filters));
     if (name && isReferenceable(*o)) {
         o->set_name(button->getNextUnnamedInstanceName());
     }
@@ -422,9 +423,6 @@ ButtonRecord::read(SWFStream& in, TagType t,
 
     if (buttonHasFilterList) {
         filter_factory::read(in, true, &_filters);
-        LOG_ONCE(
-            log_unimpl("Button filters"); 
-        );
     }
 
     if (buttonHasBlendMode) {
@@ -115,7 +115,7 @@ private:
     /// SWF8 and above can have a number of filters
     /// associated with button records
     //
-    /// Currently unused by Gnash.
+    /// These are copied for each DisplayObject instantiated.
     Filters _filters;
 
     /// SWF8 and above can have a blend mode
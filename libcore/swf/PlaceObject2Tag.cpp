@@ -51,6 +51,7 @@ PlaceObject2Tag::PlaceObject2Tag(const movie_definition& def)
     _ratio(0),
     m_clip_depth(0),
     _blendMode(0),
+    _bitmapCaching(0),
     _movie_def(def)
 {
 }
@@ -387,10 +388,7 @@ PlaceObject2Tag::readPlaceObject3(SWFStream& in)
     }
 
     if (hasFilters()) {
-        Filters v; // TODO: Attach the filters to the display object.
-        filter_factory::read(in, true, &v);
-	    // at time of writing no renderer supports bitmap filters
-	    LOG_ONCE( log_unimpl("Bitmap filters") );
+        filter_factory::read(in, true, &_filters);
     }
 
     if (hasBlendMode()) {
@@ -399,7 +397,6 @@ PlaceObject2Tag::readPlaceObject3(SWFStream& in)
         LOG_ONCE(log_unimpl("Blend mode in PlaceObject tag"));
     }
 
-    std::uint8_t bitmask = 0;
     if (hasBitmapCaching()) {
         // cacheAsBitmap is a boolean value, so the flag itself ought to be
         // enough. Alexis' SWF reference is unsure about this, but suggests
@@ -410,11 +407,10 @@ PlaceObject2Tag::readPlaceObject3(SWFStream& in)
         // with both PlaceActions and bitmap caching, and the reserved bytes
         // of the PlaceActions (see readPlaceActions) are not 0 if this byte
         // isn't read.
-        // TODO: set object property
+        //
+        // Any value but 0 is taken to enable caching.
         in.ensureBytes(1);
-        bitmask = in.read_u8();
-	    LOG_ONCE(log_unimpl("Bitmap caching"));
-        UNUSED(bitmask);
+        _bitmapCaching = in.read_u8();
     }
 
     if (hasClipActions()) {
@@ -433,7 +429,8 @@ PlaceObject2Tag::readPlaceObject3(SWFStream& in)
         if (hasClassName()) log_parse(_("  class name = %s"), className);
         if (hasClipDepth()) log_parse(_("  clip_depth = %d (%d)"),
                     m_clip_depth, m_clip_depth-DisplayObject::staticDepthOffset);
-        if (hasBitmapCaching()) log_parse(_("   bitmapCaching enabled"));
+        if (hasBitmapCaching()) log_parse(_("   bitmapCaching: %d"),
+                    +_bitmapCaching);
         log_parse(_(" m_place_type: %d"), getPlaceType());
     );
 
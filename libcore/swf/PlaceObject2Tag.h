@@ -26,6 +26,7 @@
 #include "SWF.h" // for TagType definition
 #include "SWFMatrix.h" // for composition
 #include "SWFCxForm.h" // for composition 
+#include "Filters.h"
 
 // Forward declarations
 namespace gnash {
@@ -148,6 +149,20 @@ public:
         return _blendMode;
     }
 
+    /// Whether the placed object is to be cached as a bitmap.
+    //
+    /// This is only meaningful if hasBitmapCaching() is true.
+    bool getBitmapCaching() const {
+        return _bitmapCaching;
+    }
+
+    /// Get the filters of the placed DisplayObject.
+    //
+    /// These are copied for each DisplayObject placed by the tag.
+    const Filters& getFilters() const {
+        return _filters;
+    }
+
 private:
 
     // read SWF::PLACEOBJECT 
@@ -173,6 +188,10 @@ private:
     
     std::uint8_t _blendMode;
 
+    std::uint8_t _bitmapCaching;
+
+    Filters _filters;
+
     /// NOTE: getPlaceType() is dependent on the enum values.
     enum PlaceType
     {
@@ -20,6 +20,7 @@
 #include "ShapeRecord.h"
 
 #include <vector>
+#include <atomic>
 
 #include "TypesParser.h"
 #include "utility.h"
@@ -79,6 +80,7 @@ ShapeRecord::ShapeRecord(SWFStream& in, SWF::TagType tag, movie_definition& m,
 
 ShapeRecord::ShapeRecord()
 {
+    changed();
 }
 
 ShapeRecord::~ShapeRecord()
@@ -90,6 +92,15 @@ ShapeRecord::clear()
 {
     _bounds.set_null();
     _subshapes.clear();
+    changed();
+}
+
+void
+ShapeRecord::changed()
+{
+    // Shapes are parsed by the loader threads.
+    static std::atomic<std::uint64_t> lastRevision(0);
+    _revision = ++lastRevision;
 }
 
 void
@@ -136,6 +147,8 @@ ShapeRecord::setLerp(const ShapeRecord& aa, const ShapeRecord& bb,
        return;
     }
 
+    changed();
+
     // Update current bounds.
     _bounds.set_lerp(aa.getBounds(), bb.getBounds(), ratio);
     const Subshape& a = aa.subshapes().front();
@@ -240,6 +253,7 @@ ShapeRecord::read(SWFStream& in, SWF::TagType tag, movie_definition& m,
     	subshape = _subshapes.front();
     	_subshapes.clear();
     }
+    changed();
 
     if (styleInfo) {
         _bounds = readRect(in);
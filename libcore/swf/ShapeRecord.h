@@ -26,6 +26,7 @@
 #include "SWFRect.h"
 
 #include <vector>
+#include <cstdint>
 
 
 namespace gnash {
@@ -161,6 +162,16 @@ public:
 
     void addSubshape(const Subshape& subshape) {
     	_subshapes.push_back(subshape);
+        changed();
+    }
+
+    /// Identifies the current paths of this shape.
+    //
+    /// This changes whenever the paths do, and no two different sets of
+    /// paths share it, so renderers may use it to cache their work. A
+    /// copy shares it with the original until either changes.
+    std::uint64_t revision() const {
+        return _revision;
     }
 
     const SWFRect& getBounds() const {
@@ -195,6 +206,9 @@ private:
 
     unsigned readStyleChange(SWFStream& in, size_t num_fill_bits, size_t numStyles);
 
+    /// Give the shape a new revision.
+    void changed();
+
     /// Shape record flags for use in parsing.
     enum ShapeRecordFlags {
         SHAPE_END = 0x00,
@@ -207,6 +221,7 @@ private:
 
     SWFRect _bounds;
     Subshapes _subshapes;
+    std::uint64_t _revision;
 };
 
 std::ostream& operator<<(std::ostream& o, const ShapeRecord& sh);
@@ -28,6 +28,7 @@
 #include <vector>
 #include <boost/random.hpp>
 #include <algorithm> 
+#include <cmath>
 
 #include "log.h"
 #include "SWF.h"
@@ -38,6 +39,7 @@
 #include "Function2.h"
 #include "fn_call.h"
 #include "ActionExec.h"
+#include "DecodedActions.h"
 #include "MovieClip.h"
 #include "as_environment.h"
 #include "URL.h"
@@ -57,6 +59,7 @@
 #include "as_value.h"
 #include "RunResources.h"
 #include "ObjectURI.h"
+#include "Array_as.h"
 
 // GNASH_PARANOIA_LEVEL:
 // 0 : no assertions
@@ -73,11 +76,36 @@ namespace {
     as_object* construct_object(as_function* ctor_as_func, as_environment& env,
             unsigned int nargs);
 
+    /// Move the arguments of a function call from the stack.
+    //
+    /// The first argument is the top of the stack. The values are moved,
+    /// not copied, as their stack slots are dropped.
+    void popArgs(as_environment& env, size_t nargs, fn_call::Args& args);
+
     /// Convert to object without an exception being thrown.
     //
     /// @return     null if the value cannot be converted to an object.
     as_object* safeToObject(VM& vm, const as_value& val);
 
+    /// Get the ObjectURI of a property name.
+    //
+    /// String values (the usual case) use the string_table key cached in
+    /// their shared string, so only their first lookup needs hashing.
+    ObjectURI getPropertyURI(VM& vm, const as_value& name);
+
+    /// Get a member, using the current action's property cache if any.
+    bool getActionMember(ActionExec& thread, as_object& obj,
+            const ObjectURI& uri, as_value* val);
+
+    /// Set a member, using the current action's property cache if any.
+    void setActionMember(ActionExec& thread, as_object& obj,
+            const ObjectURI& uri, const as_value& val);
+
+    /// Return a densely stored array element named by a number, or 0.
+    //
+    /// This saves converting the number to a string and looking it up.
+    as_value* numericElement(as_object& obj, const as_value& name);
+
     /// Common code for ActionGetUrl and ActionGetUrl2
     //
     /// @param target         the target window or _level1 to _level10
@@ -426,9 +454,15 @@ SWFHandlers::instance()
 
 void
 SWFHandlers::execute(ActionType type, ActionExec& thread) const
+{
+    execute(_handlers[type], thread);
+}
+
+void
+SWFHandlers::execute(const ActionHandler& handler, ActionExec& thread) const
 {
     try {
-        _handlers[type].execute(thread);
+        handler.execute(thread);
     }
     catch (const ActionParserException& e) {
         log_swferror(_("Malformed action code: %s"), e.what());
@@ -949,13 +983,19 @@ ActionGetVariable(ActionExec& thread)
     as_environment& env = thread.env;
 
     as_value& top_value = env.top(0);
-    const std::string& var_string = top_value.to_string();
+    const as_string name = top_value.to_shared_string();
+    const std::string& var_string = name.str();
     if (var_string.empty()) {
         top_value.set_undefined();
         return;
     }
 
-    top_value = thread.getVariable(var_string);
+    const int slot = thread.localSlot(top_value);
+    const as_value* local = slot >= 0 ?
+        getVM(env).currentCall().getSlot(slot) : nullptr;
+
+    if (local) top_value = *local;
+    else top_value = thread.getVariable(name);
     if (env.get_version() < 5 && top_value.is_sprite()) {
         // See http://www.ferryhalim.com/orisinal/g2/penguin.htm
         IF_VERBOSE_ASCODING_ERRORS(
@@ -976,7 +1016,8 @@ ActionSetVariable(ActionExec& thread)
 {
     as_environment& env = thread.env;
 
-    const std::string& name = env.top(1).to_string();
+    const as_string varName = env.top(1).to_shared_string();
+    const std::string& name = varName.str();
     if (name.empty()) {
         IF_VERBOSE_ASCODING_ERRORS (
             // Invalid object, can't set.
@@ -985,7 +1026,12 @@ ActionSetVariable(ActionExec& thread)
                     env.top(1), env.top(0));
         );
     }
-    thread.setVariable(name, env.top(0));
+
+    // Only a declared local can be set without a lookup.
+    const int slot = thread.localSlot(env.top(1));
+    CallFrame* frame = slot >= 0 ? &getVM(env).currentCall() : nullptr;
+    if (frame && frame->getSlot(slot)) frame->setSlot(slot, env.top(0));
+    else thread.setVariable(varName, env.top(0));
 
     IF_VERBOSE_ACTION(
         log_action(_("-- set var: %s = %s"), name, env.top(0));
@@ -1019,8 +1065,8 @@ ActionStringConcat(ActionExec& thread)
     as_environment& env = thread.env;
     const int version = getSWFVersion(env);
 
-    const std::string& op1 = env.top(0).to_string(version);
-    const std::string& op2 = env.top(1).to_string(version);
+    const as_string& op1 = env.top(0).to_shared_string(version);
+    const as_string& op2 = env.top(1).to_shared_string(version);
 
     env.top(1).set_string(op2 + op1);
     env.drop(1);
@@ -1741,6 +1787,22 @@ pushConstant(ActionExec& thread, unsigned int id)
     env.push( (*pool)[id] );
 }
 
+void
+pushRegisterValue(ActionExec& thread, size_t reg)
+{
+    as_environment& env = thread.env;
+
+    const as_value* v = getVM(env).getRegister(reg);
+    if (!v) {
+        IF_VERBOSE_MALFORMED_SWF(
+            log_swferror(_("Invalid register %d in ActionPush"), reg);
+        );
+        env.push(as_value());
+        return;
+    }
+    env.push(*v);
+}
+
 void
 ActionPushData(ActionExec& thread)
 {
@@ -1771,6 +1833,35 @@ ActionPushData(ActionExec& thread)
         "dict16"
     };
 
+    size_t count = 0;
+
+    // Use the operands decoded once by DecodedActions if we have them.
+    const DecodedAction* act = thread.currentAction();
+    if (act && act->decodedOperands) {
+        const PushOperand* op = act->operands;
+        for (const PushOperand* e = op + act->operandCount; op != e; ++op) {
+            switch (op->kind)
+            {
+                case PushOperand::LITERAL:
+                    env.push(op->value);
+                    break;
+                case PushOperand::REGISTER:
+                    pushRegisterValue(thread, op->index);
+                    break;
+                case PushOperand::DICTIONARY:
+                    pushConstant(thread, op->index);
+                    break;
+            }
+
+            IF_VERBOSE_ACTION(
+                log_action(_("\t%d) type=%s, value=%s"),
+                    count, pushType[op->type], env.top(0));
+                ++count;
+            );
+        }
+        return;
+    }
+
     const action_buffer& code = thread.code;
 
     const size_t pc = thread.getCurrentPC();
@@ -1778,7 +1869,6 @@ ActionPushData(ActionExec& thread)
 
     //---------------
     size_t i = pc;
-    size_t count = 0;
     while (i - pc < length) {
 
         const std::uint8_t type = code[3 + i];
@@ -1828,15 +1918,7 @@ ActionPushData(ActionExec& thread)
             {
                 const size_t reg = code[3 + i];
                 ++i;
-                const as_value* v = getVM(env).getRegister(reg);
-                if (!v) {
-                    IF_VERBOSE_MALFORMED_SWF(
-                        log_swferror(_("Invalid register %d in ActionPush"),
-                            reg);
-                    );
-                    env.push(as_value());
-                }
-                else env.push(*v);
+                pushRegisterValue(thread, reg);
                 break;
             }
 
@@ -1893,7 +1975,9 @@ ActionPushData(ActionExec& thread)
 void
 ActionBranchAlways(ActionExec& thread)
 {
-    std::int16_t offset = thread.code.read_int16(thread.getCurrentPC()+3);
+    const DecodedAction* act = thread.currentAction();
+    const std::int16_t offset = act ? act->operand :
+        thread.code.read_int16(thread.getCurrentPC() + 3);
     thread.adjustNextPC(offset);
     // @@ TODO range checks
 }
@@ -1936,7 +2020,8 @@ ActionBranchIfTrue(ActionExec& thread)
     assert(thread.atActionTag(SWF::ACTION_BRANCHIFTRUE));
 #endif
 
-    std::int16_t offset = code.read_int16(pc+3);
+    const DecodedAction* act = thread.currentAction();
+    const std::int16_t offset = act ? act->operand : code.read_int16(pc + 3);
 
     const bool test = toBool(env.pop(), getVM(env));
     if (test) {
@@ -2184,7 +2269,10 @@ ActionVarEquals(ActionExec& thread)
 
     as_value& value = env.top(0);
     as_value& varname = env.top(1);
-    thread.setLocalVariable(varname.to_string(), value);
+
+    const int slot = thread.localSlot(varname);
+    if (slot >= 0) getVM(env).currentCall().setSlot(slot, value);
+    else thread.setLocalVariable(varname.to_string(), value);
 
     IF_VERBOSE_ACTION(
         log_action(_("-- set local var: %s = %s"), varname.to_string(), value);
@@ -2207,12 +2295,13 @@ ActionCallFunction(ActionExec& thread)
     //
     // In all cases, even undefined, the specified number of arguments
     // is dropped from the stack.
-    const std::string& funcname = env.pop().to_string();
+    const as_string funcName = env.pop().to_shared_string();
+    const std::string& funcname = funcName.str();
 
     as_object* super(nullptr);
 
     as_object* this_ptr;
-    as_value function = thread.getVariable(funcname, &this_ptr);
+    as_value function = thread.getVariable(funcName, &this_ptr);
 
     if (!function.is_object()) {
         // In this case the call to invoke() will fail. We won't return 
@@ -2245,9 +2334,7 @@ ActionCallFunction(ActionExec& thread)
     }
 
     fn_call::Args args;
-    for (size_t i = 0; i < nargs; ++i) {
-        args += env.pop();
-    } 
+    popArgs(env, nargs, args);
 
     as_value result = invoke(function, env, this_ptr,
                   args, super, &(thread.code.getMovieDefinition()));
@@ -2338,9 +2425,16 @@ ActionVar(ActionExec& thread)
 {
     as_environment& env = thread.env;
     
+    VM& vm = getVM(env);
+    const int slot = thread.localSlot(env.top(0));
+    if (slot >= 0) {
+        vm.currentCall().declareSlot(slot);
+        env.drop(1);
+        return;
+    }
+
     const std::string& varname = env.top(0).to_string();
     const ObjectURI& name = getURI(getVM(env), varname);
-    VM& vm = getVM(env);
 
     if (vm.calling()) {
         declareLocal(vm.currentCall(), name);
@@ -2591,14 +2685,19 @@ ActionGetMember(ActionExec& thread)
                    target, static_cast<void*>(obj));
     );
 
-    const ObjectURI& k = getURI(getVM(env), member_name.to_string());
+    if (const as_value* e = numericElement(*obj, member_name)) {
+        env.top(1) = *e;
+    }
+    else {
+        const ObjectURI k = getPropertyURI(getVM(env), member_name);
 
-    if (!obj->get_member(k, &env.top(1))) {
-        IF_VERBOSE_ASCODING_ERRORS(
-            log_aserror("Reference to undefined member %s of object %s",
-                member_name, target);
-        );
-        env.top(1).set_undefined();
+        if (!getActionMember(thread, *obj, k, &env.top(1))) {
+            IF_VERBOSE_ASCODING_ERRORS(
+                log_aserror("Reference to undefined member %s of object %s",
+                    member_name, target);
+            );
+            env.top(1).set_undefined();
+        }
     }
 
     IF_VERBOSE_ACTION (
@@ -2615,10 +2714,25 @@ ActionSetMember(ActionExec& thread)
     as_environment& env = thread.env;
 
     as_object* obj = safeToObject(getVM(thread.env), env.top(2));
-    const std::string& member_name = env.top(1).to_string();
     const as_value& member_value = env.top(0);
 
-    if (member_name.empty()) {
+    // An array's length only changes when setting an element beyond it.
+    as_value* e = obj ? numericElement(*obj, env.top(1)) : nullptr;
+    if (e && (!obj->array() ||
+                toNumber(env.top(1), getVM(env)) < arrayLength(*obj))) {
+        *e = member_value;
+
+        IF_VERBOSE_ACTION (
+            log_action(_("-- set_member %s.%s=%s"),
+                env.top(2), env.top(1), member_value);
+        );
+        env.drop(3);
+        return;
+    }
+
+    const ObjectURI uri = getPropertyURI(getVM(env), env.top(1));
+
+    if (uri.empty()) {
         IF_VERBOSE_ASCODING_ERRORS (
             // Invalid object, can't set.
             log_aserror(_("ActionSetMember: %s.%s=%s: member name "
@@ -2627,12 +2741,12 @@ ActionSetMember(ActionExec& thread)
         );
     }
     else if (obj) {
-        obj->set_member(getURI(getVM(env), member_name), member_value);
+        setActionMember(thread, *obj, uri, member_value);
 
         IF_VERBOSE_ACTION (
             log_action(_("-- set_member %s.%s=%s"),
                 env.top(2),
-                member_name,
+                toString(getVM(env), uri),
                 member_value);
         );
     }
@@ -2643,7 +2757,7 @@ ActionSetMember(ActionExec& thread)
         IF_VERBOSE_ASCODING_ERRORS(
             // Invalid object, can't set.
             log_aserror(_("-- set_member %s.%s=%s on invalid object!"),
-                env.top(2), member_name, member_value);
+                env.top(2), toString(getVM(env), uri), member_value);
         );
     }
 
@@ -2693,7 +2807,7 @@ ActionCallMethod(ActionExec& thread)
     // Get name function of the method
     as_value method_name = env.pop();
 
-    std::string method_string = method_name.to_string();
+    const as_string method_string = method_name.to_shared_string();
     
     // Get an object
     as_value obj_value = env.pop();
@@ -2753,7 +2867,7 @@ ActionCallMethod(ActionExec& thread)
         // The method value
         as_value method_value; 
 
-        if (!obj->get_member(methURI, &method_value) ) {
+        if (!getActionMember(thread, *obj, methURI, &method_value)) {
             IF_VERBOSE_ASCODING_ERRORS(
             log_aserror(_("ActionCallMethod: "
                 "Can't find method %s of object %s"),
@@ -2788,9 +2902,7 @@ ActionCallMethod(ActionExec& thread)
     }
 
     fn_call::Args args;
-    for (size_t i = 0; i < nargs; ++i) {
-        args += env.pop();
-    } 
+    popArgs(env, nargs, args);
 
     as_object* super;
     as_function* func = method_obj->to_function();
@@ -2860,7 +2972,7 @@ ActionNewMethod(ActionExec& thread)
         return;
     }
 
-    const std::string& method_string = method_name.to_string();
+    const as_string method_string = method_name.to_shared_string();
     as_value method_val;
     if (method_name.is_undefined() || method_string.empty()) {
         method_val = obj_val;
@@ -3217,6 +3329,7 @@ ActionDefineFunction2(ActionExec& thread)
                         "starts at PC %d"), name, func->getStartPC());
         );
 
+        func->setName(getStringTable(env).find(name));
         thread.setVariable(name, function_value);
     }
 
@@ -3414,6 +3527,7 @@ ActionDefineFunction(ActionExec& thread)
             log_action("DefineFunction: named function '%s' starts at "
                         "PC %d", name, func->getStartPC());
         );
+        func->setName(getStringTable(env).find(name));
         thread.setVariable(name, function_value);
     }
     else {
@@ -3430,8 +3544,9 @@ void
 ActionSetRegister(ActionExec& thread)
 {
     as_environment& env = thread.env;
-    const action_buffer& code = thread.code;
-    const size_t reg = code[thread.getCurrentPC() + 3];
+    const DecodedAction* act = thread.currentAction();
+    const size_t reg = act ? act->operand :
+        thread.code[thread.getCurrentPC() + 3];
     // Save top of stack in specified register.
     getVM(env).setRegister(reg, env.top(0));
 }
@@ -3455,6 +3570,53 @@ safeToObject(VM& vm, const as_value& val)
     }
 }
 
+ObjectURI
+getPropertyURI(VM& vm, const as_value& name)
+{
+    if (name.is_string()) return getURI(vm, name.getSharedString());
+    return getURI(vm, name.to_string());
+}
+
+bool
+getActionMember(ActionExec& thread, as_object& obj, const ObjectURI& uri,
+        as_value* val)
+{
+    const DecodedAction* act = thread.currentAction();
+    if (act && act->cache) return obj.getCachedMember(uri, val, *act->cache);
+    return obj.get_member(uri, val);
+}
+
+void
+setActionMember(ActionExec& thread, as_object& obj, const ObjectURI& uri,
+        const as_value& val)
+{
+    const DecodedAction* act = thread.currentAction();
+    if (act && act->cache) obj.setCachedMember(uri, val, *act->cache);
+    else obj.set_member(uri, val);
+}
+
+as_value*
+numericElement(as_object& obj, const as_value& name)
+{
+    if (!name.is_number()) return nullptr;
+
+    std::vector<as_value>* e = obj.denseElements();
+    if (!e) return nullptr;
+
+    const double d = toNumber(name, getVM(obj));
+    if (!(d >= 0 && d < e->size()) || d != std::floor(d)) return nullptr;
+    return &(*e)[static_cast<size_t>(d)];
+}
+
+void
+popArgs(as_environment& env, size_t nargs, fn_call::Args& args)
+{
+    for (size_t i = 0; i < nargs; ++i) {
+        args += std::move(env.top(i));
+    }
+    env.drop(nargs);
+}
+
 // Utility: construct an object using given constructor.
 // This is used by both ActionNew and ActionNewMethod and
 // hides differences between builtin and actionscript-defined
@@ -3465,9 +3627,7 @@ construct_object(as_function* ctor_as_func, as_environment& env,
 {
     assert(ctor_as_func);
     fn_call::Args args;
-    for (size_t i = 0; i < nargs; ++i) {
-        args += env.pop();
-    } 
+    popArgs(env, nargs, args);
     return constructInstance(*ctor_as_func, env, args);
 }
 
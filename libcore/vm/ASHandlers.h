@@ -80,6 +80,9 @@ public:
 	/// Execute the action identified by 'type' action type
 	void execute(ActionType type, ActionExec& thread) const;
 
+	/// Execute an action using a handler already looked up
+	void execute(const ActionHandler& handler, ActionExec& thread) const;
+
 	size_t size() const { return _handlers.size(); }
 
 	ActionType lastType() const {
@@ -34,6 +34,9 @@
 #include "as_environment.h"
 #include "SystemClock.h"
 #include "CallStack.h"
+#include "DecodedActions.h"
+#include "LocalVariables.h"
+#include "Profiler.h"
 
 #include <sstream>
 #include <string>
@@ -75,7 +78,8 @@ ActionExec::ActionExec(const Function& func, as_environment& newEnv,
     _abortOnUnload(false),
     pc(func.getStartPC()),
     next_pc(pc),
-    stop_pc(pc + func.getLength())
+    stop_pc(pc + func.getLength()),
+    _currentAction(nullptr)
 {
     assert(stop_pc < code.size());
 
@@ -117,7 +121,8 @@ ActionExec::ActionExec(const action_buffer& abuf, as_environment& newEnv,
     _abortOnUnload(abortOnUnloaded),
     pc(0),
     next_pc(0),
-    stop_pc(abuf.size())
+    stop_pc(abuf.size()),
+    _currentAction(nullptr)
 {
 }
 
@@ -134,7 +139,11 @@ ActionExec::operator()()
     const int codeVersion = code.getDefinitionVersion();
     vm.setSWFVersion(codeVersion);
 
+    Profiler::Running profiling(vm.profiler());
+
     static const SWF::SWFHandlers& ash = SWF::SWFHandlers::instance();
+
+    const DecodedActions& decoded = code.decodedActions();
         
     _originalTarget = env.target();
 
@@ -213,8 +222,11 @@ ActionExec::operator()()
                 _scopeStack.pop_back();
             }
 
-            // Get the opcode.
-            std::uint8_t action_id = code[pc];
+            // Get the opcode, from the pre-decoded actions when the
+            // buffer could be decoded at this offset.
+            _currentAction = decoded.at(pc, _currentAction);
+            const std::uint8_t action_id = _currentAction ?
+                static_cast<std::uint8_t>(_currentAction->id) : code[pc];
 
             IF_VERBOSE_ACTION (
                 log_action(_("PC:%d - EX: %s"), pc, code.disasm(pc));
@@ -229,7 +241,8 @@ ActionExec::operator()()
             else {
                 // action with extra data
                 // Note this converts from int to uint!
-                std::uint16_t length(code.read_int16(pc + 1));
+                const std::uint16_t length = _currentAction ?
+                    _currentAction->nextPC - pc - 3 : code.read_int16(pc + 1);
 
                 next_pc = pc + length + 3;
                 if (next_pc > stop_pc) {
@@ -255,7 +268,18 @@ ActionExec::operator()()
                 break;
             }
 
-            ash.execute(static_cast<SWF::ActionType>(action_id), *this);
+            if (_currentAction) {
+                ash.execute(*_currentAction->handler, *this);
+            }
+            else {
+                ash.execute(static_cast<SWF::ActionType>(action_id), *this);
+            }
+
+            vm.countAction();
+
+            if (Profiler::sampleDue() && vm.profiler()) {
+                vm.profiler()->sample(vm, *this);
+            }
 
             // Code round here has to do with bugs: #20974, #21069, #20996,
             // but since there is so much disabled code it's not clear exactly
@@ -617,12 +641,24 @@ ActionExec::setVariable(const std::string& name, const as_value& val)
     gnash::setVariable(env, name, val, getScopeStack());
 }
 
+void
+ActionExec::setVariable(const as_string& name, const as_value& val)
+{
+    gnash::setVariable(env, name, val, getScopeStack());
+}
+
 as_value
 ActionExec::getVariable(const std::string& name, as_object** target)
 {
     return gnash::getVariable(env, name, getScopeStack(), target);
 }
 
+as_value
+ActionExec::getVariable(const as_string& name, as_object** target)
+{
+    return gnash::getVariable(env, name, getScopeStack(), target);
+}
+
 void
 ActionExec::setLocalVariable(const std::string& name, const as_value& val)
 {
@@ -636,6 +672,24 @@ ActionExec::setLocalVariable(const std::string& name, const as_value& val)
     }
 }
 
+int
+ActionExec::localSlot(const as_value& name)
+{
+    if (!_func || !name.is_string()) return -1;
+
+    CallFrame& frame = getVM(env).currentCall();
+    const LocalVariables* vars = frame.localVariables();
+    if (!vars || &frame.function() != _func) return -1;
+
+    const int slot = vars->slotAt(pc);
+    if (slot < 0) return -1;
+
+    // The scan guessed the name; only an exact match may skip the lookup.
+    string_table& st = getStringTable(env);
+    if (name.getSharedString().key(st) != vars->name(slot).name) return -1;
+    return slot;
+}
+
 as_object*
 ActionExec::getTarget()
 {
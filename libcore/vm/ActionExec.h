@@ -33,6 +33,7 @@ namespace gnash {
 	class as_value;
 	class Function;
 	class ActionExec;
+	struct DecodedAction;
 }
 
 namespace gnash {
@@ -190,6 +191,9 @@ public:
 	/// @param name     Name of the variable. Supports slash and dot syntax.
 	void setVariable(const std::string& name, const as_value& val);
 
+	/// Set a named variable, looking it up by a shared name.
+	void setVariable(const as_string& name, const as_value& val);
+
 	/// Set a function-local variable
     //
     /// If we're not in a function, set a normal variable.
@@ -207,6 +211,16 @@ public:
     ///                 to an object, target will be set to null.
 	as_value getVariable(const std::string& name, as_object** target = nullptr);
 
+	/// Get a named variable, looking it up by a shared name.
+	as_value getVariable(const as_string& name, as_object** target = nullptr);
+
+	/// Get the CallFrame slot of the variable named by the current action
+	//
+	/// @param name     The variable name found on the stack.
+	/// @return         The slot, or -1 if the variable must be looked up
+	///                 by name.
+	int localSlot(const as_value& name);
+
 	/// Get current target.
 	//
 	/// This function returns top 'with' stack entry, if any.
@@ -236,6 +250,12 @@ public:
 	void setNextPC(size_t pc) { next_pc = pc; }
 	
 	size_t getStopPC() const { return stop_pc; }
+
+	/// Return the pre-decoded form of the action being executed
+	//
+	/// @return     0 if the current action is being parsed from the
+	///             raw buffer (see DecodedActions).
+	const DecodedAction* currentAction() const { return _currentAction; }
 	
 private: 
 
@@ -328,6 +348,9 @@ private:
 	/// Used for try/throw/catch blocks.
 	size_t stop_pc;
 
+	/// The pre-decoded form of the action at pc, if any
+	const DecodedAction* _currentAction;
+
 };
 
 } // namespace gnash
@@ -23,6 +23,8 @@
 #include "as_object.h"
 #include "UserFunction.h" 
 #include "Property.h"
+#include "LocalVariables.h"
+#include "VM.h"
 #include "log.h"
 
 namespace gnash {
@@ -31,7 +33,9 @@ CallFrame::CallFrame(UserFunction* f)
     :
     _locals(new as_object(getGlobal(*f))),
     _func(f),
-    _registers(_func->registers())
+    _registers(_func->registers()),
+    _vars(_func->localVariables()),
+    _slots(_vars ? _vars->size() : 0)
 {
     assert(_func);
 }
@@ -49,6 +53,8 @@ CallFrame::markReachableResources() const
     std::for_each(_registers.begin(), _registers.end(),
             std::mem_fun_ref(&as_value::setReachable));
 
+    for (const Slot& s : _slots) s.value.setReachable();
+
     assert(_locals);
     _locals->setReachable();
 }
@@ -67,9 +73,38 @@ CallFrame::setLocalRegister(size_t i, const as_value& val)
 
 }
 
+void
+CallFrame::spillSlots()
+{
+    if (!_vars) return;
+
+    for (size_t i = 0, e = _slots.size(); i != e; ++i) {
+        if (_slots[i].declared) {
+            _locals->set_member(_vars->name(i), _slots[i].value);
+        }
+    }
+    _vars = nullptr;
+    _slots.clear();
+}
+
+int
+findSlot(CallFrame& c, const ObjectURI& name)
+{
+    const LocalVariables* vars = c.localVariables();
+    if (!vars) return -1;
+    VM& vm = getVM(c.locals());
+    return vars->find(name, vm.getStringTable(), vm.getSWFVersion() < 7);
+}
+
 void
 declareLocal(CallFrame& c, const ObjectURI& name)
 {
+    const int slot = findSlot(c, name);
+    if (slot >= 0) {
+        c.declareSlot(slot);
+        return;
+    }
+
     as_object& locals = c.locals();
     if (!hasOwnProperty(locals, name)) {
         locals.set_member(name, as_value());
@@ -79,6 +114,12 @@ declareLocal(CallFrame& c, const ObjectURI& name)
 void
 setLocal(CallFrame& c, const ObjectURI& name, const as_value& val)
 {
+    const int slot = findSlot(c, name);
+    if (slot >= 0) {
+        c.setSlot(slot, val);
+        return;
+    }
+
     as_object& locals = c.locals();
 
     // This way avoids searching the prototype chain, though it seems
@@ -28,6 +28,7 @@ namespace gnash {
     class as_object;
     struct ObjectURI;
     class UserFunction;
+    class LocalVariables;
 }
 
 namespace gnash {
@@ -58,7 +59,9 @@ public:
         :
         _locals(other._locals),
         _func(other._func),
-        _registers(other._registers)
+        _registers(other._registers),
+        _vars(other._vars),
+        _slots(other._slots)
     {}
 
     /// Assignment operator for containers.
@@ -66,6 +69,8 @@ public:
         _locals = other._locals;
         _func = other._func;
         _registers = other._registers;
+        _vars = other._vars;
+        _slots = other._slots;
         return *this;
     }
 
@@ -79,6 +84,10 @@ public:
         return *_func;
     }
 
+    const UserFunction& function() const {
+        return *_func;
+    }
+
     /// Get a specific register in this CallFrame
     //
     /// @param i    The index of the register to return.
@@ -105,6 +114,52 @@ public:
         return !_registers.empty();
     }
 
+    /// The local variables kept in slots rather than in locals().
+    //
+    /// @return     The variables, or null if all local variables are
+    ///             properties of locals().
+    const LocalVariables* localVariables() const {
+        return _vars;
+    }
+
+    /// Get a local variable kept in a slot.
+    //
+    /// @return     The value, or null if the variable is not declared.
+    const as_value* getSlot(size_t i) const {
+        const Slot& s = _slots[i];
+        return s.declared ? &s.value : nullptr;
+    }
+
+    /// Set a local variable kept in a slot, declaring it.
+    void setSlot(size_t i, const as_value& val) {
+        Slot& s = _slots[i];
+        s.value = val;
+        s.declared = true;
+    }
+
+    /// Declare a local variable kept in a slot, if it is not declared.
+    void declareSlot(size_t i) {
+        _slots[i].declared = true;
+    }
+
+    /// Delete a local variable kept in a slot.
+    //
+    /// @return     Whether the variable was declared.
+    bool deleteSlot(size_t i) {
+        Slot& s = _slots[i];
+        if (!s.declared) return false;
+        s.value.set_undefined();
+        s.declared = false;
+        return true;
+    }
+
+    /// Move the local variables kept in slots to locals().
+    //
+    /// This must be done before the activation object can be seen as
+    /// an object, as by the 'this' of a function found in it. All local
+    /// variables are then properties of locals() until the call ends.
+    void spillSlots();
+
     /// Mark all reachable resources
     //
     /// Reachable resources would be registers and
@@ -114,6 +169,14 @@ public:
 
 private:
 
+    /// A local variable kept in a slot.
+    struct Slot
+    {
+        Slot() : declared(false) {}
+        as_value value;
+        bool declared;
+    };
+
     friend std::ostream& operator<<(std::ostream&, const CallFrame&);
 
     /// Local variables.
@@ -124,6 +187,11 @@ private:
     /// Local registers.
     Registers _registers;
 
+    /// The local variables kept in _slots, or null.
+    const LocalVariables* _vars;
+
+    std::vector<Slot> _slots;
+
 };
 
 /// Declare a local variable in this CallFrame
@@ -143,6 +211,13 @@ void declareLocal(CallFrame& c, const ObjectURI& name);
 /// @param val  The value to set the variable to.
 void setLocal(CallFrame& c, const ObjectURI& name, const as_value& val);
 
+/// Get the slot of a local variable of this CallFrame, if it has one.
+//
+/// The variable may not be declared yet.
+//
+/// @return     The slot, or -1 if the variable is not kept in a slot.
+int findSlot(CallFrame& c, const ObjectURI& name);
+
 typedef std::vector<CallFrame> CallStack;
 
 std::ostream& operator<<(std::ostream& o, const CallFrame& fr);
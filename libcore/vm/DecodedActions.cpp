@@ -0,0 +1,254 @@
+// DecodedActions.cpp: pre-decoded form of an action_buffer, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "DecodedActions.h"
+
+#include <string>
+#include <algorithm>
+
+#include "action_buffer.h"
+#include "ASHandlers.h"
+#include "LocalVariables.h"
+#include "GnashException.h"
+#include "log.h"
+
+namespace gnash {
+
+DecodedActions::DecodedActions(const action_buffer& code)
+{
+    const SWF::SWFHandlers& ash = SWF::SWFHandlers::instance();
+
+    // Position of the first operand of each action in _operands; pointers
+    // can only be taken once the vector stops growing.
+    std::vector<size_t> firstOperand;
+
+    const size_t size = code.size();
+    size_t pc = 0;
+
+    while (pc < size) {
+
+        const std::uint8_t id = code[pc];
+        size_t next = pc + 1;
+
+        if (id & 0x80) {
+            // A tag length that cannot be read or that overflows the
+            // buffer leaves the rest of it to the byte interpreter.
+            if (pc + 2 >= size) break;
+            next = pc + 3 + code.read_uint16(pc + 1);
+            if (next > size) break;
+        }
+
+        DecodedAction act;
+        act.id = static_cast<SWF::ActionType>(id);
+        act.pc = pc;
+        act.nextPC = next;
+        act.handler = &ash[act.id];
+        act.operand = 0;
+        act.operands = nullptr;
+        act.operandCount = 0;
+        act.decodedOperands = false;
+        act.cache = nullptr;
+
+        const size_t first = _operands.size();
+
+        try {
+            switch (id) {
+                case SWF::ACTION_BRANCHALWAYS:
+                case SWF::ACTION_BRANCHIFTRUE:
+                    act.operand = code.read_int16(pc + 3);
+                    break;
+                case SWF::ACTION_SETREGISTER:
+                    act.operand = code[pc + 3];
+                    break;
+                case SWF::ACTION_GETMEMBER:
+                case SWF::ACTION_SETMEMBER:
+                case SWF::ACTION_CALLMETHOD:
+                    // Pointed to once all caches are allocated.
+                    act.operand = _caches.size();
+                    _caches.push_back(PropertyCache());
+                    break;
+                case SWF::ACTION_PUSHDATA:
+                    act.decodedOperands = decodePush(code, pc);
+                    if (!act.decodedOperands) _operands.resize(first);
+                    act.operandCount = _operands.size() - first;
+                    break;
+                default:
+                    break;
+            }
+        }
+        catch (const ActionParserException&) {
+            // Let the handler find and report the problem.
+            _operands.resize(first);
+            pc = next;
+            continue;
+        }
+
+        _actions.push_back(act);
+        firstOperand.push_back(first);
+
+        pc = next;
+    }
+
+    for (size_t i = 0, e = _actions.size(); i != e; ++i) {
+        DecodedAction& act = _actions[i];
+        if (act.operandCount) act.operands = &_operands[firstOperand[i]];
+        switch (act.id) {
+            case SWF::ACTION_GETMEMBER:
+            case SWF::ACTION_SETMEMBER:
+            case SWF::ACTION_CALLMETHOD:
+                act.cache = &_caches[act.operand];
+                act.operand = 0;
+                break;
+            default:
+                break;
+        }
+    }
+
+    IF_VERBOSE_PARSE(
+        log_parse(_("Decoded %d actions (%d push operands) from a %d bytes "
+                "action buffer"), _actions.size(), _operands.size(), size);
+    );
+}
+
+DecodedActions::~DecodedActions()
+{
+}
+
+const DecodedAction*
+DecodedActions::find(size_t pc) const
+{
+    std::vector<DecodedAction>::const_iterator it = std::lower_bound(
+            _actions.begin(), _actions.end(), pc,
+            [](const DecodedAction& act, size_t pc) { return act.pc < pc; });
+    if (it == _actions.end() || it->pc != pc) return nullptr;
+    return &*it;
+}
+
+const LocalVariables&
+DecodedActions::localVariables(size_t start, size_t end,
+        const ConstantPool* pool, const std::vector<ObjectURI>& names,
+        string_table& st, bool caseless) const
+{
+    std::unique_ptr<const LocalVariables>& vars = _localVariables[start];
+    if (!vars) {
+        vars.reset(new LocalVariables(*this, start, end, pool, names, st,
+                    caseless));
+    }
+    return *vars;
+}
+
+bool
+DecodedActions::decodePush(const action_buffer& code, size_t pc)
+{
+    // This must stay in sync with ActionPushData.
+    const std::uint16_t length = code.read_uint16(pc + 1);
+
+    size_t i = pc;
+    while (i - pc < length) {
+
+        const std::uint8_t type = code[3 + i];
+        ++i;
+
+        PushOperand op;
+        op.kind = PushOperand::LITERAL;
+        op.type = type;
+        op.index = 0;
+
+        switch (type) {
+
+            default:
+                // Unknown push type: the handler will report it.
+                return false;
+
+            case 0: // string
+            {
+                const std::string str(code.read_string(i + 3));
+                i += str.size() + 1;
+                op.value = as_value(str);
+                break;
+            }
+
+            case 1: // float
+            {
+                const float f = code.read_float_little(i + 3);
+                i += 4;
+                op.value = as_value(static_cast<double>(f));
+                break;
+            }
+
+            case 2: // null
+                op.value.set_null();
+                break;
+
+            case 3: // undefined
+                break;
+
+            case 4: // register
+                op.kind = PushOperand::REGISTER;
+                op.index = code[3 + i];
+                ++i;
+                break;
+
+            case 5: // bool
+            {
+                const bool b = code[i + 3];
+                ++i;
+                op.value = as_value(b);
+                break;
+            }
+
+            case 6: // double
+            {
+                const double d = code.read_double_wacky(i + 3);
+                i += 8;
+                op.value = as_value(d);
+                break;
+            }
+
+            case 7: // int
+            {
+                const std::int32_t val = code.read_int32(i + 3);
+                i += 4;
+                op.value = as_value(static_cast<double>(val));
+                break;
+            }
+
+            case 8: // dict8
+                op.kind = PushOperand::DICTIONARY;
+                op.index = code[3 + i];
+                ++i;
+                break;
+
+            case 9: // dict16
+                op.kind = PushOperand::DICTIONARY;
+                op.index = code.read_uint16(i + 3);
+                i += 2;
+                break;
+        }
+
+        _operands.push_back(op);
+    }
+    return true;
+}
+
+} // namespace gnash
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
@@ -0,0 +1,188 @@
+// DecodedActions.h: pre-decoded form of an action_buffer, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_DECODEDACTIONS_H
+#define GNASH_DECODEDACTIONS_H
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstdint>
+#include <boost/noncopyable.hpp>
+
+#include "SWF.h"
+#include "as_value.h"
+#include "PropertyCache.h"
+#include "ConstantPool.h"
+#include "ObjectURI.h"
+
+// Forward declarations
+namespace gnash {
+    class action_buffer;
+    class LocalVariables;
+    namespace SWF {
+        class ActionHandler;
+    }
+}
+
+namespace gnash {
+
+/// An operand of an ActionPush tag, decoded once.
+struct PushOperand
+{
+    enum Kind {
+        /// A literal value, pushed as it is.
+        LITERAL,
+        /// A register, read at execution time.
+        REGISTER,
+        /// A constant pool entry, looked up at execution time.
+        DICTIONARY
+    };
+
+    Kind kind;
+
+    /// The SWF push type, only used for verbose action logging.
+    std::uint8_t type;
+
+    /// Register number or constant pool index.
+    std::uint16_t index;
+
+    /// The value of a LITERAL operand.
+    as_value value;
+};
+
+/// An action tag decoded once from an action_buffer.
+//
+/// The interpreter loop in ActionExec uses these to avoid reparsing
+/// the opcode, the tag length and the most common operands every
+/// time an action is executed.
+struct DecodedAction
+{
+    /// The action opcode.
+    SWF::ActionType id;
+
+    /// Offset of the action in its action_buffer.
+    std::uint32_t pc;
+
+    /// Offset of the action following this one.
+    std::uint32_t nextPC;
+
+    /// The handler executing this action, resolved at decoding time.
+    const SWF::ActionHandler* handler;
+
+    /// The branch offset of ActionBranchAlways and ActionBranchIfTrue or
+    /// the register number of ActionSetRegister.
+    std::int32_t operand;
+
+    /// The operands of an ActionPush.
+    //
+    /// Only valid if decodedOperands is true; otherwise the handler
+    /// must parse the raw tag (which contains unknown push types).
+    const PushOperand* operands;
+
+    /// The number of ActionPush operands.
+    std::uint32_t operandCount;
+
+    /// Whether the operands of this action were decoded.
+    bool decodedOperands;
+
+    /// The property lookup cache of GetMember, SetMember and CallMethod.
+    PropertyCache* cache;
+};
+
+/// The pre-decoded form of an action_buffer
+//
+/// The buffer is decoded linearly, once, from its first byte. Actions are
+/// then found by their offset, so that jumps and calls into function
+/// bodies need no further parsing.
+//
+/// Offsets that are not the start of a decoded action (jumps into the
+/// middle of a tag in obfuscated SWFs, or anything following a tag whose
+/// length overflows the buffer) have no DecodedAction; ActionExec falls
+/// back to parsing the raw bytes for them.
+class DecodedActions : boost::noncopyable
+{
+public:
+
+    /// Decode the given action_buffer.
+    explicit DecodedActions(const action_buffer& code);
+
+    ~DecodedActions();
+
+    /// Return the action starting at the given offset, or 0 if there is none.
+    //
+    /// @param prev     The action run before, if any. When the offset
+    ///                 follows it, as it does unless control jumped, the
+    ///                 action is found without a search.
+    const DecodedAction* at(size_t pc,
+            const DecodedAction* prev = nullptr) const {
+        if (prev && prev->nextPC == pc) {
+            const DecodedAction* next = prev + 1;
+            if (next == _actions.data() + _actions.size()) return nullptr;
+            return next->pc == pc ? next : nullptr;
+        }
+        return find(pc);
+    }
+
+    /// Return the number of decoded actions.
+    size_t size() const {
+        return _actions.size();
+    }
+
+    /// Return the local variables of the function body between start and end
+    //
+    /// The body is scanned on the first call for a given start and the
+    /// result kept; see LocalVariables for the other arguments.
+    const LocalVariables& localVariables(size_t start, size_t end,
+            const ConstantPool* pool, const std::vector<ObjectURI>& names,
+            string_table& st, bool caseless) const;
+
+private:
+
+    /// Search the action starting at the given offset.
+    const DecodedAction* find(size_t pc) const;
+
+    /// Decode the operands of the ActionPush tag at the given offset.
+    //
+    /// @return     false if the operands could not be decoded.
+    bool decodePush(const action_buffer& code, size_t pc);
+
+    /// All actions decoded, in buffer order, so sorted by offset.
+    std::vector<DecodedAction> _actions;
+
+    /// The operands of all ActionPush tags.
+    std::vector<PushOperand> _operands;
+
+    /// The property lookup caches of all actions having one.
+    std::vector<PropertyCache> _caches;
+
+    /// The local variables of function bodies, by start offset.
+    typedef std::map<size_t, std::unique_ptr<const LocalVariables> >
+        LocalVariablesMap;
+    mutable LocalVariablesMap _localVariables;
+
+};
+
+} // namespace gnash
+
+#endif
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
@@ -0,0 +1,60 @@
+// ExecutableCode.cpp: code queued for execution, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "ExecutableCode.h"
+
+#include "SlabAllocator.h"
+
+namespace gnash {
+
+namespace {
+
+/// The pool of queued code.
+//
+/// It is never destroyed, as code may be freed by static destructors.
+SlabAllocator&
+pool()
+{
+    static SlabAllocator* p = new SlabAllocator;
+    return *p;
+}
+
+}
+
+void*
+ExecutableCode::operator new(std::size_t size)
+{
+    return pool().allocate(size);
+}
+
+void
+ExecutableCode::operator delete(void* p, std::size_t size)
+{
+    pool().deallocate(p, size);
+}
+
+} // namespace gnash
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
@@ -21,22 +21,35 @@
 #define GNASH_EXECUTABLECODE_H
 
 #include <vector>
+#include <cstddef>
 #include <boost/noncopyable.hpp>
 
 #include "ActionExec.h"
 #include "Global_as.h"
 #include "fn_call.h"
 #include "ConstantPool.h"
+#include "DisplayObject.h"
 
 namespace gnash {
 
 /// Any executable code 
+//
+/// Code is queued for every frame action, event and construction, so
+/// it is allocated from a pool of its own rather than from the free
+/// store. Freed blocks are reused by the code queued next, so a movie
+/// queuing the same code every frame allocates no memory for it.
 class ExecutableCode : boost::noncopyable
 {
 public:
 
     ExecutableCode(DisplayObject* t) : _target(t) {}
 
+    /// Allocate code from the pool.
+    static void* operator new(std::size_t size);
+
+    /// Return code to the pool.
+    static void operator delete(void* p, std::size_t size);
+
     virtual void execute() = 0;
 
     virtual ~ExecutableCode() {}
@@ -0,0 +1,441 @@
+// LocalVariables.cpp: local variables of a function kept in slots, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "LocalVariables.h"
+
+#include <string>
+#include <limits>
+
+#include "DecodedActions.h"
+#include "string_table.h"
+#include "as_value.h"
+#include "log.h"
+
+namespace gnash {
+
+namespace {
+
+/// What the scan knows of a value on the stack.
+struct Operand
+{
+    Operand() : known(false) {}
+
+    explicit Operand(as_value v) : known(true), value(std::move(v)) {}
+
+    bool known;
+    as_value value;
+};
+
+/// The stack as far as the scan can follow it.
+//
+/// Values below those it has seen pushed are unknown.
+class OperandStack
+{
+public:
+
+    void push(Operand op = Operand()) {
+        _ops.push_back(std::move(op));
+    }
+
+    Operand pop() {
+        if (_ops.empty()) return Operand();
+        Operand op = std::move(_ops.back());
+        _ops.pop_back();
+        return op;
+    }
+
+    void drop(size_t n) {
+        _ops.resize(n < _ops.size() ? _ops.size() - n : 0);
+    }
+
+    /// Pop a count, as used by calls and initializers.
+    //
+    /// @return     The count, or -1 if it is not a known number.
+    int popCount() {
+        const Operand op = pop();
+        if (!op.known || !op.value.is_number()) return -1;
+        const double d = op.value.to_number(7);
+        if (!(d >= 0 && d <= 0xffff)) return -1;
+        return static_cast<int>(d);
+    }
+
+    /// Forget everything, as after an action whose effect is not known.
+    void clear() {
+        _ops.clear();
+    }
+
+private:
+    std::vector<Operand> _ops;
+};
+
+/// Whether a constant names a plain variable rather than a path.
+bool
+plainName(const Operand& op)
+{
+    if (!op.known || !op.value.is_string()) return false;
+    const std::string& s = op.value.getSharedString().str();
+    return !s.empty() && s.find_first_of(":/.") == std::string::npos;
+}
+
+/// The name of a variable given by a plain name constant.
+ObjectURI
+nameOf(const Operand& op, string_table& st)
+{
+    return ObjectURI(static_cast<NSV::NamedStrings>(
+                op.value.getSharedString().key(st)));
+}
+
+/// Apply the effect on the stack of an action that only pops and pushes
+/// a fixed number of values.
+//
+/// @return     false if the effect of the action is not fixed.
+bool
+simpleEffect(SWF::ActionType id, OperandStack& stack)
+{
+    size_t pops, pushes;
+
+    switch (id) {
+        case SWF::ACTION_ADD:
+        case SWF::ACTION_SUBTRACT:
+        case SWF::ACTION_MULTIPLY:
+        case SWF::ACTION_DIVIDE:
+        case SWF::ACTION_EQUAL:
+        case SWF::ACTION_LESSTHAN:
+        case SWF::ACTION_LOGICALAND:
+        case SWF::ACTION_LOGICALOR:
+        case SWF::ACTION_STRINGEQ:
+        case SWF::ACTION_STRINGCONCAT:
+        case SWF::ACTION_GETPROPERTY:
+        case SWF::ACTION_STRINGCOMPARE:
+        case SWF::ACTION_CASTOP:
+        case SWF::ACTION_DELETE:
+        case SWF::ACTION_MODULO:
+        case SWF::ACTION_NEWADD:
+        case SWF::ACTION_NEWLESSTHAN:
+        case SWF::ACTION_NEWEQUALS:
+        case SWF::ACTION_GETMEMBER:
+        case SWF::ACTION_INSTANCEOF:
+        case SWF::ACTION_BITWISEAND:
+        case SWF::ACTION_BITWISEOR:
+        case SWF::ACTION_BITWISEXOR:
+        case SWF::ACTION_SHIFTLEFT:
+        case SWF::ACTION_SHIFTRIGHT:
+        case SWF::ACTION_SHIFTRIGHT2:
+        case SWF::ACTION_STRICTEQ:
+        case SWF::ACTION_GREATER:
+        case SWF::ACTION_STRINGGREATER:
+            pops = 2;
+            pushes = 1;
+            break;
+        case SWF::ACTION_LOGICALNOT:
+        case SWF::ACTION_STRINGLENGTH:
+        case SWF::ACTION_INT:
+        case SWF::ACTION_RANDOM:
+        case SWF::ACTION_MBLENGTH:
+        case SWF::ACTION_ORD:
+        case SWF::ACTION_CHR:
+        case SWF::ACTION_MBORD:
+        case SWF::ACTION_MBCHR:
+        case SWF::ACTION_DELETE2:
+        case SWF::ACTION_TYPEOF:
+        case SWF::ACTION_TARGETPATH:
+        case SWF::ACTION_TONUMBER:
+        case SWF::ACTION_TOSTRING:
+        case SWF::ACTION_INCREMENT:
+        case SWF::ACTION_DECREMENT:
+            pops = 1;
+            pushes = 1;
+            break;
+        case SWF::ACTION_SUBSTRING:
+        case SWF::ACTION_MBSUBSTRING:
+            pops = 3;
+            pushes = 1;
+            break;
+        case SWF::ACTION_GETTIMER:
+            pops = 0;
+            pushes = 1;
+            break;
+        case SWF::ACTION_POP:
+        case SWF::ACTION_TRACE:
+        case SWF::ACTION_SETTARGETEXPRESSION:
+        case SWF::ACTION_REMOVECLIP:
+        case SWF::ACTION_BRANCHIFTRUE:
+            pops = 1;
+            pushes = 0;
+            break;
+        case SWF::ACTION_EXTENDS:
+            pops = 2;
+            pushes = 0;
+            break;
+        case SWF::ACTION_SETPROPERTY:
+        case SWF::ACTION_SETMEMBER:
+            pops = 3;
+            pushes = 0;
+            break;
+        case SWF::ACTION_NEXTFRAME:
+        case SWF::ACTION_PREVFRAME:
+        case SWF::ACTION_PLAY:
+        case SWF::ACTION_STOP:
+        case SWF::ACTION_TOGGLEQUALITY:
+        case SWF::ACTION_STOPSOUNDS:
+        case SWF::ACTION_GOTOFRAME:
+        case SWF::ACTION_GETURL:
+        case SWF::ACTION_SETTARGET:
+        case SWF::ACTION_GOTOLABEL:
+        case SWF::ACTION_STRICTMODE:
+        case SWF::ACTION_SETREGISTER:
+            pops = 0;
+            pushes = 0;
+            break;
+        default:
+            return false;
+    }
+
+    stack.drop(pops);
+    for (size_t i = 0; i < pushes; ++i) stack.push();
+    return true;
+}
+
+}
+
+LocalVariables::LocalVariables(const DecodedActions& actions, size_t start,
+        size_t end, const ConstantPool* pool,
+        const std::vector<ObjectURI>& names, string_table& st, bool caseless)
+    :
+    _enabled(false),
+    _start(start),
+    _actionSlots(end - start, -1)
+{
+    // Find the branch targets, where the stack is not known, and check
+    // that nothing can make the activation object reachable.
+    std::vector<bool> targets(end - start, false);
+
+    const DecodedAction* act = nullptr;
+    for (size_t pc = start; pc < end; ) {
+        act = actions.at(pc, act);
+        if (!act || act->nextPC > end) return;
+
+        switch (act->id) {
+            case SWF::ACTION_WITH:
+            case SWF::ACTION_DEFINEFUNCTION:
+            case SWF::ACTION_DEFINEFUNCTION2:
+                return;
+            case SWF::ACTION_BRANCHALWAYS:
+            case SWF::ACTION_BRANCHIFTRUE:
+            {
+                const long target = static_cast<long>(act->nextPC) +
+                    act->operand;
+                if (target >= static_cast<long>(start) &&
+                        target < static_cast<long>(end)) {
+                    targets[target - start] = true;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        pc = act->nextPC;
+    }
+
+    _enabled = true;
+
+    for (const ObjectURI& name : names) declare(name, st, caseless);
+
+    std::vector<std::pair<size_t, ObjectURI> > uses;
+    OperandStack stack;
+
+    const DecodedAction* prev = nullptr;
+    for (size_t pc = start; pc < end; ) {
+
+        const DecodedAction& act = *actions.at(pc, prev);
+        prev = &act;
+        if (targets[pc - start]) stack.clear();
+
+        Operand name;
+
+        switch (act.id) {
+
+            case SWF::ACTION_PUSHDATA:
+                if (!act.decodedOperands) {
+                    stack.clear();
+                    break;
+                }
+                for (size_t i = 0; i < act.operandCount; ++i) {
+                    const PushOperand& op = act.operands[i];
+                    if (op.kind == PushOperand::LITERAL) {
+                        stack.push(Operand(op.value));
+                    }
+                    else if (op.kind == PushOperand::DICTIONARY && pool &&
+                            op.index < pool->size()) {
+                        as_value v;
+                        v.set_string((*pool)[op.index]);
+                        stack.push(Operand(v));
+                    }
+                    else stack.push();
+                }
+                break;
+
+            case SWF::ACTION_CONSTANTPOOL:
+                // The rest of the body uses a pool we do not know.
+                pool = nullptr;
+                break;
+
+            case SWF::ACTION_DUP:
+            {
+                Operand op = stack.pop();
+                stack.push(op);
+                stack.push(op);
+                break;
+            }
+
+            case SWF::ACTION_SWAP:
+            {
+                Operand a = stack.pop();
+                Operand b = stack.pop();
+                stack.push(a);
+                stack.push(b);
+                break;
+            }
+
+            case SWF::ACTION_GETVARIABLE:
+                name = stack.pop();
+                stack.push();
+                break;
+
+            case SWF::ACTION_SETVARIABLE:
+                stack.pop();
+                name = stack.pop();
+                break;
+
+            case SWF::ACTION_VAREQUALS:
+                stack.pop();
+                name = stack.pop();
+                if (plainName(name)) {
+                    declare(nameOf(name, st), st, caseless);
+                }
+                break;
+
+            case SWF::ACTION_VAR:
+                name = stack.pop();
+                if (plainName(name)) {
+                    declare(nameOf(name, st), st, caseless);
+                }
+                break;
+
+            case SWF::ACTION_CALLFUNCTION:
+            case SWF::ACTION_NEW:
+            {
+                stack.pop();
+                const int nargs = stack.popCount();
+                if (nargs < 0) stack.clear();
+                else stack.drop(nargs);
+                stack.push();
+                break;
+            }
+
+            case SWF::ACTION_CALLMETHOD:
+            case SWF::ACTION_NEWMETHOD:
+            {
+                stack.drop(2);
+                const int nargs = stack.popCount();
+                if (nargs < 0) stack.clear();
+                else stack.drop(nargs);
+                stack.push();
+                break;
+            }
+
+            case SWF::ACTION_INITARRAY:
+            case SWF::ACTION_INITOBJECT:
+            {
+                const int n = stack.popCount();
+                if (n < 0) stack.clear();
+                else stack.drop(act.id == SWF::ACTION_INITOBJECT ? n * 2 : n);
+                stack.push();
+                break;
+            }
+
+            default:
+                if (!simpleEffect(act.id, stack)) stack.clear();
+                break;
+        }
+
+        if (plainName(name)) uses.emplace_back(pc, nameOf(name, st));
+
+        switch (act.id) {
+            case SWF::ACTION_BRANCHALWAYS:
+            case SWF::ACTION_RETURN:
+            case SWF::ACTION_THROW:
+                // The next action is only reached by a branch.
+                stack.clear();
+                break;
+            default:
+                break;
+        }
+
+        pc = act.nextPC;
+    }
+
+    // Only now are all declared variables known.
+    for (const auto& use : uses) {
+        const int slot = find(use.second, st, caseless);
+        if (slot >= 0) _actionSlots[use.first - start] = slot;
+    }
+
+    IF_VERBOSE_ACTION(
+        log_action(_("Function at PC %d keeps %d local variables in slots"),
+            start, _names.size());
+    );
+}
+
+int
+LocalVariables::find(const ObjectURI& name, string_table& st,
+        bool caseless) const
+{
+    const ObjectURI::CaseEquals eq(st, caseless);
+    for (size_t i = 0, e = _names.size(); i != e; ++i) {
+        if (eq(_names[i], name)) return i;
+    }
+    return -1;
+}
+
+int
+LocalVariables::declare(const ObjectURI& name, string_table& st,
+        bool caseless)
+{
+    const int slot = find(name, st, caseless);
+    if (slot >= 0) return slot;
+
+    // A name that parses as a path is never looked up as a variable.
+    const std::string& s = name.toString(st);
+    if (s.empty() || s.find_first_of(":/.") != std::string::npos) return -1;
+
+    // Slot numbers must fit in _actionSlots.
+    if (_names.size() >= static_cast<size_t>(
+                std::numeric_limits<std::int16_t>::max())) {
+        return -1;
+    }
+    _names.push_back(name);
+    return _names.size() - 1;
+}
+
+} // namespace gnash
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
@@ -0,0 +1,121 @@
+// LocalVariables.h: local variables of a function kept in slots, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_LOCALVARIABLES_H
+#define GNASH_LOCALVARIABLES_H
+
+#include <vector>
+#include <cstdint>
+#include <boost/noncopyable.hpp>
+
+#include "ConstantPool.h"
+#include "ObjectURI.h"
+
+// Forward declarations
+namespace gnash {
+    class DecodedActions;
+    class string_table;
+}
+
+namespace gnash {
+
+/// The local variables of a function body that its CallFrames keep in slots
+//
+/// The local variables of a function call are normally properties of its
+/// activation object, so each access by name is a property lookup after
+/// walking the scope stack. A function body that defines no other
+/// function and has no 'with' block cannot make its activation object
+/// reachable by anything but name lookups. Such a body is scanned once
+/// and each variable it declares, by DefineLocal, DefineLocal2 or as an
+/// argument, is given a slot in the CallFrame instead.
+//
+/// Every lookup of a local variable by name finds it in its slot, so
+/// this does not depend on the scan finding every access. It only serves
+/// to let GetVariable, SetVariable, DefineLocal and DefineLocal2 actions
+/// whose name is a constant go to the slot without a lookup.
+class LocalVariables : boost::noncopyable
+{
+public:
+
+    /// Scan the function body between start and end.
+    //
+    /// @param actions  The decoded actions of the body's action_buffer.
+    /// @param pool     The ConstantPool in effect when the function was
+    ///                 defined, or null.
+    /// @param names    The variables declared on every call, such as the
+    ///                 arguments.
+    /// @param caseless Whether names differing only in case are the same.
+    LocalVariables(const DecodedActions& actions, size_t start, size_t end,
+            const ConstantPool* pool, const std::vector<ObjectURI>& names,
+            string_table& st, bool caseless);
+
+    /// Whether the body can keep its variables in slots.
+    bool enabled() const {
+        return _enabled;
+    }
+
+    /// The number of slots.
+    size_t size() const {
+        return _names.size();
+    }
+
+    /// The name of a slot.
+    const ObjectURI& name(size_t slot) const {
+        return _names[slot];
+    }
+
+    /// Find the slot of a variable.
+    //
+    /// @return     The slot, or -1 if the variable has none.
+    int find(const ObjectURI& name, string_table& st, bool caseless) const;
+
+    /// The slot of the variable named by the action at the given offset.
+    //
+    /// @return     The slot, or -1 if the scan found none. The action must
+    ///             still check that it finds name(slot) on the stack.
+    int slotAt(size_t pc) const {
+        if (pc < _start || pc - _start >= _actionSlots.size()) return -1;
+        return _actionSlots[pc - _start];
+    }
+
+private:
+
+    /// Give a slot to a declared variable, unless it has one.
+    //
+    /// @return     The slot, or -1 if the name cannot have one.
+    int declare(const ObjectURI& name, string_table& st, bool caseless);
+
+    bool _enabled;
+
+    size_t _start;
+
+    std::vector<ObjectURI> _names;
+
+    /// The slot used by the action at each offset from _start, or -1.
+    std::vector<std::int16_t> _actionSlots;
+
+};
+
+} // namespace gnash
+
+#endif
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
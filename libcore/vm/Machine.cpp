@@ -32,6 +32,9 @@
 #include "Class.h"
 #include "CodeStream.h"
 #include "SWF.h"
+#include "as_class.h"
+#include "Property.h"
+#include "PropertyCache.h"
 
 namespace gnash {
 namespace abc {
@@ -322,6 +325,36 @@ private:
     VM::AVMVersion _ver;
 };
 
+/// Whether log_abc() prints anything.
+//
+/// Formatting a stack for it is costly, and it is done on every lookup.
+inline bool
+abcLogging()
+{
+    return LogFile::getDefaultInstance().getVerbosity() >= LogFile::LOG_EXTRA;
+}
+
+/// The name of a slot of an object, or 0 if its class has no such slot.
+//
+/// A Class object has the static slots of its Class; other objects have
+/// the instance slots of the first Class on their prototype chain.
+const ObjectURI*
+slotName(as_object& obj, std::uint32_t slot)
+{
+    if (const as_class* c = dynamic_cast<as_class*>(&obj)) {
+        return c->getClass()->staticSlotName(slot);
+    }
+
+    as_object* proto = obj.get_prototype();
+    for (size_t i = 0; proto && i < PropertyCache::maxDepth; ++i) {
+        if (const as_class* c = dynamic_cast<as_class*>(proto)) {
+            return c->getClass()->slotName(slot);
+        }
+        proto = proto->get_prototype();
+    }
+    return 0;
+}
+
 }
 
 Machine::Machine(VM& vm)
@@ -387,7 +420,7 @@ Machine::execute()
     assert(mStream);
 
 	for (;;) {
-		std::size_t opStart = mStream->tellg();
+		std::size_t opStart = mStream->tell();
         
         try {
 
@@ -862,7 +895,7 @@ Machine::execute()
                 /// position on op entry.
                 case SWF::ABC_ACTION_LOOKUPSWITCH:
                 {
-                    std::size_t npos = mStream->tellg();
+                    std::size_t npos = mStream->tell();
                     if (!_stack.top(0).is_number()) throw ASException();
 
                     std::uint32_t index =
@@ -1441,8 +1474,13 @@ Machine::execute()
                     }
                     else {
 
-                        as_value property =
-                            getMember(*object, a.getGlobalName());
+                        const string_table::key ns = a.getNamespace() ?
+                            a.getNamespace()->getURI() : 0;
+
+                        as_value property;
+                        object->getCachedMember(
+                                ObjectURI(a.getGlobalName(), ns), &property,
+                                _propertyCaches[mStream->position()]);
                     
                         if (!property.is_undefined() && !property.is_null()) {
                             log_abc("Calling method %s on object %s",
@@ -1993,7 +2031,8 @@ Machine::execute()
                     as_value prop;
                     
                     const ObjectURI uri(name, ns);
-                    const bool found = object->get_member(uri, &prop);
+                    const bool found = object->getCachedMember(uri, &prop,
+                            _propertyCaches[mStream->position()]);
                     if (!found) {
                         log_abc("GETPROPERTY: property %s not found",
                                 mST.value(name));
@@ -2087,10 +2126,19 @@ Machine::execute()
                         break;
                     } 
 
-                    object->get_member_slot(sindex + 1, &val);
+                    // Slot ids are laid out by the traits of the Class,
+                    // so they map straight to a name.
+                    const ObjectURI* name = slotName(*object, sindex);
+                    if (!name) {
+                        log_abc("GETSLOT: object %s has no slot %u",
+                                as_value(object), sindex);
+                    }
+                    else {
+                        object->getCachedMember(*name, &val,
+                                _propertyCaches[mStream->position()]);
+                    }
 
-                    log_abc("object has value %s at real_slot=%u abc_slot=%u",
-                            val, sindex + 1, sindex);
+                    log_abc("object has value %s at slot %u", val, sindex);
                     push_stack(val);
                     
                     break;
@@ -2125,18 +2173,15 @@ Machine::execute()
                         break;
                     }
 
-                    // We use sindex + 1, because currently as_object sets
-                    // a property at a slot index 1 higher than the
-                    // index the AbcBlock thinks the property is at.
-                    if ( ! obj->set_member_slot(sindex+1, value) )
+                    const ObjectURI* name = slotName(*obj, sindex);
+                    if (!name || !obj->setCachedMember(*name, value,
+                                _propertyCaches[mStream->position()]))
                     {
-                        log_abc("Failed to set property at "
-                                "real_slot=%u abc_slot=%u", sindex+1, sindex);
+                        log_abc("Failed to set property at slot %u", sindex);
                     }
                     else
                     {
-                        log_abc("Set property at real_slot=%u abc_slot=%u",
-                                sindex+1, sindex);
+                        log_abc("Set property at slot %u", sindex);
                     }
 
                     break;
@@ -3272,12 +3317,14 @@ Machine::instantiateClass(std::string className, as_object* /*global*/)
 }
 
 as_value
-Machine::find_prop_strict(MultiName multiname)
+Machine::find_prop_strict(const MultiName& multiname)
 {
 	
-    log_abc("Looking for property %2% in namespace %1%",
-            mST.value(multiname.getNamespace()->getURI()),
-            mST.value(multiname.getGlobalName()));
+    if (abcLogging()) {
+        log_abc("Looking for property %2% in namespace %1%",
+                mST.value(multiname.getNamespace()->getURI()),
+                mST.value(multiname.getGlobalName()));
+    }
 
     // We should not push anything onto the scope stack here; whatever is
     // needed should already be pushed. The pp will not call FINDPROP*
@@ -3289,8 +3336,16 @@ Machine::find_prop_strict(MultiName multiname)
     print_scope_stack();
     const string_table::key var = multiname.getGlobalName();
     const string_table::key ns = multiname.getNamespace()->getURI();
+    const ObjectURI uri(var, ns);
+
+    // Each instruction remembers what it found in each scope, so that
+    // looking again through the same, unchanged, scopes costs a version
+    // comparison per scope object.
+    ScopeCaches& caches = _scopeCaches[mStream->position()];
+    const size_t scopes = _scopeStack.totalSize();
+    if (caches.size() < scopes) caches.resize(scopes);
 
-	for (size_t i = 0; i < _scopeStack.totalSize(); ++i)
+	for (size_t i = 0; i < scopes; ++i)
     {
 		as_object* scope_object = _scopeStack.at(i);
 		if (!scope_object) {
@@ -3298,7 +3353,16 @@ Machine::find_prop_strict(MultiName multiname)
 			continue;
 		}
         
-        if (scope_object->get_member(ObjectURI(var, ns), &val)) {
+        Property* prop;
+        if (caches[i].lookup(*scope_object, uri, getSWFVersion(*scope_object),
+                    prop)) {
+            if (!prop) continue;
+            val = prop->getValue(*scope_object);
+            push_stack(scope_object);
+            return val;
+        }
+
+        if (scope_object->get_member(uri, &val)) {
             push_stack(_scopeStack.at(i));
 			return val;
 		}
@@ -3314,6 +3378,7 @@ Machine::find_prop_strict(MultiName multiname)
 void
 Machine::print_stack()
 {
+    if (!abcLogging()) return;
 
 	std::stringstream ss;
 	ss << "Stack: ";
@@ -3327,6 +3392,7 @@ Machine::print_stack()
 void
 Machine::print_scope_stack()
 {
+    if (!abcLogging()) return;
 
 	std::stringstream ss;
 	ss << "ScopeStack: ";
@@ -3342,7 +3408,7 @@ Machine::print_scope_stack()
 void
 Machine::get_args(size_t argc, fn_call::Args& args)
 {
-    std::vector<as_value> v(argc);
+    fn_call::Args::container_type v(argc);
 	for (size_t i = argc; i > 0; --i) {
 		v.at(i-1) = pop_stack();
 	}
@@ -22,8 +22,11 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <cstdint>
 #include "SafeStack.h"
 #include "as_value.h"
+#include "PropertyCache.h"
 #include "log.h"
 
 namespace gnash {
@@ -292,7 +295,7 @@ private:
 	void saveState();
 	void restoreState();
 
-	as_value find_prop_strict(MultiName multiname);
+	as_value find_prop_strict(const MultiName& multiname);
 
 	void print_stack();
 
@@ -360,6 +363,18 @@ private:
     /// the section that is not changeable.
 	SafeStack<as_object*> _scopeStack;
 
+    /// The lookups of one FINDPROPSTRICT, FINDPROPERTY or GETLEX.
+    //
+    /// There is a cache for each position on the scope stack, so an entry
+    /// is valid only for the same, unchanged, scope objects.
+    typedef std::vector<PropertyCache> ScopeCaches;
+
+    /// The scope lookup caches of each instruction, by its address.
+    std::unordered_map<const std::uint8_t*, ScopeCaches> _scopeCaches;
+
+    /// The property caches of slot and property accesses, by address.
+    std::unordered_map<const std::uint8_t*, PropertyCache> _propertyCaches;
+
     CodeStream *mStream;
 
 	string_table& mST;
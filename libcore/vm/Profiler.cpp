@@ -0,0 +1,191 @@
+// Profiler.cpp: sampling profiler for ActionScript, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "Profiler.h"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#ifdef HAVE_SETITIMER
+# include <sys/time.h>
+#endif
+
+#include "VM.h"
+#include "ActionExec.h"
+#include "Function.h"
+#include "action_buffer.h"
+#include "SWF.h"
+#include "log.h"
+#include "utility.h"
+
+namespace gnash {
+
+namespace {
+
+/// Append a frame to a folded stack.
+void
+addFrame(std::string& line, const std::string& frame)
+{
+    if (!line.empty()) line += ';';
+    const size_t start = line.size();
+    line += frame;
+
+    // Separators and spaces would split the frame.
+    std::replace(line.begin() + start, line.end(), ';', ':');
+    std::replace(line.begin() + start, line.end(), ' ', '_');
+}
+
+/// Whether a Profiler has started the timer.
+bool started = false;
+
+#ifdef HAVE_SETITIMER
+struct sigaction oldAction;
+#endif
+
+}
+
+volatile std::sig_atomic_t Profiler::_due = 0;
+volatile std::sig_atomic_t Profiler::_running = 0;
+
+Profiler::Profiler(std::string path, unsigned long interval)
+    :
+    _path(std::move(path)),
+    _active(false)
+{
+#ifdef HAVE_SETITIMER
+    if (started) {
+        log_error(_("Only one ActionScript profile can be taken at a time"));
+        return;
+    }
+
+    struct sigaction action;
+    action.sa_handler = &Profiler::onTimer;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    if (sigaction(SIGPROF, &action, &oldAction)) {
+        log_error(_("Could not install the ActionScript profiler"));
+        return;
+    }
+
+    struct itimerval timer;
+    timer.it_interval.tv_sec = interval / 1000000;
+    timer.it_interval.tv_usec = interval % 1000000;
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, nullptr)) {
+        log_error(_("Could not start the ActionScript profiler"));
+        sigaction(SIGPROF, &oldAction, nullptr);
+        return;
+    }
+
+    started = true;
+    _active = true;
+    log_debug("Profiling ActionScript every %d microseconds to %s",
+            interval, _path);
+#else
+    UNUSED(interval);
+    log_error(_("ActionScript profiling is not supported on this system"));
+#endif
+}
+
+Profiler::~Profiler()
+{
+    if (!_active) return;
+
+#ifdef HAVE_SETITIMER
+    struct itimerval timer = {};
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    sigaction(SIGPROF, &oldAction, nullptr);
+#endif
+    _due = 0;
+    started = false;
+
+    write();
+}
+
+void
+Profiler::onTimer(int)
+{
+    if (_running) _due = 1;
+}
+
+void
+Profiler::sample(const VM& vm, const ActionExec& exec)
+{
+    _due = 0;
+    if (!_active) return;
+
+    const string_table& st = vm.getStringTable();
+    std::string line;
+
+    const CallStack& calls = vm.getCallStack();
+    for (const CallFrame& frame : calls) {
+        const Function* f = dynamic_cast<const Function*>(&frame.function());
+        if (!f) {
+            addFrame(line, "[native]");
+            continue;
+        }
+        std::ostringstream s;
+        if (f->name()) s << st.value(f->name());
+        else s << "function";
+        s << '@' << f->getActionBuffer().getDefinitionURL() << ':'
+          << f->getStartPC();
+        addFrame(line, s.str());
+    }
+
+    // Frame actions and event handlers, including those run during a
+    // function call.
+    if (!exec.isFunction()) {
+        addFrame(line, exec.code.getDefinitionURL());
+    }
+
+    const size_t pc = exec.getCurrentPC();
+    std::ostringstream s;
+    s << static_cast<SWF::ActionType>(exec.code[pc]);
+    addFrame(line, s.str());
+
+    ++_samples[line];
+}
+
+bool
+Profiler::write() const
+{
+    std::ofstream out(_path.c_str());
+
+    for (const auto& s : _samples) {
+        out << s.first << ' ' << s.second << '\n';
+    }
+
+    if (!out) {
+        log_error(_("Could not write the ActionScript profile to %s"), _path);
+        return false;
+    }
+    log_debug("Wrote %d ActionScript profile stacks to %s",
+            _samples.size(), _path);
+    return true;
+}
+
+} // namespace gnash
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
@@ -0,0 +1,126 @@
+// Profiler.h: sampling profiler for ActionScript, for Gnash.
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef GNASH_PROFILER_H
+#define GNASH_PROFILER_H
+
+#include <map>
+#include <string>
+#include <csignal>
+#include <boost/noncopyable.hpp>
+
+// Forward declarations
+namespace gnash {
+    class ActionExec;
+    class VM;
+}
+
+namespace gnash {
+
+/// Samples the ActionScript being executed
+//
+/// A timer fires every interval of CPU time used by the process. If
+/// actions are being executed, the next action to finish is recorded,
+/// with the functions on the call stack. The samples are written as
+/// folded stacks, one line per distinct stack followed by its number
+/// of samples, as read by flamegraph.pl:
+//
+/// onEnterFrame@file:///movie.swf:1234;update@file:///movie.swf:2345;ActionCallMethod 17
+//
+/// A function is named by its name, if it was defined with one, and the
+/// URL and offset of its code. Actions outside a function are named by
+/// the URL of their movie.
+//
+/// Only one Profiler can be active at a time. When none is, the cost to
+/// the interpreter is a test of sampleDue() after each action.
+class Profiler : boost::noncopyable
+{
+public:
+
+    /// Start sampling.
+    //
+    /// @param path     The file to write the profile to.
+    /// @param interval The interval between samples, in microseconds of
+    ///                 CPU time.
+    Profiler(std::string path, unsigned long interval);
+
+    /// Stop sampling and write the profile.
+    ~Profiler();
+
+    /// Whether a sample should be taken after the current action.
+    static bool sampleDue() {
+        return _due;
+    }
+
+    /// Record the action just executed by an ActionExec.
+    void sample(const VM& vm, const ActionExec& exec);
+
+    /// Write the samples taken so far.
+    //
+    /// @return     false if the file could not be written.
+    bool write() const;
+
+    /// Marks the time spent executing actions
+    //
+    /// The timer is only counted between the construction of the first
+    /// Running object and its destruction, so that the time taken by
+    /// rendering, for instance, is not attributed to the next action.
+    class Running : boost::noncopyable
+    {
+    public:
+        explicit Running(const Profiler* p)
+            :
+            _wasRunning(_running)
+        {
+            if (p) _running = 1;
+        }
+
+        ~Running() {
+            _running = _wasRunning;
+        }
+
+    private:
+        const std::sig_atomic_t _wasRunning;
+    };
+
+private:
+
+    static void onTimer(int);
+
+    static volatile std::sig_atomic_t _due;
+
+    static volatile std::sig_atomic_t _running;
+
+    const std::string _path;
+
+    /// Whether this Profiler started the timer.
+    bool _active;
+
+    /// The number of samples of each folded stack.
+    std::map<std::string, unsigned long> _samples;
+
+};
+
+} // namespace gnash
+
+#endif
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
@@ -43,6 +43,7 @@
 #include "namedStrings.h"
 #include "VirtualClock.h" // for getTime()
 #include "GnashNumeric.h"
+#include "Profiler.h"
 
 namespace {
 gnash::RcInitFile& rcfile = gnash::RcInitFile::getDefaultInstance();
@@ -59,11 +60,18 @@ VM::VM(movie_root& root, VirtualClock& clock)
 	_stack(),
     _shLib(new SharedObjectLibrary(*this)),
     _rng(clock.elapsed()),
-    _constantPool(nullptr)
+    _constantPool(nullptr),
+    _actionsExecuted(0)
 {
 	NSV::loadStrings(_stringTable);
     _global->registerClasses();
 	_clock.restart();
+
+    const std::string& profile = rcfile.getActionProfile();
+    if (!profile.empty()) {
+        const int interval = rcfile.getActionProfileInterval();
+        _profiler.reset(new Profiler(profile, interval > 0 ? interval : 1000));
+    }
 }
 
 VM::~VM()
@@ -377,7 +385,7 @@ newAdd(as_value& op1, const as_value& op2, const VM& vm)
 		// use string semantic
 		const int version = vm.getSWFVersion();
 		convertToString(op1, vm);
-		op1.set_string(op1.to_string(version) + r.to_string(version));
+		op1.set_string(op1.getSharedString() + r.to_shared_string(version));
         return;
 	}
 
@@ -492,7 +500,7 @@ convertToNumber(as_value& v, const VM& vm)
 as_value&
 convertToString(as_value& v, const VM& vm)
 {
-    v.set_string(v.to_string(vm.getSWFVersion()));
+    v.set_string(v.to_shared_string(vm.getSWFVersion()));
     return v;
 }
 
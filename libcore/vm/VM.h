@@ -51,6 +51,7 @@ namespace gnash {
     class as_object;
     class VirtualClock;
     class UserFunction;
+    class Profiler;
 }
 
 namespace gnash {
@@ -241,6 +242,26 @@ public:
         return !_callStack.empty();
     }
 
+    /// The calls in progress, the current one last.
+    const CallStack& getCallStack() const {
+        return _callStack;
+    }
+
+    /// The ActionScript profiler, if profiling is enabled.
+    Profiler* profiler() const {
+        return _profiler.get();
+    }
+
+    /// Count an executed action.
+    void countAction() {
+        ++_actionsExecuted;
+    }
+
+    /// The number of actions executed so far.
+    std::uint64_t actionsExecuted() const {
+        return _actionsExecuted;
+    }
+
     /// Print stack, call stack, and registers to the specified ostream
     void dumpState(std::ostream& o, size_t limit = 0);
 
@@ -281,6 +302,11 @@ private:
     RNG _rng;
 
     const ConstantPool* _constantPool;
+
+    /// Samples ActionScript execution if the rcfile asks for it.
+    std::unique_ptr<Profiler> _profiler;
+
+    std::uint64_t _actionsExecuted;
 };
 
 // @param lowerCaseHint if true the caller guarantees
@@ -295,6 +321,16 @@ getURI(const VM& vm, const std::string& str, bool lowerCaseHint=false)
     return ObjectURI((NSV::NamedStrings)vm.getStringTable().find(str));
 }
 
+/// Get the ObjectURI of a shared string
+//
+/// The string_table key is cached in the string, so only the first
+/// lookup of a given as_string needs hashing.
+inline ObjectURI
+getURI(const VM& vm, const as_string& str)
+{
+    return ObjectURI((NSV::NamedStrings)str.key(vm.getStringTable()));
+}
+
 inline ObjectURI
 getURI(const VM&, NSV::NamedStrings s)
 {
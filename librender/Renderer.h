@@ -142,6 +142,7 @@
 
 
 #include <vector>
+#include <ostream>
 #include <boost/noncopyable.hpp>
 
 #include "dsodefs.h" // for DSOEXPORT
@@ -196,6 +197,11 @@ public:
     /// Return a description of this renderer.
     virtual std::string description() const = 0;
 
+    /// Print statistics about the renderer's work, if it keeps any.
+    //
+    /// These are printed with the frame timings.
+    virtual void summarize(std::ostream& /*o*/) const {}
+
     /// ==================================================================
     /// Interfaces for adjusting renderer output.
     /// ==================================================================
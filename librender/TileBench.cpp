@@ -0,0 +1,215 @@
+// TileBench.cpp: time the AGG renderer drawing frames in tiles
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "Renderer.h"
+#include "agg/Renderer_agg.h"
+#include "ShapeRecord.h"
+#include "FillStyle.h"
+#include "LineStyle.h"
+#include "Geometry.h"
+#include "Transform.h"
+#include "SWFRect.h"
+#include "SWFMatrix.h"
+#include "RGBA.h"
+#include "ClockTime.h"
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
+
+using namespace std;
+using namespace gnash;
+
+// Prints the time taken by the AGG renderer to draw a 1920x1080 frame of
+// overlapping shapes with 1, 2, 4 and 8 threads, and the speedup over one
+// thread. One thread is also timed without the shape cache, which makes
+// it transform every shape each frame. Each frame must come out the same
+// as without the cache.
+//
+// Pass a number to scale the amount of work; the default keeps
+// 'make check' quick.
+
+namespace {
+
+const int width = 1920;
+const int height = 1080;
+
+class Stopwatch
+{
+public:
+    Stopwatch() : _start(clocktime::getTicks()) {}
+    std::uint64_t elapsed() const { return clocktime::getTicks() - _start; }
+private:
+    std::uint64_t _start;
+};
+
+rgba
+randomColor(minstd_rand& r, std::uint8_t minAlpha)
+{
+    return rgba(r() % 256, r() % 256, r() % 256,
+            minAlpha + r() % (256 - minAlpha));
+}
+
+/// A closed curvy star with a solid or gradient fill, and maybe an outline.
+SWF::ShapeRecord
+makeShape(minstd_rand& r)
+{
+    // In twips.
+    const int cx = (r() % width) * 20;
+    const int cy = (r() % height) * 20;
+    const int radius = (20 + r() % 180) * 20;
+    const int points = 5 + r() % 8;
+
+    SWF::Subshape s;
+
+    if (r() % 3) {
+        s.addFillStyle(SolidFill(randomColor(r, 128)));
+    }
+    else {
+        SWFMatrix m;
+        // The gradient square is 32768 twips wide and centered on 0.
+        m.set_scale(2.0 * radius / 32768, 2.0 * radius / 32768);
+        m.set_translation(cx, cy);
+        GradientFill::GradientRecords records;
+        records.push_back(GradientRecord(0, randomColor(r, 128)));
+        records.push_back(GradientRecord(255, randomColor(r, 128)));
+        s.addFillStyle(GradientFill(GradientFill::LINEAR, m, records));
+    }
+
+    int lineWidth = 0;
+    if (r() % 2) {
+        lineWidth = 20 + r() % 80;
+        s.addLineStyle(LineStyle(lineWidth, randomColor(r, 255)));
+    }
+
+    Path p(cx + radius, cy, 0, 1, lineWidth ? 1 : 0);
+    for (int i = 1; i <= points; ++i) {
+        const double control = (i - 0.5) * 2 * M_PI / points;
+        const double anchor = i * 2 * M_PI / points;
+        const double inner = i == points ? radius : radius * 0.6;
+        p.drawCurveTo(cx + radius * 1.2 * std::cos(control),
+                cy + radius * 1.2 * std::sin(control),
+                cx + inner * std::cos(anchor), cy + inner * std::sin(anchor));
+    }
+    p.close();
+    s.addPath(p);
+
+    const int extent = radius * 1.2 + lineWidth;
+
+    SWF::ShapeRecord shape;
+    shape.addSubshape(s);
+    shape.setBounds(SWFRect(cx - extent, cy - extent, cx + extent,
+                cy + extent));
+    return shape;
+}
+
+void
+drawFrame(Renderer& renderer, const vector<SWF::ShapeRecord>& shapes)
+{
+    const Transform xform;
+    Renderer::External ex(renderer, rgba(255, 255, 255, 255));
+    for (const SWF::ShapeRecord& shape : shapes) {
+        renderer.drawShape(shape, xform);
+    }
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char** argv)
+{
+    const size_t scale = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1;
+    const size_t frames = 5 * scale;
+
+    minstd_rand r(1);
+    vector<SWF::ShapeRecord> shapes;
+    for (size_t i = 0; i < 2000; ++i) shapes.push_back(makeShape(r));
+
+    std::unique_ptr<Renderer_agg_base> renderer(
+            create_Renderer_agg("RGBA32"));
+    if (!renderer.get()) {
+        cout << "  ERROR: no RGBA32 renderer" << endl;
+        return EXIT_FAILURE;
+    }
+
+    const size_t size = width * height * 4;
+    vector<std::uint8_t> buffer(size);
+    vector<std::uint8_t> serial;
+    renderer->init_buffer(&buffer[0], size, width, height, width * 4);
+
+    cout << frames << " frames of " << shapes.size() << " shapes at "
+         << width << "x" << height << ":" << endl;
+
+    renderer->setRenderThreads(1);
+    renderer->setShapeCacheSize(0);
+    {
+        drawFrame(*renderer, shapes);
+
+        Stopwatch t;
+        for (size_t i = 0; i < frames; ++i) drawFrame(*renderer, shapes);
+        cout << "  1 thread, no shape cache: "
+             << double(t.elapsed()) / frames << " ms/frame" << endl;
+        serial = buffer;
+    }
+    renderer->setShapeCacheSize(64 << 20);
+
+    double base = 0;
+    int status = 0;
+
+    const unsigned threads[] = { 1, 2, 4, 8 };
+    for (unsigned n : threads) {
+        renderer->setRenderThreads(n);
+
+        // Not timed: the first frame after a change starts the threads,
+        // and the first one of all fills the shape cache.
+        drawFrame(*renderer, shapes);
+
+        Stopwatch t;
+        for (size_t i = 0; i < frames; ++i) drawFrame(*renderer, shapes);
+        const double ms = double(t.elapsed()) / frames;
+
+        if (n == 1) base = ms;
+
+        cout << "  " << n << " threads: " << ms << " ms/frame";
+        if (ms) cout << " (" << base / ms << "x)";
+        cout << endl;
+
+        if (buffer != serial) {
+            cout << "  ERROR: the frame differs from one thread's without "
+                    "the shape cache" << endl;
+            status = EXIT_FAILURE;
+        }
+    }
+
+    renderer->summarize(cout);
+
+    return status;
+}
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
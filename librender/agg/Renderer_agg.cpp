@@ -75,10 +75,6 @@ What could and should be /optimized/
   - EASY: Do not even start rendering shapes that are abviously out of the
     invalidated bounds!  
     
-  - The alpha mask buffers (masks) are allocated and freed for each mask which
-    results in many large-size buffer allocations during a second. Maybe this
-    should be optimized.
-    
   - Matrix-transformed paths (generated before drawing a shape) should be cached
     and re-used to avoid recalculation of the same coordinates.
     
@@ -114,7 +110,11 @@ AGG resources
 #include <cmath>
 #include <math.h> // We use round()!
 #include <climits>
+#include <limits>
 #include <functional>
+#include <algorithm>
+#include <memory>
+#include <thread>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -164,6 +164,9 @@ AGG resources
 #endif
 
 #include "Renderer_agg_bitmap.h"
+#include "Renderer_agg_workers.h"
+#include "Renderer_agg_cache.h"
+#include "rc.h"
 
 // Print a debugging warning when rendering of a whole character
 // is skipped 
@@ -184,6 +187,9 @@ typedef std::vector<geometry::Range2d<int> > ClipBounds;
 typedef boost::ptr_vector<AlphaMask> AlphaMasks;
 typedef std::vector<Path> GnashPaths;
 
+/// The number of rows of pixels in each tile rendered by a thread.
+const int tileHeight = 64;
+
 // Note: this is here in case ::round doesn't exist. However, it's not
 // advisable to check using ifdefs (as previously), because ::round is
 // generally a function not a macro!
@@ -233,6 +239,58 @@ analyzePaths(const GnashPaths &paths, bool& have_shape,
     }
 }
 
+/// Finds the rows of pixels that paths already transformed to the stage
+/// may cover.
+//
+/// Curves stay within their control points, so the rows of all points
+/// are enough, with one row on each side for the offsets added when
+/// the paths are converted to AGG paths.
+void
+pathRows(const GnashPaths& paths, int& minY, int& maxY)
+{
+    std::int32_t top = std::numeric_limits<std::int32_t>::max();
+    std::int32_t bottom = std::numeric_limits<std::int32_t>::min();
+
+    for (const Path& path : paths) {
+        top = std::min(top, path.ap.y);
+        bottom = std::max(bottom, path.ap.y);
+        for (const Edge& edge : path.m_edges) {
+            top = std::min(top, std::min(edge.cp.y, edge.ap.y));
+            bottom = std::max(bottom, std::max(edge.cp.y, edge.ap.y));
+        }
+    }
+
+    if (top > bottom) {
+        minY = 0;
+        maxY = -1;
+        return;
+    }
+
+    minY = static_cast<int>(std::floor(twipsToPixels(top))) - 1;
+    maxY = static_cast<int>(std::ceil(twipsToPixels(bottom))) + 1;
+}
+
+/// How far, in pixels, the strokes of the given line styles may reach
+/// beyond their paths.
+//
+/// This is the width of the widest line, lengthened at miter joins: twice
+/// what a stroke needs, which leaves room for square caps.
+int
+strokeMargin(const std::vector<LineStyle>& styles, float stroke_scale)
+{
+    float margin = 1;
+
+    for (const LineStyle& style : styles) {
+        const float width = std::max(std::max(1.0f,
+                    style.getThickness() * stroke_scale),
+                static_cast<float>(twipsToPixels(style.getThickness())));
+        const float miter = style.joinStyle() == JOIN_MITER ?
+            std::max(1.0f, style.miterLimitFactor()) : 1.0f;
+        margin = std::max(margin, width * miter);
+    }
+    return static_cast<int>(std::ceil(margin)) + 1;
+}
+
 class EdgeToPath
 {
 
@@ -305,14 +363,142 @@ buildPaths(AggPaths& dest, const GnashPaths& paths)
     std::for_each(paths.begin(), paths.end(), GnashToAggPath(dest, 0.05));
 } 
 
+/// A path with its curves already turned into the lines the rasterizers
+/// draw them with.
+//
+/// This is done once for a path that is drawn many times. Its vertices
+/// are the ones conv_curve gives for the AGG path, so it draws the same
+/// pixels.
+class FlatPath
+{
+    struct Vertex
+    {
+        double x;
+        double y;
+        unsigned cmd;
+    };
+
+public:
+
+    explicit FlatPath(agg::path_storage& path)
+    {
+        agg::conv_curve<agg::path_storage> curve(path);
+        curve.rewind(0);
+
+        Vertex v;
+        while (!agg::is_stop(v.cmd = curve.vertex(&v.x, &v.y))) {
+            _vertices.push_back(v);
+        }
+        _vertices.shrink_to_fit();
+    }
+
+    /// The memory taken by the path.
+    size_t bytes() const {
+        return sizeof(FlatPath) + _vertices.capacity() * sizeof(Vertex);
+    }
+
+    /// Reads the vertices of a path for the rasterizers.
+    //
+    /// A path may be read by several threads at once, each with its own
+    /// Reader.
+    class Reader
+    {
+    public:
+        explicit Reader(const FlatPath& path)
+            :
+            _vertices(path._vertices),
+            _next(0)
+        {}
+
+        void rewind(unsigned /*path_id*/) {
+            _next = 0;
+        }
+
+        unsigned vertex(double* x, double* y) {
+            if (_next == _vertices.size()) return agg::path_cmd_stop;
+            const Vertex& v = _vertices[_next++];
+            *x = v.x;
+            *y = v.y;
+            return v.cmd;
+        }
+
+    private:
+        const std::vector<Vertex>& _vertices;
+        size_t _next;
+    };
+
+private:
+
+    std::vector<Vertex> _vertices;
+};
+
+typedef std::vector<FlatPath> FlatPaths;
+
+/// Flatten AGG paths, one FlatPath for each.
+void
+flattenPaths(FlatPaths& dest, AggPaths& paths)
+{
+    dest.reserve(paths.size());
+    for (agg::path_storage& path : paths) dest.push_back(FlatPath(path));
+}
+
+/// A subshape transformed to the stage, ready to be rasterized
+//
+/// These are kept between frames for shapes drawn again with the same
+/// matrix, and shared by the threads drawing a frame, so they are not
+/// changed once built.
+struct StageShape
+{
+    StageShape()
+        :
+        have_shape(false),
+        have_outline(false),
+        minY(0),
+        maxY(-1)
+    {}
+
+    /// The memory taken by the shape.
+    size_t bytes() const {
+        size_t bytes = sizeof(StageShape);
+        for (const Path& path : paths) {
+            bytes += sizeof(Path) + path.m_edges.capacity() * sizeof(Edge);
+        }
+        for (const FlatPath& path : fills) bytes += path.bytes();
+        for (const FlatPath& path : outlines) bytes += path.bytes();
+        return bytes;
+    }
+
+    /// The paths in stage TWIPS, which hold their styles and are used
+    /// to draw masks.
+    GnashPaths paths;
+
+    /// The paths to fill, if there is a fill.
+    FlatPaths fills;
+
+    /// The paths to stroke, aligned to pixels, if there are lines.
+    FlatPaths outlines;
+
+    bool have_shape;
+    bool have_outline;
+
+    /// The rows of pixels the shape may cover.
+    int minY;
+    int maxY;
+};
+
+/// The subshape number in the ShapeKey of a glyph, which is drawn
+/// without its outlines.
+const size_t glyphSubshape = std::numeric_limits<size_t>::max();
+
 // --- ALPHA MASK BUFFER CONTAINER ---------------------------------------------
-// How masks are implemented: A mask is basically a full alpha buffer. Each 
+// How masks are implemented: A mask is basically an alpha buffer. Each 
 // pixel in the alpha buffer defines the fraction of color values that are
 // copied to the main buffer. The alpha mask buffer has 256 alpha levels per
-// pixel, which is good as it allows anti-aliased masks. A full size buffer
-// is allocated for each mask even if the invalidated bounds may be much 
-// smaller. The advantage of this is that the alpha mask adaptor does not need
-// to do any clipping which results in better performance.
+// pixel, which is good as it allows anti-aliased masks. The buffer only
+// covers the box around the invalidated bounds of the frame, as nothing
+// outside them is drawn; pixels outside the box are fully masked. The
+// buffers are kept for the next masks, so that a frame does not allocate
+// them again.
 // Masks can be nested, which means the intersection of all masks should be 
 // visible (logical AND). To allow this we hold a stack of alpha masks and the 
 // topmost mask is used itself as a mask to draw any new mask. When rendering 
@@ -332,17 +518,39 @@ class AlphaMask
 
 public:
 
-    AlphaMask(int width, int height)
+    typedef Mask::cover_type cover_type;
+
+    AlphaMask()
         :
-        _rbuf(nullptr, width, height, width),
         _pixf(_rbuf),
-        _rbase(_pixf),
-        _amask(_rbuf),
-        _buffer(new std::uint8_t[width * height]())
+        _amask(_rbuf)
+    {}
+
+    /// Cover a box of the stage, in pixels.
+    //
+    /// The pixels in the box are left as they were, so each region that
+    /// is drawn must be cleared.
+    void reset(const geometry::Range2d<int>& box)
     {
-        _rbuf.attach(_buffer.get(), width, height, width);
+        _box = box;
+        const int width = box.isNull() ? 0 : box.width() + 1;
+        const int height = box.isNull() ? 0 : box.height() + 1;
+
+        // The buffer only grows, so a reused mask does not reallocate.
+        _buffer.resize(std::max<size_t>(_buffer.size(), width * height));
+        _rbuf.attach(_buffer.data(), width, height, width);
     }
-    
+
+    /// The part of the stage the mask covers.
+    const geometry::Range2d<int>& box() const {
+        return _box;
+    }
+
+    /// The stage coordinates of the top left of the box.
+    int left() const { return _box.isNull() ? 0 : _box.getMinX(); }
+    int top() const { return _box.isNull() ? 0 : _box.getMinY(); }
+
+    /// Clear a region of the stage that is in the box.
     void clear(const geometry::Range2d<int>& region)
     {
         if (region.isNull()) return;
@@ -353,24 +561,50 @@ public:
         // region can't be world as it should be intersected with 
         // the visible SWFRect
         assert(!region.isWorld());
+        assert(Intersection(region, _box) == region);
 
-        unsigned int left = region.getMinX();
-        unsigned int width = region.width() + 1;
+        const unsigned int left = region.getMinX() - _box.getMinX();
+        const unsigned int width = region.width() + 1;
 
-        const unsigned int max_y = region.getMaxY();
-        for (unsigned int y=region.getMinY(); y <= max_y; ++y) 
+        const unsigned int min_y = region.getMinY() - _box.getMinY();
+        const unsigned int max_y = region.getMaxY() - _box.getMinY();
+        for (unsigned int y = min_y; y <= max_y; ++y) 
         {
              _pixf.copy_hline(left, y, width, black);
         }
     }
     
-    Renderer& get_rbase() {
-        return _rbase;
+    /// A renderer drawing into the rows from minY to maxY only.
+    //
+    /// It draws in coordinates of the box, whose top left is (0, 0).
+    Renderer get_rbase(int minY, int maxY) {
+        Renderer rbase(_pixf);
+        rbase.clip_box(0, minY, _pixf.width() - 1, maxY);
+        return rbase;
     }
     
-    const Mask& getMask() const {
-        return _amask;
-    }    
+    /// Multiply covers by the mask, in coordinates of the box.
+    void combine_hspan(int x, int y, cover_type* dst, int num_pix) const
+    {
+        const int width = _pixf.width();
+        if (y < 0 || y >= int(_pixf.height()) || x >= width ||
+                x + num_pix <= 0) {
+            std::fill_n(dst, num_pix, 0);
+            return;
+        }
+        if (x < 0) {
+            std::fill_n(dst, -x, 0);
+            dst -= x;
+            num_pix += x;
+            x = 0;
+        }
+        const int over = x + num_pix - width;
+        if (over > 0) {
+            std::fill_n(dst + num_pix - over, over, 0);
+            num_pix -= over;
+        }
+        _amask.combine_hspan(x, y, dst, num_pix);
+    }
     
 private:
 
@@ -380,17 +614,165 @@ private:
     // pixel access
     agg::pixfmt_gray8 _pixf;    
     
-    // renderer base
-    Renderer _rbase;
-    
     // alpha mask
     Mask _amask;
     
-    // in-memory buffer
-    std::unique_ptr<std::uint8_t[]> _buffer;
+    // in-memory buffer, kept when the mask is reused
+    std::vector<std::uint8_t> _buffer;
+
+    /// The part of the stage in the buffer.
+    geometry::Range2d<int> _box;
     
 };
 
+// --- TILES -------------------------------------------------------------------
+// A frame can be rendered by several threads, each taking one tile (a band
+// of rows across the stage) at a time. Every tile runs all the draw calls
+// of the frame that reach it, in order. The paths are rasterized whole, as
+// when drawing the stage at once, and only the scanlines of the tile are
+// swept and blended, so each pixel comes out exactly the same. Clipping
+// the rasterizer to the tile instead would be cheaper, but moves the
+// points where edges are cut and so changes the anti-aliasing.
+
+/// A rasterizer that only sweeps the scanlines from minY to maxY
+//
+/// The AGG scanline renderers call rewind_scanlines(), sweep_scanline()
+/// and, for the compound rasterizer, sweep_styles() on the type they are
+/// given, so hiding those is enough to make them skip the other rows.
+template<typename Rasterizer>
+class BandRasterizer : public Rasterizer
+{
+public:
+
+    BandRasterizer(int minY, int maxY)
+        :
+        _minY(minY),
+        _maxY(maxY),
+        _y(std::numeric_limits<int>::min())
+    {}
+
+    bool rewind_scanlines() {
+        _y = std::numeric_limits<int>::min();
+        if (!Rasterizer::rewind_scanlines()) return false;
+        if (_maxY < Rasterizer::min_y()) return false;
+        if (_minY <= Rasterizer::min_y()) return true;
+        return Rasterizer::navigate_scanline(_minY);
+    }
+
+    template<typename Scanline>
+    bool sweep_scanline(Scanline& sl) {
+        if (_y >= _maxY || !Rasterizer::sweep_scanline(sl)) return false;
+        _y = sl.y();
+        return _y <= _maxY;
+    }
+
+    /// Sweep a style of the compound rasterizer.
+    template<typename Scanline>
+    bool sweep_scanline(Scanline& sl, int style) {
+        if (!Rasterizer::sweep_scanline(sl, style)) return false;
+        _y = sl.y();
+        return _y <= _maxY;
+    }
+
+    unsigned sweep_styles() {
+        return _y >= _maxY ? 0 : Rasterizer::sweep_styles();
+    }
+
+private:
+    const int _minY;
+    const int _maxY;
+
+    /// The last scanline swept.
+    int _y;
+};
+
+/// An alpha mask that is only read in the rows from minY to maxY
+//
+/// The row after a tile may be swept before the rasterizer knows the tile
+/// is done. That row of the mask belongs to the next tile, which may be
+/// drawing it, so it counts as fully masked instead.
+class BandMask
+{
+public:
+
+    typedef AlphaMask::cover_type cover_type;
+
+    /// Read a mask at (x - left, y - top) for scanlines at (x, y).
+    BandMask(const AlphaMask& mask, int minY, int maxY, int left, int top)
+        :
+        _mask(mask),
+        _minY(minY),
+        _maxY(maxY),
+        _left(left),
+        _top(top)
+    {}
+
+    void combine_hspan(int x, int y, cover_type* dst, int num_pix) const {
+        if (y < _minY || y > _maxY) {
+            std::fill_n(dst, num_pix, 0);
+            return;
+        }
+        _mask.combine_hspan(x - _left, y - _top, dst, num_pix);
+    }
+
+private:
+    const AlphaMask& _mask;
+    const int _minY;
+    const int _maxY;
+    const int _left;
+    const int _top;
+};
+
+typedef agg::scanline_u8_am<BandMask> MaskedScanline;
+
+/// Where draw calls render: the whole stage, or one tile of it
+//
+/// Everything a draw call changes besides the pixels of its rows is
+/// kept here, so that the threads rendering tiles share nothing they
+/// write. Masks are shared, as each tile only draws its own rows of
+/// them.
+template<typename PixelFormat>
+struct RenderTarget
+{
+    RenderTarget(PixelFormat& pixf, int minY, int maxY)
+        :
+        rbase(pixf),
+        minY(minY),
+        maxY(maxY),
+        drawingMask(false)
+    {
+        rbase.clip_box(0, minY, pixf.width() - 1, maxY);
+    }
+
+    /// A mask, the topmost by default, as read in this target.
+    BandMask mask(size_t below = 0) const {
+        assert(below < masks.size());
+        const AlphaMask& m = *masks[masks.size() - 1 - below];
+        return BandMask(m, minY, maxY, m.left(), m.top());
+    }
+
+    /// The part of a region in the rows of this target.
+    geometry::Range2d<int> rows(const geometry::Range2d<int>& region) const {
+        return Intersection(region, geometry::Range2d<int>(region.getMinX(),
+                    minY, region.getMaxX(), maxY));
+    }
+
+    agg::renderer_base<PixelFormat> rbase;
+
+    /// The first and last rows drawn.
+    const int minY;
+    const int maxY;
+
+    /// The active masks, innermost last.
+    std::vector<AlphaMask*> masks;
+
+    /// Whether shapes are drawn into the topmost mask.
+    bool drawingMask;
+
+    /// The clipping bounds a shape is drawn in; see select_clipbounds().
+    std::vector<const geometry::Range2d<int>*> clipbounds;
+};
+
 /// Class for rendering lines.
 template<typename PixelFormat>
 class LineRenderer
@@ -398,13 +780,15 @@ class LineRenderer
 public:
     typedef agg::renderer_base<PixelFormat> BaseRenderer;
     typedef agg::renderer_scanline_aa_solid<BaseRenderer> Renderer;
-    typedef agg::rasterizer_scanline_aa<> Rasterizer;
+    typedef BandRasterizer<agg::rasterizer_scanline_aa<> > Rasterizer;
     typedef agg::conv_stroke<agg::path_storage> Stroke;
 
-    LineRenderer(const ClipBounds& clipbounds, BaseRenderer& baseRenderer)
+    LineRenderer(const ClipBounds& clipbounds,
+            RenderTarget<PixelFormat>& target)
         :
         _clipbounds(clipbounds),
-        _renderer(baseRenderer)
+        _ras(target.minY, target.maxY),
+        _renderer(target.rbase)
     {}
 
     template<typename ScanLine>
@@ -453,36 +837,36 @@ public:
 
     /// Render the pixels using this renderer
     typedef typename agg::renderer_base<PixelFormat> Renderer;
-    typedef agg::rasterizer_scanline_aa<> Rasterizer;
+    typedef BandRasterizer<agg::rasterizer_scanline_aa<> > Rasterizer;
 
     EmptyVideoRenderer(const ClipBounds& clipbounds)
         :
         _clipbounds(clipbounds)
     {}
 
-    void render(agg::path_storage& path, Renderer& rbase,
-        const AlphaMasks& masks)
+    void render(agg::path_storage& path, RenderTarget<PixelFormat>& target)
     {
-        if (masks.empty()) {
+        Rasterizer ras(target.minY, target.maxY);
+
+        if (target.masks.empty()) {
             // No mask active
             agg::scanline_p8 sl;
-            renderScanlines(path, rbase, sl);
+            renderScanlines(path, ras, target.rbase, sl);
         }
         else {
             // Untested.
-            typedef agg::scanline_u8_am<agg::alpha_mask_gray8> Scanline;
-            Scanline sl(masks.back().getMask());
-            renderScanlines(path, rbase, sl);
+            const BandMask mask = target.mask();
+            MaskedScanline sl(mask);
+            renderScanlines(path, ras, target.rbase, sl);
         }
     } 
 
 private:
 
     template<typename Scanline>
-    void renderScanlines(agg::path_storage& path, Renderer& rbase,
-            Scanline& sl)
+    void renderScanlines(agg::path_storage& path, Rasterizer& ras,
+            Renderer& rbase, Scanline& sl)
     {
-        Rasterizer ras;
         agg::renderer_scanline_aa_solid<Renderer> ren_sl(rbase);
 
         for (const auto& cb : _clipbounds)
@@ -549,7 +933,7 @@ public:
     typedef typename agg::renderer_base<PixelFormat> Renderer;
     typedef agg::span_interpolator_linear<> Interpolator;
     typedef agg::span_allocator<agg::rgba8> SpanAllocator;
-    typedef agg::rasterizer_scanline_aa<> Rasterizer;
+    typedef BandRasterizer<agg::rasterizer_scanline_aa<> > Rasterizer;
     
     // cloning image accessor is used to avoid disturbing pixels at
     // the edges for rotated video. 
@@ -580,22 +964,21 @@ public:
         _smoothing(smooth)
     {}
 
-    void render(agg::path_storage& path, Renderer& rbase,
-            const AlphaMasks& masks)
+    void render(agg::path_storage& path, RenderTarget<PixelFormat>& target)
     {
         switch (_quality)
         {
             case QUALITY_BEST:
             case QUALITY_HIGH:
                 if (_smoothing) {
-                    renderFrame<HighQualityFilter>(path, rbase, masks);
+                    renderFrame<HighQualityFilter>(path, target);
                 }
-                else renderFrame<LowQualityFilter>(path, rbase, masks);
+                else renderFrame<LowQualityFilter>(path, target);
                 break;
             case QUALITY_MEDIUM:
             case QUALITY_LOW:
                 // FIXME: Should this be still lower quality?
-                renderFrame<LowQualityFilter>(path, rbase, masks);
+                renderFrame<LowQualityFilter>(path, target);
                 break;
         }
     }
@@ -604,35 +987,35 @@ private:
 
     /// Render a frame with or without alpha masks active.
     template<typename SpanGenerator>
-    void renderFrame(agg::path_storage& path, Renderer& rbase,
-            const AlphaMasks& masks)
+    void renderFrame(agg::path_storage& path,
+            RenderTarget<PixelFormat>& target)
     {
         SpanGenerator sg(_accessor, _interpolator);
-        if (masks.empty()) {
+        Rasterizer ras(target.minY, target.maxY);
+        if (target.masks.empty()) {
             // No mask active
             agg::scanline_u8 sl;
-            renderScanlines(path, rbase, sl, sg);
+            renderScanlines(path, ras, target.rbase, sl, sg);
         }
         else {
             // Untested.
-            typedef agg::scanline_u8_am<agg::alpha_mask_gray8> Scanline;
-            Scanline sl(masks.back().getMask());
-            renderScanlines(path, rbase, sl, sg);
+            const BandMask mask = target.mask();
+            MaskedScanline sl(mask);
+            renderScanlines(path, ras, target.rbase, sl, sg);
         }
     } 
 
     template<typename Scanline, typename SpanGenerator>
-    void renderScanlines(agg::path_storage& path, Renderer& rbase,
-            Scanline& sl, SpanGenerator& sg)
+    void renderScanlines(agg::path_storage& path, Rasterizer& ras,
+            Renderer& rbase, Scanline& sl, SpanGenerator& sg)
     {
-        Rasterizer _ras;
         for (const auto& cb : _clipbounds)
         {
-            applyClipBox<Rasterizer> (_ras, cb);
+            applyClipBox<Rasterizer> (ras, cb);
 
-            _ras.add_path(path);
+            ras.add_path(path);
 
-            agg::render_scanlines_aa(_ras, sl, rbase, _sa, sg);
+            agg::render_scanlines_aa(ras, sl, rbase, _sa, sg);
         }
     }
     
@@ -669,6 +1052,9 @@ private:
 template <class PixelFormat>
 class Renderer_agg : public Renderer_agg_base
 {
+
+    /// Where draw calls render; see RenderTarget.
+    typedef RenderTarget<PixelFormat> Target;
   
 public:
 
@@ -700,28 +1086,21 @@ public:
     }
 
     template<typename SourceFormat, typename Matrix>
-    void renderVideo(image::GnashImage& frame, Matrix& img_mtx,
+    void renderVideo(Target& t, image::GnashImage& frame, Matrix& img_mtx,
             agg::path_storage path, bool smooth)
     {
-
-        // renderer base for the stage buffer (not the frame image!)
-        renderer_base& rbase = *m_rbase;
-
         VideoRenderer<PixelFormat, SourceFormat> vr(_clipbounds, frame,
                 img_mtx, _quality, smooth);
 
         // If smoothing is requested and _quality is set to HIGH or BEST,
         // use high-quality interpolation.
-        vr.render(path, rbase, _alphaMasks);
+        vr.render(path, t);
     }
 
-    void renderEmptyVideo(agg::path_storage path)
+    void renderEmptyVideo(Target& t, agg::path_storage path)
     {
-        // renderer base for the stage buffer (not the frame image!)
-        renderer_base& rbase = *m_rbase;
-
         EmptyVideoRenderer<PixelFormat> vr(_clipbounds);
-        vr.render(path, rbase, _alphaMasks);
+        vr.render(path, t);
     }
 
     void drawVideoFrame(image::GnashImage* frame, const Transform& xform,
@@ -775,18 +1154,28 @@ public:
             _render_images.push_back(image);
 
             // clear video region with transparent color
-            renderEmptyVideo(path);
+            submit([this, path](Target& t) { renderEmptyVideo(t, path); });
             return;
         }
 #endif
 
+        // Each tile needs its own copy of the matrix, which the span
+        // interpolator takes by reference.
         switch (frame->type())
         {
             case image::TYPE_RGBA:
-                renderVideo<agg::pixfmt_rgba32_pre>(*frame, mtx, path, smooth);
+                submit([this, frame, mtx, path, smooth](Target& t) {
+                    agg::trans_affine m(mtx);
+                    renderVideo<agg::pixfmt_rgba32_pre>(t, *frame, m, path,
+                        smooth);
+                });
                 break;
             case image::TYPE_RGB:
-                renderVideo<agg::pixfmt_rgb24_pre>(*frame, mtx, path, smooth);
+                submit([this, frame, mtx, path, smooth](Target& t) {
+                    agg::trans_affine m(mtx);
+                    renderVideo<agg::pixfmt_rgb24_pre>(t, *frame, m, path,
+                        smooth);
+                });
                 break;
             default:
                 log_error(_("Can't render this type of frame"));
@@ -802,6 +1191,7 @@ public:
       yres(1),
       bpp(bits_per_pixel),
       scale_set(false),
+      _recording(false),
       m_drawing_mask(false)
   {
     // TODO: we really don't want to set the scale here as the core should
@@ -828,14 +1218,41 @@ public:
     
     m_rbuf.attach(mem, xres, yres, rowstride);
 
-    // allocate pixel format accessor and renderer_base
+    // allocate pixel format accessor and the target for the whole stage
     m_pixf.reset(new PixelFormat(m_rbuf));
-    m_rbase.reset(new renderer_base(*m_pixf));  
+    _stage.reset(new Target(*m_pixf, 0, yres - 1));
     
     // by default allow drawing everywhere
     set_invalidated_region_world();
   }
   
+  /// Render frames with the given number of threads.
+  //
+  /// With more than one, the draw calls of a frame are recorded and
+  /// rendered by end_display(), one tile at a time in each thread. 0 uses
+  /// one thread per processor.
+  virtual void setRenderThreads(unsigned int threads)
+  {
+    assert(!_recording);
+
+    if (!threads) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    if (threads > 1) _workers.reset(new RenderWorkers(threads));
+    else _workers.reset();
+  }
+
+  virtual void setShapeCacheSize(size_t bytes)
+  {
+    _shapes.setBudget(bytes);
+  }
+
+  virtual void summarize(std::ostream& o) const
+  {
+    if (!_shapes.budget()) return;
+    o << "shape cache: ";
+    _shapes.summarize(o);
+    o << "\n";
+  }
 
   void begin_display(const gnash::rgba& bg,
       int /*viewport_width*/, int /*viewport_height*/,
@@ -849,18 +1266,27 @@ public:
     // them for display after ::end_display()
     _render_images.clear();
 
+    // Left over if the last frame failed.
+    _commands.clear();
+    freeRetiredMasks();
+
+    _recording = _workers.get() != nullptr;
+
     // clear the stage using the background color
     if ( ! _clipbounds.empty() )
     {
-        const agg::rgba8& col = agg::rgba8_pre(bg.m_r, bg.m_g, bg.m_b, bg.m_a);
-        for (const auto& bounds : _clipbounds)
-        {
-            clear_framebuffer(bounds, col);
-        }
+        const agg::rgba8 col = agg::rgba8_pre(bg.m_r, bg.m_g, bg.m_b, bg.m_a);
+        submit([this, col](Target& t) {
+            for (const auto& bounds : _clipbounds)
+            {
+                clear_framebuffer(t, bounds, col);
+            }
+        });
     }
     
     // reset status variables
     m_drawing_mask = false;
+    _stage->drawingMask = false;
   }
   
  
@@ -897,10 +1323,13 @@ public:
     // of the screen. The result would be still correct, but slower. 
     // This function clears only a certain portion of the screen, while /not/ 
     // being notably slower for a fullscreen clear. 
-    void clear_framebuffer(const geometry::Range2d<int>& region,
-        const agg::rgba8& color)
+    void clear_framebuffer(const Target& t,
+        const geometry::Range2d<int>& bounds, const agg::rgba8& color)
     {
-        assert(region.isFinite());
+        assert(bounds.isFinite());
+
+        const geometry::Range2d<int> region = t.rows(bounds);
+        if (region.isNull()) return;
 
         // add 1 to width since we have still to draw a pixel when 
         // getMinX==getMaxX     
@@ -931,6 +1360,95 @@ public:
                         "were still active");
             disable_mask();      
         }
+
+        if (_recording) {
+            _recording = false;
+            renderTiles();
+        }
+    }
+
+    /// Run the recorded draw calls of the frame in tiles.
+    void renderTiles()
+    {
+        const size_t tiles = (yres + tileHeight - 1) / tileHeight;
+
+        _workers->run(tiles, [this](size_t tile) {
+            const int minY = tile * tileHeight;
+            Target t(*m_pixf, minY, std::min(minY + tileHeight, yres) - 1);
+            for (const Command& c : _commands) {
+                if (c.maxY < t.minY || c.minY > t.maxY) continue;
+                c.draw(t);
+            }
+        });
+
+        _commands.clear();
+        freeRetiredMasks();
+    }
+
+    /// Draw now, or record the draw call if the frame is rendered in tiles.
+    //
+    /// @param minY     The first row the call may change.
+    /// @param maxY     The last row the call may change.
+    template<typename Draw>
+    void submit(Draw draw, int minY = std::numeric_limits<int>::min(),
+            int maxY = std::numeric_limits<int>::max())
+    {
+        if (!_recording) {
+            draw(*_stage);
+            return;
+        }
+        _commands.push_back(Command(minY, maxY, draw));
+    }
+
+    /// Transform a subshape to the stage, or find it in the shape cache.
+    //
+    /// The result is shared, so it lasts until the frame is rendered if
+    /// it is recorded.
+    ///
+    /// @param glyph    Whether the paths are a glyph, which is filled
+    ///                 with the non-zero rule and has no outlines.
+    std::shared_ptr<const StageShape> stageShape(const ShapeKey& key,
+            const GnashPaths& objpaths,
+            const std::vector<LineStyle>& line_styles, const SWFMatrix& mat,
+            bool glyph)
+    {
+        std::shared_ptr<const StageShape> cached = _shapes.find(key);
+        if (cached) return cached;
+
+        std::shared_ptr<StageShape> s(new StageShape);
+
+        if (glyph) s->have_shape = true;
+        else analyzePaths(objpaths, s->have_shape, s->have_outline);
+
+        if (s->have_shape || s->have_outline) {
+
+            apply_matrix_to_path(objpaths, s->paths, mat);
+
+            pathRows(s->paths, s->minY, s->maxY);
+            if (s->have_outline) {
+                const int margin = strokeMargin(line_styles,
+                        outline_scale(mat));
+                s->minY -= margin;
+                s->maxY += margin;
+            }
+
+            if (s->have_shape) {
+                AggPaths agg_paths;
+                buildPaths(agg_paths, s->paths);
+                flattenPaths(s->fills, agg_paths);
+            }
+
+            // Flash only aligns outlines. Probably this is done at
+            // rendering level.
+            if (s->have_outline) {
+                AggPaths agg_paths_rounded;
+                buildPaths_rounded(agg_paths_rounded, s->paths, line_styles);
+                flattenPaths(s->outlines, agg_paths_rounded);
+            }
+        }
+
+        _shapes.insert(key, s, s->bytes());
+        return s;
     }
 
     // Draw the line strip formed by the sequence of points.
@@ -946,16 +1464,9 @@ public:
         SWFMatrix mat = stage_matrix;
         mat.concatenate(line_mat);    
 
-        LineRenderer<PixelFormat> lr(_clipbounds, *m_rbase);
-
         // -- create path --
         agg::path_storage path;
 
-        typename LineRenderer<PixelFormat>::Stroke stroke(path);
-        stroke.width(1);
-        stroke.line_cap(agg::round_cap);
-        stroke.line_join(agg::round_join);
-
         typedef std::vector<point> Points;
         
         // We've asserted that it has at least one element.
@@ -974,18 +1485,29 @@ public:
             path.line_to(pnt.x, pnt.y);
         }
 
-        if (_alphaMasks.empty()) {
+        submit([this, path, color](Target& t) { renderLine(t, path, color); });
+    }
+
+    void renderLine(Target& t, agg::path_storage path, const rgba& color)
+    {
+        LineRenderer<PixelFormat> lr(_clipbounds, t);
+
+        typename LineRenderer<PixelFormat>::Stroke stroke(path);
+        stroke.width(1);
+        stroke.line_cap(agg::round_cap);
+        stroke.line_join(agg::round_join);
+
+        if (t.masks.empty()) {
             // No mask active
             agg::scanline_p8 sl;      
             lr.render(sl, stroke, color);
         }
         else {
             // Mask is active!
-            typedef agg::scanline_u8_am<agg::alpha_mask_gray8> sl_type;
-            sl_type sl(_alphaMasks.back().getMask());      
+            const BandMask mask = t.mask();
+            MaskedScanline sl(mask);
             lr.render(sl, stroke, color);
         }
-
     } 
 
 
@@ -994,24 +1516,47 @@ public:
         // Set flag so that rendering of shapes is simplified (only solid fill) 
         m_drawing_mask = true;
 
-        _alphaMasks.push_back(new AlphaMask(xres, yres));
-        AlphaMask& new_mask = _alphaMasks.back();
-
-        for (const auto& bounds : _clipbounds ) {
-            new_mask.clear(bounds);
-        }
-
+        // Nothing outside the clipping bounds is drawn, so the mask only
+        // needs their box. It is the same for all masks of a frame, which
+        // lets a nested mask be drawn through the one below it.
+        geometry::Range2d<int> box;
+        for (const auto& bounds : _clipbounds) box.expandTo(bounds);
+
+        if (_freeMasks.empty()) _freeMasks.push_back(new AlphaMask);
+        _alphaMasks.transfer(_alphaMasks.end(), _freeMasks.end() - 1,
+                _freeMasks);
+        AlphaMask* new_mask = &_alphaMasks.back();
+        new_mask->reset(box);
+
+        submit([this, new_mask](Target& t) {
+            t.drawingMask = true;
+            t.masks.push_back(new_mask);
+            for (const auto& bounds : _clipbounds ) {
+                new_mask->clear(t.rows(bounds));
+            }
+        });
     }
 
     void end_submit_mask()
     {
         m_drawing_mask = false;
+        submit([](Target& t) { t.drawingMask = false; });
     }
 
     void disable_mask()
     {
         assert(!_alphaMasks.empty());
-        _alphaMasks.pop_back();
+        submit([](Target& t) { t.masks.pop_back(); });
+
+        // A recorded frame uses the mask until it is rendered.
+        AlphaMasks& to = _recording ? _retiredMasks : _freeMasks;
+        to.transfer(to.end(), _alphaMasks.end() - 1, _alphaMasks);
+    }
+
+    /// Keep the masks of a rendered frame for the next ones.
+    void freeRetiredMasks()
+    {
+        _freeMasks.transfer(_freeMasks.end(), _retiredMasks);
     }
   
 
@@ -1025,51 +1570,62 @@ public:
     if (shape.getBounds().is_null()) {
         return;
     } 
-    select_clipbounds(shape.getBounds(), mat);
+    select_clipbounds(_selected, shape.getBounds(), mat);
     
-    if (_clipbounds_selected.empty()) return; 
+    if (_selected.empty()) return;
       
-    GnashPaths paths;
-    apply_matrix_to_path(shape.subshapes().front().paths(), paths, mat);
+    const std::shared_ptr<const StageShape> s = stageShape(
+            ShapeKey(shape.revision(), glyphSubshape, mat),
+            shape.subshapes().front().paths(), std::vector<LineStyle>(), mat,
+            true);
+
+    submit([this, &shape, s, color, mat](Target& t) {
+        drawGlyph(t, shape, *s, color, mat);
+    }, s->minY, s->maxY);
+  }
+
+  void drawGlyph(Target& t, const SWF::ShapeRecord& shape,
+          const StageShape& s, const rgba& color, const SWFMatrix& mat)
+  {
+    select_clipbounds(t.clipbounds, shape.getBounds(), mat);
+
+    if (t.clipbounds.empty()) return;
 
     // If it's a mask, we don't need the rest.
-    if (m_drawing_mask) {
-      draw_mask_shape(paths, false);
+    if (t.drawingMask) {
+      draw_mask_shape(t, s.paths, false);
       return;
     }
 
-    // convert gnash paths to agg paths.
-    AggPaths agg_paths;    
-    buildPaths(agg_paths, paths);
- 
     std::vector<FillStyle> v(1, FillStyle(SolidFill(color)));
 
     // prepare style handler
     StyleHandler sh;
     build_agg_styles(sh, v, mat, SWFCxForm());
     
-    draw_shape(paths, agg_paths, sh, false);
+    draw_shape(t, s.paths, s.fills, sh, false);
     
     // NOTE: Do not use even-odd filling rule for glyphs!
     
     // clear clipping ranges to ease debugging
-    _clipbounds_selected.clear();
+    t.clipbounds.clear();
   }
 
 
-  /// Fills _clipbounds_selected with pointers to _clipbounds members who
+  /// Fills selected with pointers to _clipbounds members who
   /// intersect with the given character (transformed by mat). This avoids
   /// rendering of characters outside a particular clipping range.
-  /// "_clipbounds_selected" is used by draw_shape() and draw_outline() and
-  /// *must* be initialized prior to using those function.
-  void select_clipbounds(const SWFRect& objectBounds, const SWFMatrix& source_mat)
+  /// The clipbounds of a Target are used by draw_shape() and draw_outline()
+  /// and *must* be initialized prior to using those function.
+  void select_clipbounds(std::vector<const geometry::Range2d<int>*>& selected,
+          const SWFRect& objectBounds, const SWFMatrix& source_mat) const
   {
     
     SWFMatrix mat = stage_matrix;
     mat.concatenate(source_mat);
   
-    _clipbounds_selected.clear();
-    _clipbounds_selected.reserve(_clipbounds.size());
+    selected.clear();
+    selected.reserve(_clipbounds.size());
 
     if (objectBounds.is_null()) {
       log_debug("Warning: select_clipbounds encountered a character "
@@ -1086,21 +1642,21 @@ public:
     for (const auto& clip : _clipbounds) {
 
       if (clip.intersects(bounds.getRange())) 
-        _clipbounds_selected.push_back(&clip);
+        selected.push_back(&clip);
 
     }  
   }
   
-  void select_all_clipbounds() {
+  void select_all_clipbounds(Target& t) {
   
-    if (_clipbounds_selected.size() == _clipbounds.size()) return; 
+    if (t.clipbounds.size() == _clipbounds.size()) return;
   
-    _clipbounds_selected.clear();
-    _clipbounds_selected.reserve(_clipbounds.size());
+    t.clipbounds.clear();
+    t.clipbounds.reserve(_clipbounds.size());
     
     for (const auto& clip : _clipbounds)
     {
-      _clipbounds_selected.push_back(&clip);
+      t.clipbounds.push_back(&clip);
     }
   }
 
@@ -1116,85 +1672,94 @@ public:
             return; // no need to draw
         }
 
-        for (const SWF::Subshape& subshape : shape.subshapes()) {
+        const SWF::ShapeRecord::Subshapes& subshapes = shape.subshapes();
+
+        for (size_t i = 0; i < subshapes.size(); ++i) {
 
+            const SWF::Subshape& subshape = subshapes[i];
             const SWF::ShapeRecord::FillStyles& fillStyles = subshape.fillStyles();
             const SWF::ShapeRecord::LineStyles& lineStyles = subshape.lineStyles();
             const SWF::ShapeRecord::Paths& paths = subshape.paths();
 
-            // select ranges
-            select_clipbounds(shape.getBounds(), xform.matrix);
-
             // render the DisplayObject's subshape.
-            drawShape(fillStyles, lineStyles, paths, xform.matrix,
-                      xform.colorTransform);
+            drawShape(ShapeKey(shape.revision(), i, xform.matrix),
+                    shape.getBounds(), fillStyles, lineStyles, paths,
+                    xform.matrix, xform.colorTransform);
         }
     }
 
-    void drawShape(const std::vector<FillStyle>& FillStyles,
+    /// Draw a subshape of a shape with the given bounds.
+    //
+    /// The styles must last until the frame is rendered, which they do
+    /// as shapes are not changed while the stage is drawn.
+    void drawShape(const ShapeKey& key, const SWFRect& shapeBounds,
+        const std::vector<FillStyle>& FillStyles,
         const std::vector<LineStyle>& line_styles,
         const std::vector<Path>& objpaths, const SWFMatrix& mat,
         const SWFCxForm& cx)
     {
+        const std::shared_ptr<const StageShape> s = stageShape(key, objpaths,
+                line_styles, mat, false);
 
-        bool have_shape, have_outline;
-
-        analyzePaths(objpaths, have_shape, have_outline);
-
-        if (!have_shape && !have_outline) {
+        if (!s->have_shape && !s->have_outline) {
             // Early return for invisible character.
             return; 
         }
 
-        GnashPaths paths;
-        apply_matrix_to_path(objpaths, paths, mat);
+        // Bitmap fills look their bitmap up when first drawn, which the
+        // threads drawing tiles must not do at the same time.
+        if (_recording) {
+            for (const FillStyle& style : FillStyles) {
+                const BitmapFill* f = boost::get<BitmapFill>(&style.fill);
+                if (f) f->bitmap();
+            }
+        }
+
+        submit([=, &FillStyles, &line_styles](Target& t) {
+            drawShape(t, shapeBounds, FillStyles, line_styles, *s, mat, cx);
+        }, s->minY, s->maxY);
+    }
+
+    void drawShape(Target& t, const SWFRect& shapeBounds,
+        const std::vector<FillStyle>& FillStyles,
+        const std::vector<LineStyle>& line_styles,
+        const StageShape& s, const SWFMatrix& mat, const SWFCxForm& cx)
+    {
+        // select ranges
+        select_clipbounds(t.clipbounds, shapeBounds, mat);
 
         // Masks apparently do not use agg_paths, so return
         // early
-        if (m_drawing_mask) {
+        if (t.drawingMask) {
 
             // Shape is drawn inside a mask, skip sub-shapes handling and
             // outlines
-            draw_mask_shape(paths, false); 
+            draw_mask_shape(t, s.paths, false);
             return;
         }
 
-        AggPaths agg_paths;    
-        AggPaths agg_paths_rounded;    
-
-        // Flash only aligns outlines. Probably this is done at rendering
-        // level.
-        if (have_outline) {
-            buildPaths_rounded(agg_paths_rounded, paths, line_styles);     
-        }
-
-        if (have_shape) {
-            buildPaths(agg_paths, paths);
-        }
-        
-
-        if (_clipbounds_selected.empty()) {
+        if (t.clipbounds.empty()) {
 #ifdef GNASH_WARN_WHOLE_CHARACTER_SKIP
             log_debug("Warning: AGG renderer skipping a whole character");
 #endif
-            return; 
+            return;
         }
 
         // prepare fill styles
         StyleHandler sh;
-        if (have_shape) build_agg_styles(sh, FillStyles, mat, cx);
+        if (s.have_shape) build_agg_styles(sh, FillStyles, mat, cx);
 
 
-            if (have_shape) {
-                draw_shape(paths, agg_paths, sh, true);        
+            if (s.have_shape) {
+                draw_shape(t, s.paths, s.fills, sh, true);
             }
-            if (have_outline)            {
-                draw_outlines(paths, agg_paths_rounded,
+            if (s.have_outline)            {
+                draw_outlines(t, s.paths, s.outlines,
                         line_styles, cx, mat);
             }
 
         // Clear selected clipbounds to ease debugging 
-        _clipbounds_selected.clear();
+        t.clipbounds.clear();
     }
 
     /// Takes a path and translates it using the given SWFMatrix. The new path
@@ -1406,11 +1971,11 @@ public:
   /// @param subshape_id
   ///    Defines which subshape to draw. -1 means all subshapes.
   ///
-  void draw_shape(const GnashPaths &paths,
-    const AggPaths& agg_paths,  
+  void draw_shape(Target& t, const GnashPaths &paths,
+    const FlatPaths& agg_paths,  
     StyleHandler& sh, bool even_odd) {
     
-    if (_alphaMasks.empty()) {
+    if (t.masks.empty()) {
     
       // No mask active, use normal scanline renderer
       
@@ -1418,18 +1983,19 @@ public:
       
       scanline_type sl;
       
-      draw_shape_impl<scanline_type> (paths, agg_paths, 
+      draw_shape_impl<scanline_type> (t, paths, agg_paths, 
         sh, even_odd, sl);
         
     } else {
     
       // Mask is active, use alpha mask scanline renderer
       
-      typedef agg::scanline_u8_am<agg::alpha_mask_gray8> scanline_type;
+      typedef MaskedScanline scanline_type;
       
-      scanline_type sl(_alphaMasks.back().getMask());
+      const BandMask mask = t.mask();
+      scanline_type sl(mask);
       
-      draw_shape_impl<scanline_type> (paths, agg_paths, 
+      draw_shape_impl<scanline_type> (t, paths, agg_paths, 
         sh, even_odd, sl);
         
     }
@@ -1440,8 +2006,8 @@ public:
   /// one with and one without an alpha mask. This makes drawing without masks
   /// much faster.  
   template <class scanline_type>
-  void draw_shape_impl(const GnashPaths &paths,
-    const AggPaths& agg_paths,
+  void draw_shape_impl(Target& t, const GnashPaths &paths,
+    const FlatPaths& agg_paths,
     StyleHandler& sh, bool even_odd, scanline_type& sl) {
     /*
     Fortunately, AGG provides a rasterizer that fits perfectly to the flash
@@ -1454,15 +2020,16 @@ public:
     
     assert(m_pixf.get());
     
-    assert(!m_drawing_mask);
+    assert(!t.drawingMask);
     
     if ( _clipbounds.empty() ) return;
 
     // Target renderer
-    renderer_base& rbase = *m_rbase;
+    renderer_base& rbase = t.rbase;
 
-    typedef agg::rasterizer_compound_aa<agg::rasterizer_sl_clip_int> ras_type;
-    ras_type rasc;  // flash-like renderer
+    typedef BandRasterizer<
+      agg::rasterizer_compound_aa<agg::rasterizer_sl_clip_int> > ras_type;
+    ras_type rasc(t.minY, t.maxY);  // flash-like renderer
 
     agg::renderer_scanline_aa_solid<
       agg::renderer_base<PixelFormat> > ren_sl(rbase); // solid fills
@@ -1476,7 +2043,7 @@ public:
       rasc.filling_rule(agg::fill_non_zero);
       
     
-    for (const geometry::Range2d<int>* bounds : _clipbounds_selected) {
+    for (const geometry::Range2d<int>* bounds : t.clipbounds) {
 
       applyClipBox<ras_type> (rasc, *bounds);
       
@@ -1486,10 +2053,9 @@ public:
       for (size_t pno=0; pno<pcount; ++pno) {
           
         const Path &this_path_gnash = paths[pno];
-        agg::path_storage &this_path_agg = 
-          const_cast<agg::path_storage&>(agg_paths[pno]);
-        
-        agg::conv_curve<agg::path_storage> curve(this_path_agg);        
+
+        // The curves are already flattened.
+        FlatPath::Reader curve(agg_paths[pno]);
 
         if ((this_path_gnash.m_fill0==0) && (this_path_gnash.m_fill1==0)) {
           // Skip this path as it contains no fill style
@@ -1517,11 +2083,15 @@ public:
 
   // very similar to draw_shape but used for generating masks. There are no
   // fill styles nor subshapes and such. Just render plain solid shapes.
-  void draw_mask_shape(const GnashPaths& paths, bool even_odd)
+  // Masks are drawn in the coordinates of their box.
+  void draw_mask_shape(Target& t, const GnashPaths& paths, bool even_odd)
   {
 
-    const AlphaMasks::size_type mask_count = _alphaMasks.size();
+    const size_t mask_count = t.masks.size();
+    const AlphaMask& mask = *t.masks.back();
     
+    if (mask.box().isNull()) return;
+
     if (mask_count < 2) {
     
       // This is the first level mask
@@ -1530,7 +2100,7 @@ public:
       
       scanline_type sl;
       
-      draw_mask_shape_impl(paths, even_odd, sl);
+      draw_mask_shape_impl(t, paths, even_odd, sl);
         
     }
     else {
@@ -1538,11 +2108,15 @@ public:
       // Woohoo! We're drawing a nested mask! Use the previous mask while 
       // drawing the new one, the result will be the intersection.
       
-      typedef agg::scanline_u8_am<agg::alpha_mask_gray8> scanline_type;
+      typedef MaskedScanline scanline_type;
       
-      scanline_type sl(_alphaMasks[mask_count - 2].getMask());
+      const AlphaMask& below = *t.masks[mask_count - 2];
+      assert(below.box() == mask.box());
+      const BandMask band(below, t.minY - mask.top(), t.maxY - mask.top(),
+              0, 0);
+      scanline_type sl(band);
       
-      draw_mask_shape_impl(paths, even_odd, sl);
+      draw_mask_shape_impl(t, paths, even_odd, sl);
         
     }
     
@@ -1550,30 +2124,38 @@ public:
   
   
   template <class scanline_type>
-  void draw_mask_shape_impl(const GnashPaths& paths, bool even_odd,
+  void draw_mask_shape_impl(Target& t, const GnashPaths& paths, bool even_odd,
     scanline_type& sl) {
     
     typedef agg::pixfmt_gray8 pixfmt;
     typedef agg::renderer_base<pixfmt> renderer_base;
     
-    assert(!_alphaMasks.empty());
+    assert(!t.masks.empty());
+    AlphaMask& mask = *t.masks.back();
     
     // dummy style handler
     typedef agg_mask_style_handler sh_type;
     sh_type sh;                   
        
-    // compound rasterizer used for flash shapes
-    typedef agg::rasterizer_compound_aa<agg::rasterizer_sl_clip_int> rasc_type;
-    rasc_type rasc;
+    // compound rasterizer used for flash shapes, in the rows of the
+    // target
+    const int minY = t.minY - mask.top();
+    const int maxY = t.maxY - mask.top();
+    typedef BandRasterizer<
+      agg::rasterizer_compound_aa<agg::rasterizer_sl_clip_int> > rasc_type;
+    rasc_type rasc(minY, maxY);
     
 
     // activate even-odd filling rule
     if (even_odd) rasc.filling_rule(agg::fill_even_odd);
     else rasc.filling_rule(agg::fill_non_zero);
       
-    // push paths to AGG
+    // push paths to AGG, moved to the box
     agg::path_storage path; 
     agg::conv_curve<agg::path_storage> curve(path);
+    const agg::trans_affine_translation toBox(-mask.left(), -mask.top());
+    agg::conv_transform<agg::conv_curve<agg::path_storage> >
+        moved(curve, toBox);
 
     for (const Path& this_path : paths) {
 
@@ -1592,12 +2174,12 @@ public:
               EdgeToPath(path));
       
       // add to rasterizer
-      rasc.add_path(curve);
+      rasc.add_path(moved);
     
     } // for path
     
     // renderer base
-    renderer_base& rbase = _alphaMasks.back().get_rbase();
+    renderer_base rbase = mask.get_rbase(minY, maxY);
     
     // span allocator
     typedef agg::span_allocator<agg::gray8> alloc_type;
@@ -1612,12 +2194,12 @@ public:
 
 
   /// Just like draw_shapes() except that it draws an outline.
-  void draw_outlines(const GnashPaths &paths,
-    const AggPaths& agg_paths,
+  void draw_outlines(Target& t, const GnashPaths &paths,
+    const FlatPaths& agg_paths,
     const std::vector<LineStyle> &line_styles, const SWFCxForm& cx,
     const SWFMatrix& linestyle_matrix) {
     
-    if (_alphaMasks.empty()) {
+    if (t.masks.empty()) {
     
       // No mask active, use normal scanline renderer
       
@@ -1625,18 +2207,19 @@ public:
       
       scanline_type sl;
       
-      draw_outlines_impl<scanline_type> (paths, agg_paths, 
+      draw_outlines_impl<scanline_type> (t, paths, agg_paths, 
         line_styles, cx, linestyle_matrix, sl);
         
     } else {
     
       // Mask is active, use alpha mask scanline renderer
       
-      typedef agg::scanline_u8_am<agg::alpha_mask_gray8> scanline_type;
+      typedef MaskedScanline scanline_type;
       
-      scanline_type sl(_alphaMasks.back().getMask());
+      const BandMask mask = t.mask();
+      scanline_type sl(mask);
       
-      draw_outlines_impl<scanline_type> (paths, agg_paths,
+      draw_outlines_impl<scanline_type> (t, paths, agg_paths,
         line_styles, cx, linestyle_matrix, sl);
         
     }
@@ -1646,15 +2229,15 @@ public:
 
   /// Template for draw_outlines(), see draw_shapes_impl().
   template <class scanline_type>
-  void draw_outlines_impl(const GnashPaths &paths,
-    const AggPaths& agg_paths,
+  void draw_outlines_impl(Target& t, const GnashPaths &paths,
+    const FlatPaths& agg_paths,
     const std::vector<LineStyle> &line_styles, const SWFCxForm& cx, 
     const SWFMatrix& linestyle_matrix, scanline_type& sl) {
     
     assert(m_pixf.get());
 
     // Flash ignores lines in mask /definitions/ 
-    if (m_drawing_mask) return;    
+    if (t.drawingMask) return;    
     
     if ( _clipbounds.empty() ) return;
 
@@ -1662,22 +2245,20 @@ public:
     // has a line style associated, so that we avoid walking the paths again
     // when there really are no outlines to draw...
     
-    // use avg between x and y scale
-    const float stroke_scale = (std::abs(linestyle_matrix.get_x_scale()) + 
-       std::abs(linestyle_matrix.get_y_scale())) / 2.0f * get_stroke_scale();
+    const float stroke_scale = outline_scale(linestyle_matrix);
     
     
     // AGG stuff
-    typedef agg::rasterizer_scanline_aa<> ras_type; 
-    ras_type ras;  // anti alias
+    typedef BandRasterizer<agg::rasterizer_scanline_aa<> > ras_type; 
+    ras_type ras(t.minY, t.maxY);  // anti alias
 
-    renderer_base& rbase = *m_rbase;
+    renderer_base& rbase = t.rbase;
 
     agg::renderer_scanline_aa_solid<
       agg::renderer_base<PixelFormat> > ren_sl(rbase); // solid fills
       
     
-    for (const geometry::Range2d<int>* bounds : _clipbounds_selected) {
+    for (const geometry::Range2d<int>* bounds : t.clipbounds) {
 
       applyClipBox<ras_type> (ras, *bounds);
       
@@ -1685,17 +2266,13 @@ public:
 
         const Path& this_path_gnash = paths[pno];
 
-        agg::path_storage &this_path_agg = 
-          const_cast<agg::path_storage&>(agg_paths[pno]);
-        
         if (this_path_gnash.m_line==0) {
           // Skip this path as it contains no line style
           continue;
         } 
         
-        agg::conv_curve< agg::path_storage > curve(this_path_agg); // to render curves
-        agg::conv_stroke< agg::conv_curve < agg::path_storage > > 
-          stroke(curve);  // to get an outline
+        FlatPath::Reader curve(agg_paths[pno]); // curves already flattened
+        agg::conv_stroke<FlatPath::Reader> stroke(curve);  // to get an outline
 
         const LineStyle& lstyle = line_styles[this_path_gnash.m_line-1];
           
@@ -1755,7 +2332,7 @@ public:
   
   /// Draws the given polygon.
   template <class scanline_type>
-  void draw_poly_impl(const point* corners, size_t corner_count, const rgba& fill, 
+  void draw_poly_impl(Target& t, const point* corners, size_t corner_count, const rgba& fill, 
     const rgba& outline, scanline_type& sl, const SWFMatrix& poly_mat) {
     
     assert(m_pixf.get());
@@ -1767,10 +2344,10 @@ public:
     SWFMatrix mat = stage_matrix;
     mat.concatenate(poly_mat);
     
-    typedef agg::rasterizer_scanline_aa<> ras_type;
-    renderer_base& rbase = *m_rbase;
+    typedef BandRasterizer<agg::rasterizer_scanline_aa<> > ras_type;
+    renderer_base& rbase = t.rbase;
 
-    ras_type ras;
+    ras_type ras(t.minY, t.maxY);
     agg::renderer_scanline_aa_solid<
       agg::renderer_base<PixelFormat> > ren_sl(rbase);
       
@@ -1837,15 +2414,25 @@ public:
   void draw_poly(const std::vector<point>& corners, const rgba& fill, 
     const rgba& outline, const SWFMatrix& mat, bool masked) {
     
-    if (masked && !_alphaMasks.empty()) {
+    submit([=](Target& t) {
+        draw_poly(t, corners, fill, outline, mat, masked);
+    });
+  }
+
+  void draw_poly(Target& t, const std::vector<point>& corners,
+    const rgba& fill, const rgba& outline, const SWFMatrix& mat,
+    bool masked) {
+    
+    if (masked && !t.masks.empty()) {
     
       // apply mask
       
-      typedef agg::scanline_u8_am<agg::alpha_mask_gray8> sl_type; 
+      typedef MaskedScanline sl_type; 
       
-      sl_type sl(_alphaMasks.back().getMask());
+      const BandMask mask = t.mask();
+      sl_type sl(mask);
          
-      draw_poly_impl<sl_type>(&corners.front(), corners.size(), fill, outline, sl, mat);       
+      draw_poly_impl<sl_type>(t, &corners.front(), corners.size(), fill, outline, sl, mat);       
     
     } else {
     
@@ -1855,16 +2442,23 @@ public:
       
       sl_type sl;
          
-      draw_poly_impl<sl_type>(&corners.front(), corners.size(), fill, outline, sl, mat);
+      draw_poly_impl<sl_type>(t, &corners.front(), corners.size(), fill, outline, sl, mat);
     
     }
     
   }
 
 
-  inline float get_stroke_scale() {
+  inline float get_stroke_scale() const {
     return (stage_matrix.get_x_scale() + stage_matrix.get_y_scale()) / 2.0f;
   }                      
+
+  /// The scale of the outlines of a shape drawn with the given matrix.
+  float outline_scale(const SWFMatrix& linestyle_matrix) const {
+    // use avg between x and y scale
+    return (std::abs(linestyle_matrix.get_x_scale()) + 
+       std::abs(linestyle_matrix.get_y_scale())) / 2.0f * get_stroke_scale();
+  }                      
   
   inline void world_to_pixel(int& x, int& y,
     float world_x, float world_y) const
@@ -1913,7 +2507,7 @@ public:
     
     int count=0;
 
-    _clipbounds_selected.clear();
+    if (_stage.get()) _stage->clipbounds.clear();
     _clipbounds.clear();    
 
     // TODO: cache 'visiblerect' and maintain in sync with
@@ -1974,12 +2568,18 @@ public:
   void set_scale(float new_xscale, float new_yscale) {
     
     scale_set=true;
+    const SWFMatrix old = stage_matrix;
     stage_matrix.set_identity();
     stage_matrix.set_scale(new_xscale/20.0f, new_yscale/20.0f);
+
+    // The cached shapes are on the old stage.
+    if (!(stage_matrix == old)) _shapes.clear();
   }
 
   void set_translation(float xoff, float yoff) {
+    const SWFMatrix old = stage_matrix;
     stage_matrix.set_translation(xoff, yoff);
+    if (!(stage_matrix == old)) _shapes.clear();
   }
 
   virtual unsigned int getBytesPerPixel() const {
@@ -1990,9 +2590,6 @@ private:  // private variables
     
     typedef agg::renderer_base<PixelFormat> renderer_base;
 
-    // renderer base
-    std::unique_ptr<renderer_base> m_rbase;
- 
     // An external renderer.   
     std::unique_ptr<Renderer> _external;
 
@@ -2008,7 +2605,45 @@ private:  // private variables
 
     /// clipping rectangle
     ClipBounds _clipbounds;
-    std::vector< geometry::Range2d<int> const* > _clipbounds_selected;
+
+    /// Clipping bounds selected while recording a draw call.
+    std::vector< geometry::Range2d<int> const* > _selected;
+
+    /// Draws into the whole stage.
+    std::unique_ptr<Target> _stage;
+
+    /// The threads rendering a frame in tiles, if there are several.
+    std::unique_ptr<RenderWorkers> _workers;
+
+    /// Whether draw calls are recorded, to be rendered by end_display().
+    bool _recording;
+
+    /// A recorded draw call and the rows it may change.
+    struct Command
+    {
+        template<typename Draw>
+        Command(int minY, int maxY, Draw draw)
+            :
+            minY(minY),
+            maxY(maxY),
+            draw(draw)
+        {}
+
+        int minY;
+        int maxY;
+        std::function<void(Target&)> draw;
+    };
+
+    std::vector<Command> _commands;
+
+    /// Subshapes already transformed to the stage.
+    ShapeCache<StageShape> _shapes;
+
+    /// Masks disabled in a recorded frame, which may still be drawn to.
+    AlphaMasks _retiredMasks;
+
+    /// Masks not in use, whose buffers are kept for the next ones.
+    AlphaMasks _freeMasks;
 
     // this flag is set while a mask is drawn
     bool m_drawing_mask; 
@@ -2044,7 +2679,10 @@ bool is_little_endian_host() {
 }
 
 
-DSOEXPORT Renderer_agg_base*  create_Renderer_agg(const char *pixelformat)
+namespace {
+
+Renderer_agg_base*
+createRenderer(const char *pixelformat)
 {
 
   if (!pixelformat) return nullptr;
@@ -2104,6 +2742,20 @@ DSOEXPORT Renderer_agg_base*  create_Renderer_agg(const char *pixelformat)
   return nullptr; // avoid compiler warning
 }
 
+} // anonymous namespace
+
+DSOEXPORT Renderer_agg_base*  create_Renderer_agg(const char *pixelformat)
+{
+  Renderer_agg_base* renderer = createRenderer(pixelformat);
+  if (renderer) {
+    const RcInitFile& rcfile = RcInitFile::getDefaultInstance();
+    renderer->setRenderThreads(rcfile.getRenderThreads());
+    renderer->setShapeCacheSize(
+            static_cast<size_t>(rcfile.getShapeCacheSize()) * 1024);
+  }
+  return renderer;
+}
+
 
 DSOEXPORT const char *agg_detect_pixel_format(unsigned int rofs,
         unsigned int rsize, unsigned int gofs, unsigned int gsize,
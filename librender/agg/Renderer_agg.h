@@ -46,6 +46,18 @@ public:
                              int rowstride) = 0;
     
     virtual unsigned int getBytesPerPixel() const = 0;
+
+    /// Render frames with the given number of threads
+    //
+    /// Frames are drawn by the calling thread when this is 1, which is
+    /// the default. 0 uses one thread per processor.
+    virtual void setRenderThreads(unsigned int threads) = 0;
+
+    /// Keep up to the given number of bytes of transformed shapes
+    //
+    /// Shapes drawn again with the same matrix then skip transforming
+    /// and flattening their paths. 0, the default, keeps none.
+    virtual void setShapeCacheSize(size_t bytes) = 0;
     
     unsigned int getBitsPerPixel() const { return getBytesPerPixel()*8; }
     
@@ -73,6 +85,8 @@ public:
 //
 /// If the given pixelformat is unsupported, or any other error
 /// occurs, NULL is returned.
+/// The renderer uses the number of threads set by the renderThreads
+/// option of gnashrc, and the shape cache size set by shapeCacheSize.
 ///
 DSOEXPORT Renderer_agg_base *create_Renderer_agg(const char *pixelformat);
   
@@ -0,0 +1,209 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef BACKEND_RENDER_HANDLER_AGG_CACHE_H
+#define BACKEND_RENDER_HANDLER_AGG_CACHE_H
+
+#include <list>
+#include <memory>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <boost/noncopyable.hpp>
+
+#include "SWFMatrix.h"
+
+namespace gnash {
+
+/// Identifies a subshape drawn with a given matrix
+//
+/// Shapes are told apart by their revision, which changes whenever their
+/// paths do. The matrix is compared in the fixed-point form it is kept
+/// in, so the same matrix always gives the same key.
+struct ShapeKey
+{
+    ShapeKey(std::uint64_t revision, size_t subshape, const SWFMatrix& mat)
+        :
+        revision(revision),
+        subshape(subshape),
+        a(mat.a()),
+        b(mat.b()),
+        c(mat.c()),
+        d(mat.d()),
+        tx(mat.tx()),
+        ty(mat.ty())
+    {}
+
+    bool operator==(const ShapeKey& o) const {
+        return revision == o.revision && subshape == o.subshape &&
+            a == o.a && b == o.b && c == o.c && d == o.d &&
+            tx == o.tx && ty == o.ty;
+    }
+
+    std::uint64_t revision;
+    size_t subshape;
+    std::int32_t a, b, c, d, tx, ty;
+};
+
+struct ShapeKeyHash
+{
+    size_t operator()(const ShapeKey& k) const {
+        std::uint64_t h = k.revision * 0x9e3779b97f4a7c15ULL + k.subshape;
+        const std::int32_t m[] = { k.a, k.b, k.c, k.d, k.tx, k.ty };
+        for (std::int32_t v : m) {
+            h = (h ^ static_cast<std::uint32_t>(v)) * 0x100000001b3ULL;
+        }
+        return static_cast<size_t>(h ^ (h >> 32));
+    }
+};
+
+/// Keeps the most recently drawn shapes within a memory budget
+//
+/// Entries are shared, so a frame that is still to be rendered keeps
+/// the ones it uses after they are evicted. The least recently found or
+/// inserted entries are evicted first.
+template<typename T>
+class ShapeCache : boost::noncopyable
+{
+public:
+
+    typedef std::shared_ptr<const T> Entry;
+
+    /// @param budget   The bytes the entries may take. 0 caches nothing.
+    explicit ShapeCache(size_t budget = 0)
+        :
+        _budget(budget),
+        _bytes(0),
+        _hits(0),
+        _misses(0),
+        _evictions(0)
+    {}
+
+    /// Find an entry, counting a hit or a miss
+    Entry find(const ShapeKey& key) {
+        if (!_budget) return Entry();
+
+        const typename Index::iterator it = _index.find(key);
+        if (it == _index.end()) {
+            ++_misses;
+            return Entry();
+        }
+        ++_hits;
+        _lru.splice(_lru.begin(), _lru, it->second);
+        return it->second->entry;
+    }
+
+    /// Add an entry taking about the given number of bytes.
+    //
+    /// It must not be cached already. Entries larger than the whole
+    /// budget are not kept.
+    void insert(const ShapeKey& key, const Entry& entry, size_t bytes) {
+        if (bytes > _budget) return;
+
+        _lru.push_front(Item(key, entry, bytes));
+        _index.emplace(key, _lru.begin());
+        _bytes += bytes;
+
+        while (_bytes > _budget) evict();
+    }
+
+    void clear() {
+        _index.clear();
+        _lru.clear();
+        _bytes = 0;
+    }
+
+    /// Change the budget, evicting entries beyond it.
+    void setBudget(size_t budget) {
+        _budget = budget;
+        while (_bytes > _budget) evict();
+    }
+
+    size_t budget() const { return _budget; }
+
+    size_t bytes() const { return _bytes; }
+
+    size_t size() const { return _lru.size(); }
+
+    std::uint64_t hits() const { return _hits; }
+
+    std::uint64_t misses() const { return _misses; }
+
+    std::uint64_t evictions() const { return _evictions; }
+
+    /// Print the number of entries and how often they were found.
+    void summarize(std::ostream& o) const {
+        const std::uint64_t lookups = _hits + _misses;
+        o << _lru.size() << " entries, " << _bytes / 1024 << " of "
+          << _budget / 1024 << " KB, " << _hits << " hits, " << _misses
+          << " misses";
+        if (lookups) o << " (" << _hits * 100 / lookups << "% hit)";
+        o << ", " << _evictions << " evicted";
+    }
+
+private:
+
+    struct Item
+    {
+        Item(const ShapeKey& key, const Entry& entry, size_t bytes)
+            :
+            key(key),
+            entry(entry),
+            bytes(bytes)
+        {}
+
+        ShapeKey key;
+        Entry entry;
+        size_t bytes;
+    };
+
+    typedef std::list<Item> LRU;
+    typedef std::unordered_map<ShapeKey, typename LRU::iterator,
+            ShapeKeyHash> Index;
+
+    void evict() {
+        const Item& last = _lru.back();
+        _bytes -= last.bytes;
+        _index.erase(last.key);
+        _lru.pop_back();
+        ++_evictions;
+    }
+
+    /// Most recently used first.
+    LRU _lru;
+
+    Index _index;
+
+    size_t _budget;
+
+    size_t _bytes;
+
+    std::uint64_t _hits;
+
+    std::uint64_t _misses;
+
+    std::uint64_t _evictions;
+};
+
+} // namespace gnash
+
+#endif // BACKEND_RENDER_HANDLER_AGG_CACHE_H
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
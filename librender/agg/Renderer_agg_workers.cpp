@@ -0,0 +1,128 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "Renderer_agg_workers.h"
+
+#include <algorithm>
+
+namespace gnash {
+
+RenderWorkers::RenderWorkers(size_t threads)
+    :
+    _generation(0),
+    _busy(0),
+    _stopping(false),
+    _job(nullptr),
+    _count(0),
+    _next(0)
+{
+    for (size_t i = 1; i < std::max<size_t>(threads, 1); ++i) {
+        _threads.emplace_back(&RenderWorkers::work, this);
+    }
+}
+
+RenderWorkers::~RenderWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _start.notify_all();
+    for (std::thread& t : _threads) t.join();
+}
+
+void
+RenderWorkers::run(size_t count, const Job& job)
+{
+    if (!count) return;
+
+    if (_threads.empty()) {
+        for (size_t i = 0; i < count; ++i) job(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _job = &job;
+        _count = count;
+        _next = 0;
+        _error = nullptr;
+        _busy = _threads.size();
+        ++_generation;
+    }
+    _start.notify_all();
+
+    takeTiles();
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [this] { return !_busy; });
+        _job = nullptr;
+        std::swap(error, _error);
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+void
+RenderWorkers::work()
+{
+    size_t generation = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _start.wait(lock, [this, generation] {
+                return _stopping || _generation != generation;
+            });
+            if (_stopping) return;
+            generation = _generation;
+        }
+
+        takeTiles();
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!--_busy) _done.notify_one();
+    }
+}
+
+void
+RenderWorkers::takeTiles()
+{
+    for (size_t i = _next++; i < _count; i = _next++) {
+        try {
+            (*_job)(i);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_error) _error = std::current_exception();
+            // Leave the remaining tiles; the frame is lost anyway.
+            _next = _count;
+        }
+    }
+}
+
+} // namespace gnash
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
@@ -0,0 +1,100 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef BACKEND_RENDER_HANDLER_AGG_WORKERS_H
+#define BACKEND_RENDER_HANDLER_AGG_WORKERS_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <boost/noncopyable.hpp>
+
+namespace gnash {
+
+/// The threads used to render the tiles of a frame
+//
+/// The threads are started once and wait between frames. The thread
+/// calling run() takes tiles too, so a pool of n threads starts n - 1.
+class RenderWorkers : boost::noncopyable
+{
+public:
+
+    typedef std::function<void(size_t)> Job;
+
+    /// @param threads  The number of threads rendering, at least 1.
+    explicit RenderWorkers(size_t threads);
+
+    ~RenderWorkers();
+
+    /// The number of threads rendering, including the caller of run().
+    size_t size() const {
+        return _threads.size() + 1;
+    }
+
+    /// Call job for each tile from 0 to count - 1
+    //
+    /// Tiles are taken in order by whichever thread is free. This
+    /// returns when all of them are done, rethrowing the first exception
+    /// a tile threw.
+    void run(size_t count, const Job& job);
+
+private:
+
+    void work();
+
+    /// Take tiles of the current job until there are none left.
+    void takeTiles();
+
+    std::vector<std::thread> _threads;
+
+    std::mutex _mutex;
+
+    /// Signalled when a job starts, or when the pool is destroyed.
+    std::condition_variable _start;
+
+    /// Signalled when the last worker leaves a job.
+    std::condition_variable _done;
+
+    /// Counts the jobs started, so that each worker joins each job once.
+    size_t _generation;
+
+    /// The number of workers that have not finished the current job.
+    size_t _busy;
+
+    bool _stopping;
+
+    const Job* _job;
+
+    size_t _count;
+
+    std::atomic<size_t> _next;
+
+    std::exception_ptr _error;
+};
+
+} // namespace gnash
+
+#endif // BACKEND_RENDER_HANDLER_AGG_WORKERS_H
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
@@ -139,10 +139,10 @@ public:
 		return new SWFMovie(o, this, parent);
 	}
 	
-	virtual const PlayList& get_playlist(size_t frame_number) const
+	virtual const PlayList* getPlaylist(size_t frame_number) const
 	{
-		assert ( frame_number < _playlist.size() );
-		return _playlist[frame_number];
+		if (frame_number >= _playlist.size()) return NULL;
+		return &_playlist[frame_number];
 	}
 
 	//
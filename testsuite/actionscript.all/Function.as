@@ -1123,12 +1123,109 @@ check(f.hasOwnProperty("constructor"));
 check_equals(called, 0);
 #endif
 
+//----------------------------------------------------------
+// Local variables of functions
+//----------------------------------------------------------
+
+f = function() {
+    var s = 0;
+    for (var i = 0; i < 5; ++i) s += i;
+    return s;
+};
+check_equals(f(), 10);
+
+// A deleted local is gone, so setting it again sets a timeline variable.
+f = function() {
+    var deletedLocal = 1;
+    check(delete deletedLocal);
+    check_equals(typeof(deletedLocal), "undefined");
+    deletedLocal = 3;
+    return deletedLocal;
+};
+check_equals(f(), 3);
+check_equals(deletedLocal, 3);
+delete deletedLocal;
+
+// A local hides a timeline variable only once it is declared.
+shadowedGlobal = "global";
+f = function() {
+    var before = shadowedGlobal;
+    var shadowedGlobal = "local";
+    var shadowedGlobal = "again";
+    return before + " " + shadowedGlobal;
+};
+check_equals(f(), "global again");
+check_equals(shadowedGlobal, "global");
+
+f = function() {
+    var xy = 5;
+    var n = "y";
+    return eval("x" + n);
+};
+check_equals(f(), 5);
+
+f = function() {
+    var shadowed = 1;
+    var o = { shadowed: 2 };
+    var r;
+    with (o) { r = shadowed; }
+    return r + " " + shadowed;
+};
+check_equals(f(), "2 1");
+
+f = function(a) {
+    arguments[0] = 9;
+    return a + " " + arguments[0] + " " + arguments.length;
+};
+check_equals(f(4), "4 9 1");
+
+// A function found in a local variable is called with the activation
+// object as 'this', which then has the locals as properties.
+bump = function() { return ++this.spilled; };
+f = function() {
+    var spilled = 7;
+    var s = bump;
+    check_equals(s(), 8);
+    check_equals(spilled, 8);
+    spilled = 20;
+    check_equals(s(), 21);
+    check(delete spilled);
+    return typeof(spilled);
+};
+check_equals(f(), "undefined");
+
+#if OUTPUT_VERSION > 5
+// Nested functions see the locals of the call they were defined in.
+f = function() {
+    var captured = 1;
+    var g = function() { captured = 5; };
+    g();
+    return captured;
+};
+check_equals(f(), 5);
+
+f = function() {
+    var captured = 1;
+    var g = function() { return captured; };
+    captured = 2;
+    return g();
+};
+check_equals(f(), 2);
+
+f = function() {
+    var kept = "kept";
+    return function() { return kept; };
+};
+g = f();
+check_equals(g(), "kept");
+#endif
+
 #if OUTPUT_VERSION == 5
- check_totals(150); // SWF5
+ check_totals(165); // SWF5
 #endif
 #if OUTPUT_VERSION == 6
- check_totals(263); // SWF6
+ check_totals(281); // SWF6
 #endif
 #if OUTPUT_VERSION >= 7
- check_totals(264); // SWF7,SWF8
+ check_totals(282); // SWF7,SWF8
 #endif
@@ -119,15 +119,15 @@ endOfTest = function()
 #endif
 
 #if OUTPUT_VERSION == 6
-	check_totals(927); // SWF6
+	check_totals(932); // SWF6
 #endif
 
 #if OUTPUT_VERSION == 7
-	check_totals(960); // SWF7
+	check_totals(964); // SWF7
 #endif
 
 #if OUTPUT_VERSION >= 8
-	check_totals(1077); // SWF8+
+	check_totals(1092); // SWF8+
 #endif
 
 	play();
@@ -1143,30 +1143,30 @@ check_equals(typeof(this.$version), 'undefined');
     check_equals(_root.filters.toString(), "");
 
     _root.filters = [ new flash.filters.ConvolutionFilter() ];
-    xcheck_equals(_root.filters.length, 1);
-    xcheck_equals(_root.filters.toString(), "[object Object]");
+    check_equals(_root.filters.length, 1);
+    check_equals(_root.filters.toString(), "[object Object]");
 
     _root.filters = [ new flash.filters.ConvolutionFilter(),
                       new flash.filters.DropShadowFilter() ];
-    xcheck_equals(_root.filters.length, 2);
-    xcheck_equals(_root.filters.toString(), "[object Object],[object Object]");
+    check_equals(_root.filters.length, 2);
+    check_equals(_root.filters.toString(), "[object Object],[object Object]");
 
     // The filters are recreated every time.
     tmp1 = _root.filters;
     tmp2 = _root.filters;
-    xcheck(tmp1[0] !== tmp2[0]);
+    check(tmp1[0] !== tmp2[0]);
     
     _root.filters = [ new flash.filters.ConvolutionFilter(),
                       new flash.filters.DropShadowFilter(),
                       "boh!" ];
-    xcheck_equals(_root.filters.length, 2);
-    xcheck_equals(_root.filters.toString(), "[object Object],[object Object]");
+    check_equals(_root.filters.length, 2);
+    check_equals(_root.filters.toString(), "[object Object],[object Object]");
 
     _root.filters = [ new flash.filters.ConvolutionFilter(),
                       "boh!",
                       new flash.filters.BlurFilter() ];
-    xcheck_equals(_root.filters.length, 2);
-    xcheck_equals(_root.filters.toString(), "[object Object],[object Object]");
+    check_equals(_root.filters.length, 2);
+    check_equals(_root.filters.toString(), "[object Object],[object Object]");
     
     _root.filters = 34;
     check_equals(_root.filters.length, 0);
@@ -1198,6 +1198,33 @@ check_equals(typeof(this.$version), 'undefined');
     _root.filters = "";
     check_equals(_root.filters.length, 0);
 
+    // The copies are filters of the same class.
+    cm = new flash.filters.ColorMatrixFilter([ 0, 1, 0, 0, 0, 1, 0, 0, 0, 0,
+                                               0, 0, 1, 0, 0, 0, 0, 0, 1, 0 ]);
+    _root.filters = [ new flash.filters.BlurFilter(), cm ];
+    check(_root.filters[0] instanceof flash.filters.BlurFilter);
+    check(_root.filters[1] instanceof flash.filters.ColorMatrixFilter);
+    check_equals(_root.filters[1].matrix.toString(),
+        "0,1,0,0,0,1,0,0,0,0,0,0,1,0,0,0,0,0,1,0");
+
+    // Changing a copy changes neither the clip's filters nor the original.
+    ch = _root.filters;
+    ch[1].matrix = [];
+    check_equals(_root.filters[1].matrix[1], 1);
+    check_equals(cm.matrix[1], 1);
+
+    cv = new flash.filters.ConvolutionFilter(3, 3, [ 0, 1, 0, 1, -4, 1, 0, 1, 0 ],
+                                             2, 1);
+    check_equals(cv.matrixX, 3);
+    check_equals(cv.matrixY, 3);
+    check_equals(cv.matrix.toString(), "0,1,0,1,-4,1,0,1,0");
+    check_equals(cv.divisor, 2);
+    check_equals(cv.bias, 1);
+    _root.filters = [ cv ];
+    check_equals(_root.filters[0].matrix.toString(), "0,1,0,1,-4,1,0,1,0");
+
+    _root.filters = [];
+
 #endif
 
 //------------------------------------------------
@@ -2220,6 +2247,14 @@ onData = function()
 	{
 		//note("Clearing data load interval "+dataLoadInterval);
 		clearInterval(dataLoadInterval);
+#if OUTPUT_VERSION > 5
+		check(efInheritedCalls > 0);
+		check(efSourceCalls > 0);
+		check_equals(efFromClipCalls, 0);
+#endif
+#if OUTPUT_VERSION == 6
+		check(efLowerCalls > 0);
+#endif
 		endOfTest();
 	}
 	else
@@ -2600,4 +2635,39 @@ check_equals(mc._x, 17);
 
 #endif
 
+//----------------------------------------------------------
+// onEnterFrame handlers inherited through the prototype chain
+// (checked in onData, after some frames have passed)
+//----------------------------------------------------------
+
+#if OUTPUT_VERSION > 5
+
+countEnterFrame = function() { _root[this._name + "Calls"]++; };
+efInheritedCalls = 0;
+efSourceCalls = 0;
+efFromClipCalls = 0;
+
+// The handler is set on the prototype after the clip got it.
+efProto = {};
+efInherited = createEmptyMovieClip("efInherited", getNextHighestDepth());
+efInherited.__proto__ = efProto;
+efProto.onEnterFrame = countEnterFrame;
+
+// DisplayObjects end the prototype chain, so a clip used as a prototype
+// doesn't pass its handler on.
+efFromClip = createEmptyMovieClip("efFromClip", getNextHighestDepth());
+efSource = createEmptyMovieClip("efSource", getNextHighestDepth());
+efFromClip.__proto__ = efSource;
+efSource.onEnterFrame = countEnterFrame;
+check_equals(efFromClip.onEnterFrame, undefined);
+
+#endif
+
+#if OUTPUT_VERSION == 6
+// Up to SWF6 the handler name is not case-sensitive.
+efLowerCalls = 0;
+efLower = createEmptyMovieClip("efLower", getNextHighestDepth());
+efLower.onenterframe = countEnterFrame;
+#endif
+
 //endOfTest();
@@ -797,6 +797,18 @@ check_equals(typeof(c[10]), 'undefined'); // was not protected..
 c.length = 11;
 check_equals(typeof(c[10]), 'undefined'); // and won't come back
 
+// Elements with very long indices are removed as well
+c = [ 1, 2, 3 ];
+c[1000000000] = 'far';
+check_equals(c.length, 1000000001);
+c.length = 2;
+check_equals(c.length, 2);
+check_equals(c[1], 2);
+check_equals(typeof(c[2]), 'undefined');
+check_equals(typeof(c[1000000000]), 'undefined');
+c.length = 1000000001;
+check_equals(typeof(c[1000000000]), 'undefined');
+
 //-------------------------------
 // Test sort
 //-------------------------------
@@ -1813,11 +1825,11 @@ check_equals(ar.__proto__, "string");
 //
 
 #if OUTPUT_VERSION < 6
- check_totals(552);
+ check_totals(559);
 #else
 # if OUTPUT_VERSION < 7
-  check_totals(636);
+  check_totals(643);
 # else
-  check_totals(646);
+  check_totals(653);
 # endif
 #endif
@@ -0,0 +1,176 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "GC.h"
+#include "log.h"
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <string>
+
+#include "check.h"
+
+using namespace gnash;
+
+namespace {
+
+size_t live = 0;
+size_t tracked = 0;
+
+class Node : public GcResource
+{
+public:
+    Node(GC& gc, bool track = false)
+        :
+        GcResource(gc),
+        _tracked(track)
+    {
+        ++live;
+        if (_tracked) ++tracked;
+    }
+
+    ~Node() {
+        --live;
+        if (_tracked) --tracked;
+    }
+
+    std::vector<Node*> children;
+
+protected:
+    void markReachableResources() const {
+        for (const Node* n : children) n->setReachable();
+    }
+
+private:
+    const bool _tracked;
+};
+
+class Root : public GcRoot
+{
+public:
+    void markReachableResources() const {
+        for (const Node* n : nodes) n->setReachable();
+    }
+    std::vector<Node*> nodes;
+};
+
+size_t
+heapBlocks()
+{
+    GC::HeapOccupancy heap;
+    GC::heapOccupancy(heap);
+    size_t n = 0;
+    for (const auto& c : heap) n += c.used;
+    return n;
+}
+
+size_t
+managed(const GC& gc)
+{
+    GC::CollectablesCount cc;
+    gc.countCollectables(cc);
+    size_t n = 0;
+    for (const auto& c : cc) n += c.second;
+    return n;
+}
+
+}
+
+TRYMAIN(_runtest);
+int
+trymain(int /*argc*/, char** /*argv*/)
+{
+    LogFile& lgf = LogFile::getDefaultInstance();
+    lgf.setVerbosity(2);
+
+    Root root;
+    {
+        GC gc(root);
+
+        // A full cycle keeps what the root reaches, directly or not.
+        Node* a = new Node(gc);
+        Node* b = new Node(gc);
+        a->children.push_back(b);
+        new Node(gc);
+        root.nodes.push_back(a);
+
+        gc.runCycle();
+        check_equals(live, 2);
+        check_equals(managed(gc), 2);
+        check_equals(gc.stats().cycles, 1);
+        check_equals(heapBlocks(), 2);
+
+        // Garbage in the old generation goes with a full cycle too.
+        a->children.clear();
+        gc.runCycle();
+        check_equals(live, 1);
+
+        // Young garbage goes with the first automatic cycle.
+        for (size_t i = 0; i < 1000; ++i) new Node(gc);
+        gc.fuzzyCollect();
+        check_equals(live, 1);
+        check_equals(gc.stats().deleted, 1000);
+        check_equals(gc.stats().allocated, 1003);
+        check_equals(gc.stats().freed, 1002);
+
+        // Build a large old generation.
+        for (size_t i = 0; i < 10000; ++i) a->children.push_back(new Node(gc));
+        for (size_t i = 0; i < 40000; ++i) {
+            a->children.push_back(new Node(gc, true));
+        }
+        gc.runCycle();
+        check_equals(live, 50001);
+        const size_t oldSweeps = gc.stats().oldSweeps;
+
+        // Dropped old resources are swept over several calls, which
+        // keep the survivors and the resources promoted meanwhile.
+        a->children.resize(10000);
+        size_t calls = 0;
+        size_t kept = 0;
+        size_t maxDeleted = 0;
+        while (tracked && calls < 100) {
+            a->children.push_back(new Node(gc));
+            ++kept;
+            for (size_t i = 0; i < 10000; ++i) new Node(gc);
+            gc.fuzzyCollect();
+            check_equals(managed(gc), live);
+            maxDeleted = std::max(maxDeleted, gc.stats().deleted);
+            ++calls;
+        }
+        check_equals(tracked, 0);
+        check(maxDeleted < 40000);
+        check(gc.stats().oldSweeps > oldSweeps);
+        check(gc.stats().maxPause >= gc.stats().lastPause);
+
+        gc.runCycle();
+        check_equals(live, 10001 + kept);
+        check_equals(managed(gc), live);
+        check_equals(heapBlocks(), live);
+    }
+
+    // The collector deletes everything it manages.
+    check_equals(live, 0);
+    check_equals(heapBlocks(), 0);
+
+    return 0;
+}
+
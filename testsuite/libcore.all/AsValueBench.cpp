@@ -0,0 +1,166 @@
+// AsValueBench.cpp: time as_value copies and conversions
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "DummyMovieDefinition.h"
+#include "VM.h"
+#include "movie_root.h"
+#include "Movie.h"
+#include "as_object.h"
+#include "as_value.h"
+#include "log.h"
+#include "ManualClock.h"
+#include "RunResources.h"
+#include "StreamProvider.h"
+#include "ClockTime.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdlib>
+
+using namespace std;
+using namespace gnash;
+
+// Prints the time taken to copy, assign and convert a mix of values of
+// every type, as the VM does when pushing, storing and passing them.
+//
+// Pass a number to scale the amount of work; the default keeps
+// 'make check' quick.
+
+namespace {
+
+class Stopwatch
+{
+public:
+    Stopwatch() : _start(clocktime::getTicks()) {}
+    std::uint64_t elapsed() const { return clocktime::getTicks() - _start; }
+private:
+    std::uint64_t _start;
+};
+
+void
+report(const string& what, size_t ops, std::uint64_t ms)
+{
+    cout << "  " << what << ": " << ops << " in " << ms << " ms";
+    if (ms) cout << " (" << ops / ms << "/ms)";
+    cout << endl;
+}
+
+}
+
+int
+main(int argc, char** argv)
+{
+    const size_t scale = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1;
+
+    RunResources runResources;
+    const URL url("");
+    runResources.setStreamProvider(
+            std::shared_ptr<StreamProvider>(new StreamProvider(url, url)));
+
+    boost::intrusive_ptr<movie_definition> md(
+            new DummyMovieDefinition(runResources, 7));
+
+    ManualClock clock;
+    movie_root root(clock, runResources);
+    root.init(md.get(), MovieClip::MovieVariables());
+
+    VM& vm = root.getVM();
+    as_object* obj = new as_object(getGlobal(vm));
+    as_object* clip = getObject(&root.getRootMovie());
+
+    cout << "sizeof(as_value): " << sizeof(as_value) << endl;
+
+    vector<as_value> values;
+    for (size_t i = 0; i < 1000; ++i) {
+        switch (i % 8) {
+            case 0: values.push_back(as_value()); break;
+            case 1: values.push_back(as_value(static_cast<double>(i))); break;
+            case 2: values.push_back(as_value(i % 3 == 0)); break;
+            case 3: values.push_back(as_value("12.5")); break;
+            case 4: values.push_back(as_value(obj)); break;
+            case 5: values.push_back(as_value(clip)); break;
+            case 6: values.push_back(as_value(i * 0.25)); break;
+            default: values.push_back(as_value("0x1F")); break;
+        }
+    }
+
+    const size_t rounds = 2000 * scale;
+    const size_t ops = rounds * values.size();
+
+    Stopwatch c;
+    for (size_t r = 0; r < rounds; ++r) {
+        vector<as_value> copy(values);
+        if (copy.size() != values.size()) std::abort();
+    }
+    report("copy", ops, c.elapsed());
+
+    vector<as_value> dst(values.size());
+    Stopwatch a;
+    for (size_t r = 0; r < rounds; ++r) {
+        for (size_t i = 0, e = values.size(); i < e; ++i) {
+            dst[(i + r) % e] = values[i];
+        }
+    }
+    report("assign", ops, a.elapsed());
+
+    double sum = 0;
+    Stopwatch n;
+    for (size_t r = 0; r < rounds; ++r) {
+        for (const as_value& v : values) {
+            if (v.is_number() || v.is_string() || v.is_bool()) {
+                sum += v.to_number(7);
+            }
+        }
+    }
+    report("to_number", ops, n.elapsed());
+
+    size_t length = 0;
+    Stopwatch s;
+    for (size_t r = 0; r < rounds / 10; ++r) {
+        for (const as_value& v : values) {
+            if (!v.is_object()) length += v.to_string().size();
+        }
+    }
+    report("to_string", ops / 10, s.elapsed());
+
+    size_t truths = 0;
+    Stopwatch b;
+    for (size_t r = 0; r < rounds; ++r) {
+        for (const as_value& v : values) truths += v.to_bool(7);
+    }
+    report("to_bool", ops, b.elapsed());
+
+    // Keep the results alive.
+    if (isNaN(sum) || !length || !truths) {
+        cout << "  ERROR: unexpected conversion results" << endl;
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
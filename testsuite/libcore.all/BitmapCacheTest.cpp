@@ -0,0 +1,216 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "log.h"
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "check.h"
+#include "BitmapCache.h"
+#include "Renderer.h"
+#include "CachedBitmap.h"
+#include "GnashImage.h"
+#include "Transform.h"
+#include "SWFMatrix.h"
+#include "SWFCxForm.h"
+#include "SWFRect.h"
+
+using namespace gnash;
+
+namespace {
+
+class TestBitmap : public CachedBitmap
+{
+public:
+    explicit TestBitmap(std::unique_ptr<image::GnashImage> im)
+        :
+        _image(std::move(im))
+    {}
+
+    image::GnashImage& image() { return *_image; }
+    void dispose() { _image.reset(); }
+    bool disposed() const { return !_image.get(); }
+
+private:
+    std::unique_ptr<image::GnashImage> _image;
+};
+
+/// Records what is drawn, and draws into bitmaps with another of itself.
+class TestRenderer : public Renderer
+{
+public:
+
+    explicit TestRenderer(bool internal = true)
+        :
+        shapes(0),
+        xoff(0),
+        yoff(0),
+        image(nullptr),
+        _internal(internal)
+    {}
+
+    std::string description() const { return "Test"; }
+
+    CachedBitmap* createCachedBitmap(std::unique_ptr<image::GnashImage> im) {
+        return new TestBitmap(std::move(im));
+    }
+
+    void drawVideoFrame(image::GnashImage*, const Transform&, const SWFRect*,
+            bool) {}
+    void drawLine(const std::vector<point>&, const rgba&, const SWFMatrix&) {}
+    void draw_poly(const std::vector<point>&, const rgba&, const rgba&,
+            const SWFMatrix&, bool) {}
+
+    void drawShape(const SWF::ShapeRecord&, const Transform& xform) {
+        ++shapes;
+        last = xform;
+    }
+
+    void drawGlyph(const SWF::ShapeRecord&, const rgba&, const SWFMatrix&) {}
+    void begin_submit_mask() {}
+    void end_submit_mask() {}
+    void disable_mask() {}
+
+    geometry::Range2d<int> world_to_pixel(const SWFRect&) const {
+        return geometry::Range2d<int>();
+    }
+
+    point pixel_to_world(int x, int y) const { return point(x, y); }
+
+    void set_translation(float x, float y) {
+        xoff = x;
+        yoff = y;
+    }
+
+    size_t shapes;
+    Transform last;
+    float xoff;
+    float yoff;
+
+    /// The image of the last internal render.
+    image::GnashImage* image;
+
+    std::unique_ptr<TestRenderer> inner;
+
+private:
+
+    void begin_display(const rgba&, int, int, float, float, float, float) {}
+    void end_display() {}
+
+    Renderer* startInternalRender(image::GnashImage& im) {
+        if (!_internal) return nullptr;
+        image = &im;
+        inner.reset(new TestRenderer);
+        return inner.get();
+    }
+
+    void endInternalRender() {}
+
+    bool _internal;
+};
+
+}
+
+int
+main()
+{
+    TestRenderer r;
+    BitmapCache cache;
+
+    // 100x50 pixels, drawn at (10, 20) pixels.
+    const SWFRect bounds(0, 0, 2000, 1000);
+    SWFMatrix m;
+    m.set_translation(200, 400);
+    SWFCxForm cx;
+    cx.aa = 128;
+
+    size_t draws = 0;
+    SWFMatrix drawn;
+    const BitmapCache::Draw draw = [&](Renderer&, const Transform& x) {
+        ++draws;
+        drawn = x.matrix;
+        check(x.colorTransform == SWFCxForm());
+    };
+
+    // The first update draws the content in world coordinates into a
+    // bitmap with a pixel to spare on each side.
+    check(cache.update(r, Transform(m, cx), bounds, draw));
+    check_equals(draws, 1);
+    check(drawn == m);
+    check(r.image);
+    check_equals(r.image->width(), 102);
+    check_equals(r.image->height(), 52);
+    check(r.inner.get());
+    check_equals(r.inner->xoff, -9);
+    check_equals(r.inner->yoff, -19);
+
+    cache.display(r, Transform(m, cx));
+    check_equals(r.shapes, 1);
+    check_equals(r.last.matrix.tx(), 180);
+    check_equals(r.last.matrix.ty(), 380);
+    check(r.last.colorTransform == cx);
+
+    // Moving does not draw again; the bitmap moves by whole pixels.
+    m.set_translation(230, 390);
+    check(cache.update(r, Transform(m, cx), bounds, draw));
+    check_equals(draws, 1);
+    cache.display(r, Transform(m, cx));
+    check_equals(r.last.matrix.tx(), 220);
+    check_equals(r.last.matrix.ty(), 360);
+
+    // Nor does changing the color transform.
+    check(cache.update(r, Transform(m, SWFCxForm()), bounds, draw));
+    check_equals(draws, 1);
+
+    // Scaling does.
+    m.set_scale(2, 2);
+    check(cache.update(r, Transform(m, cx), bounds, draw));
+    check_equals(draws, 2);
+    check_equals(r.image->width(), 203);
+
+    // So do changes to the content.
+    cache.invalidate();
+    check(cache.update(r, Transform(m, cx), bounds, draw));
+    check_equals(draws, 3);
+    check(cache.update(r, Transform(m, cx), SWFRect(0, 0, 2000, 2000), draw));
+    check_equals(draws, 4);
+
+    // Content too large for a bitmap is drawn normally.
+    m.set_scale(40, 40);
+    check(!cache.update(r, Transform(m, cx), bounds, draw));
+    check_equals(draws, 4);
+
+    // As is everything when the renderer cannot draw into bitmaps.
+    TestRenderer external(false);
+    BitmapCache unsupported;
+    check(!unsupported.update(external, Transform(), bounds, draw));
+    check(!unsupported.update(external, Transform(), bounds, draw));
+    check_equals(draws, 4);
+
+    return 0;
+}
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
@@ -0,0 +1,308 @@
+// CallBench.cpp: time ActionScript calls of native and user functions
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "MovieFactory.h"
+#include "movie_definition.h"
+#include "movie_root.h"
+#include "Movie.h"
+#include "VM.h"
+#include "fn_call.h"
+#include "Global_as.h"
+#include "as_object.h"
+#include "as_value.h"
+#include "log.h"
+#include "ManualClock.h"
+#include "RunResources.h"
+#include "StreamProvider.h"
+#include "IOChannel.h"
+#include "tu_file.h"
+#include "ClockTime.h"
+#include "swf/TagLoadersTable.h"
+#include "swf/DefaultTagLoaders.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+using namespace std;
+using namespace gnash;
+
+// Prints the time taken by ActionScript loops calling a native function
+// (Math.max), a DefineFunction function and a DefineFunction2 function
+// with two arguments, and by the same loop without a call.
+//
+// The loops are functions of a SWF built in memory, so that the calls
+// go through CallFunction and CallMethod as in a real movie.
+//
+// Pass a number to scale the amount of work; the default keeps
+// 'make check' quick.
+
+namespace {
+
+class Stopwatch
+{
+public:
+    Stopwatch() : _start(clocktime::getTicks()) {}
+    std::uint64_t elapsed() const { return clocktime::getTicks() - _start; }
+private:
+    std::uint64_t _start;
+};
+
+/// AVM1 bytecode.
+class Code
+{
+public:
+
+    Code& op(std::uint8_t code) {
+        _b.push_back(code);
+        return *this;
+    }
+
+    Code& push(const string& s) {
+        vector<std::uint8_t> p(1, 0);
+        p.insert(p.end(), s.begin(), s.end());
+        p.push_back(0);
+        return action(0x96, p);
+    }
+
+    Code& push(std::int32_t n) {
+        vector<std::uint8_t> p(1, 7);
+        for (int i = 0; i < 4; ++i) p.push_back(n >> (8 * i));
+        return action(0x96, p);
+    }
+
+    Code& pushRegister(std::uint8_t reg) {
+        return action(0x96, vector<std::uint8_t>{4, reg});
+    }
+
+    Code& branch(std::uint8_t code, std::int16_t offset) {
+        return action(code, vector<std::uint8_t>{
+            std::uint8_t(offset), std::uint8_t(offset >> 8)});
+    }
+
+    Code& action(std::uint8_t code, const vector<std::uint8_t>& payload) {
+        op(code);
+        putU16(payload.size());
+        _b.insert(_b.end(), payload.begin(), payload.end());
+        return *this;
+    }
+
+    Code& append(const Code& c) {
+        _b.insert(_b.end(), c._b.begin(), c._b.end());
+        return *this;
+    }
+
+    Code& putU16(std::uint16_t n) {
+        _b.push_back(n);
+        _b.push_back(n >> 8);
+        return *this;
+    }
+
+    Code& putU32(std::uint32_t n) {
+        putU16(n);
+        return putU16(n >> 16);
+    }
+
+    Code& putString(const string& s) {
+        _b.insert(_b.end(), s.begin(), s.end());
+        _b.push_back(0);
+        return *this;
+    }
+
+    size_t size() const { return _b.size(); }
+
+    const vector<std::uint8_t>& bytes() const { return _b; }
+
+private:
+    vector<std::uint8_t> _b;
+};
+
+Code
+defineFunction(const string& name, const vector<string>& params,
+        const Code& body)
+{
+    Code p;
+    p.putString(name).putU16(params.size());
+    for (const string& s : params) p.putString(s);
+    p.putU16(body.size());
+    return Code().action(0x9b, p.bytes()).append(body);
+}
+
+/// A DefineFunction2 with arguments in registers 1 and up and no
+/// this, arguments or super.
+Code
+defineFunction2(const string& name, const vector<string>& params,
+        const Code& body)
+{
+    Code p;
+    p.putString(name).putU16(params.size());
+    p.op(params.size() + 1).putU16(0x2a);
+    for (size_t i = 0; i < params.size(); ++i) {
+        p.op(i + 1).putString(params[i]);
+    }
+    p.putU16(body.size());
+    return Code().action(0x8e, p.bytes()).append(body);
+}
+
+/// function name(n) { var i = 0; while (i < n) { body; ++i; } return i; }
+Code
+loopFunction(const string& name, const Code& body)
+{
+    Code next;
+    next.push("i").push("i").op(0x1c).op(0x50).op(0x1d);
+
+    Code test;
+    test.push("i").op(0x1c).push("n").op(0x1c).op(0x48).op(0x12);
+
+    // Each branch is 5 bytes long.
+    const int skip = body.size() + next.size() + 5;
+    const int back = -(test.size() + 5 + skip);
+
+    Code c;
+    c.push("i").push(0).op(0x3c);
+    c.append(test).branch(0x9d, skip);
+    c.append(body).append(next).branch(0x99, back);
+    c.push("i").op(0x1c).op(0x3e);
+    return defineFunction(name, vector<string>{"n"}, c);
+}
+
+vector<std::uint8_t>
+makeSWF(const Code& actions)
+{
+    Code tags;
+    tags.putU16((12 << 6) | 0x3f).putU32(actions.size()).append(actions);
+    tags.putU16(1 << 6).putU16(0);
+
+    // Empty frame rectangle, 12 fps, one frame.
+    Code swf;
+    swf.op('F').op('W').op('S').op(7);
+    swf.putU32(8 + 5 + tags.size());
+    swf.op(0).putU16(12 << 8).putU16(1).append(tags);
+    return swf.bytes();
+}
+
+/// Push the arguments (i, 2).
+Code&
+callArgs(Code& c)
+{
+    return c.push(2).push("i").op(0x1c).push(2);
+}
+
+}
+
+int
+main(int argc, char** argv)
+{
+    const size_t scale = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1;
+    const std::int32_t calls = 100000 * scale;
+
+    Code f;
+    f.push("a").op(0x1c).op(0x3e);
+    Code f2;
+    f2.pushRegister(1).op(0x3e);
+
+    Code native;
+    callArgs(native).push("Math").op(0x1c).push("max").op(0x52).op(0x17);
+    Code user;
+    callArgs(user).push("f").op(0x3d).op(0x17);
+    Code user2;
+    callArgs(user2).push("f2").op(0x3d).op(0x17);
+
+    Code actions;
+    actions.append(defineFunction("f", vector<string>{"a", "b"}, f));
+    actions.append(defineFunction2("f2", vector<string>{"a", "b"}, f2));
+    actions.append(loopFunction("none", Code()));
+    actions.append(loopFunction("native", native));
+    actions.append(loopFunction("user", user));
+    actions.append(loopFunction("user2", user2));
+    actions.op(0);
+
+    const vector<std::uint8_t> swf = makeSWF(actions);
+    FILE* fp = std::tmpfile();
+    if (!fp || std::fwrite(&swf[0], swf.size(), 1, fp) != 1) {
+        cout << "  ERROR: could not write the test movie" << endl;
+        return EXIT_FAILURE;
+    }
+    std::rewind(fp);
+
+    RunResources runResources;
+    const URL url("file:///CallBench.swf");
+    runResources.setStreamProvider(
+            std::shared_ptr<StreamProvider>(new StreamProvider(url, url)));
+    std::shared_ptr<SWF::TagLoadersTable> loaders(new SWF::TagLoadersTable());
+    addDefaultLoaders(*loaders);
+    runResources.setTagLoaders(loaders);
+
+    boost::intrusive_ptr<movie_definition> md(MovieFactory::makeMovie(
+                makeFileChannel(fp, true), url.str(), runResources, false));
+    if (!md) {
+        cout << "  ERROR: could not load the test movie" << endl;
+        return EXIT_FAILURE;
+    }
+    md->completeLoad();
+    md->ensure_frame_loaded(md->get_frame_count());
+
+    ManualClock clock;
+    movie_root root(clock, runResources);
+    Movie* movie = root.init(md.get(), MovieClip::MovieVariables());
+    VM& vm = root.getVM();
+    as_object* target = getObject(movie);
+
+    cout << "sizeof(fn_call): " << sizeof(fn_call) << endl;
+    cout << calls << " calls with 2 arguments:" << endl;
+
+    const char* loops[] = { "none", "native", "user", "user2" };
+    for (const char* name : loops) {
+        const as_value loop = getMember(*target, getURI(vm, name));
+        if (!loop.is_function()) {
+            cout << "  ERROR: " << name << " is not defined" << endl;
+            return EXIT_FAILURE;
+        }
+
+        fn_call::Args args;
+        args += calls;
+
+        Stopwatch t;
+        const as_value ret = invoke(loop, as_environment(vm), target, args);
+        const std::uint64_t ms = t.elapsed();
+
+        cout << "  " << name << ": " << ms << " ms";
+        if (ms) cout << " (" << calls / ms << "/ms)";
+        cout << endl;
+
+        if (toNumber(ret, vm) != calls) {
+            cout << "  ERROR: " << name << " returned " << ret << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    return 0;
+}
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
@@ -36,6 +36,7 @@
 #include "Shape.h"
 #include "TextField.h"
 #include "SWFStream.h"
+#include "fn_call.h"
 #include "FillStyle.h"
 #include "swf/DefineFontAlignZonesTag.h"
 #include "swf/DefineShapeTag.h"
@@ -82,13 +83,19 @@ using namespace gnash::SWF;
 (as_object) \
 (DisplayObject) (StaticText) (MorphShape) (Shape) \
 (InteractiveObject) (MovieClip) (TextField) (Button) (Movie) \
-(movie_root) (PropFlags) (ObjectURI)
+(movie_root) (PropFlags) (ObjectURI) (fn_call)
 
 int
 main(int /*argc*/, char** /*argv*/)
 {
     std::cout << "Gnash class sizes:\n";
     BOOST_PP_SEQ_FOR_EACH(SIZE, _, TYPES)
+
+    // Values are copied on every push, store and call, so they must
+    // stay a type and a pointer-sized payload.
+    check(sizeof(as_value) <= 16);
+    check(sizeof(as_value) <= 2 * sizeof(double));
+
     return 0;
 }
 
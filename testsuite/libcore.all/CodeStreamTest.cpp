@@ -24,10 +24,10 @@
 #include "log.h"
 
 #include <iostream>
-#include <sstream>
 #include <cassert>
 #include <cmath>
 #include <string>
+#include <vector>
 
 #include "check.h"
 
@@ -37,12 +37,23 @@ using namespace gnash;
 using std::cout;
 using std::endl;
 
+namespace {
+
+bool
+verify(const std::vector<std::uint8_t>& code)
+{
+	CodeStream stream(code.data(), code.data() + code.size());
+	return stream.verify();
+}
+
+}
+
 int
 main(int /*argc*/, char** /*argv*/)
 {
-	char data[10] = {0x4,0x1,0x2,0x3,0x4,0x5,0x6,0x7,0x8,0x9};
+	const std::uint8_t data[10] = {0x4,0x1,0x2,0x3,0x4,0x5,0x6,0x7,0x8,0x9};
 	
-	CodeStream* stream = new CodeStream(std::string(data,10));
+	CodeStream* stream = new CodeStream(data, data + 10);
 	
 	//Test read_as30p()
 	std::uint8_t opcode;
@@ -55,19 +66,15 @@ main(int /*argc*/, char** /*argv*/)
 	//Make sure we stopped at the right spot.
 	check_equals(i,10);
 
-	//Reset stream.
-	stream->seekTo(0);
-	stream->clear();
-
 	//Test seekTo
 	stream->seekTo(5);
+	check_equals(stream->tell(), 5);
 	
 	opcode = stream->read_as3op();
 	check_equals(opcode,data[5]);
 
 	//Reset stream.
 	stream->seekTo(0);
-	stream->clear();	
 
 	//Test read_u8.
 	i=0;
@@ -77,8 +84,8 @@ main(int /*argc*/, char** /*argv*/)
 		i++;
 	}
 	
-	char newData[6] = {0x5,0xC5,0x0,0x0,0x1,0x2}; 
-	CodeStream* streamA = new CodeStream(std::string(newData,6));
+	const std::uint8_t newData[6] = {0x5,0xC5,0x0,0x0,0x1,0x2}; 
+	CodeStream* streamA = new CodeStream(newData, newData + 6);
 	
 	std::uint8_t byteA = streamA->read_u8();
 	check_equals(byteA,newData[0]);
@@ -87,7 +94,73 @@ main(int /*argc*/, char** /*argv*/)
 	std::int32_t byteB = streamA->read_S24();
 	check_equals(byteB,197);
 
+	const std::uint8_t negative[3] = {0xFE, 0xFF, 0xFF};
+	CodeStream streamB(negative, negative + 3);
+	check_equals(streamB.read_S24(), -2);
+
+	//Test read_V32.
+	const std::uint8_t v32[8] = {0x7F, 0x80, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F};
+	CodeStream streamC(v32, v32 + 8);
+	check_equals(streamC.read_V32(), 0x7Fu);
+	check_equals(streamC.read_V32(), 0x80u);
+	check_equals(streamC.read_V32(), 0xFFFFFFFFu);
+	check_equals(streamC.tell(), 8);
+
+	//Test verify.
 	
-	
+	// getlocal0, pushscope, pushbyte 1, iftrue +2, pushbyte 2, pop,
+	// returnvoid
+	std::vector<std::uint8_t> code = {0xD0, 0x30, 0x24, 0x1, 0x11, 0x2, 0x0,
+		0x0, 0x24, 0x2, 0x29, 0x47};
+	check(verify(code));
+
+	// Into the operand of pushbyte.
+	code[5] = 0x1;
+	check(!verify(code));
+
+	// A branch to the end of the code is a return.
+	code[5] = 0x4;
+	check(verify(code));
+	code[5] = 0x5;
+	check(!verify(code));
+
+	// Backwards, to the jump itself and to before the code.
+	code = {0x9, 0x10, 0xFC, 0xFF, 0xFF};
+	check(verify(code));
+	code[2] = 0xFA;
+	check(!verify(code));
+
+	// Truncated operands.
+	check(!verify({0x24}));
+	check(!verify({0x46, 0x1}));
+	check(!verify({0x46, 0x1, 0x80}));
+	check(verify({0x46, 0x1, 0x80, 0x1}));
+	check(!verify({0x10, 0x0}));
+
+	// Unknown opcodes.
+	check(!verify({0x2, 0xFF}));
+
+	// lookupswitch: the default and two cases, relative to the opcode.
+	code = {0x1B, 0x0D, 0x0, 0x0, 0x1, 0x0B, 0x0, 0x0, 0x0C, 0x0, 0x0,
+		0x2, 0x2, 0x47};
+	check(verify(code));
+	code[1] = 0x0E;
+	check(verify(code));
+	code[1] = 0x09;
+	check(!verify(code));
+
+	// Too many cases.
+	code[1] = 0x0D;
+	code[4] = 0x5;
+	check(!verify(code));
+
+	// The stream is left at the start.
+	CodeStream streamD(code.data(), code.data() + code.size());
+	streamD.verify();
+	check_equals(streamD.tell(), 0);
+
+	delete stream;
+	delete streamA;
+
 	return 0;
 }
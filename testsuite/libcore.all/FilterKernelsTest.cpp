@@ -0,0 +1,246 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "log.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "check.h"
+#include "FilterKernels.h"
+#include "Filters.h"
+#include "GnashImage.h"
+
+using namespace gnash;
+
+namespace {
+
+/// A reproducible image of premultiplied pixels, some transparent.
+void
+fill(image::GnashImage& im)
+{
+    std::uint32_t seed = 12345;
+    for (std::uint8_t* p = im.begin(); p != im.end(); p += 4) {
+        seed = seed * 1103515245 + 12345;
+        const std::uint8_t a = (seed >> 8) % 4 ? seed >> 16 : 0;
+        for (size_t c = 0; c < 3; ++c) {
+            seed = seed * 1103515245 + 12345;
+            p[c] = ((seed >> 16) & 0xff) * a / 255;
+        }
+        p[3] = a;
+    }
+}
+
+/// Whether a kernel gives the same pixels with and without SIMD.
+bool
+sameWithoutSimd(const std::function<void(image::GnashImage&)>& kernel)
+{
+    // Odd sizes, so that the vector loops have leftovers.
+    image::ImageRGBA a(37, 29);
+    fill(a);
+    image::ImageRGBA b(37, 29);
+    std::copy(a.begin(), a.end(), b.begin());
+
+    const bool simd = filter::simd();
+    kernel(a);
+    filter::setSimd(false);
+    kernel(b);
+    filter::setSimd(simd);
+
+    return std::equal(a.begin(), a.end(), b.begin());
+}
+
+std::uint8_t*
+pixel(image::GnashImage& im, size_t x, size_t y)
+{
+    return scanline(im, y) + x * 4;
+}
+
+}
+
+int
+main()
+{
+    if (!filter::simd()) {
+        std::cout << "Built without SSE2: comparing plain kernels" << std::endl;
+    }
+
+    // A single white pixel blurred by a 3x3 box spreads evenly.
+    image::ImageRGBA im(5, 5);
+    std::fill(im.begin(), im.end(), 0);
+    std::fill(pixel(im, 2, 2), pixel(im, 2, 2) + 4, 255);
+    filter::boxBlur(im, 3, 3, 1);
+    check_equals(+pixel(im, 2, 2)[0], 28);
+    check_equals(+pixel(im, 1, 1)[3], 28);
+    check_equals(+pixel(im, 3, 3)[3], 28);
+    check_equals(+pixel(im, 0, 2)[3], 0);
+    check_equals(+pixel(im, 2, 4)[3], 0);
+
+    // Blurs smaller than three pixels do nothing.
+    check_equals(filter::blurRadius(1.5), 0);
+    check_equals(filter::blurRadius(3), 1);
+    check_equals(filter::blurRadius(1000), 127);
+
+    // An identity color matrix keeps opaque pixels, and one swapping
+    // red and blue swaps them.
+    image::ImageRGBA opaque(2, 1);
+    const std::uint8_t px[] = { 200, 100, 50, 255, 10, 20, 30, 255 };
+    std::copy(px, px + 8, opaque.begin());
+    const float identity[] = {
+        1, 0, 0, 0, 0,
+        0, 1, 0, 0, 0,
+        0, 0, 1, 0, 0,
+        0, 0, 0, 1, 0
+    };
+    filter::colorMatrix(opaque, identity);
+    check(std::equal(px, px + 8, opaque.begin()));
+
+    const float swap[] = {
+        0, 0, 1, 0, 0,
+        0, 1, 0, 0, 0,
+        1, 0, 0, 0, 0,
+        0, 0, 0, 1, 0
+    };
+    filter::colorMatrix(opaque, swap);
+    check_equals(+opaque.begin()[0], 50);
+    check_equals(+opaque.begin()[2], 200);
+
+    // The offset is in 0..255 and the results are clamped.
+    const float brighten[] = {
+        1, 0, 0, 0, 100,
+        0, 1, 0, 0, 0,
+        0, 0, 1, 0, 0,
+        0, 0, 0, 1, 0
+    };
+    filter::colorMatrix(opaque, brighten);
+    check_equals(+opaque.begin()[0], 150);
+    check_equals(+opaque.begin()[4], 130);
+
+    // A convolution with only a center of 1 changes nothing.
+    std::copy(px, px + 8, opaque.begin());
+    const float center[] = { 0, 0, 0, 0, 1, 0, 0, 0, 0 };
+    filter::convolve(opaque, 3, 3, center, 1, 0, false, true, 0, 0);
+    check(std::equal(px, px + 8, opaque.begin()));
+
+    // Pixels outside the image are the edge's when clamped, else the
+    // given color.
+    const float left[] = { 0, 0, 0, 1, 0, 0, 0, 0, 0 };
+    filter::convolve(opaque, 3, 3, left, 1, 0, false, true, 0, 0);
+    check_equals(+opaque.begin()[0], 200);
+    check_equals(+opaque.begin()[4], 200);
+    filter::convolve(opaque, 3, 3, left, 1, 0, false, false, 0xff0000, 255);
+    check_equals(+opaque.begin()[0], 255);
+    check_equals(+opaque.begin()[1], 0);
+    check_equals(+opaque.begin()[4], 200);
+
+    // An unblurred shadow is the shape offset, behind the shape.
+    image::ImageRGBA dot(5, 5);
+    std::fill(dot.begin(), dot.end(), 0);
+    std::fill(pixel(dot, 1, 2), pixel(dot, 1, 2) + 4, 255);
+    filter::shadow(dot, 2, 0, 0x0000ff, 255, 0, 0, 1, 1, false, false, false);
+    check_equals(+pixel(dot, 1, 2)[0], 255);
+    check_equals(+pixel(dot, 3, 2)[0], 0);
+    check_equals(+pixel(dot, 3, 2)[2], 255);
+    check_equals(+pixel(dot, 3, 2)[3], 255);
+    check_equals(+pixel(dot, 2, 2)[3], 0);
+
+    // Knocked out, only the shadow is left.
+    filter::shadow(dot, 0, 1, 0x00ff00, 128, 0, 0, 1, 1, false, true, false);
+    check_equals(+pixel(dot, 1, 2)[3], 0);
+    check_equals(+pixel(dot, 1, 3)[1], 128);
+    check_equals(+pixel(dot, 1, 3)[3], 128);
+
+    // Each kernel gives the same pixels with SIMD as without.
+    check(sameWithoutSimd([](image::GnashImage& i) {
+        filter::boxBlur(i, 5, 9, 1);
+    }));
+    check(sameWithoutSimd([](image::GnashImage& i) {
+        filter::boxBlur(i, 40, 3, 3);
+    }));
+    check(sameWithoutSimd([&](image::GnashImage& i) {
+        filter::colorMatrix(i, swap);
+    }));
+    const float sepia[] = {
+        0.39f, 0.77f, 0.19f, 0, 0,
+        0.35f, 0.69f, 0.17f, 0, 0,
+        0.27f, 0.53f, 0.13f, 0, 0,
+        0, 0, 0, 0.8f, 12.5f
+    };
+    check(sameWithoutSimd([&](image::GnashImage& i) {
+        filter::colorMatrix(i, sepia);
+    }));
+    const float sharpen[] = { 0, -1, 0, -1, 5.5f, -1, 0, -1, 0 };
+    check(sameWithoutSimd([&](image::GnashImage& i) {
+        filter::convolve(i, 3, 3, sharpen, 1.5f, 3, false, true, 0, 0);
+    }));
+    const float wide[] = { 1, 2, 3, 2, 1 };
+    check(sameWithoutSimd([&](image::GnashImage& i) {
+        filter::convolve(i, 5, 1, wide, 9, 0, true, false, 0x336699, 40);
+    }));
+    check(sameWithoutSimd([](image::GnashImage& i) {
+        filter::shadow(i, 3, -2, 0x102030, 200, 6, 4, 1.5f, 2, false,
+                false, false);
+    }));
+    check(sameWithoutSimd([](image::GnashImage& i) {
+        filter::shadow(i, 0, 0, 0xffcc00, 255, 8, 8, 2, 1, true,
+                false, false);
+    }));
+
+    // Filters leave room for what they draw outside, and copies keep
+    // their parameters.
+    Filters filters;
+    filters.emplace_back(new BlurFilter(4, 8, 2));
+    filters.emplace_back(new DropShadowFilter(4, 0, 0, 255, 4, 4, 1, 1,
+                false, false, false));
+    filters.emplace_back(new GlowFilter(0, 255, 4, 4, 1, 1, true, false));
+
+    FilterMargins m;
+    for (const auto& f : filters) f->addMargins(m);
+    check_equals(m.left, 4 + 2);
+    check_equals(m.right, 4 + 2 + 4);
+    check_equals(m.top, 8 + 2);
+    check_equals(m.bottom, 8 + 2);
+
+    const Filters copies = cloneFilters(filters);
+    check_equals(copies.size(), 3);
+    const BlurFilter* blur = dynamic_cast<const BlurFilter*>(copies[0].get());
+    check(blur);
+    if (blur) {
+        check_equals(blur->m_blurY, 8);
+        check_equals(+blur->m_quality, 2);
+    }
+    check(dynamic_cast<const GlowFilter*>(copies[2].get()));
+
+    // Unimplemented filters say so.
+    image::ImageRGBA small(1, 1);
+    check(!BevelFilter().apply(small));
+    check(BlurFilter(4, 4, 1).apply(small));
+
+    return 0;
+}
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
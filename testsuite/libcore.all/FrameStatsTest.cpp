@@ -0,0 +1,157 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "log.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "check.h"
+#include "FrameStats.h"
+
+using namespace gnash;
+
+namespace {
+
+FrameStats::Counters
+totals(std::uint64_t actions, std::uint64_t allocated, std::uint64_t freed)
+{
+    FrameStats::Counters c;
+    c.actions = actions;
+    c.allocated = allocated;
+    c.freed = freed;
+    return c;
+}
+
+size_t
+count(const std::string& s, const std::string& what)
+{
+    size_t n = 0;
+    for (size_t p = s.find(what); p != std::string::npos;
+            p = s.find(what, p + 1)) {
+        ++n;
+    }
+    return n;
+}
+
+}
+
+int
+main()
+{
+    FrameStats stats(4);
+
+    // The current frame is only kept when the next one begins.
+    check_equals(stats.size(), 0);
+    stats.beginFrame(totals(0, 0, 0));
+    check_equals(stats.size(), 0);
+
+    // Phases are timed by the clock of the FrameStats, so these must
+    // come after the time the frame began.
+    const std::uint64_t t = stats.now();
+    stats.setAdvanced();
+    stats.addPhase(FrameStats::PHASE_ACTIONS, t + 10, t + 30);
+    stats.addPhase(FrameStats::PHASE_ACTIONS, t + 40, t + 45);
+    stats.addPhase(FrameStats::PHASE_RENDER, t + 50, t + 60);
+    stats.addInvalidatedArea(100);
+    stats.beginFrame(totals(12, 7, 3));
+    check_equals(stats.size(), 1);
+
+    const FrameStats::Frame& f = stats[0];
+    check(f.advanced);
+    check_equals(f.phaseStart[FrameStats::PHASE_ACTIONS], t + 10);
+    check_equals(f.phaseTime[FrameStats::PHASE_ACTIONS], 25);
+    check_equals(f.phaseTime[FrameStats::PHASE_RENDER], 10);
+    check_equals(f.phaseTime[FrameStats::PHASE_TIMERS], 0);
+    check_equals(f.end, t + 60);
+    check_equals(f.invalidatedArea, 100);
+    check_equals(f.counters.actions, 12);
+    check_equals(f.counters.allocated, 7);
+    check_equals(f.counters.freed, 3);
+
+    // Counters are per frame.
+    stats.beginFrame(totals(20, 7, 5));
+    check_equals(stats.size(), 2);
+    check(!stats[1].advanced);
+    check_equals(stats[1].counters.actions, 8);
+    check_equals(stats[1].counters.allocated, 0);
+    check_equals(stats[1].counters.freed, 2);
+    check_equals(stats[1].invalidatedArea, 0);
+
+    // Only the last frames are kept, oldest first.
+    std::uint64_t actions = 20;
+    for (std::uint64_t i = 3; i < 8; ++i) {
+        actions += i;
+        stats.beginFrame(totals(actions, 7, 5));
+    }
+    check_equals(stats.size(), 4);
+    check_equals(stats[0].counters.actions, 4);
+    check_equals(stats[3].counters.actions, 7);
+
+    // A Timer adds to its phase.
+    {
+        FrameStats::Timer t(stats, FrameStats::PHASE_TIMERS);
+    }
+    stats.beginFrame(totals(700, 7, 5));
+    check_equals(stats[3].phaseTime[FrameStats::PHASE_TIMERS],
+            stats[3].end - stats[3].phaseStart[FrameStats::PHASE_TIMERS]);
+    check(stats[3].phaseStart[FrameStats::PHASE_TIMERS] >= stats[3].start);
+
+    std::ostringstream trace;
+    stats.writeTrace(trace);
+    const std::string& s = trace.str();
+    check_equals(s.substr(0, 16), "{\"traceEvents\":[");
+    check_equals(count(s, "\"name\":\"frame\""), 4);
+    check_equals(count(s, "\"ph\":\"C\""), 4);
+    check_equals(count(s, "{"), count(s, "}"));
+    check_equals(count(s, "["), count(s, "]"));
+
+    std::ostringstream summary;
+    stats.summarize(summary);
+    check(summary.str().find("4 frames (0 advanced)") == 0);
+    check(summary.str().find("present") != std::string::npos);
+
+    // Ending a frame keeps it at once.
+    stats.endFrame(totals(800, 9, 5));
+    check_equals(stats[3].counters.actions, 100);
+    stats.endFrame(totals(900, 9, 5));
+    check_equals(stats[3].counters.actions, 100);
+
+    // Work outside a frame starts one, which counts everything since
+    // the last frame ended.
+    stats.addPhase(FrameStats::PHASE_RENDER, 1000, 1010);
+    stats.endFrame(totals(905, 9, 5));
+    check_equals(stats[3].start, 1000);
+    check_equals(stats[3].end, 1010);
+    check_equals(stats[3].phaseTime[FrameStats::PHASE_RENDER], 10);
+    check_equals(stats[3].counters.actions, 105);
+
+    check_equals(std::string(FrameStats::phaseName(FrameStats::PHASE_CLEANUP)),
+            "cleanup");
+
+    return 0;
+}
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
@@ -0,0 +1,183 @@
+// PropertyListBench.cpp: time PropertyList insertion, lookup and enumeration
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "PropertyList.h"
+#include "DummyMovieDefinition.h"
+#include "VM.h"
+#include "movie_root.h"
+#include "as_object.h"
+#include "as_value.h"
+#include "log.h"
+#include "ManualClock.h"
+#include "RunResources.h"
+#include "StreamProvider.h"
+#include "ClockTime.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdlib>
+
+using namespace std;
+using namespace gnash;
+
+// Prints the time taken to insert, look up and enumerate properties, for
+// many small objects (looked up by linear search) and for one large one
+// (looked up by hash), in case-sensitive (SWF7) and case-insensitive
+// (SWF6) mode.
+//
+// Pass a number to scale the amount of work; the default keeps
+// 'make check' quick.
+
+namespace {
+
+struct CountKeys : KeyVisitor
+{
+    CountKeys() : count(0) {}
+    void operator()(const ObjectURI&) { ++count; }
+    size_t count;
+};
+
+class Timer
+{
+public:
+    Timer() : _start(clocktime::getTicks()) {}
+    std::uint64_t elapsed() const { return clocktime::getTicks() - _start; }
+private:
+    std::uint64_t _start;
+};
+
+void
+report(const string& what, size_t ops, std::uint64_t ms)
+{
+    cout << "  " << what << ": " << ops << " in " << ms << " ms";
+    if (ms) cout << " (" << ops / ms << "/ms)";
+    cout << endl;
+}
+
+void
+bench(as_object& owner, const vector<ObjectURI>& names,
+        size_t objects, size_t rounds)
+{
+    const size_t props = names.size();
+    const as_value val(1.0);
+
+    vector<std::unique_ptr<PropertyList> > lists;
+    lists.reserve(objects);
+
+    Timer t;
+    for (size_t i = 0; i < objects; ++i) {
+        lists.push_back(std::unique_ptr<PropertyList>(new PropertyList(owner)));
+        for (const ObjectURI& uri : names) lists.back()->setValue(uri, val);
+    }
+    report("insert", objects * props, t.elapsed());
+
+    size_t found = 0;
+    Timer l;
+    for (size_t r = 0; r < rounds; ++r) {
+        for (const auto& p : lists) {
+            for (const ObjectURI& uri : names) {
+                if (p->getProperty(uri)) ++found;
+            }
+        }
+    }
+    report("lookup", rounds * objects * props, l.elapsed());
+
+    CountKeys keys;
+    Timer e;
+    for (size_t r = 0; r < rounds; ++r) {
+        for (const auto& p : lists) {
+            PropertyList::PropertyTracker done;
+            p->visitKeys(keys, done);
+        }
+    }
+    report("enumerate", keys.count, e.elapsed());
+
+    if (found != rounds * objects * props) {
+        cout << "  ERROR: " << found << " lookups succeeded" << endl;
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+vector<ObjectURI>
+makeNames(VM& vm, const string& prefix, size_t n)
+{
+    vector<ObjectURI> names;
+    for (size_t i = 0; i < n; ++i) {
+        std::ostringstream s;
+        s << prefix << i;
+        names.push_back(getURI(vm, s.str()));
+    }
+    return names;
+}
+
+}
+
+int
+main(int argc, char** argv)
+{
+    const size_t scale = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1;
+
+    RunResources runResources;
+    const URL url("");
+    runResources.setStreamProvider(
+            std::shared_ptr<StreamProvider>(new StreamProvider(url, url)));
+
+    boost::intrusive_ptr<movie_definition> md(
+            new DummyMovieDefinition(runResources, 7));
+
+    ManualClock clock;
+    movie_root root(clock, runResources);
+    root.init(md.get(), MovieClip::MovieVariables());
+
+    VM& vm = root.getVM();
+    as_object* owner = new as_object(getGlobal(vm));
+
+    const vector<ObjectURI> small = makeNames(vm, "smallProp", 4);
+    const vector<ObjectURI> large = makeNames(vm, "largeProp", 1000);
+
+    cout << "sizeof(PropertyList): " << sizeof(PropertyList) << endl;
+
+    const size_t objects = 20000 * scale;
+
+    const int versions[] = { 7, 6 };
+    for (int version : versions) {
+        vm.setSWFVersion(version);
+
+        cout << "SWF" << version << ", " << objects << " objects with "
+             << small.size() << " properties:" << endl;
+        bench(*owner, small, objects, 10);
+
+        cout << "SWF" << version << ", 1 object with "
+             << large.size() << " properties:" << endl;
+        bench(*owner, large, scale, 100);
+    }
+
+    return 0;
+}
+
+// Local Variables:
+// mode: C++
+// indent-tabs-mode: nil
+// End:
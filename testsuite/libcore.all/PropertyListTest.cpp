@@ -36,6 +36,7 @@
 #include <sstream>
 #include <cassert>
 #include <string>
+#include <vector>
 #include <utility> // for make_pair
 
 #include "check.h"
@@ -55,6 +56,20 @@ getVal(PropertyList& p, const ObjectURI& k, as_value& val, as_object& obj)
     return false;
 }
 
+struct KeyCollector : KeyVisitor
+{
+    void operator()(const ObjectURI& uri) { keys.push_back(uri); }
+    std::vector<ObjectURI> keys;
+};
+
+ObjectURI
+nthURI(VM& vm, const std::string& prefix, size_t n)
+{
+    std::ostringstream s;
+    s << prefix << n;
+    return getURI(vm, s.str());
+}
+
 TRYMAIN(_runtest);
 int
 trymain(int /*argc*/, char** /*argv*/)
@@ -203,6 +218,135 @@ trymain(int /*argc*/, char** /*argv*/)
 		check_equals(props.size(), 3);
 
 	}
+
+    // Lists with more than PropertyList::flatLimit properties are
+    // looked up by hash; they must behave like small ones.
+    vm.setSWFVersion(7);
+
+    PropertyList big(*obj);
+    for (size_t i = 0; i < 100; ++i) {
+        big.setValue(nthURI(vm, "prop", i), as_value(static_cast<double>(i)));
+    }
+    check_equals(big.size(), 100);
+    check(getVal(big, getURI(vm, "prop57"), ret, *obj));
+    check_strictly_equals(ret, as_value(57.0));
+    check(!getVal(big, getURI(vm, "PROP57"), ret, *obj));
+
+    // Properties don't move when others are added.
+    Property* prop1 = big.getProperty(getURI(vm, "prop1"));
+    for (size_t i = 0; i < 100; ++i) {
+        big.setValue(nthURI(vm, "other", i), val);
+    }
+    check_equals(big.getProperty(getURI(vm, "prop1")), prop1);
+    for (size_t i = 0; i < 100; ++i) {
+        check(big.delProperty(nthURI(vm, "other", i)).second);
+    }
+    check_equals(big.getProperty(getURI(vm, "prop1")), prop1);
+
+    check(big.setValue(getURI(vm, "PROP57"), val));
+    check_equals(big.size(), 101);
+
+    // Case-insensitive lookups find the first property created.
+    vm.setSWFVersion(6);
+    check(getVal(big, getURI(vm, "Prop57"), ret, *obj));
+    check_strictly_equals(ret, as_value(57.0));
+    check(big.delProperty(getURI(vm, "prop57")).second);
+    check(getVal(big, getURI(vm, "Prop57"), ret, *obj));
+    check_strictly_equals(ret, val);
+    check(big.setValue(getURI(vm, "pROP57"), val2));
+    check_equals(big.size(), 100);
+    vm.setSWFVersion(7);
+    check(getVal(big, getURI(vm, "PROP57"), ret, *obj));
+    check_strictly_equals(ret, val2);
+
+    for (size_t i = 0; i < 100; i += 2) {
+        check(big.delProperty(nthURI(vm, "prop", i)).second);
+    }
+    check_equals(big.size(), 50);
+    check(!getVal(big, getURI(vm, "prop2"), ret, *obj));
+    check(getVal(big, getURI(vm, "prop99"), ret, *obj));
+    check_strictly_equals(ret, as_value(99.0));
+
+    // Enumeration follows creation order.
+    KeyCollector keys;
+    PropertyList::PropertyTracker done;
+    big.visitKeys(keys, done);
+    check_equals(keys.keys.size(), 50);
+    check(keys.keys.front().name == getURI(vm, "prop1").name);
+    check(keys.keys[27].name == getURI(vm, "prop55").name);
+    check(keys.keys[28].name == getURI(vm, "prop59").name);
+    check(keys.keys.back().name == getURI(vm, "PROP57").name);
+
+    big.clear();
+    check_equals(big.size(), 0);
+    check(!getVal(big, getURI(vm, "prop1"), ret, *obj));
+
+    // Array elements created in order are stored densely.
+    PropertyList dense(*obj);
+    dense.setValue(getURI(vm, "length"), val, PropFlags::dontEnum);
+    dense.setDense();
+    check(dense.elements());
+    for (size_t i = 0; i < 3; ++i) {
+        check(dense.setValue(nthURI(vm, "", i), as_value(static_cast<double>(i))));
+    }
+    check(dense.setValue(getURI(vm, "other"), val));
+    check_equals(dense.size(), 5);
+    check_equals(dense.elements()->size(), 3);
+    check(dense.isElement(getURI(vm, "7")));
+    check(!dense.isElement(getURI(vm, "07")));
+    check(!dense.element(getURI(vm, "3")));
+    const as_value* elem = dense.element(getURI(vm, "2"));
+    check(elem);
+    if (elem) check_strictly_equals((*elem), as_value(2.0));
+
+    // Only the last element can be deleted without leaving a hole.
+    check(dense.delProperty(getURI(vm, "2")).second);
+    check_equals(dense.elements()->size(), 2);
+    check(dense.setValue(getURI(vm, "2"), val2));
+
+    // Elements created after another property are not.
+    check(dense.setValue(getURI(vm, "3"), val2));
+    check(!dense.elements());
+    check_equals(dense.size(), 6);
+
+    // Enumeration order doesn't change when storing sparsely.
+    KeyCollector denseKeys;
+    PropertyList::PropertyTracker denseDone;
+    dense.visitKeys(denseKeys, denseDone);
+    check_equals(denseKeys.keys.size(), 5);
+    check(denseKeys.keys[0].name == getURI(vm, "0").name);
+    check(denseKeys.keys[1].name == getURI(vm, "1").name);
+    check(denseKeys.keys[2].name == getURI(vm, "other").name);
+    check(denseKeys.keys[3].name == getURI(vm, "2").name);
+    check(denseKeys.keys[4].name == getURI(vm, "3").name);
+
+    // Asking for the Property of an element makes them all Properties.
+    PropertyList elems(*obj);
+    elems.setDense();
+    for (size_t i = 0; i < 20; ++i) {
+        elems.setValue(nthURI(vm, "", i), as_value(static_cast<double>(i)));
+    }
+    elems.setValue(getURI(vm, "after"), val);
+    check(elems.elements());
+    const PropertyList::Version before = elems.version();
+    check(getVal(elems, getURI(vm, "12"), ret, *obj));
+    check_strictly_equals(ret, as_value(12.0));
+    check(!elems.elements());
+    check(elems.version() != before);
+    check_equals(elems.size(), 21);
+    KeyCollector elemKeys;
+    PropertyList::PropertyTracker elemDone;
+    elems.visitKeys(elemKeys, elemDone);
+    check_equals(elemKeys.keys.size(), 21);
+    check(elemKeys.keys[19].name == getURI(vm, "19").name);
+    check(elemKeys.keys[20].name == getURI(vm, "after").name);
+
+    // Lists with an index property can't store densely.
+    PropertyList indexed(*obj);
+    indexed.setValue(getURI(vm, "1"), val);
+    indexed.setDense();
+    check(!indexed.elements());
+
 	return 0;
 }
 
@@ -0,0 +1,268 @@
+//
+//   Copyright (C) 2012 Free Software Foundation, Inc
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifdef HAVE_CONFIG_H
+#include "gnashconfig.h"
+#endif
+
+#include "movie_root.h"
+#include "as_value.h"
+#include "as_function.h"
+#include "fn_call.h"
+#include "Global_as.h"
+#include "Timers.h"
+#include "log.h"
+#include "VM.h"
+#include "DummyMovieDefinition.h"
+#include "movie_definition.h"
+#include "ManualClock.h"
+#include "RunResources.h"
+#include "StreamProvider.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "check.h"
+
+using namespace gnash;
+
+namespace {
+
+/// The tags of the timers run, in order.
+std::vector<int> fired;
+
+/// What a timer does besides recording its tag.
+std::function<void(int)> onFire;
+
+as_value
+record(const fn_call& fn)
+{
+    const int tag = toInt(fn.arg(0), getVM(fn));
+    fired.push_back(tag);
+    if (onFire) onFire(tag);
+    return as_value();
+}
+
+/// The tags of the timers run since the last call, like "1,2".
+std::string
+takeFired()
+{
+    std::ostringstream s;
+    for (size_t i = 0; i < fired.size(); ++i) {
+        if (i) s << ",";
+        s << fired[i];
+    }
+    fired.clear();
+    return s.str();
+}
+
+/// Add a timer that calls record() with its tag.
+std::uint32_t
+setTimer(movie_root& stage, as_function& f, as_object& o, unsigned long ms,
+        int tag, bool runOnce = false)
+{
+    fn_call::Args args;
+    args += tag;
+    return stage.addIntervalTimer(std::unique_ptr<Timer>(
+                new Timer(f, ms, &o, std::move(args), runOnce)));
+}
+
+}
+
+TRYMAIN(_runtest);
+int
+trymain(int /*argc*/, char** /*argv*/)
+{
+    gnash::LogFile& dbglogfile = gnash::LogFile::getDefaultInstance();
+    dbglogfile.setVerbosity();
+
+    RunResources ri;
+    const URL url("");
+    ri.setStreamProvider(
+            std::shared_ptr<StreamProvider>(new StreamProvider(url, url)));
+
+    boost::intrusive_ptr<movie_definition> md(new DummyMovieDefinition(ri, 7));
+
+    ManualClock clock;
+    movie_root stage(clock, ri);
+
+    MovieClip::MovieVariables v;
+    stage.init(md.get(), v);
+
+    as_object& o = *getObject(const_cast<Movie*>(&stage.getRootMovie()));
+    as_function& f = *getGlobal(o).createFunction(record);
+
+    // Timers expiring together run in the order they were set.
+    std::uint32_t a = setTimer(stage, f, o, 100, 1);
+    std::uint32_t b = setTimer(stage, f, o, 100, 2);
+    std::uint32_t c = setTimer(stage, f, o, 100, 3);
+
+    clock.advance(99);
+    stage.advance();
+    check_equals(takeFired(), "");
+
+    clock.advance(1);
+    stage.advance();
+    check_equals(takeFired(), "1,2,3");
+
+    // The next expiry is known once the timers ran.
+    check_equals(stage.timeToNextTimer(), 100);
+
+    // Each runs once per heartbeat.
+    stage.advance();
+    check_equals(takeFired(), "");
+
+    clock.advance(100);
+    stage.advance();
+    check_equals(takeFired(), "1,2,3");
+
+    check(stage.clearIntervalTimer(a));
+    check(stage.clearIntervalTimer(b));
+    check(stage.clearIntervalTimer(c));
+    check(!stage.clearIntervalTimer(a));
+
+    clock.advance(100);
+    stage.advance();
+    check_equals(takeFired(), "");
+
+    // A cleared timer doesn't hide the next one.
+    a = setTimer(stage, f, o, 50, 1);
+    b = setTimer(stage, f, o, 80, 2);
+    check_equals(stage.timeToNextTimer(), 50);
+    check(stage.clearIntervalTimer(a));
+    check_equals(stage.timeToNextTimer(), 80);
+    check(stage.clearIntervalTimer(b));
+    check_equals(stage.timeToNextTimer(), -1);
+
+    // Late timers run by expiry, but after those expiring just now.
+    a = setTimer(stage, f, o, 50, 1);
+    b = setTimer(stage, f, o, 30, 2);
+
+    clock.advance(100);
+    stage.advance();
+    check_equals(takeFired(), "2,1");
+
+    // 1 is now due exactly, 2 is late.
+    stage.advance();
+    check_equals(takeFired(), "1,2");
+
+    stage.advance();
+    check_equals(takeFired(), "2");
+
+    stage.advance();
+    check_equals(takeFired(), "");
+
+    stage.clearIntervalTimer(a);
+    stage.clearIntervalTimer(b);
+
+    // A timer cleared by one running before it doesn't run.
+    a = setTimer(stage, f, o, 100, 1);
+    b = setTimer(stage, f, o, 100, 2);
+    c = setTimer(stage, f, o, 100, 3);
+
+    onFire = [&](int tag) {
+        if (tag == 1) check(stage.clearIntervalTimer(b));
+    };
+    clock.advance(100);
+    stage.advance();
+    check_equals(takeFired(), "1,3");
+
+    // One clearing itself doesn't run again, nor does one cleared by a
+    // timer running after it.
+    onFire = [&](int tag) {
+        if (tag == 3) {
+            check(stage.clearIntervalTimer(c));
+            check(stage.clearIntervalTimer(a));
+        }
+    };
+    clock.advance(100);
+    stage.advance();
+    check_equals(takeFired(), "1,3");
+
+    clock.advance(100);
+    stage.advance();
+    check_equals(takeFired(), "");
+
+    // A timer replaced by one running before it runs when the new one
+    // is due.
+    a = setTimer(stage, f, o, 100, 1);
+    b = setTimer(stage, f, o, 100, 2);
+    onFire = [&](int tag) {
+        if (tag == 1) {
+            stage.clearIntervalTimer(a);
+            stage.clearIntervalTimer(b);
+            b = setTimer(stage, f, o, 100, 2);
+        }
+    };
+    clock.advance(100);
+    stage.advance();
+    check_equals(takeFired(), "1");
+
+    onFire = nullptr;
+    clock.advance(100);
+    stage.advance();
+    check_equals(takeFired(), "2");
+    stage.clearIntervalTimer(b);
+
+    // A timer set by a running one doesn't run in the same heartbeat, even
+    // if it is already due.
+    std::uint32_t added = 0;
+    a = setTimer(stage, f, o, 100, 1, true);
+    onFire = [&](int tag) {
+        if (tag == 1) added = setTimer(stage, f, o, 0, 4, true);
+    };
+    clock.advance(100);
+    stage.advance();
+    check_equals(takeFired(), "1");
+
+    onFire = nullptr;
+    stage.advance();
+    check_equals(takeFired(), "4");
+
+    // Both ran once, so they are gone.
+    check(!stage.clearIntervalTimer(a));
+    check(!stage.clearIntervalTimer(added));
+
+    // One set with an interval runs when it is due, after the others.
+    a = setTimer(stage, f, o, 100, 1);
+    onFire = [&](int tag) {
+        if (tag == 1 && !added) added = setTimer(stage, f, o, 100, 5);
+    };
+    added = 0;
+    clock.advance(100);
+    stage.advance();
+    check_equals(takeFired(), "1");
+
+    clock.advance(100);
+    stage.advance();
+    check_equals(takeFired(), "1,5");
+
+    onFire = nullptr;
+    stage.clearIntervalTimer(a);
+    stage.clearIntervalTimer(added);
+
+    clock.advance(100);
+    stage.advance();
+    check_equals(takeFired(), "");
+    check_equals(stage.timeToNextTimer(), -1);
+
+    return 0;
+}
@@ -444,6 +444,9 @@ play_movie(const std::string& filename, const RunResources& runResources)
 
     quitrequested = false;
 
+    // For measuring the time to the first frame.
+    const std::uint64_t startTicks = clocktime::getTicks();
+
     URL url(filename);
     
     try
@@ -513,6 +516,11 @@ play_movie(const std::string& filename, const RunResources& runResources)
         MovieClip::MovieVariables v;
         m.init(md.get(), v);
 
+        // The first frame has been parsed, constructed and its actions
+        // (including any ABC) executed.
+        log_debug("First frame ready %d ms after loading started",
+                clocktime::getTicks() - startTicks);
+
         log_debug("iteration, timer: %lu, localDelay: %ld",
                 cl.elapsed(), localDelay);
         gnashSleep(localDelay);